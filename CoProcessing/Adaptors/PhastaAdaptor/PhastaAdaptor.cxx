@@ -134,20 +134,11 @@ extern "C" void addfields(
   vtkIdType NumberOfNodes = UnstructuredGrid->GetNumberOfPoints();
   // now add numerical field data
   //velocity
+  // the components are stored one after the other, map them without copying
   if(idd->IsFieldNeeded("velocity"))
     {
-    vtkDoubleArray* velocity = vtkDoubleArray::New();
-    velocity->SetName("velocity");
-    velocity->SetNumberOfComponents(3);
-    velocity->SetNumberOfTuples(NumberOfNodes);
-    for (vtkIdType idx=0; idx<NumberOfNodes; idx++)
-      {
-      velocity->SetTuple3(idx, dofArray[idx],
-                          dofArray[idx+ *nshg],
-                          dofArray[idx+ *nshg*2]);
-      }
-    UnstructuredGrid->GetPointData()->AddArray(velocity);
-    velocity->Delete();
+    vtkCPAdaptorAPI::AddFieldArray("velocity", false, VTK_DOUBLE, dofArray,
+                                   NumberOfNodes, 3, 1, *nshg);
     }
 
   //pressure
@@ -16,6 +16,22 @@
 
 #include "vtkCPAdaptorAPI.h"
 
+#include <string>
+
+namespace
+{
+  void AddFieldArray(char* name, int* nameLength, int* cellData, int dataType,
+    void* data, int* numberOfTuples, int* numberOfComponents,
+    int* tupleStride, int* componentStride)
+    {
+    // Fortran strings are not null terminated.
+    std::string arrayName(name, *nameLength);
+    vtkCPAdaptorAPI::AddFieldArray(arrayName.c_str(), *cellData != 0, dataType,
+      data, *numberOfTuples, *numberOfComponents, *tupleStride,
+      *componentStride);
+    }
+}
+
 // call at the start of the simulation
 void coprocessorinitialize()
 {
@@ -51,3 +67,29 @@ void coprocess()
 {
   vtkCPAdaptorAPI::CoProcess();
 }
+
+// add a buffer of the simulation to the grid without copying it, until
+// coprocess() returns
+void addfieldarraydouble(char* name, int* nameLength, int* cellData,
+  double* data, int* numberOfTuples, int* numberOfComponents,
+  int* tupleStride, int* componentStride)
+{
+  AddFieldArray(name, nameLength, cellData, VTK_DOUBLE, data, numberOfTuples,
+    numberOfComponents, tupleStride, componentStride);
+}
+
+void addfieldarrayfloat(char* name, int* nameLength, int* cellData,
+  float* data, int* numberOfTuples, int* numberOfComponents,
+  int* tupleStride, int* componentStride)
+{
+  AddFieldArray(name, nameLength, cellData, VTK_FLOAT, data, numberOfTuples,
+    numberOfComponents, tupleStride, componentStride);
+}
+
+void addfieldarrayinteger(char* name, int* nameLength, int* cellData,
+  int* data, int* numberOfTuples, int* numberOfComponents,
+  int* tupleStride, int* componentStride)
+{
+  AddFieldArray(name, nameLength, cellData, VTK_INT, data, numberOfTuples,
+    numberOfComponents, tupleStride, componentStride);
+}
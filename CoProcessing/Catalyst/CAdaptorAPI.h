@@ -47,6 +47,23 @@ extern "C" {
   // has been filled in elsewhere.
   void VTKPVCATALYST_EXPORT coprocess();
 
+  // add a buffer of the simulation to the point data, or to the cell data
+  // when cellData is 1, of the grid without copying it, until coprocess()
+  // returns. Component c of tuple t is data[t*tupleStride +
+  // c*componentStride]: strides of 0 mean contiguous tuples, e.g. a Fortran
+  // array dimensioned (numberOfComponents, numberOfTuples), strides of 1
+  // and numberOfTuples mean separate components, e.g. a Fortran array
+  // dimensioned (numberOfTuples, numberOfComponents).
+  void VTKPVCATALYST_EXPORT addfieldarraydouble(char* name, int* nameLength,
+    int* cellData, double* data, int* numberOfTuples, int* numberOfComponents,
+    int* tupleStride, int* componentStride);
+  void VTKPVCATALYST_EXPORT addfieldarrayfloat(char* name, int* nameLength,
+    int* cellData, float* data, int* numberOfTuples, int* numberOfComponents,
+    int* tupleStride, int* componentStride);
+  void VTKPVCATALYST_EXPORT addfieldarrayinteger(char* name, int* nameLength,
+    int* cellData, int* data, int* numberOfTuples, int* numberOfComponents,
+    int* tupleStride, int* componentStride);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
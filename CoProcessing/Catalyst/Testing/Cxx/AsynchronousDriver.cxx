@@ -0,0 +1,170 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    AsynchronousDriver.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Runs a mock simulation, where computing a time step and co-processing it
+// take the same time, with vtkCPProcessor co-processing synchronously then
+// asynchronously, with the grids deep and shallow copied. Checks that the
+// pipeline sees the values of each time step and reports the wall time and
+// the timing counters of vtkCPDataDescription: asynchronously, the wall time
+// must get close to the time of the simulation alone.
+
+#include "vtkCPDataDescription.h"
+#include "vtkCPInputDataDescription.h"
+#include "vtkCPPipeline.h"
+#include "vtkCPProcessor.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkTimerLog.h"
+
+#include <vtksys/SystemTools.hxx>
+
+namespace
+{
+  const int NumberOfTimeSteps = 10;
+  const unsigned long StepDelay = 100; // milliseconds
+}
+
+// Checks the values of the grid and takes StepDelay to co-process them.
+class vtkAsynchronousDriverPipeline : public vtkCPPipeline
+{
+public:
+  static vtkAsynchronousDriverPipeline* New();
+  vtkTypeMacro(vtkAsynchronousDriverPipeline, vtkCPPipeline);
+
+  virtual int RequestDataDescription(vtkCPDataDescription* dataDescription)
+    {
+    dataDescription->GetInputDescriptionByName("input")->AllFieldsOn();
+    dataDescription->GetInputDescriptionByName("input")->GenerateMeshOn();
+    return 1;
+    }
+
+  virtual int CoProcess(vtkCPDataDescription* dataDescription)
+    {
+    vtkImageData* grid = vtkImageData::SafeDownCast(
+      dataDescription->GetInputDescriptionByName("input")->GetGrid());
+    vtkDataArray* values = grid? grid->GetPointData()->GetArray("value") : NULL;
+    double expected = static_cast<double>(dataDescription->GetTimeStep());
+    if (!values || values->GetTuple1(0) != expected ||
+      values->GetTuple1(values->GetNumberOfTuples() - 1) != expected)
+      {
+      cerr << "ERROR: wrong values for time step " << expected << endl;
+      return 0;
+      }
+    vtksys::SystemTools::Delay(StepDelay);
+    ++this->NumberOfCoProcessedSteps;
+    return 1;
+    }
+
+  int NumberOfCoProcessedSteps;
+
+protected:
+  vtkAsynchronousDriverPipeline() : NumberOfCoProcessedSteps(0) {}
+
+private:
+  vtkAsynchronousDriverPipeline(const vtkAsynchronousDriverPipeline&); // Not implemented
+  void operator=(const vtkAsynchronousDriverPipeline&); // Not implemented
+};
+
+vtkStandardNewMacro(vtkAsynchronousDriverPipeline);
+
+namespace
+{
+  // Runs the simulation, returns false on errors.
+  bool Simulate(bool asynchronous, bool shallow)
+    {
+    vtkNew<vtkCPProcessor> processor;
+    processor->SetAsynchronousCoProcessing(asynchronous? 1 : 0);
+    vtkNew<vtkAsynchronousDriverPipeline> pipeline;
+    processor->AddPipeline(pipeline.GetPointer());
+
+    vtkNew<vtkCPDataDescription> dataDescription;
+    dataDescription->AddInput("input");
+    dataDescription->GetInputDescriptionByName("input")->SetShallowStaging(
+      shallow);
+
+    vtkNew<vtkImageData> grid;
+    grid->SetDimensions(64, 64, 64);
+    vtkNew<vtkDoubleArray> values;
+    values->SetName("value");
+    values->SetNumberOfTuples(grid->GetNumberOfPoints());
+    grid->GetPointData()->AddArray(values.GetPointer());
+
+    bool status = true;
+    double staging = 0;
+    double backPressure = 0;
+    double start = vtkTimerLog::GetUniversalTime();
+    for (int step = 0; step < NumberOfTimeSteps; ++step)
+      {
+      // computes the time step. When staged shallow, the values of the
+      // previous time step must be left untouched: a new array is used.
+      vtksys::SystemTools::Delay(StepDelay);
+      vtkDoubleArray* current = values.GetPointer();
+      vtkNew<vtkDoubleArray> next;
+      if (shallow)
+        {
+        next->DeepCopy(values.GetPointer());
+        grid->GetPointData()->AddArray(next.GetPointer());
+        current = next.GetPointer();
+        }
+      current->FillComponent(0, step);
+
+      dataDescription->SetTimeData(step, step);
+      if (processor->RequestDataDescription(dataDescription.GetPointer()))
+        {
+        dataDescription->GetInputDescriptionByName("input")->SetGrid(
+          grid.GetPointer());
+        status = processor->CoProcess(dataDescription.GetPointer()) && status;
+        staging += dataDescription->GetStagingTime();
+        backPressure += dataDescription->GetBackPressureTime();
+        }
+      }
+    processor->Finalize();
+    double elapsed = vtkTimerLog::GetUniversalTime() - start;
+
+    cout << (asynchronous? (shallow? "asynchronous, shallow staging" :
+        "asynchronous, deep staging") : "synchronous")
+         << ": " << elapsed << "s, staging " << staging
+         << "s, back-pressure " << backPressure << "s, simulation alone "
+         << NumberOfTimeSteps * StepDelay / 1000.0 << "s" << endl;
+
+    if (pipeline->NumberOfCoProcessedSteps != NumberOfTimeSteps)
+      {
+      cerr << "ERROR: " << pipeline->NumberOfCoProcessedSteps
+           << " time steps co-processed instead of " << NumberOfTimeSteps
+           << endl;
+      status = false;
+      }
+    // synchronously, the time steps take twice the time of the simulation.
+    // Asynchronously, only the last one does.
+    double synchronousTime = 2 * NumberOfTimeSteps * StepDelay / 1000.0;
+    if (asynchronous && elapsed > 0.75 * synchronousTime)
+      {
+      cerr << "ERROR: asynchronous co-processing does not overlap the "
+           << "simulation." << endl;
+      status = false;
+      }
+    return status;
+    }
+}
+
+int AsynchronousDriver(int, char*[])
+{
+  bool status = Simulate(false, false);
+  status = Simulate(true, false) && status;
+  status = Simulate(true, true) && status;
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
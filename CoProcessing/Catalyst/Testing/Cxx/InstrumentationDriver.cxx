@@ -0,0 +1,145 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    InstrumentationDriver.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Co-processes a few time steps with a pipeline writing a file, with the
+// instrumentation of vtkCPProcessor on, and checks the JSON and CSV logs
+// written by Finalize().
+
+#include "vtkCPDataDescription.h"
+#include "vtkCPPipeline.h"
+#include "vtkCPProcessor.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkTesting.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <vtksys/SystemTools.hxx>
+
+namespace
+{
+  const int NumberOfTimeSteps = 5;
+  const int BytesPerStep = 1 << 20;
+}
+
+// Writes BytesPerStep to a file per co-processing call.
+class vtkInstrumentationDriverPipeline : public vtkCPPipeline
+{
+public:
+  static vtkInstrumentationDriverPipeline* New();
+  vtkTypeMacro(vtkInstrumentationDriverPipeline, vtkCPPipeline);
+
+  virtual int RequestDataDescription(vtkCPDataDescription*)
+    {
+    return 1;
+    }
+
+  virtual int CoProcess(vtkCPDataDescription*)
+    {
+    std::vector<char> data(BytesPerStep, 'x');
+    ofstream file(this->FileName.c_str(), ios::out | ios::binary);
+    file.write(&data[0], BytesPerStep);
+    return file? 1 : 0;
+    }
+
+  std::string FileName;
+
+protected:
+  vtkInstrumentationDriverPipeline() {}
+
+private:
+  vtkInstrumentationDriverPipeline(const vtkInstrumentationDriverPipeline&); // Not implemented
+  void operator=(const vtkInstrumentationDriverPipeline&); // Not implemented
+};
+
+vtkStandardNewMacro(vtkInstrumentationDriverPipeline);
+
+namespace
+{
+  // Co-processes the time steps and returns the log.
+  std::string Run(const std::string& directory, const char* logName)
+    {
+    std::string logFileName = directory + "/" + logName;
+    vtksys::SystemTools::RemoveFile(logFileName.c_str());
+
+    vtkNew<vtkCPProcessor> processor;
+    processor->SetInstrumentationFileName(logFileName.c_str());
+    vtkNew<vtkInstrumentationDriverPipeline> pipeline;
+    pipeline->FileName = directory + "/InstrumentationDriver.dat";
+    processor->AddPipeline(pipeline.GetPointer());
+
+    vtkNew<vtkCPDataDescription> dataDescription;
+    dataDescription->AddInput("input");
+    for (int step = 0; step < NumberOfTimeSteps; ++step)
+      {
+      dataDescription->SetTimeData(step, step);
+      if (processor->RequestDataDescription(dataDescription.GetPointer()))
+        {
+        processor->CoProcess(dataDescription.GetPointer());
+        }
+      }
+    processor->Finalize();
+    vtksys::SystemTools::RemoveFile(pipeline->FileName.c_str());
+
+    std::ostringstream log;
+    ifstream file(logFileName.c_str());
+    log << file.rdbuf();
+    cout << log.str() << endl;
+    return log.str();
+    }
+}
+
+int InstrumentationDriver(int argc, char* argv[])
+{
+  vtkNew<vtkTesting> testing;
+  testing->AddArguments(argc, const_cast<const char**>(argv));
+  std::string directory = testing->GetTempDirectory();
+  bool status = true;
+
+  std::string json = Run(directory, "InstrumentationDriver.json");
+  std::ostringstream calls;
+  calls << "\"calls\": " << NumberOfTimeSteps << ",";
+  if (json.find("\"name\": \"vtkInstrumentationDriverPipeline\"") ==
+    std::string::npos || json.find(calls.str()) == std::string::npos)
+    {
+    cerr << "ERROR: wrong JSON log." << endl;
+    status = false;
+    }
+
+  std::string csv = Run(directory, "InstrumentationDriver.csv");
+  std::istringstream lines(csv);
+  std::string header, row;
+  std::getline(lines, header);
+  std::getline(lines, row);
+  std::vector<std::string> columns;
+  vtksys::SystemTools::Split(row, columns, ',');
+  if (header.compare(0, 15, "pipeline index,") != 0 || columns.size() != 15 ||
+    columns[1] != "\"vtkInstrumentationDriverPipeline\"" || columns[2] != "\"\"" ||
+    atoi(columns[4].c_str()) != NumberOfTimeSteps)
+    {
+    cerr << "ERROR: wrong CSV log." << endl;
+    status = false;
+    }
+#if defined(__linux__)
+  else if (atof(columns[12].c_str()) < NumberOfTimeSteps * BytesPerStep)
+    {
+    cerr << "ERROR: bytes written not recorded." << endl;
+    status = false;
+    }
+#endif
+
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,223 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    ZeroCopyDriver.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Runs a mock simulation through vtkCPAdaptorAPI, as a C or Fortran
+// adaptor does, with a vector field stored as a structure of arrays and a
+// scalar field, first copying them into VTK arrays then adding them with
+// vtkCPAdaptorAPI::AddFieldArray(). Checks that the pipeline sees the
+// values of each time step and that the arrays are removed after each
+// co-processing call, and reports the time and the memory used per step.
+
+#include "vtkCPAdaptorAPI.h"
+#include "vtkCPDataDescription.h"
+#include "vtkCPInputDataDescription.h"
+#include "vtkCPPipeline.h"
+#include "vtkCPProcessor.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkTimerLog.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include <vtksys/SystemInformation.hxx>
+
+namespace
+{
+  const int NumberOfTimeSteps = 5;
+  const int Dimension = 100; // 10^6 points
+
+  // Memory used by the process, in KiB.
+  long long GetMemoryUsed()
+    {
+    vtksys::SystemInformation information;
+    return information.GetProcMemoryUsed();
+    }
+}
+
+// Checks the values of the fields and records the memory used.
+class vtkZeroCopyDriverPipeline : public vtkCPPipeline
+{
+public:
+  static vtkZeroCopyDriverPipeline* New();
+  vtkTypeMacro(vtkZeroCopyDriverPipeline, vtkCPPipeline);
+
+  virtual int RequestDataDescription(vtkCPDataDescription* dataDescription)
+    {
+    dataDescription->GetInputDescriptionByName("input")->AllFieldsOn();
+    dataDescription->GetInputDescriptionByName("input")->GenerateMeshOn();
+    return 1;
+    }
+
+  virtual int CoProcess(vtkCPDataDescription* dataDescription)
+    {
+    this->MemoryUsed = GetMemoryUsed();
+    vtkImageData* grid = vtkImageData::SafeDownCast(
+      dataDescription->GetInputDescriptionByName("input")->GetGrid());
+    vtkDataArray* velocity = grid->GetPointData()->GetArray("velocity");
+    vtkDataArray* pressure = grid->GetPointData()->GetArray("pressure");
+    double step = static_cast<double>(dataDescription->GetTimeStep());
+    vtkIdType last = grid->GetNumberOfPoints() - 1;
+    if (!velocity || !pressure || velocity->GetNumberOfComponents() != 3 ||
+      velocity->GetComponent(0, 0) != step ||
+      velocity->GetComponent(0, 2) != step + 2 ||
+      velocity->GetComponent(last, 1) != step + 1 + last ||
+      pressure->GetTuple1(last) != -step)
+      {
+      cerr << "ERROR: wrong values for time step " << step << endl;
+      return 0;
+      }
+    ++this->NumberOfCoProcessedSteps;
+    return 1;
+    }
+
+  long long MemoryUsed;
+  int NumberOfCoProcessedSteps;
+
+protected:
+  vtkZeroCopyDriverPipeline() : MemoryUsed(0), NumberOfCoProcessedSteps(0) {}
+
+private:
+  vtkZeroCopyDriverPipeline(const vtkZeroCopyDriverPipeline&); // Not implemented
+  void operator=(const vtkZeroCopyDriverPipeline&); // Not implemented
+};
+
+vtkStandardNewMacro(vtkZeroCopyDriverPipeline);
+
+namespace
+{
+  // Runs the simulation, returns false on errors. Sets the memory added
+  // while co-processing, in KiB.
+  bool Simulate(bool zeroCopy, long long& memory)
+    {
+    vtkNew<vtkZeroCopyDriverPipeline> pipeline;
+    vtkCPAdaptorAPI::GetCoProcessor()->AddPipeline(pipeline.GetPointer());
+
+    vtkIdType numberOfPoints = Dimension * Dimension * Dimension;
+    // the velocity components are stored one after the other.
+    std::vector<double> velocity(3 * numberOfPoints);
+    std::vector<double> pressure(numberOfPoints);
+
+    bool status = true;
+    double elapsed = 0;
+    memory = 0;
+    for (int step = 0; step < NumberOfTimeSteps; ++step)
+      {
+      for (vtkIdType i = 0; i < numberOfPoints; ++i)
+        {
+        for (int c = 0; c < 3; ++c)
+          {
+          velocity[i + c * numberOfPoints] = step + c + i;
+          }
+        pressure[i] = -step;
+        }
+
+      double time = step;
+      int coProcess = 0;
+      vtkCPAdaptorAPI::RequestDataDescription(&step, &time, &coProcess);
+      if (!coProcess)
+        {
+        continue;
+        }
+      long long baseMemory = GetMemoryUsed();
+      double start = vtkTimerLog::GetUniversalTime();
+      int needGrid = 0;
+      vtkCPAdaptorAPI::NeedToCreateGrid(&needGrid);
+      if (needGrid)
+        {
+        vtkNew<vtkImageData> grid;
+        grid->SetDimensions(Dimension, Dimension, Dimension);
+        vtkCPAdaptorAPI::GetCoProcessorData()->GetInputDescriptionByName(
+          "input")->SetGrid(grid.GetPointer());
+        }
+      vtkDataSet* grid = vtkDataSet::SafeDownCast(
+        vtkCPAdaptorAPI::GetCoProcessorData()->GetInputDescriptionByName(
+          "input")->GetGrid());
+      if (zeroCopy)
+        {
+        status = vtkCPAdaptorAPI::AddFieldArray("velocity", false, VTK_DOUBLE,
+            &velocity[0], numberOfPoints, 3, 1, numberOfPoints) && status;
+        status = vtkCPAdaptorAPI::AddFieldArray("pressure", false, VTK_DOUBLE,
+            &pressure[0], numberOfPoints, 1) && status;
+        }
+      else
+        {
+        vtkNew<vtkDoubleArray> velocityArray;
+        velocityArray->SetName("velocity");
+        velocityArray->SetNumberOfComponents(3);
+        velocityArray->SetNumberOfTuples(numberOfPoints);
+        for (vtkIdType i = 0; i < numberOfPoints; ++i)
+          {
+          velocityArray->SetTuple3(i, velocity[i],
+            velocity[i + numberOfPoints], velocity[i + 2 * numberOfPoints]);
+          }
+        grid->GetPointData()->AddArray(velocityArray.GetPointer());
+        vtkNew<vtkDoubleArray> pressureArray;
+        pressureArray->SetName("pressure");
+        pressureArray->SetNumberOfTuples(numberOfPoints);
+        std::copy(pressure.begin(), pressure.end(),
+          pressureArray->GetPointer(0));
+        grid->GetPointData()->AddArray(pressureArray.GetPointer());
+        }
+      vtkCPAdaptorAPI::CoProcess();
+      elapsed += vtkTimerLog::GetUniversalTime() - start;
+      memory += pipeline->MemoryUsed - baseMemory;
+
+      if (zeroCopy && (grid->GetPointData()->GetArray("velocity") ||
+          grid->GetPointData()->GetArray("pressure")))
+        {
+        cerr << "ERROR: field arrays not removed after co-processing." << endl;
+        status = false;
+        }
+      }
+    vtkCPAdaptorAPI::GetCoProcessor()->RemovePipeline(pipeline.GetPointer());
+    memory /= NumberOfTimeSteps;
+
+    cout << (zeroCopy? "zero-copy" : "copy") << ": "
+         << elapsed / NumberOfTimeSteps << "s and " << memory
+         << " KiB added per time step, fields of "
+         << 4 * numberOfPoints * sizeof(double) / 1024 << " KiB" << endl;
+
+    if (pipeline->NumberOfCoProcessedSteps != NumberOfTimeSteps)
+      {
+      cerr << "ERROR: " << pipeline->NumberOfCoProcessedSteps
+           << " time steps co-processed instead of " << NumberOfTimeSteps
+           << endl;
+      status = false;
+      }
+    return status;
+    }
+}
+
+int ZeroCopyDriver(int, char*[])
+{
+  long long copyMemory = 0;
+  long long zeroCopyMemory = 0;
+  vtkCPAdaptorAPI::CoProcessorInitialize();
+  bool status = Simulate(false, copyMemory);
+  status = Simulate(true, zeroCopyMemory) && status;
+  vtkCPAdaptorAPI::CoProcessorFinalize();
+#if defined(__linux__)
+  // the copies hold as much memory as the fields.
+  if (zeroCopyMemory > copyMemory / 2)
+    {
+    cerr << "ERROR: zero-copy fields use as much memory as copies." << endl;
+    status = false;
+    }
+#endif
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -18,12 +18,17 @@
 #include "vtkCompositeDataIterator.h"
 #include "vtkCPDataDescription.h"
 #include "vtkCPInputDataDescription.h"
+#include "vtkCPMappedDataArrayTemplate.h"
 #include "vtkCPProcessor.h"
+#include "vtkDataArray.h"
 #include "vtkDataSet.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkPointData.h"
+#include "vtkWeakPointer.h"
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 // This code is meant as an API for Fortran and C simulation codes.
 namespace ParaViewCoProcessing
@@ -40,6 +45,26 @@ namespace ParaViewCoProcessing
       grid->GetFieldData()->Initialize();
       }
     }
+
+  /// An array added by vtkCPAdaptorAPI::AddFieldArray().
+  struct FieldArray
+    {
+    vtkWeakPointer<vtkDataSetAttributes> Attributes;
+    std::string Name;
+    };
+  std::vector<FieldArray> FieldArrays;
+
+  /// Maps a strided buffer without copying it.
+  template <class T>
+  vtkDataArray* NewMappedArray(T* data, vtkIdType numberOfTuples,
+    int numberOfComponents, vtkIdType tupleStride, vtkIdType componentStride)
+    {
+    vtkCPMappedDataArrayTemplate<T>* array =
+      vtkCPMappedDataArrayTemplate<T>::New();
+    array->SetStridedArray(data, numberOfTuples, numberOfComponents,
+      tupleStride, componentStride);
+    return array;
+    }
 } // end namespace
 
 vtkCPDataDescription* vtkCPAdaptorAPI::CoProcessorData = NULL;
@@ -67,6 +92,8 @@ void vtkCPAdaptorAPI::CoProcessorInitialize()
 //-----------------------------------------------------------------------------
 void vtkCPAdaptorAPI::CoProcessorFinalize()
 {
+  vtkCPAdaptorAPI::RemoveFieldArrays();
+
   if(vtkCPAdaptorAPI::CoProcessor)
     {
     vtkCPAdaptorAPI::CoProcessor->Delete();
@@ -162,6 +189,103 @@ void vtkCPAdaptorAPI::CoProcess()
     {
     vtkCPAdaptorAPI::CoProcessor->CoProcess(vtkCPAdaptorAPI::CoProcessorData);
     }
+  // The buffers of the simulation are only valid during this call.
+  vtkCPAdaptorAPI::RemoveFieldArrays();
   // Reset time data.
   vtkCPAdaptorAPI::IsTimeDataSet = false;
 }
+
+//-----------------------------------------------------------------------------
+bool vtkCPAdaptorAPI::AddFieldArray(const char* name, bool cellData,
+  int dataType, void* data, vtkIdType numberOfTuples, int numberOfComponents,
+  vtkIdType tupleStride, vtkIdType componentStride, unsigned int block)
+{
+  if(!vtkCPAdaptorAPI::CoProcessorData || !name || !data ||
+     numberOfTuples < 0 || numberOfComponents < 1)
+    {
+    vtkGenericWarningMacro("Cannot add field array.");
+    return false;
+    }
+  vtkDataObject* grid =
+    vtkCPAdaptorAPI::CoProcessorData->GetInputDescriptionByName("input")->GetGrid();
+  vtkDataSet* dataSet = vtkDataSet::SafeDownCast(grid);
+  if(vtkMultiBlockDataSet* multiBlock = vtkMultiBlockDataSet::SafeDownCast(grid))
+    {
+    dataSet = block < multiBlock->GetNumberOfBlocks() ?
+      vtkDataSet::SafeDownCast(multiBlock->GetBlock(block)) : NULL;
+    }
+  if(!dataSet)
+    {
+    vtkGenericWarningMacro("No grid to attach field array " << name << " to.");
+    return false;
+    }
+
+  if(tupleStride == 0 && componentStride == 0)
+    {
+    tupleStride = numberOfComponents;
+    componentStride = 1;
+    }
+  vtkDataArray* array = NULL;
+  if(tupleStride == numberOfComponents && componentStride == 1)
+    {
+    array = vtkDataArray::CreateDataArray(dataType);
+    if(array)
+      {
+      array->SetNumberOfComponents(numberOfComponents);
+      // save = 1: the buffer is not released with the array.
+      array->SetVoidArray(data, numberOfTuples * numberOfComponents, 1);
+      }
+    }
+  else
+    {
+    switch(dataType)
+      {
+      case VTK_DOUBLE:
+        array = ParaViewCoProcessing::NewMappedArray(static_cast<double*>(data),
+          numberOfTuples, numberOfComponents, tupleStride, componentStride);
+        break;
+      case VTK_FLOAT:
+        array = ParaViewCoProcessing::NewMappedArray(static_cast<float*>(data),
+          numberOfTuples, numberOfComponents, tupleStride, componentStride);
+        break;
+      case VTK_INT:
+        array = ParaViewCoProcessing::NewMappedArray(static_cast<int*>(data),
+          numberOfTuples, numberOfComponents, tupleStride, componentStride);
+        break;
+      }
+    }
+  if(!array)
+    {
+    vtkGenericWarningMacro("Unsupported data type " << dataType
+                           << " for field array " << name << ".");
+    return false;
+    }
+  array->SetName(name);
+
+  vtkDataSetAttributes* attributes = cellData ?
+    static_cast<vtkDataSetAttributes*>(dataSet->GetCellData()) :
+    static_cast<vtkDataSetAttributes*>(dataSet->GetPointData());
+  attributes->AddArray(array);
+  array->Delete();
+
+  ParaViewCoProcessing::FieldArray fieldArray;
+  fieldArray.Attributes = attributes;
+  fieldArray.Name = name;
+  ParaViewCoProcessing::FieldArrays.push_back(fieldArray);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void vtkCPAdaptorAPI::RemoveFieldArrays()
+{
+  std::vector<ParaViewCoProcessing::FieldArray>::iterator iter;
+  for(iter = ParaViewCoProcessing::FieldArrays.begin();
+      iter != ParaViewCoProcessing::FieldArrays.end(); ++iter)
+    {
+    if(iter->Attributes)
+      {
+      iter->Attributes->RemoveArray(iter->Name.c_str());
+      }
+    }
+  ParaViewCoProcessing::FieldArrays.clear();
+}
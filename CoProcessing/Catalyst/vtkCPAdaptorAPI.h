@@ -46,9 +46,30 @@ public:
   static void NeedToCreateGrid(int* needGrid);
 
   /// do the actual coprocessing.  it is assumed that the vtkCPDataDescription
-  /// has been filled in elsewhere.
+  /// has been filled in elsewhere. The arrays added with AddFieldArray()
+  /// are removed from the grid afterwards.
   static void CoProcess();
 
+  /// Adds a buffer of the simulation as an array of the point data, or of
+  /// the cell data when cellData is true, of the "input" grid, or of its
+  /// block at the given index when it is a vtkMultiBlockDataSet, without
+  /// copying it. Component c of tuple t is data[t*tupleStride +
+  /// c*componentStride], in number of values of the given VTK data type:
+  /// strides of 0 mean contiguous tuples (array of structures, or a Fortran
+  /// array dimensioned (numberOfComponents, numberOfTuples)), strides of 1
+  /// and numberOfTuples mean separate components (structure of arrays, or a
+  /// Fortran array dimensioned (numberOfTuples, numberOfComponents)).
+  /// Contiguous buffers are used as the storage of a regular array, the
+  /// others through a vtkCPMappedDataArrayTemplate, which only supports
+  /// VTK_DOUBLE, VTK_FLOAT and VTK_INT. The buffer must stay valid and
+  /// unchanged until CoProcess() returns, which removes the array, or
+  /// until the co-processing of the time step completes when it is
+  /// asynchronous with shallow staging. Returns false on errors.
+  static bool AddFieldArray(const char* name, bool cellData, int dataType,
+    void* data, vtkIdType numberOfTuples, int numberOfComponents,
+    vtkIdType tupleStride = 0, vtkIdType componentStride = 0,
+    unsigned int block = 0);
+
   /// provides access to the vtkCPDataDescription instance.
   static vtkCPDataDescription* GetCoProcessorData()
     { return vtkCPAdaptorAPI::CoProcessorData; }
@@ -68,6 +89,9 @@ protected:
   // as if coprocessing is not needed for this time/time step
   static bool IsTimeDataSet;
 
+  /// Removes the arrays added by AddFieldArray() from their grids.
+  static void RemoveFieldArrays();
+
 };
 #endif
 // VTK-HeaderTest-Exclude: vtkCPAdaptorAPI.h
@@ -47,6 +47,9 @@ vtkCPDataDescription::vtkCPDataDescription()
   this->IsTimeDataSet = false;
   this->ForceOutput = false;
   this->UserData = NULL;
+  this->StagingTime = 0;
+  this->BackPressureTime = 0;
+  this->CoProcessingTime = 0;
 
   this->Internals = new vtkInternals();
 }
@@ -206,4 +209,7 @@ void vtkCPDataDescription::PrintSelf(ostream& os, vtkIndent indent)
     {
     os << indent << "UserData: (NULL)\n";
     }
+  os << indent << "StagingTime: " << this->StagingTime << "\n";
+  os << indent << "BackPressureTime: " << this->BackPressureTime << "\n";
+  os << indent << "CoProcessingTime: " << this->CoProcessingTime << "\n";
 }
@@ -96,6 +96,18 @@ public:
   /// adaptor to the coprocessing pipelines.
   vtkGetObjectMacro(UserData, vtkFieldData);
 
+  /// Timing counters, in seconds, set by vtkCPProcessor::CoProcess().
+  /// StagingTime is the time spent copying the grids for asynchronous
+  /// co-processing, see vtkCPProcessor::SetAsynchronousCoProcessing().
+  /// BackPressureTime is the time RequestDataDescription() and CoProcess()
+  /// of this time step waited for the co-processing of earlier time steps
+  /// to complete. CoProcessingTime is the time the pipelines took for the
+  /// last time step they completed, i.e. this time step when co-processing
+  /// synchronously and usually the previous one otherwise.
+  vtkGetMacro(StagingTime, double);
+  vtkGetMacro(BackPressureTime, double);
+  vtkGetMacro(CoProcessingTime, double);
+
 protected:
   vtkCPDataDescription();
   virtual ~vtkCPDataDescription();
@@ -124,6 +136,13 @@ private:
   /// it can store a wide variety of data types which are all python wrapped.
   vtkFieldData* UserData;
 
+  /// Timing counters of the last co-processed time step.
+  double StagingTime;
+  double BackPressureTime;
+  double CoProcessingTime;
+
+  friend class vtkCPProcessor;
+
   class vtkInternals;
   vtkInternals* Internals;
 
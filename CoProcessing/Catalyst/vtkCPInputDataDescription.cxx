@@ -41,6 +41,7 @@ vtkCPInputDataDescription::vtkCPInputDataDescription()
   this->Grid = NULL;
   this->GenerateMesh = false;
   this->AllFields = false;
+  this->ShallowStaging = false;
   this->Internals = new vtkCPInputDataDescription::vtkInternals();
   this->WholeExtent[0] = this->WholeExtent[2] = this->WholeExtent[4] = 0;
   this->WholeExtent[1] = this->WholeExtent[3] = this->WholeExtent[5] = -1;
@@ -228,6 +229,7 @@ void vtkCPInputDataDescription::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
   os << indent << "AllFields: " << this->AllFields << "\n";
   os << indent << "GenerateMesh: " << this->GenerateMesh << "\n";
+  os << indent << "ShallowStaging: " << this->ShallowStaging << "\n";
   if(this->Grid)
     {
     os << indent << "Grid: " << this->Grid << "\n";
@@ -95,6 +95,17 @@ public:
   vtkSetVector6Macro(WholeExtent, int);
   vtkGetVector6Macro(WholeExtent, int);
 
+  // Description:
+  // Only used with vtkCPProcessor::AsynchronousCoProcessing. When on, the
+  // grid is shallow copied for the pipelines instead of deep copied: the
+  // simulation guarantees that the arrays of the grid are neither modified
+  // nor released until the next call to RequestDataDescription(),
+  // CoProcess() or Finalize() of the processor returns. Off by default and
+  // not affected by Reset().
+  vtkSetMacro(ShallowStaging, bool);
+  vtkGetMacro(ShallowStaging, bool);
+  vtkBooleanMacro(ShallowStaging, bool);
+
 protected:
   vtkCPInputDataDescription();
   ~vtkCPInputDataDescription();
@@ -117,6 +128,10 @@ protected:
   // On when the mesh should be generated.
   bool GenerateMesh;
 
+  // Description:
+  // On when the grid is shallow copied for asynchronous co-processing.
+  bool ShallowStaging;
+
   // Description:
   // The grid for coprocessing. The grid is not owned by the object.
   vtkDataObject* Grid;
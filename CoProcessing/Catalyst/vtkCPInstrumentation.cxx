@@ -0,0 +1,562 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkCPInstrumentation.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCPInstrumentation.h"
+
+#include "vtkAlgorithm.h"
+#include "vtkCallbackCommand.h"
+#include "vtkCommand.h"
+#include "vtkCPPipeline.h"
+#include "vtkMultiProcessController.h"
+#include "vtkObjectFactory.h"
+#include "vtkSmartPointer.h"
+#include "vtkSMProxy.h"
+#include "vtkSMProxyIterator.h"
+#include "vtkSMProxyManager.h"
+#include "vtkSMSessionProxyManager.h"
+#include "vtkTimerLog.h"
+#include "vtkWeakPointer.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <vtksys/SystemTools.hxx>
+
+#if !defined(_WIN32)
+# include <sys/resource.h>
+#endif
+
+//=============================================================================
+// Measures of the process at a point in time.
+struct vtkCPInstrumentationSnapshot
+{
+  double Time;
+  double PeakMemory; // KiB
+  double BytesWritten;
+
+  static vtkCPInstrumentationSnapshot Take()
+    {
+    vtkCPInstrumentationSnapshot snapshot;
+    snapshot.Time = vtkTimerLog::GetUniversalTime();
+    snapshot.PeakMemory = 0;
+    snapshot.BytesWritten = 0;
+#if !defined(_WIN32)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+      {
+# if defined(__APPLE__)
+      snapshot.PeakMemory = usage.ru_maxrss / 1024.0;
+# else
+      snapshot.PeakMemory = static_cast<double>(usage.ru_maxrss);
+# endif
+      }
+#endif
+#if defined(__linux__)
+    // bytes passed to write calls by the process, whatever the file system.
+    ifstream io("/proc/self/io");
+    std::string key;
+    double value;
+    while (io >> key >> value)
+      {
+      if (key == "wchar:")
+        {
+        snapshot.BytesWritten = value;
+        break;
+        }
+      }
+#endif
+    return snapshot;
+    }
+};
+
+//=============================================================================
+// Identifies a pipeline, or a filter within a pipeline.
+struct vtkCPInstrumentationKey
+{
+  int Index;
+  std::string Pipeline;
+  std::string Filter; // empty for the pipeline itself.
+
+  bool operator<(const vtkCPInstrumentationKey& other) const
+    {
+    if (this->Index != other.Index)
+      {
+      return this->Index < other.Index;
+      }
+    if (this->Pipeline != other.Pipeline)
+      {
+      return this->Pipeline < other.Pipeline;
+      }
+    return this->Filter < other.Filter;
+    }
+};
+
+//=============================================================================
+// Sums of the measures of a pipeline or a filter on one process.
+struct vtkCPInstrumentationRecord
+{
+  int Calls;
+  double Time;
+  double MaxCallTime;
+  double PeakMemory;
+  double BytesWritten;
+
+  vtkCPInstrumentationRecord()
+    : Calls(0), Time(0), MaxCallTime(0), PeakMemory(0), BytesWritten(0)
+    {
+    }
+
+  void Add(const vtkCPInstrumentationSnapshot& start,
+    const vtkCPInstrumentationSnapshot& end)
+    {
+    double time = end.Time - start.Time;
+    ++this->Calls;
+    this->Time += time;
+    this->MaxCallTime = std::max(this->MaxCallTime, time);
+    this->PeakMemory += end.PeakMemory - start.PeakMemory;
+    this->BytesWritten += end.BytesWritten - start.BytesWritten;
+    }
+};
+
+//=============================================================================
+// Minimum, maximum and average of a measure over the processes.
+struct vtkCPInstrumentationStatistic
+{
+  double Min;
+  double Max;
+  double Sum;
+
+  vtkCPInstrumentationStatistic()
+    : Min(VTK_DOUBLE_MAX), Max(-VTK_DOUBLE_MAX), Sum(0)
+    {
+    }
+
+  void Add(double value)
+    {
+    this->Min = std::min(this->Min, value);
+    this->Max = std::max(this->Max, value);
+    this->Sum += value;
+    }
+};
+
+struct vtkCPInstrumentationAggregate
+{
+  int NumberOfProcesses;
+  int Calls;
+  double MaxCallTime;
+  vtkCPInstrumentationStatistic Time;
+  vtkCPInstrumentationStatistic PeakMemory;
+  vtkCPInstrumentationStatistic BytesWritten;
+
+  vtkCPInstrumentationAggregate()
+    : NumberOfProcesses(0), Calls(0), MaxCallTime(0)
+    {
+    }
+
+  void Add(const vtkCPInstrumentationRecord& record)
+    {
+    ++this->NumberOfProcesses;
+    this->Calls = std::max(this->Calls, record.Calls);
+    this->MaxCallTime = std::max(this->MaxCallTime, record.MaxCallTime);
+    this->Time.Add(record.Time);
+    this->PeakMemory.Add(record.PeakMemory);
+    this->BytesWritten.Add(record.BytesWritten);
+    }
+};
+
+namespace
+{
+  typedef std::map<vtkCPInstrumentationKey, vtkCPInstrumentationAggregate>
+    AggregateMap;
+
+  std::string QuoteJSON(const std::string& text)
+    {
+    std::string quoted = "\"";
+    for (size_t cc = 0; cc < text.size(); ++cc)
+      {
+      char c = text[cc];
+      if (c == '"' || c == '\\')
+        {
+        quoted += '\\';
+        quoted += c;
+        }
+      else if (static_cast<unsigned char>(c) < 0x20)
+        {
+        quoted += ' ';
+        }
+      else
+        {
+        quoted += c;
+        }
+      }
+    return quoted + "\"";
+    }
+
+  std::string QuoteCSV(const std::string& text)
+    {
+    std::string quoted = "\"";
+    for (size_t cc = 0; cc < text.size(); ++cc)
+      {
+      if (text[cc] == '"')
+        {
+        quoted += '"';
+        }
+      quoted += text[cc];
+      }
+    return quoted + "\"";
+    }
+
+  void WriteJSON(ostream& os, const char* name,
+    const vtkCPInstrumentationStatistic& statistic, int numProcs)
+    {
+    os << QuoteJSON(name) << ": { \"min\": " << statistic.Min
+       << ", \"avg\": " << statistic.Sum / numProcs
+       << ", \"max\": " << statistic.Max << " }";
+    }
+
+  void WriteJSON(ostream& os, const vtkCPInstrumentationAggregate& aggregate,
+    const char* indent)
+    {
+    int numProcs = std::max(aggregate.NumberOfProcesses, 1);
+    os << indent << "\"processes\": " << aggregate.NumberOfProcesses << ",\n"
+       << indent << "\"calls\": " << aggregate.Calls << ",\n"
+       << indent;
+    WriteJSON(os, "time", aggregate.Time, numProcs);
+    os << ",\n" << indent << "\"call time max\": " << aggregate.MaxCallTime
+       << ",\n" << indent;
+    WriteJSON(os, "peak memory delta", aggregate.PeakMemory, numProcs);
+    os << ",\n" << indent;
+    WriteJSON(os, "bytes written", aggregate.BytesWritten, numProcs);
+    }
+
+  void WriteCSV(ostream& os, const vtkCPInstrumentationStatistic& statistic,
+    int numProcs)
+    {
+    os << "," << statistic.Min << "," << statistic.Sum / numProcs << ","
+       << statistic.Max;
+    }
+}
+
+//=============================================================================
+class vtkCPInstrumentation::vtkInternals
+{
+public:
+  typedef std::map<vtkCPInstrumentationKey, vtkCPInstrumentationRecord>
+    RecordMap;
+  RecordMap Records;
+
+  // The pipeline being co-processed, Index is -1 otherwise.
+  vtkCPInstrumentationKey Pipeline;
+  vtkCPInstrumentationSnapshot PipelineStart;
+
+  struct ObservedFilter
+  {
+    vtkWeakPointer<vtkObject> Filter;
+    std::string Name;
+  };
+  std::map<vtkObject*, ObservedFilter> Filters;
+  std::map<vtkObject*, vtkCPInstrumentationSnapshot> RunningFilters;
+  vtkSmartPointer<vtkCallbackCommand> Observer;
+};
+
+vtkStandardNewMacro(vtkCPInstrumentation);
+//----------------------------------------------------------------------------
+vtkCPInstrumentation::vtkCPInstrumentation()
+{
+  this->Internals = new vtkInternals;
+  this->Internals->Pipeline.Index = -1;
+  this->Internals->Observer = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->Internals->Observer->SetCallback(&vtkCPInstrumentation::FilterCallback);
+  this->Internals->Observer->SetClientData(this);
+}
+
+//----------------------------------------------------------------------------
+vtkCPInstrumentation::~vtkCPInstrumentation()
+{
+  std::map<vtkObject*, vtkInternals::ObservedFilter>::iterator iter;
+  for (iter = this->Internals->Filters.begin();
+    iter != this->Internals->Filters.end(); ++iter)
+    {
+    if (iter->second.Filter)
+      {
+      iter->second.Filter->RemoveObserver(this->Internals->Observer);
+      }
+    }
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void vtkCPInstrumentation::StartPipeline(vtkCPPipeline* pipeline, int index)
+{
+  this->ObserveFilters();
+  this->Internals->Pipeline.Index = index;
+  this->Internals->Pipeline.Pipeline = pipeline->GetPipelineName();
+  this->Internals->Pipeline.Filter.clear();
+  this->Internals->RunningFilters.clear();
+  this->Internals->PipelineStart = vtkCPInstrumentationSnapshot::Take();
+}
+
+//----------------------------------------------------------------------------
+void vtkCPInstrumentation::EndPipeline()
+{
+  if (this->Internals->Pipeline.Index < 0)
+    {
+    return;
+    }
+  this->Internals->Records[this->Internals->Pipeline].Add(
+    this->Internals->PipelineStart, vtkCPInstrumentationSnapshot::Take());
+  this->Internals->Pipeline.Index = -1;
+}
+
+//----------------------------------------------------------------------------
+void vtkCPInstrumentation::ObserveFilters()
+{
+  if (!vtkSMProxyManager::IsInitialized())
+    {
+    return;
+    }
+  vtkSMSessionProxyManager* sessionProxyManager =
+    vtkSMProxyManager::GetProxyManager()->GetActiveSessionProxyManager();
+  if (!sessionProxyManager)
+    {
+    return;
+    }
+
+  vtkSmartPointer<vtkSMProxyIterator> iter =
+    vtkSmartPointer<vtkSMProxyIterator>::New();
+  iter->SetSessionProxyManager(sessionProxyManager);
+  iter->SetModeToAll();
+  for (iter->Begin(); !iter->IsAtEnd(); iter->Next())
+    {
+    vtkSMProxy* proxy = iter->GetProxy();
+    if (!proxy || !proxy->GetObjectsCreated())
+      {
+      continue;
+      }
+    vtkAlgorithm* algorithm =
+      vtkAlgorithm::SafeDownCast(proxy->GetClientSideObject());
+    if (!algorithm)
+      {
+      continue;
+      }
+    // the address may be the one of a deleted filter.
+    vtkInternals::ObservedFilter& observed = this->Internals->Filters[algorithm];
+    if (observed.Filter.GetPointer() == algorithm)
+      {
+      continue;
+      }
+    observed.Filter = algorithm;
+    observed.Name = iter->GetKey();
+    algorithm->AddObserver(vtkCommand::StartEvent, this->Internals->Observer);
+    algorithm->AddObserver(vtkCommand::EndEvent, this->Internals->Observer);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCPInstrumentation::FilterCallback(vtkObject* caller,
+  unsigned long eventId, void* clientData, void*)
+{
+  vtkCPInstrumentation* self = static_cast<vtkCPInstrumentation*>(clientData);
+  if (eventId == vtkCommand::StartEvent)
+    {
+    self->StartFilter(caller);
+    }
+  else
+    {
+    self->EndFilter(caller);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCPInstrumentation::StartFilter(vtkObject* filter)
+{
+  if (this->Internals->Pipeline.Index >= 0)
+    {
+    this->Internals->RunningFilters[filter] =
+      vtkCPInstrumentationSnapshot::Take();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCPInstrumentation::EndFilter(vtkObject* filter)
+{
+  std::map<vtkObject*, vtkCPInstrumentationSnapshot>::iterator running =
+    this->Internals->RunningFilters.find(filter);
+  if (running == this->Internals->RunningFilters.end())
+    {
+    return;
+    }
+  if (this->Internals->Pipeline.Index < 0)
+    {
+    this->Internals->RunningFilters.erase(running);
+    return;
+    }
+  vtkCPInstrumentationKey key = this->Internals->Pipeline;
+  key.Filter = this->Internals->Filters[filter].Name;
+  this->Internals->Records[key].Add(running->second,
+    vtkCPInstrumentationSnapshot::Take());
+  this->Internals->RunningFilters.erase(running);
+}
+
+//----------------------------------------------------------------------------
+int vtkCPInstrumentation::Write(const char* fileName,
+  vtkMultiProcessController* controller)
+{
+  // the records of this process, one per 3 lines.
+  std::ostringstream local;
+  local.precision(12);
+  vtkInternals::RecordMap::iterator iter;
+  for (iter = this->Internals->Records.begin();
+    iter != this->Internals->Records.end(); ++iter)
+    {
+    const vtkCPInstrumentationRecord& record = iter->second;
+    local << iter->first.Pipeline << "\n" << iter->first.Filter << "\n"
+          << iter->first.Index << " " << record.Calls << " " << record.Time
+          << " " << record.MaxCallTime << " " << record.PeakMemory << " "
+          << record.BytesWritten << "\n";
+    }
+
+  int numProcs = controller? controller->GetNumberOfProcesses() : 1;
+  int myId = controller? controller->GetLocalProcessId() : 0;
+  std::vector<std::string> texts;
+  if (numProcs > 1)
+    {
+    std::string text = local.str();
+    vtkIdType length = static_cast<vtkIdType>(text.size());
+    std::vector<vtkIdType> lengths(numProcs, 0);
+    std::vector<vtkIdType> offsets(numProcs, 0);
+    controller->Gather(&length, &lengths[0], 1, 0);
+    std::vector<char> buffer(1);
+    if (myId == 0)
+      {
+      for (int cc = 1; cc < numProcs; ++cc)
+        {
+        offsets[cc] = offsets[cc - 1] + lengths[cc - 1];
+        }
+      buffer.resize(offsets[numProcs - 1] + lengths[numProcs - 1] + 1);
+      }
+    controller->GatherV(text.c_str(), &buffer[0], length, &lengths[0],
+      &offsets[0], 0);
+    if (myId == 0)
+      {
+      for (int cc = 0; cc < numProcs; ++cc)
+        {
+        texts.push_back(std::string(&buffer[offsets[cc]], lengths[cc]));
+        }
+      }
+    }
+  else
+    {
+    texts.push_back(local.str());
+    }
+
+  int status = 1;
+  if (myId == 0)
+    {
+    AggregateMap aggregates;
+    for (size_t cc = 0; cc < texts.size(); ++cc)
+      {
+      std::istringstream input(texts[cc]);
+      vtkCPInstrumentationKey key;
+      std::string values;
+      while (std::getline(input, key.Pipeline) &&
+        std::getline(input, key.Filter) && std::getline(input, values))
+        {
+        vtkCPInstrumentationRecord record;
+        std::istringstream(values) >> key.Index >> record.Calls >> record.Time
+          >> record.MaxCallTime >> record.PeakMemory >> record.BytesWritten;
+        aggregates[key].Add(record);
+        }
+      }
+
+    ofstream file(fileName);
+    bool csv = vtksys::SystemTools::LowerCase(
+      vtksys::SystemTools::GetFilenameLastExtension(fileName)) == ".csv";
+    if (csv)
+      {
+      file << "pipeline index,pipeline,filter,processes,calls,"
+           << "time min (s),time avg (s),time max (s),call time max (s),"
+           << "peak memory delta min (KiB),peak memory delta avg (KiB),"
+           << "peak memory delta max (KiB),bytes written min,"
+           << "bytes written avg,bytes written max\n";
+      for (AggregateMap::iterator agg = aggregates.begin();
+        agg != aggregates.end(); ++agg)
+        {
+        const vtkCPInstrumentationAggregate& aggregate = agg->second;
+        int procs = std::max(aggregate.NumberOfProcesses, 1);
+        file << agg->first.Index << "," << QuoteCSV(agg->first.Pipeline) << ","
+             << QuoteCSV(agg->first.Filter) << ","
+             << aggregate.NumberOfProcesses << "," << aggregate.Calls;
+        WriteCSV(file, aggregate.Time, procs);
+        file << "," << aggregate.MaxCallTime;
+        WriteCSV(file, aggregate.PeakMemory, procs);
+        WriteCSV(file, aggregate.BytesWritten, procs);
+        file << "\n";
+        }
+      }
+    else
+      {
+      // the record of a pipeline comes before the ones of its filters.
+      file << "{\n  \"processes\": " << numProcs << ",\n  \"pipelines\": [";
+      bool firstPipeline = true;
+      bool firstFilter = true;
+      for (AggregateMap::iterator agg = aggregates.begin();
+        agg != aggregates.end(); ++agg)
+        {
+        if (agg->first.Filter.empty())
+          {
+          file << (firstPipeline? "\n" : "\n      ]\n    },\n") << "    {\n"
+               << "      \"index\": " << agg->first.Index << ",\n"
+               << "      \"name\": " << QuoteJSON(agg->first.Pipeline)
+               << ",\n";
+          WriteJSON(file, agg->second, "      ");
+          file << ",\n      \"filters\": [";
+          firstPipeline = false;
+          firstFilter = true;
+          }
+        else
+          {
+          file << (firstFilter? "\n" : ",\n") << "        {\n"
+               << "          \"name\": " << QuoteJSON(agg->first.Filter)
+               << ",\n";
+          WriteJSON(file, agg->second, "          ");
+          file << "\n        }";
+          firstFilter = false;
+          }
+        }
+      file << (firstPipeline? "\n  ]\n}\n" : "\n      ]\n    }\n  ]\n}\n");
+      }
+    file.close();
+    status = file? 1 : 0;
+    }
+  if (numProcs > 1)
+    {
+    controller->Broadcast(&status, 1, 0);
+    }
+  if (!status)
+    {
+    vtkErrorMacro("Cannot write " << fileName << ".");
+    }
+  return status;
+}
+
+//----------------------------------------------------------------------------
+void vtkCPInstrumentation::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfRecords: " << this->Internals->Records.size()
+     << "\n";
+}
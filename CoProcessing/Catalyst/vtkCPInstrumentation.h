@@ -0,0 +1,73 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkCPInstrumentation.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef vtkCPInstrumentation_h
+#define vtkCPInstrumentation_h
+
+#include "vtkObject.h"
+#include "vtkPVCatalystModule.h" // For windows import/export of shared libraries
+
+class vtkCPPipeline;
+class vtkMultiProcessController;
+
+/// @ingroup CoProcessing
+/// Records the wall time, the growth of the peak resident memory and the
+/// bytes written by the process during the co-processing calls of each
+/// pipeline, and during the executions of each filter of the proxy manager
+/// within them. Filters are timed from the co-processing call following
+/// the one creating them. Used by vtkCPProcessor, see
+/// vtkCPProcessor::SetInstrumentationFileName(). The memory and bytes
+/// written are only measured on platforms providing them, e.g. the bytes
+/// written only on Linux.
+class VTKPVCATALYST_EXPORT vtkCPInstrumentation : public vtkObject
+{
+public:
+  static vtkCPInstrumentation* New();
+  vtkTypeMacro(vtkCPInstrumentation,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Marks the start and the end of the co-processing call of the pipeline
+  /// at the given index of the processor.
+  void StartPipeline(vtkCPPipeline* pipeline, int index);
+  void EndPipeline();
+
+  /// Aggregates the records of all the processes of the controller, NULL
+  /// for this process only, and writes them on process 0 as CSV when the
+  /// file name ends with .csv, as JSON otherwise. Must be called on all
+  /// processes. Returns 0 when the file cannot be written.
+  int Write(const char* fileName, vtkMultiProcessController* controller);
+
+protected:
+  vtkCPInstrumentation();
+  virtual ~vtkCPInstrumentation();
+
+  /// Observes the executions of the filters not observed yet.
+  void ObserveFilters();
+
+  /// Called on the start and end events of the filters.
+  void StartFilter(vtkObject* filter);
+  void EndFilter(vtkObject* filter);
+
+  static void FilterCallback(vtkObject* caller, unsigned long eventId,
+    void* clientData, void* callData);
+
+private:
+  vtkCPInstrumentation(const vtkCPInstrumentation&); // Not implemented
+  void operator=(const vtkCPInstrumentation&); // Not implemented
+
+  class vtkInternals;
+  vtkInternals* Internals;
+};
+
+#endif
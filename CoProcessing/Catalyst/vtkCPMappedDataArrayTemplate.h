@@ -0,0 +1,128 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkCPMappedDataArrayTemplate.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef vtkCPMappedDataArrayTemplate_h
+#define vtkCPMappedDataArrayTemplate_h
+
+#include "vtkMappedDataArray.h"
+
+#include "vtkTypeTemplate.h" // For templated vtkObject API
+#include "vtkObjectFactory.h" // for vtkStandardNewMacro
+
+#include <vector> // for std::vector
+
+/// @ingroup CoProcessing
+/// Maps a strided buffer of the simulation into the vtkDataArray interface
+/// without copying it: component c of tuple t is
+/// Array[t*TupleStride + c*ComponentStride]. This covers arrays of
+/// structures (strides NumberOfComponents and 1), structures of arrays,
+/// e.g. Fortran arrays dimensioned (numberOfTuples, numberOfComponents)
+/// (strides 1 and numberOfTuples), and fields within arrays of records.
+/// The buffer is not owned and the container is read only. See
+/// vtkCPAdaptorAPI::AddFieldArray().
+template <class Scalar>
+class vtkCPMappedDataArrayTemplate: public vtkMappedDataArray<Scalar>
+{
+public:
+  vtkAbstractTemplateTypeMacro(vtkCPMappedDataArrayTemplate<Scalar>,
+                               vtkMappedDataArray<Scalar>)
+  vtkMappedDataArrayNewInstanceMacro(
+      vtkCPMappedDataArrayTemplate<Scalar>)
+  static vtkCPMappedDataArrayTemplate *New();
+  virtual void PrintSelf(ostream &os, vtkIndent indent);
+
+  typedef typename Superclass::ValueType ValueType;
+
+  /// Set the buffer of the simulation and its layout, strides are in
+  /// number of Scalar. The buffer must stay valid while it is used.
+  void SetStridedArray(Scalar *array, vtkIdType numTuples,
+                       int numComponents, vtkIdType tupleStride,
+                       vtkIdType componentStride);
+
+  // Reimplemented virtuals -- see superclasses for descriptions:
+  void Initialize();
+  void GetTuples(vtkIdList *ptIds, vtkAbstractArray *output);
+  void GetTuples(vtkIdType p1, vtkIdType p2, vtkAbstractArray *output);
+  void Squeeze();
+  vtkArrayIterator *NewIterator();
+  vtkIdType LookupValue(vtkVariant value);
+  void LookupValue(vtkVariant value, vtkIdList *ids);
+  vtkVariant GetVariantValue(vtkIdType idx);
+  void ClearLookup();
+  double* GetTuple(vtkIdType i);
+  void GetTuple(vtkIdType i, double *tuple);
+  vtkIdType LookupTypedValue(Scalar value);
+  void LookupTypedValue(Scalar value, vtkIdList *ids);
+  ValueType GetValue(vtkIdType idx) const;
+  Scalar& GetValueReference(vtkIdType idx);
+  void GetTypedTuple(vtkIdType idx, Scalar *t) const;
+
+  /// This container is read only -- this method does nothing but print a
+  /// warning.
+  int Allocate(vtkIdType sz, vtkIdType ext);
+  int Resize(vtkIdType numTuples);
+  void SetNumberOfTuples(vtkIdType number);
+  void SetTuple(vtkIdType i, vtkIdType j, vtkAbstractArray *source);
+  void SetTuple(vtkIdType i, const float *source);
+  void SetTuple(vtkIdType i, const double *source);
+  void InsertTuple(vtkIdType i, vtkIdType j, vtkAbstractArray *source);
+  void InsertTuple(vtkIdType i, const float *source);
+  void InsertTuple(vtkIdType i, const double *source);
+  void InsertTuples(vtkIdList *dstIds, vtkIdList *srcIds,
+                    vtkAbstractArray *source);
+  void InsertTuples(vtkIdType dstStart, vtkIdType n, vtkIdType srcStart,
+                    vtkAbstractArray* source);
+  vtkIdType InsertNextTuple(vtkIdType j, vtkAbstractArray *source);
+  vtkIdType InsertNextTuple(const float *source);
+  vtkIdType InsertNextTuple(const double *source);
+  void DeepCopy(vtkAbstractArray *aa);
+  void DeepCopy(vtkDataArray *da);
+  void InterpolateTuple(vtkIdType i, vtkIdList *ptIndices,
+                        vtkAbstractArray* source,  double* weights);
+  void InterpolateTuple(vtkIdType i, vtkIdType id1, vtkAbstractArray *source1,
+                        vtkIdType id2, vtkAbstractArray *source2, double t);
+  void SetVariantValue(vtkIdType idx, vtkVariant value);
+  void InsertVariantValue(vtkIdType idx, vtkVariant value);
+  void RemoveTuple(vtkIdType id);
+  void RemoveFirstTuple();
+  void RemoveLastTuple();
+  void SetTypedTuple(vtkIdType i, const Scalar *t);
+  void InsertTypedTuple(vtkIdType i, const Scalar *t);
+  vtkIdType InsertNextTypedTuple(const Scalar *t);
+  void SetValue(vtkIdType idx, Scalar value);
+  vtkIdType InsertNextValue(Scalar v);
+  void InsertValue(vtkIdType idx, Scalar v);
+
+protected:
+  vtkCPMappedDataArrayTemplate();
+  ~vtkCPMappedDataArrayTemplate();
+
+  Scalar *Array;
+  vtkIdType TupleStride;
+  vtkIdType ComponentStride;
+
+private:
+  vtkCPMappedDataArrayTemplate(
+      const vtkCPMappedDataArrayTemplate &); // Not implemented.
+  void operator=(
+      const vtkCPMappedDataArrayTemplate &); // Not implemented.
+
+  vtkIdType Lookup(const Scalar &val, vtkIdType startIndex);
+  std::vector<double> TempDoubleArray;
+};
+
+#include "vtkCPMappedDataArrayTemplate.txx"
+
+#endif //vtkCPMappedDataArrayTemplate_h
+// VTK-HeaderTest-Exclude: vtkCPMappedDataArrayTemplate.h
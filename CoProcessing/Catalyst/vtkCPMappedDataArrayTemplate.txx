@@ -0,0 +1,501 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkCPMappedDataArrayTemplate.txx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCPMappedDataArrayTemplate.h"
+
+#include "vtkIdList.h"
+#include "vtkObjectFactory.h"
+#include "vtkVariant.h"
+#include "vtkVariantCast.h"
+
+//------------------------------------------------------------------------------
+// Can't use vtkStandardNewMacro with a template.
+template <class Scalar> vtkCPMappedDataArrayTemplate<Scalar> *
+vtkCPMappedDataArrayTemplate<Scalar>::New()
+{
+  VTK_STANDARD_NEW_BODY(vtkCPMappedDataArrayTemplate<Scalar>)
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::PrintSelf(ostream &os, vtkIndent indent)
+{
+  this->vtkCPMappedDataArrayTemplate<Scalar>::Superclass::PrintSelf(
+        os, indent);
+  os << indent << "Array: " << this->Array << std::endl;
+  os << indent << "TupleStride: " << this->TupleStride << std::endl;
+  os << indent << "ComponentStride: " << this->ComponentStride << std::endl;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::Initialize()
+{
+  this->Array = NULL;
+  this->TupleStride = 1;
+  this->ComponentStride = 1;
+  this->MaxId = -1;
+  this->Size = 0;
+  this->NumberOfComponents = 1;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::GetTuples(vtkIdList *ptIds, vtkAbstractArray *output)
+{
+  vtkDataArray *outArray = vtkDataArray::FastDownCast(output);
+  if (!outArray)
+    {
+    vtkWarningMacro(<<"Input is not a vtkDataArray");
+    return;
+    }
+
+  vtkIdType numTuples = ptIds->GetNumberOfIds();
+
+  outArray->SetNumberOfComponents(this->NumberOfComponents);
+  outArray->SetNumberOfTuples(numTuples);
+
+  const vtkIdType numPoints = ptIds->GetNumberOfIds();
+  for (vtkIdType i = 0; i < numPoints; ++i)
+    {
+    outArray->SetTuple(i, this->GetTuple(ptIds->GetId(i)));
+    }
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::GetTuples(vtkIdType p1, vtkIdType p2, vtkAbstractArray *output)
+{
+  vtkDataArray *da = vtkDataArray::FastDownCast(output);
+  if (!da)
+    {
+    vtkErrorMacro(<<"Input is not a vtkDataArray");
+    return;
+    }
+
+  if (da->GetNumberOfComponents() != this->GetNumberOfComponents())
+    {
+    vtkErrorMacro(<<"Incorrect number of components in input array.");
+    return;
+    }
+
+  for (vtkIdType daTupleId = 0; p1 <= p2; ++p1)
+    {
+    da->SetTuple(daTupleId++, this->GetTuple(p1));
+    }
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::Squeeze()
+{
+  // noop
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkArrayIterator*
+vtkCPMappedDataArrayTemplate<Scalar>::NewIterator()
+{
+  vtkErrorMacro(<<"Not implemented.");
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkIdType vtkCPMappedDataArrayTemplate<Scalar>
+::LookupValue(vtkVariant value)
+{
+  bool valid = true;
+  Scalar val = vtkVariantCast<Scalar>(value, &valid);
+  if (valid)
+    {
+    return this->Lookup(val, 0);
+    }
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::LookupValue(vtkVariant value, vtkIdList *ids)
+{
+  bool valid = true;
+  Scalar val = vtkVariantCast<Scalar>(value, &valid);
+  ids->Reset();
+  if (valid)
+    {
+    vtkIdType index = 0;
+    while ((index = this->Lookup(val, index)) >= 0)
+      {
+      ids->InsertNextId(index++);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkVariant vtkCPMappedDataArrayTemplate<Scalar>
+::GetVariantValue(vtkIdType idx)
+{
+  return vtkVariant(this->GetValueReference(idx));
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::ClearLookup()
+{
+  // no-op, no fast lookup implemented.
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> double* vtkCPMappedDataArrayTemplate<Scalar>
+::GetTuple(vtkIdType i)
+{
+  this->TempDoubleArray.resize(this->NumberOfComponents);
+  this->GetTuple(i, &this->TempDoubleArray[0]);
+  return &this->TempDoubleArray[0];
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::GetTuple(vtkIdType i, double *tuple)
+{
+  const Scalar *first = this->Array + i * this->TupleStride;
+  for (int c = 0; c < this->NumberOfComponents; ++c)
+    {
+    tuple[c] = static_cast<double>(first[c * this->ComponentStride]);
+    }
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkIdType vtkCPMappedDataArrayTemplate<Scalar>
+::LookupTypedValue(Scalar value)
+{
+  return this->Lookup(value, 0);
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::LookupTypedValue(Scalar value, vtkIdList *ids)
+{
+  ids->Reset();
+  vtkIdType index = 0;
+  while ((index = this->Lookup(value, index)) >= 0)
+    {
+    ids->InsertNextId(index++);
+    }
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar>
+typename vtkCPMappedDataArrayTemplate<Scalar>::ValueType
+vtkCPMappedDataArrayTemplate<Scalar>::GetValue(vtkIdType idx) const
+{
+  // Work around const-correct inconsistencies:
+  typedef vtkCPMappedDataArrayTemplate<Scalar> ThisClass;
+  return const_cast<ThisClass*>(this)->GetValueReference(idx);
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> Scalar& vtkCPMappedDataArrayTemplate<Scalar>
+::GetValueReference(vtkIdType idx)
+{
+  const vtkIdType tuple = idx / this->NumberOfComponents;
+  const vtkIdType comp = idx % this->NumberOfComponents;
+  return this->Array[tuple * this->TupleStride + comp * this->ComponentStride];
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::GetTypedTuple(vtkIdType tupleId, Scalar *tuple) const
+{
+  const Scalar *first = this->Array + tupleId * this->TupleStride;
+  for (int c = 0; c < this->NumberOfComponents; ++c)
+    {
+    tuple[c] = first[c * this->ComponentStride];
+    }
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> int vtkCPMappedDataArrayTemplate<Scalar>
+::Allocate(vtkIdType, vtkIdType)
+{
+  vtkErrorMacro("Read only container.")
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> int vtkCPMappedDataArrayTemplate<Scalar>
+::Resize(vtkIdType)
+{
+  vtkErrorMacro("Read only container.")
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::SetNumberOfTuples(vtkIdType)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::SetTuple(vtkIdType, vtkIdType, vtkAbstractArray *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::SetTuple(vtkIdType, const float *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::SetTuple(vtkIdType, const double *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InsertTuple(vtkIdType, vtkIdType, vtkAbstractArray *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InsertTuple(vtkIdType, const float *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InsertTuple(vtkIdType, const double *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InsertTuples(vtkIdList *, vtkIdList *, vtkAbstractArray *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InsertTuples(vtkIdType, vtkIdType, vtkIdType, vtkAbstractArray *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkIdType vtkCPMappedDataArrayTemplate<Scalar>
+::InsertNextTuple(vtkIdType, vtkAbstractArray *)
+{
+  vtkErrorMacro("Read only container.")
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkIdType vtkCPMappedDataArrayTemplate<Scalar>
+::InsertNextTuple(const float *)
+{
+
+  vtkErrorMacro("Read only container.")
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkIdType vtkCPMappedDataArrayTemplate<Scalar>
+::InsertNextTuple(const double *)
+{
+  vtkErrorMacro("Read only container.")
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::DeepCopy(vtkAbstractArray *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::DeepCopy(vtkDataArray *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InterpolateTuple(vtkIdType, vtkIdList *, vtkAbstractArray *, double *)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InterpolateTuple(vtkIdType, vtkIdType, vtkAbstractArray*, vtkIdType,
+                   vtkAbstractArray*, double)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::SetVariantValue(vtkIdType, vtkVariant)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InsertVariantValue(vtkIdType, vtkVariant)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::RemoveTuple(vtkIdType)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::RemoveFirstTuple()
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::RemoveLastTuple()
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::SetTypedTuple(vtkIdType, const Scalar*)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InsertTypedTuple(vtkIdType, const Scalar*)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkIdType vtkCPMappedDataArrayTemplate<Scalar>
+::InsertNextTypedTuple(const Scalar *)
+{
+  vtkErrorMacro("Read only container.")
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::SetValue(vtkIdType, Scalar)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkIdType vtkCPMappedDataArrayTemplate<Scalar>
+::InsertNextValue(Scalar)
+{
+  vtkErrorMacro("Read only container.")
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::InsertValue(vtkIdType, Scalar)
+{
+  vtkErrorMacro("Read only container.")
+  return;
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkCPMappedDataArrayTemplate<Scalar>
+::vtkCPMappedDataArrayTemplate()
+  : Array(NULL), TupleStride(1), ComponentStride(1)
+{
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkCPMappedDataArrayTemplate<Scalar>
+::~vtkCPMappedDataArrayTemplate()
+{ }
+
+//------------------------------------------------------------------------------
+template <class Scalar> void vtkCPMappedDataArrayTemplate<Scalar>
+::SetStridedArray(Scalar *array, vtkIdType numTuples, int numComponents,
+                  vtkIdType tupleStride, vtkIdType componentStride)
+{
+  this->Initialize();
+  this->Array = array;
+  this->TupleStride = tupleStride;
+  this->ComponentStride = componentStride;
+  this->NumberOfComponents = numComponents;
+  this->Size = this->NumberOfComponents * numTuples;
+  this->MaxId = this->Size - 1;
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+template <class Scalar> vtkIdType vtkCPMappedDataArrayTemplate<Scalar>
+::Lookup(const Scalar &val, vtkIdType index)
+{
+  while (index <= this->MaxId)
+    {
+    if (this->GetValueReference(index) == val)
+      {
+      return index;
+      }
+    ++index;
+    }
+  return -1;
+}
@@ -31,6 +31,12 @@ int vtkCPPipeline::Finalize()
   return 1;
 }
 
+//----------------------------------------------------------------------------
+const char* vtkCPPipeline::GetPipelineName()
+{
+  return this->GetClassName();
+}
+
 //----------------------------------------------------------------------------
 void vtkCPPipeline::PrintSelf(ostream& os, vtkIndent indent)
 {
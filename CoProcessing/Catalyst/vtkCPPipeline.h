@@ -48,6 +48,10 @@ public:
   /// is given. Returns 1 for success and 0 for failure.
   virtual int Finalize();
 
+  /// Returns the name identifying the pipeline, e.g. in the instrumentation
+  /// logs of vtkCPProcessor. The default is the class name.
+  virtual const char* GetPipelineName();
+
 protected:
   vtkCPPipeline();
   virtual ~vtkCPPipeline();
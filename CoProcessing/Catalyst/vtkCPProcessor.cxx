@@ -19,21 +19,28 @@
 #include "vtkCPCxxHelper.h"
 #include "vtkCPDataDescription.h"
 #include "vtkCPInputDataDescription.h"
+#include "vtkCPInstrumentation.h"
 #include "vtkCPPipeline.h"
+#include "vtkConditionVariable.h"
+#include "vtkDataObject.h"
+#include "vtkFieldData.h"
 #ifdef PARAVIEW_USE_MPI
 #include "vtkMPI.h"
 #include "vtkMPICommunicator.h"
 #include "vtkMPIController.h"
 #endif
 #include "vtkMultiProcessController.h"
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
 #include "vtkObjectFactory.h"
 #include "vtkSmartPointer.h"
 #include "vtkSMIntVectorProperty.h"
 #include "vtkSMProxy.h"
 #include "vtkSMProxyManager.h"
 #include "vtkSMSessionProxyManager.h"
+#include "vtkTimerLog.h"
 
-
+#include <deque>
 #include <list>
 
 struct vtkCPProcessorInternals
@@ -41,6 +48,225 @@ struct vtkCPProcessorInternals
   typedef std::list<vtkSmartPointer<vtkCPPipeline> > PipelineList;
   typedef PipelineList::iterator PipelineListIterator;
   PipelineList Pipelines;
+
+  // Set when instrumenting the co-processing calls.
+  vtkSmartPointer<vtkCPInstrumentation> Instrumentation;
+
+  // Asynchronous co-processing: the time steps are staged alternately into
+  // two slots and co-processed in order by the helper thread. The
+  // simulation thread only uses the pipelines when the helper thread is
+  // idle, so the second slot is only used by time steps whose output is
+  // forced.
+  vtkSmartPointer<vtkMutexLock> Mutex;
+  vtkSmartPointer<vtkConditionVariable> Condition;
+  vtkSmartPointer<vtkMultiThreader> Threader;
+  int ThreadId;
+  vtkSmartPointer<vtkCPDataDescription> Slots[2];
+  int NextSlot;
+  std::deque<int> Queue;
+  bool Busy;
+  bool Terminate;
+  bool Failed;
+  double CoProcessingTime;
+
+  // Simulation thread only.
+  bool ShallowStaged;
+  double RequestWaitTime;
+  bool WarnedSynchronous;
+
+  vtkCPProcessorInternals()
+    : Mutex(vtkSmartPointer<vtkMutexLock>::New()),
+    Condition(vtkSmartPointer<vtkConditionVariable>::New()),
+    Threader(vtkSmartPointer<vtkMultiThreader>::New()),
+    ThreadId(-1), NextSlot(0), Busy(false), Terminate(false), Failed(false),
+    CoProcessingTime(0), ShallowStaged(false), RequestWaitTime(0),
+    WarnedSynchronous(false)
+    {
+    }
+
+  ~vtkCPProcessorInternals()
+    {
+    this->StopThread();
+    }
+
+  // Runs the pipelines that request this time step.
+  int CoProcessPipelines(vtkCPDataDescription* dataDescription)
+    {
+    int success = 1;
+    int index = 0;
+    for(PipelineListIterator iter=this->Pipelines.begin();
+        iter!=this->Pipelines.end();iter++, index++)
+      {
+      if(dataDescription->GetForceOutput() == false)
+        {
+        // Reset dataDescription so that we can check each pipeline again
+        // before calling CoProcess to make sure which pipelines should
+        // be executing.
+        for(unsigned int i=0;i<dataDescription->GetNumberOfInputDescriptions();i++)
+          {
+          dataDescription->GetInputDescription(i)->GenerateMeshOff();
+          dataDescription->GetInputDescription(i)->AllFieldsOff();
+          }
+        }
+      if(dataDescription->GetForceOutput() == true ||
+         iter->GetPointer()->RequestDataDescription(dataDescription))
+        {
+        if(this->Instrumentation)
+          {
+          this->Instrumentation->StartPipeline(iter->GetPointer(), index);
+          }
+        if(!iter->GetPointer()->CoProcess(dataDescription))
+          {
+          success = 0;
+          }
+        if(this->Instrumentation)
+          {
+          this->Instrumentation->EndPipeline();
+          }
+        }
+      }
+    return success;
+    }
+
+  // Waits until at most maxStaged time steps are staged or being
+  // co-processed. Returns the seconds waited.
+  double Wait(size_t maxStaged)
+    {
+    double start = vtkTimerLog::GetUniversalTime();
+    this->Mutex->Lock();
+    while (this->Queue.size() + (this->Busy? 1 : 0) > maxStaged)
+      {
+      this->Condition->Wait(this->Mutex);
+      }
+    this->Mutex->Unlock();
+    return vtkTimerLog::GetUniversalTime() - start;
+    }
+
+  // Copies the time step into a slot. Returns true when a grid was shallow
+  // copied.
+  bool Stage(vtkCPDataDescription* dataDescription, int index)
+    {
+    if (!this->Slots[index])
+      {
+      this->Slots[index] = vtkSmartPointer<vtkCPDataDescription>::New();
+      }
+    vtkCPDataDescription* slot = this->Slots[index];
+    bool shallow = false;
+    for(unsigned int i=0;i<dataDescription->GetNumberOfInputDescriptions();i++)
+      {
+      const char* name = dataDescription->GetInputDescriptionName(i);
+      vtkCPInputDataDescription* input = dataDescription->GetInputDescription(i);
+      slot->AddInput(name);
+      vtkCPInputDataDescription* staged = slot->GetInputDescriptionByName(name);
+      staged->SetWholeExtent(input->GetWholeExtent());
+      vtkDataObject* grid = input->GetGrid();
+      if (!grid)
+        {
+        staged->SetGrid(NULL);
+        continue;
+        }
+      vtkDataObject* copy = grid->NewInstance();
+      if (input->GetShallowStaging())
+        {
+        copy->ShallowCopy(grid);
+        shallow = true;
+        }
+      else
+        {
+        copy->DeepCopy(grid);
+        }
+      staged->SetGrid(copy);
+      copy->Delete();
+      }
+    slot->SetTimeData(dataDescription->GetTime(), dataDescription->GetTimeStep());
+    slot->SetForceOutput(dataDescription->GetForceOutput());
+    if (dataDescription->GetUserData())
+      {
+      vtkFieldData* userData = vtkFieldData::New();
+      userData->DeepCopy(dataDescription->GetUserData());
+      slot->SetUserData(userData);
+      userData->Delete();
+      }
+    else
+      {
+      slot->SetUserData(NULL);
+      }
+    return shallow;
+    }
+
+  // Queues a staged slot for the helper thread.
+  void Schedule(int index)
+    {
+    if (this->ThreadId < 0)
+      {
+      this->ThreadId = this->Threader->SpawnThread(
+        &vtkCPProcessorInternals::ThreadMain, this);
+      }
+    this->Mutex->Lock();
+    this->Queue.push_back(index);
+    this->Mutex->Unlock();
+    this->Condition->Broadcast();
+    }
+
+  // Joins the helper thread once the staged time steps are co-processed.
+  void StopThread()
+    {
+    if (this->ThreadId >= 0)
+      {
+      this->Mutex->Lock();
+      this->Terminate = true;
+      this->Mutex->Unlock();
+      this->Condition->Broadcast();
+      this->Threader->TerminateThread(this->ThreadId);
+      this->ThreadId = -1;
+      this->Terminate = false;
+      }
+    }
+
+  static VTK_THREAD_RETURN_TYPE ThreadMain(void* arg)
+    {
+    vtkMultiThreader::ThreadInfo* info =
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    static_cast<vtkCPProcessorInternals*>(info->UserData)->Run();
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
+  void Run()
+    {
+    this->Mutex->Lock();
+    while (!this->Queue.empty() || !this->Terminate)
+      {
+      if (this->Queue.empty())
+        {
+        this->Condition->Wait(this->Mutex);
+        continue;
+        }
+      vtkCPDataDescription* slot = this->Slots[this->Queue.front()];
+      this->Queue.pop_front();
+      this->Busy = true;
+      this->Mutex->Unlock();
+
+      double start = vtkTimerLog::GetUniversalTime();
+      int success = this->CoProcessPipelines(slot);
+      double elapsed = vtkTimerLog::GetUniversalTime() - start;
+      // release the copies, and the buffers of the simulation.
+      slot->ResetAll();
+      for(unsigned int i=0;i<slot->GetNumberOfInputDescriptions();i++)
+        {
+        slot->GetInputDescription(i)->SetGrid(NULL);
+        }
+
+      this->Mutex->Lock();
+      this->Busy = false;
+      this->CoProcessingTime = elapsed;
+      if (!success)
+        {
+        this->Failed = true;
+        }
+      this->Condition->Broadcast();
+      }
+    this->Mutex->Unlock();
+    }
 };
 
 vtkStandardNewMacro(vtkCPProcessor);
@@ -50,6 +276,8 @@ vtkCPProcessor::vtkCPProcessor()
 {
   this->Internal = new vtkCPProcessorInternals;
   this->InitializationHelper = NULL;
+  this->AsynchronousCoProcessing = 0;
+  this->InstrumentationFileName = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -66,6 +294,7 @@ vtkCPProcessor::~vtkCPProcessor()
     this->InitializationHelper->Delete();
     this->InitializationHelper = NULL;
     }
+  this->SetInstrumentationFileName(NULL);
 }
 
 //----------------------------------------------------------------------------
@@ -77,6 +306,7 @@ int vtkCPProcessor::AddPipeline(vtkCPPipeline* pipeline)
     return 0;
     }
 
+  this->Internal->Wait(0);
   this->Internal->Pipelines.push_back(pipeline);
   return 1;
 }
@@ -112,12 +342,14 @@ vtkCPPipeline* vtkCPProcessor::GetPipeline(int which)
 //----------------------------------------------------------------------------
 void vtkCPProcessor::RemovePipeline(vtkCPPipeline* pipeline)
 {
+  this->Internal->Wait(0);
   this->Internal->Pipelines.remove(pipeline);
 }
 
 //----------------------------------------------------------------------------
 void vtkCPProcessor::RemoveAllPipelines()
 {
+  this->Internal->Wait(0);
   this->Internal->Pipelines.clear();
 }
 
@@ -192,6 +424,18 @@ int vtkCPProcessor::RequestDataDescription(
     vtkWarningMacro("DataDescription is NULL.");
     return 0;
     }
+  // the pipelines are not thread safe: wait for the helper thread to
+  // co-process the staged time steps. This is not needed when forcing the
+  // output, unless they use the buffers of the simulation.
+  double wait = 0;
+  if(dataDescription->GetForceOutput() == false ||
+     this->Internal->ShallowStaged)
+    {
+    wait = this->Internal->Wait(0);
+    this->Internal->ShallowStaged = false;
+    }
+  this->Internal->RequestWaitTime = wait;
+  dataDescription->BackPressureTime = wait;
   if(dataDescription->GetForceOutput() == true)
     {
     return 1;
@@ -228,31 +472,46 @@ int vtkCPProcessor::CoProcess(vtkCPDataDescription* dataDescription)
     vtkWarningMacro("DataDescription is NULL.");
     return 0;
     }
+  vtkCPProcessorInternals* internal = this->Internal;
+  if(this->InstrumentationFileName && !internal->Instrumentation)
+    {
+    internal->Instrumentation = vtkSmartPointer<vtkCPInstrumentation>::New();
+    }
+  double backPressure = internal->RequestWaitTime;
+  internal->RequestWaitTime = 0;
   int success = 1;
-  for(vtkCPProcessorInternals::PipelineListIterator iter =
-        this->Internal->Pipelines.begin();
-      iter!=this->Internal->Pipelines.end();iter++)
+  if(this->AsynchronousCoProcessing && this->CanCoProcessAsynchronously())
     {
-    if(dataDescription->GetForceOutput() == false)
-      {
-      // Reset dataDescription so that we can check each pipeline again
-      // before calling CoProcess to make sure which pipelines should
-      // be executing.
-      for(unsigned int i=0;i<dataDescription->GetNumberOfInputDescriptions();i++)
-        {
-        dataDescription->GetInputDescription(i)->GenerateMeshOff();
-        dataDescription->GetInputDescription(i)->AllFieldsOff();
-        }
-      }
-    if(dataDescription->GetForceOutput() == true ||
-       iter->GetPointer()->RequestDataDescription(dataDescription))
-      {
-      if(!iter->GetPointer()->CoProcess(dataDescription))
-        {
-        success = 0;
-        }
-      }
+    // a slot must be free, and both when the staged time step uses the
+    // buffers of the simulation.
+    backPressure += internal->Wait(internal->ShallowStaged? 0 : 1);
+    double start = vtkTimerLog::GetUniversalTime();
+    internal->ShallowStaged =
+      internal->Stage(dataDescription, internal->NextSlot);
+    dataDescription->StagingTime = vtkTimerLog::GetUniversalTime() - start;
+
+    internal->Mutex->Lock();
+    success = internal->Failed? 0 : 1;
+    internal->Failed = false;
+    dataDescription->CoProcessingTime = internal->CoProcessingTime;
+    internal->Mutex->Unlock();
+
+    internal->Schedule(internal->NextSlot);
+    internal->NextSlot = 1 - internal->NextSlot;
     }
+  else
+    {
+    backPressure += internal->Wait(0);
+    internal->ShallowStaged = false;
+    double start = vtkTimerLog::GetUniversalTime();
+    success = (internal->CoProcessPipelines(dataDescription) &&
+      !internal->Failed)? 1 : 0;
+    internal->Failed = false;
+    dataDescription->StagingTime = 0;
+    dataDescription->CoProcessingTime =
+      vtkTimerLog::GetUniversalTime() - start;
+    }
+  dataDescription->BackPressureTime = backPressure;
   // we want to reset everything here to make sure that new information
   // is properly passed in the next time.
   dataDescription->ResetAll();
@@ -262,6 +521,27 @@ int vtkCPProcessor::CoProcess(vtkCPDataDescription* dataDescription)
 //----------------------------------------------------------------------------
 int vtkCPProcessor::Finalize()
 {
+  this->Internal->Wait(0);
+  this->Internal->StopThread();
+  if(this->Internal->Failed)
+    {
+    vtkWarningMacro("Problems co-processing the last time steps.");
+    this->Internal->Failed = false;
+    }
+
+  // collective, processes without co-processing calls write no records.
+  if(this->InstrumentationFileName)
+    {
+    if(!this->Internal->Instrumentation)
+      {
+      this->Internal->Instrumentation =
+        vtkSmartPointer<vtkCPInstrumentation>::New();
+      }
+    this->Internal->Instrumentation->Write(this->InstrumentationFileName,
+      vtkMultiProcessController::GetGlobalController());
+    }
+  this->Internal->Instrumentation = NULL;
+
   if(this->Controller)
     {
     this->Controller->SetGlobalController(NULL);
@@ -283,8 +563,57 @@ int vtkCPProcessor::Finalize()
   return 1;
 }
 
+//----------------------------------------------------------------------------
+bool vtkCPProcessor::CanCoProcessAsynchronously()
+{
+  const char* reason = NULL;
+#ifdef PARAVIEW_USE_MPI
+  // the pipelines communicate on the helper thread while the simulation
+  // communicates too.
+  vtkMultiProcessController* controller =
+    vtkMultiProcessController::GetGlobalController();
+  int initialized = 0;
+  MPI_Initialized(&initialized);
+  if(initialized && controller && controller->GetNumberOfProcesses() > 1)
+    {
+    int provided = MPI_THREAD_SINGLE;
+    MPI_Query_thread(&provided);
+    if(provided < MPI_THREAD_MULTIPLE)
+      {
+      reason = "MPI does not provide MPI_THREAD_MULTIPLE";
+      }
+    }
+#endif
+  // the Python interpreter is only used from the simulation thread.
+  for(vtkCPProcessorInternals::PipelineListIterator iter =
+        this->Internal->Pipelines.begin();
+      !reason && iter!=this->Internal->Pipelines.end();iter++)
+    {
+    if(iter->GetPointer()->IsA("vtkCPPythonScriptPipeline"))
+      {
+      reason = "Python pipelines are used";
+      }
+    }
+
+  if(!reason)
+    {
+    return true;
+    }
+  if(!this->Internal->WarnedSynchronous)
+    {
+    vtkWarningMacro("Co-processing synchronously since " << reason << ".");
+    this->Internal->WarnedSynchronous = true;
+    }
+  return false;
+}
+
 //----------------------------------------------------------------------------
 void vtkCPProcessor::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "AsynchronousCoProcessing: "
+     << this->AsynchronousCoProcessing << endl;
+  os << indent << "InstrumentationFileName: "
+     << (this->InstrumentationFileName? this->InstrumentationFileName : "(none)")
+     << endl;
 }
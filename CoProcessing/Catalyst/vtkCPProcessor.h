@@ -105,6 +105,37 @@ public:
   /// implementation an opportunity to clean up, before it is destroyed.
   virtual int Finalize();
 
+  /// When on, CoProcess() stages the grids of the time step, see
+  /// vtkCPInputDataDescription::SetShallowStaging(), and returns while the
+  /// pipelines execute on a helper thread, so that the simulation computes
+  /// the next time step meanwhile. Time steps are co-processed in order.
+  /// The pipelines are not thread safe, so RequestDataDescription() waits
+  /// until they are done with the staged time step, see
+  /// vtkCPDataDescription::GetBackPressureTime(): one time step is in
+  /// flight at a time. RequestDataDescription() does not wait when the
+  /// output is forced, unless the staged time step uses the buffers of the
+  /// simulation, so such a time step can be staged in a second slot while
+  /// the previous one is co-processed; CoProcess() waits when both slots
+  /// are in use. CoProcess() returns 0 if the pipelines failed on an
+  /// earlier time step. The pipelines must not use the objects of the
+  /// simulation thread, e.g. its rendering context. Python pipelines, and
+  /// running on more than one process with an MPI implementation not
+  /// providing MPI_THREAD_MULTIPLE, are not supported: time steps are
+  /// co-processed synchronously then. Off by default.
+  vtkSetMacro(AsynchronousCoProcessing, int);
+  vtkGetMacro(AsynchronousCoProcessing, int);
+  vtkBooleanMacro(AsynchronousCoProcessing, int);
+
+  /// When set, the wall time, the growth of the peak resident memory and
+  /// the bytes written of the co-processing calls of each pipeline, and of
+  /// the executions of each filter within them, are recorded and written
+  /// to this file by Finalize(), aggregated over the processes (min, avg,
+  /// max). The log is CSV when the file name ends with .csv, JSON
+  /// otherwise. Must be the same on all processes. NULL, i.e. no
+  /// instrumentation, by default. See vtkCPInstrumentation.
+  vtkSetStringMacro(InstrumentationFileName);
+  vtkGetStringMacro(InstrumentationFileName);
+
 protected:
   vtkCPProcessor();
   virtual ~vtkCPProcessor();
@@ -112,6 +143,13 @@ protected:
   /// Create a new instance of the InitializationHelper.
   virtual vtkObject* NewInitializationHelper();
 
+  /// Returns true when the time steps can be co-processed on the helper
+  /// thread, warns once otherwise.
+  virtual bool CanCoProcessAsynchronously();
+
+  int AsynchronousCoProcessing;
+  char* InstrumentationFileName;
+
 private:
   vtkCPProcessor(const vtkCPProcessor&); // Not implemented
   void operator=(const vtkCPProcessor&); // Not implemented
@@ -280,6 +280,13 @@ int vtkCPPythonScriptPipeline::Finalize()
   return 1;
 }
 
+//----------------------------------------------------------------------------
+const char* vtkCPPythonScriptPipeline::GetPipelineName()
+{
+  return this->PythonScriptName? this->PythonScriptName :
+    this->Superclass::GetPipelineName();
+}
+
 //----------------------------------------------------------------------------
 vtkStdString vtkCPPythonScriptPipeline::GetPythonAddress(void* pointer)
 {
@@ -53,6 +53,9 @@ public:
   /// is given. Returns 1 for success and 0 for failure.
   virtual int Finalize();
 
+  /// Returns the name of the script, without the path or extension.
+  virtual const char* GetPipelineName();
+
 protected:
   vtkCPPythonScriptPipeline();
   virtual ~vtkCPPythonScriptPipeline();
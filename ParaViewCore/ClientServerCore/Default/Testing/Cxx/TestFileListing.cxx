@@ -0,0 +1,186 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestFileListing.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Benchmarks the directory listings of vtkPVFileInformation on a synthetic
+// directory holding a file series, a few single files and subdirectories:
+// the listing with one vtkPVFileInformation per entry and the compact
+// listing, whole, filtered and paged. Reports the time to gather each and to
+// move it through a vtkClientServerStream as for a remote file dialog, and
+// checks the entries of the compact listings. Use --files=500000 for the
+// benchmark, the directory is only created once.
+
+#include "vtkClientServerStream.h"
+#include "vtkCollection.h"
+#include "vtkNew.h"
+#include "vtkPVFileInformation.h"
+#include "vtkPVFileInformationHelper.h"
+#include "vtkTesting.h"
+#include "vtkTimerLog.h"
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vtksys/CommandLineArguments.hxx>
+#include <vtksys/SystemTools.hxx>
+
+namespace
+{
+  const int NumberOfSingleFiles = 26;
+  const int NumberOfDirectories = 3;
+
+  std::string SeriesFileName(int index)
+    {
+    char name[64];
+    sprintf(name, "data_%07d.vtu", index);
+    return name;
+    }
+
+  bool MakeListedDirectory(const std::string& path, int numFiles)
+    {
+    std::ostringstream marker;
+    marker << path << ".listing_" << numFiles;
+    if (vtksys::SystemTools::FileExists(marker.str().c_str(), true))
+      {
+      return true;
+      }
+    vtksys::SystemTools::RemoveADirectory(path.c_str());
+    vtksys::SystemTools::RemoveFile(marker.str().c_str());
+    if (!vtksys::SystemTools::MakeDirectory(path.c_str()))
+      {
+      return false;
+      }
+    for (int cc = 0; cc < NumberOfDirectories; ++cc)
+      {
+      std::string dir = path + "/subdir_" + static_cast<char>('a' + cc);
+      vtksys::SystemTools::MakeDirectory(dir.c_str());
+      }
+    for (int cc = 0; cc < NumberOfSingleFiles; ++cc)
+      {
+      std::string file = path + "/single_" + static_cast<char>('a' + cc) + ".txt";
+      ofstream(file.c_str()).close();
+      }
+    for (int cc = 0; cc < numFiles; ++cc)
+      {
+      std::string file = path + "/" + SeriesFileName(cc);
+      ofstream(file.c_str()).close();
+      }
+    ofstream(marker.str().c_str()).close();
+    return true;
+    }
+
+  // Gathers the listing and sends it through a stream into received.
+  void List(vtkPVFileInformationHelper* helper, vtkPVFileInformation* received,
+    const char* name)
+    {
+    vtkNew<vtkTimerLog> timer;
+    vtkNew<vtkPVFileInformation> info;
+    timer->StartTimer();
+    info->CopyFromObject(helper);
+    timer->StopTimer();
+    double gather = timer->GetElapsedTime();
+
+    timer->StartTimer();
+    vtkClientServerStream stream;
+    info->CopyToStream(&stream);
+    const unsigned char* data;
+    size_t length;
+    stream.GetData(&data, &length);
+    vtkClientServerStream copy;
+    copy.SetData(data, length);
+    received->CopyFromStream(&copy);
+    timer->StopTimer();
+
+    cout << name << ": gather " << gather << "s, stream "
+         << timer->GetElapsedTime() << "s, " << length << " bytes" << endl;
+    }
+
+  bool Check(bool condition, const char* message)
+    {
+    if (!condition)
+      {
+      cerr << "ERROR: " << message << endl;
+      }
+    return condition;
+    }
+}
+
+int TestFileListing(int argc, char* argv[])
+{
+  int numFiles = 20000;
+
+  vtksys::CommandLineArguments arg;
+  arg.Initialize(argc, argv);
+  typedef vtksys::CommandLineArguments argT;
+  arg.AddArgument("--files", argT::EQUAL_ARGUMENT, &numFiles,
+    "Number of files of the series in the listed directory.");
+  arg.StoreUnusedArguments(true);
+  if (!arg.Parse() || numFiles < 2)
+    {
+    cerr << "Problem parsing arguments" << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkTesting> testing;
+  testing->AddArguments(argc, const_cast<const char**>(argv));
+  std::string path = testing->GetTempDirectory();
+  path += "/TestFileListing";
+  if (!MakeListedDirectory(path, numFiles))
+    {
+    cerr << "Cannot create " << path << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkPVFileInformationHelper> helper;
+  helper->SetPath(path.c_str());
+  helper->SetDirectoryListing(1);
+
+  vtkNew<vtkPVFileInformation> info;
+  List(helper.GetPointer(), info.GetPointer(), "listing");
+  bool status = Check(info->GetContents()->GetNumberOfItems() ==
+    NumberOfDirectories + NumberOfSingleFiles + 1, "wrong listing.");
+
+  helper->SetCompactListing(1);
+  List(helper.GetPointer(), info.GetPointer(), "compact listing");
+  int numEntries = NumberOfDirectories + NumberOfSingleFiles + 1;
+  int group = NumberOfDirectories; // "data_..vtu", before "single_a.txt"
+  status = Check(info->GetTotalNumberOfListingEntries() == numEntries &&
+    info->GetNumberOfListingEntries() == numEntries &&
+    info->GetListingEntryType(0) == vtkPVFileInformation::DIRECTORY &&
+    info->GetListingEntryType(group) == vtkPVFileInformation::FILE_GROUP &&
+    info->GetNumberOfListingGroupFiles(group) == numFiles &&
+    info->GetListingEntryTarget(0) == NULL &&
+    info->GetListingEntryTarget(group) == NULL &&
+    SeriesFileName(numFiles - 1) ==
+      info->GetListingGroupFileName(group, numFiles - 1),
+    "wrong compact listing.") && status;
+
+  helper->SetListingFilter("*.vtu *.vtk");
+  List(helper.GetPointer(), info.GetPointer(), "filtered compact listing");
+  status = Check(info->GetTotalNumberOfListingEntries() == NumberOfDirectories + 1 &&
+    info->GetListingEntryType(NumberOfDirectories) ==
+      vtkPVFileInformation::FILE_GROUP,
+    "wrong filtered compact listing.") && status;
+
+  helper->SetListingFilter(NULL);
+  helper->SetListingOffset(NumberOfDirectories + 2);
+  helper->SetListingLimit(10);
+  List(helper.GetPointer(), info.GetPointer(), "compact listing page");
+  status = Check(info->GetTotalNumberOfListingEntries() == numEntries &&
+    info->GetNumberOfListingEntries() == 10 &&
+    std::string("single_b.txt") == info->GetListingEntryName(0) &&
+    info->GetNumberOfListingGroupFiles(0) == 0,
+    "wrong compact listing page.") && status;
+
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
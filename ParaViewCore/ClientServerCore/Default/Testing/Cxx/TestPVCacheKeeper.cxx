@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVCacheKeeper.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Caches more time steps of a sphere than fit in vtkPVCacheKeeper, checks
+// which ones are evicted, then spills them to disk and reads them back.
+// The first process gets a lower cache limit than the others: in parallel,
+// all the processes must still keep the same time steps.
+
+#include "vtkCacheSizeKeeper.h"
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+#include "vtkPVCacheKeeper.h"
+#include "vtkPVConfig.h"
+#include "vtkSphereSource.h"
+
+#ifdef PARAVIEW_USE_MPI
+# include "vtkMPIController.h"
+#else
+# include "vtkDummyController.h"
+#endif
+
+#include <cmath>
+
+namespace
+{
+  // The sphere is centered on the time step, so that the cached data tells
+  // which time step it was saved for.
+  bool Show(vtkSphereSource* sphere, vtkPVCacheKeeper* keeper, double time)
+    {
+    sphere->SetCenter(time, 0, 0);
+    keeper->SetCacheTime(time);
+    keeper->Update();
+    double bounds[6];
+    vtkPolyData::SafeDownCast(keeper->GetOutput())->GetBounds(bounds);
+    if (std::fabs((bounds[0] + bounds[1]) / 2 - time) > 1e-6)
+      {
+      cerr << "ERROR: wrong data shown for time step " << time << endl;
+      return false;
+      }
+    return true;
+    }
+
+  // Checks that exactly the expected time steps, out of 0 to 5, are cached
+  // on all the processes.
+  bool CheckCached(vtkPVCacheKeeper* keeper, vtkMultiProcessController* contr,
+    const char* expected)
+    {
+    bool status = true;
+    for (int cc = 0; cc < 6; ++cc)
+      {
+      int local = keeper->IsCached(cc)? 1 : 0;
+      int any = 0;
+      int all = 0;
+      contr->AllReduce(&local, &any, 1, vtkCommunicator::MAX_OP);
+      contr->AllReduce(&local, &all, 1, vtkCommunicator::MIN_OP);
+      if (any != all)
+        {
+        cerr << "ERROR: the processes disagree about time step " << cc << endl;
+        status = false;
+        }
+      if (local != (expected[cc] == '1'))
+        {
+        cerr << "ERROR: time step " << cc << " should "
+             << (local? "not " : "") << "be cached" << endl;
+        status = false;
+        }
+      }
+    return status;
+    }
+}
+
+int TestPVCacheKeeper(int argc, char* argv[])
+{
+#ifdef PARAVIEW_USE_MPI
+  vtkNew<vtkMPIController> contr;
+#else
+  vtkNew<vtkDummyController> contr;
+#endif
+  contr->Initialize(&argc, &argv);
+  vtkMultiProcessController::SetGlobalController(contr.GetPointer());
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(64);
+  sphere->SetPhiResolution(64);
+
+  vtkNew<vtkPVCacheKeeper> keeper;
+  keeper->SetInputConnection(sphere->GetOutputPort());
+  keeper->SetCachingEnabled(true);
+
+  vtkCacheSizeKeeper* sizeKeeper = vtkCacheSizeKeeper::GetInstance();
+  sizeKeeper->SetCacheFull(0);
+  sizeKeeper->SetSpillToDisk(false);
+  sizeKeeper->SetCacheLimit(VTK_UNSIGNED_LONG_MAX);
+
+  // Room for 2 time steps on the first process, 4 on the others.
+  bool status = Show(sphere.GetPointer(), keeper.GetPointer(), 0);
+  unsigned long size = sizeKeeper->GetCacheSize();
+  sizeKeeper->SetCacheLimit(
+    contr->GetLocalProcessId() == 0? (5 * size) / 2 : (9 * size) / 2);
+  vtkPVCacheKeeper::ClearCacheStateFlags();
+
+  for (int cc = 1; cc < 4; ++cc)
+    {
+    status = Show(sphere.GetPointer(), keeper.GetPointer(), cc) && status;
+    }
+  status = CheckCached(keeper.GetPointer(), contr.GetPointer(), "001100") &&
+    status;
+
+  // Time step 2 is used again, so time step 3 is evicted for time step 4.
+  status = Show(sphere.GetPointer(), keeper.GetPointer(), 2) && status;
+  status = Show(sphere.GetPointer(), keeper.GetPointer(), 4) && status;
+  status = CheckCached(keeper.GetPointer(), contr.GetPointer(), "001010") &&
+    status;
+  if (vtkPVCacheKeeper::GetCacheMemoryHits() != 1 ||
+    vtkPVCacheKeeper::GetCacheMisses() != 4)
+    {
+    cerr << "ERROR: " << vtkPVCacheKeeper::GetCacheMemoryHits()
+         << " memory hits and " << vtkPVCacheKeeper::GetCacheMisses()
+         << " misses instead of 1 and 4" << endl;
+    status = false;
+    }
+
+  // Evicted time steps are now written to disk and read back from there.
+  sizeKeeper->SetSpillToDisk(true);
+  status = Show(sphere.GetPointer(), keeper.GetPointer(), 5) && status;
+  status = CheckCached(keeper.GetPointer(), contr.GetPointer(), "001011") &&
+    status;
+  status = Show(sphere.GetPointer(), keeper.GetPointer(), 2) && status;
+  if (vtkPVCacheKeeper::GetCacheDiskHits() != 1)
+    {
+    cerr << "ERROR: " << vtkPVCacheKeeper::GetCacheDiskHits()
+         << " disk hits instead of 1" << endl;
+    status = false;
+    }
+
+  keeper->RemoveAllCaches();
+  status = CheckCached(keeper.GetPointer(), contr.GetPointer(), "000000") &&
+    status;
+  if (sizeKeeper->GetCacheSize() != 0)
+    {
+    cerr << "ERROR: " << sizeKeeper->GetCacheSize()
+         << " KB still reported after removing the caches" << endl;
+    status = false;
+    }
+
+  int local = status? 1 : 0;
+  int global = 0;
+  contr->AllReduce(&local, &global, 1, vtkCommunicator::MIN_OP);
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  contr->Finalize();
+  return global? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -51,8 +51,12 @@
 
 #include <vtksys/SystemTools.hxx>
 #include <vtksys/RegularExpression.hxx>
+#include <algorithm>
+#include <ctype.h> // tolower
+#include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 vtkStandardNewMacro(vtkPVFileInformation);
 
@@ -369,11 +373,166 @@ class vtkPVFileInformationSet :
 {
 };
 
+//-----------------------------------------------------------------------------
+// Columns of the compact listing. Names holds the null terminated names of
+// the entries, followed by the ones of the files of the groups, and
+// NameOffsets where each of them starts. The files of entry e are the ones
+// from GroupOffsets[e] to GroupOffsets[e+1]. Targets gives, for each entry,
+// the index of the full path a link resolves to in Names, -1 otherwise;
+// these full paths come last.
+class vtkPVFileInformationListing
+{
+public:
+  vtkPVFileInformationListing() : TotalNumberOfEntries(-1) {}
+
+  void Initialize()
+    {
+    this->TotalNumberOfEntries = -1;
+    this->Types.clear();
+    this->Hidden.clear();
+    this->NameOffsets.clear();
+    this->GroupOffsets.clear();
+    this->Targets.clear();
+    this->Names.clear();
+    }
+
+  void AddName(const std::string& name)
+    {
+    this->NameOffsets.push_back(static_cast<int>(this->Names.size()));
+    this->Names.insert(this->Names.end(), name.begin(), name.end());
+    this->Names.push_back('\0');
+    }
+
+  const char* GetName(size_t index) const
+    {
+    return index < this->NameOffsets.size()?
+      &this->Names[this->NameOffsets[index]] : NULL;
+    }
+
+  int TotalNumberOfEntries;
+  std::vector<int> Types;
+  std::vector<unsigned char> Hidden;
+  std::vector<int> NameOffsets;
+  std::vector<int> GroupOffsets;
+  std::vector<int> Targets;
+  std::vector<char> Names;
+};
+
+//-----------------------------------------------------------------------------
+// Entry of a compact listing while it is built.
+struct vtkPVFileInformationEntry
+{
+  std::string Name;
+  int Type;
+  bool Hidden;
+  std::vector<std::string> Files; // of a FILE_GROUP, in sequence order.
+  std::string Target; // full path a link resolves to.
+};
+
+// Files of a sequence while a compact listing is built.
+struct vtkPVFileInformationGroup
+{
+  bool Hidden; // of the first file found.
+  std::map<int, std::string> Files;
+};
+
+// Directories first, then files and groups, each sorted by name.
+static bool vtkPVFileInformationEntryLess(
+  const vtkPVFileInformationEntry* a, const vtkPVFileInformationEntry* b)
+{
+  bool aIsDirectory = vtkPVFileInformation::IsDirectory(a->Type);
+  bool bIsDirectory = vtkPVFileInformation::IsDirectory(b->Type);
+  if (aIsDirectory != bIsDirectory)
+    {
+    return aIsDirectory;
+    }
+  return a->Name < b->Name;
+}
+
+// Matches name against a wildcard pattern made of '*', '?' and characters.
+static bool vtkPVFileInformationWildcardMatch(const char* pattern,
+  const char* name)
+{
+  const char* star = NULL;
+  const char* resume = NULL;
+  while (*name)
+    {
+    if (*pattern == '*')
+      {
+      star = pattern++;
+      resume = name;
+      }
+#if defined(_WIN32)
+    else if (*pattern == '?' || tolower(*pattern) == tolower(*name))
+#else
+    else if (*pattern == '?' || *pattern == *name)
+#endif
+      {
+      ++pattern;
+      ++name;
+      }
+    else if (star)
+      {
+      pattern = star + 1;
+      name = ++resume;
+      }
+    else
+      {
+      return false;
+      }
+    }
+  while (*pattern == '*')
+    {
+    ++pattern;
+    }
+  return *pattern == '\0';
+}
+
+static bool vtkPVFileInformationFilter(
+  const std::vector<std::string>& patterns, const char* name)
+{
+  if (patterns.empty())
+    {
+    return true;
+    }
+  for (size_t cc = 0; cc < patterns.size(); ++cc)
+    {
+    if (vtkPVFileInformationWildcardMatch(patterns[cc].c_str(), name))
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+template <class T>
+static vtkClientServerStream::Array vtkPVFileInformationInsertArray(
+  const std::vector<T>& values)
+{
+  static const T empty = T();
+  return vtkClientServerStream::InsertArray(
+    values.empty()? &empty : &values[0], static_cast<int>(values.size()));
+}
+
+template <class T>
+static bool vtkPVFileInformationGetArray(const vtkClientServerStream* css,
+  int argument, std::vector<T>& values)
+{
+  vtkTypeUInt32 length;
+  if (!css->GetArgumentLength(0, argument, &length))
+    {
+    return false;
+    }
+  values.resize(length);
+  return length == 0 || css->GetArgument(0, argument, &values[0], length);
+}
+
 //-----------------------------------------------------------------------------
 vtkPVFileInformation::vtkPVFileInformation()
 {
   this->RootOnly = 1;
   this->Contents = vtkCollection::New();
+  this->Listing = new vtkPVFileInformationListing();
   this->SequenceParser = vtkFileSequenceParser::New();
   this->Type = INVALID;
   this->Name = NULL;
@@ -386,6 +545,7 @@ vtkPVFileInformation::vtkPVFileInformation()
 vtkPVFileInformation::~vtkPVFileInformation()
 {
   this->Contents->Delete();
+  delete this->Listing;
   this->SequenceParser->Delete();
   this->SetName(NULL);
   this->SetFullPath(NULL);
@@ -468,6 +628,12 @@ void vtkPVFileInformation::CopyFromObject(vtkObject* object)
 
   if (this->IsDirectory(this->Type) && helper->GetDirectoryListing())
     {
+    if (helper->GetCompactListing())
+      {
+      this->GetCompactDirectoryListing(helper);
+      return;
+      }
+
     // Since we want a directory listing, we now to platform specific listing
     // with intelligent pattern matching hee-haa.
 #if defined(_WIN32)
@@ -899,6 +1065,295 @@ void vtkPVFileInformation::GetDirectoryListing()
 #endif
 }
 
+//-----------------------------------------------------------------------------
+// Unlike GetDirectoryListing(), no vtkPVFileInformation is created per entry
+// and only the entries readdir does not give the type of (links, file systems
+// not reporting types) are stat-ed, which matters for directories with
+// hundreds of thousands of files.
+void vtkPVFileInformation::GetCompactDirectoryListing(
+  vtkPVFileInformationHelper* helper)
+{
+  std::vector<std::string> patterns;
+  if (helper->GetListingFilter())
+    {
+    std::vector<vtksys::String> tokens =
+      vtksys::SystemTools::SplitString(helper->GetListingFilter(), ' ');
+    for (size_t cc = 0; cc < tokens.size(); ++cc)
+      {
+      if (!tokens[cc].empty())
+        {
+        patterns.push_back(tokens[cc]);
+        }
+      }
+    }
+
+  std::vector<vtkPVFileInformationEntry> entries;
+  vtkPVFileInformationEntry entry;
+
+#if defined(_WIN32)
+  // The Windows listing also handles the network shares, convert it.
+  this->GetWindowsDirectoryListing();
+  vtkSmartPointer<vtkCollectionIterator> iter;
+  iter.TakeReference(this->Contents->NewIterator());
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+    vtkPVFileInformation* info = vtkPVFileInformation::SafeDownCast(
+      iter->GetCurrentObject());
+    entry.Name = info->GetName();
+    entry.Type = info->GetType();
+    entry.Hidden = info->GetHidden();
+    entry.Files.clear();
+    entry.Target.clear();
+    if (entry.Type == SINGLE_FILE_LINK || entry.Type == DIRECTORY_LINK)
+      {
+      // the name is the shortcut's without ".lnk", the full path its target.
+      entry.Target = info->GetFullPath();
+      }
+    if (entry.Type == FILE_GROUP)
+      {
+      for (int cc = 0; cc < info->Contents->GetNumberOfItems(); cc++)
+        {
+        vtkPVFileInformation* child = vtkPVFileInformation::SafeDownCast(
+          info->Contents->GetItemAsObject(cc));
+        if (vtkPVFileInformationFilter(patterns, child->GetName()))
+          {
+          entry.Files.push_back(child->GetName());
+          }
+        }
+      if (entry.Files.empty())
+        {
+        continue;
+        }
+      }
+    else if (!IsDirectory(entry.Type) &&
+      !vtkPVFileInformationFilter(patterns, entry.Name.c_str()))
+      {
+      continue;
+      }
+    entries.push_back(entry);
+    }
+  this->Contents->RemoveAllItems();
+#else
+  std::string prefix = this->FullPath;
+  vtkPVFileInformationAddTerminatingSlash(prefix);
+
+  typedef std::map<std::string, vtkPVFileInformationGroup> MapOfStringToGroup;
+  MapOfStringToGroup groups;
+
+  DIR* dir = opendir(this->FullPath);
+  if (!dir)
+    {
+    this->Listing->Initialize();
+    this->Listing->TotalNumberOfEntries = 0;
+    return;
+    }
+  while (const dirent* d = readdir(dir))
+    {
+    if (strcmp(d->d_name, ".") == 0 || strcmp(d->d_name, "..") == 0)
+      {
+      continue;
+      }
+    int type = INVALID;
+#if !(defined (__SVR4) && defined (__sun))
+    if (d->d_type == DT_DIR)
+      {
+      type = DIRECTORY;
+      }
+    else if (d->d_type == DT_REG)
+      {
+      type = SINGLE_FILE;
+      }
+#endif
+    if (type == INVALID)
+      {
+      std::string fullpath = prefix + d->d_name;
+      if (!vtksys::SystemTools::FileExists(fullpath.c_str()))
+        {
+        continue;
+        }
+      type = vtksys::SystemTools::FileIsDirectory(fullpath.c_str())?
+        DIRECTORY : SINGLE_FILE;
+      }
+    bool hidden = d->d_name[0] == '.';
+
+    if (type == SINGLE_FILE)
+      {
+      if (!vtkPVFileInformationFilter(patterns, d->d_name))
+        {
+        continue;
+        }
+      if (this->SequenceParser->ParseFileSequence(const_cast<char*>(d->d_name)))
+        {
+        std::pair<MapOfStringToGroup::iterator, bool> inserted =
+          groups.insert(MapOfStringToGroup::value_type(
+              this->SequenceParser->GetSequenceName(),
+              vtkPVFileInformationGroup()));
+        if (inserted.second)
+          {
+          inserted.first->second.Hidden = hidden;
+          }
+        inserted.first->second.Files[
+          this->SequenceParser->GetSequenceIndex()] = d->d_name;
+        continue;
+        }
+      }
+    entry.Name = d->d_name;
+    entry.Type = type;
+    entry.Hidden = hidden;
+    entries.push_back(entry);
+    }
+  closedir(dir);
+
+  // Groups with a single file are listed as that file.
+  for (MapOfStringToGroup::iterator iter = groups.begin();
+    iter != groups.end(); ++iter)
+    {
+    const vtkPVFileInformationGroup& group = iter->second;
+    entry.Type = group.Files.size() > 1? FILE_GROUP : SINGLE_FILE;
+    entry.Name = group.Files.size() > 1? iter->first :
+      group.Files.begin()->second;
+    entry.Hidden = group.Hidden;
+    entries.push_back(entry);
+    if (entry.Type == FILE_GROUP)
+      {
+      std::vector<std::string>& files = entries.back().Files;
+      files.reserve(group.Files.size());
+      for (std::map<int, std::string>::const_iterator file =
+        group.Files.begin(); file != group.Files.end(); ++file)
+        {
+        files.push_back(file->second);
+        }
+      }
+    }
+#endif
+
+  // Sort pointers, not the entries which can hold many file names.
+  std::vector<const vtkPVFileInformationEntry*> order(entries.size());
+  for (size_t cc = 0; cc < entries.size(); ++cc)
+    {
+    order[cc] = &entries[cc];
+    }
+  std::sort(order.begin(), order.end(), vtkPVFileInformationEntryLess);
+
+  int total = static_cast<int>(order.size());
+  int begin = std::min(helper->GetListingOffset(), total);
+  int end = total;
+  if (helper->GetListingLimit() > 0 && helper->GetListingLimit() < total - begin)
+    {
+    end = begin + helper->GetListingLimit();
+    }
+
+  vtkPVFileInformationListing* listing = this->Listing;
+  listing->Initialize();
+  listing->TotalNumberOfEntries = total;
+  int numberOfFiles = 0;
+  for (int cc = begin; cc < end; ++cc)
+    {
+    listing->AddName(order[cc]->Name);
+    listing->Types.push_back(order[cc]->Type);
+    listing->Hidden.push_back(order[cc]->Hidden? 1 : 0);
+    listing->GroupOffsets.push_back(numberOfFiles);
+    numberOfFiles += static_cast<int>(order[cc]->Files.size());
+    }
+  listing->GroupOffsets.push_back(numberOfFiles);
+  for (int cc = begin; cc < end; ++cc)
+    {
+    for (size_t file = 0; file < order[cc]->Files.size(); ++file)
+      {
+      listing->AddName(order[cc]->Files[file]);
+      }
+    }
+  for (int cc = begin; cc < end; ++cc)
+    {
+    if (order[cc]->Target.empty())
+      {
+      listing->Targets.push_back(-1);
+      }
+    else
+      {
+      listing->Targets.push_back(
+        static_cast<int>(listing->NameOffsets.size()));
+      listing->AddName(order[cc]->Target);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+int vtkPVFileInformation::GetNumberOfListingEntries()
+{
+  return static_cast<int>(this->Listing->Types.size());
+}
+
+//-----------------------------------------------------------------------------
+const char* vtkPVFileInformation::GetListingEntryName(int entry)
+{
+  if (entry < 0 || entry >= this->GetNumberOfListingEntries())
+    {
+    return NULL;
+    }
+  return this->Listing->GetName(entry);
+}
+
+//-----------------------------------------------------------------------------
+int vtkPVFileInformation::GetListingEntryType(int entry)
+{
+  if (entry < 0 || entry >= this->GetNumberOfListingEntries())
+    {
+    return INVALID;
+    }
+  return this->Listing->Types[entry];
+}
+
+//-----------------------------------------------------------------------------
+bool vtkPVFileInformation::GetListingEntryHidden(int entry)
+{
+  if (entry < 0 || entry >= this->GetNumberOfListingEntries())
+    {
+    return false;
+    }
+  return this->Listing->Hidden[entry] != 0;
+}
+
+//-----------------------------------------------------------------------------
+const char* vtkPVFileInformation::GetListingEntryTarget(int entry)
+{
+  if (entry < 0 || entry >= this->GetNumberOfListingEntries() ||
+    static_cast<size_t>(entry) >= this->Listing->Targets.size() ||
+    this->Listing->Targets[entry] < 0)
+    {
+    return NULL;
+    }
+  return this->Listing->GetName(this->Listing->Targets[entry]);
+}
+
+//-----------------------------------------------------------------------------
+int vtkPVFileInformation::GetNumberOfListingGroupFiles(int entry)
+{
+  if (entry < 0 || entry >= this->GetNumberOfListingEntries())
+    {
+    return 0;
+    }
+  return this->Listing->GroupOffsets[entry + 1] -
+    this->Listing->GroupOffsets[entry];
+}
+
+//-----------------------------------------------------------------------------
+const char* vtkPVFileInformation::GetListingGroupFileName(int entry, int file)
+{
+  if (file < 0 || file >= this->GetNumberOfListingGroupFiles(entry))
+    {
+    return NULL;
+    }
+  return this->Listing->GetName(this->GetNumberOfListingEntries() +
+    this->Listing->GroupOffsets[entry] + file);
+}
+
+//-----------------------------------------------------------------------------
+int vtkPVFileInformation::GetTotalNumberOfListingEntries()
+{
+  return this->Listing->TotalNumberOfEntries;
+}
+
 //-----------------------------------------------------------------------------
 void vtkPVFileInformation::SetHiddenFlag( )
 {
@@ -1078,6 +1533,18 @@ void vtkPVFileInformation::CopyToStream(vtkClientServerStream* stream)
     child->CopyToStream(&childStream);
     *stream << childStream;
     }
+
+  vtkPVFileInformationListing* listing = this->Listing;
+  *stream << listing->TotalNumberOfEntries;
+  if (listing->TotalNumberOfEntries >= 0)
+    {
+    *stream << vtkPVFileInformationInsertArray(listing->Types)
+      << vtkPVFileInformationInsertArray(listing->Hidden)
+      << vtkPVFileInformationInsertArray(listing->NameOffsets)
+      << vtkPVFileInformationInsertArray(listing->GroupOffsets)
+      << vtkPVFileInformationInsertArray(listing->Targets)
+      << vtkPVFileInformationInsertArray(listing->Names);
+    }
   *stream << vtkClientServerStream::End;
 }
 
@@ -1131,6 +1598,25 @@ void vtkPVFileInformation::CopyFromStream(const vtkClientServerStream* css)
     this->Contents->AddItem(child);
     child->Delete();
     }
+
+  int arg = 5 + num_of_children;
+  vtkPVFileInformationListing* listing = this->Listing;
+  if (!css->GetArgument(0, arg++, &listing->TotalNumberOfEntries))
+    {
+    vtkErrorMacro("Error parsing number of listing entries.");
+    return;
+    }
+  if (listing->TotalNumberOfEntries >= 0 &&
+    (!vtkPVFileInformationGetArray(css, arg++, listing->Types) ||
+     !vtkPVFileInformationGetArray(css, arg++, listing->Hidden) ||
+     !vtkPVFileInformationGetArray(css, arg++, listing->NameOffsets) ||
+     !vtkPVFileInformationGetArray(css, arg++, listing->GroupOffsets) ||
+     !vtkPVFileInformationGetArray(css, arg++, listing->Targets) ||
+     !vtkPVFileInformationGetArray(css, arg++, listing->Names)))
+    {
+    vtkErrorMacro("Error parsing compact listing.");
+    listing->Initialize();
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -1141,6 +1627,7 @@ void vtkPVFileInformation::Initialize()
   this->Type = INVALID;
   this->Hidden = false;
   this->Contents->RemoveAllItems();
+  this->Listing->Initialize();
 }
 
 //-----------------------------------------------------------------------------
@@ -1171,6 +1658,15 @@ void vtkPVFileInformation::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Hidden: "<< this->Hidden << endl;
   os << indent << "FastFileTypeDetection: " << this->FastFileTypeDetection << endl;
 
+  os << indent << "TotalNumberOfListingEntries: "
+    << this->Listing->TotalNumberOfEntries << endl;
+  for (int cc=0; cc < this->GetNumberOfListingEntries(); cc++)
+    {
+    os << indent.GetNextIndent() << this->GetListingEntryName(cc)
+      << " (type: " << this->GetListingEntryType(cc)
+      << ", files: " << this->GetNumberOfListingGroupFiles(cc) << ")" << endl;
+    }
+
   for (int cc=0; cc < this->Contents->GetNumberOfItems(); cc++)
     {
     os << endl;
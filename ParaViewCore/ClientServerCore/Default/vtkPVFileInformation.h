@@ -28,6 +28,8 @@
 #include "vtkPVInformation.h"
 
 class vtkCollection;
+class vtkPVFileInformationHelper;
+class vtkPVFileInformationListing;
 class vtkPVFileInformationSet;
 class vtkFileSequenceParser;
 
@@ -98,11 +100,34 @@ public:
   // or the contents of this file group if Type ==FILE_GROUP.
   vtkGetObjectMacro(Contents, vtkCollection);
 
+  // Description:
+  // Get the compact listing of this directory, gathered instead of Contents
+  // when vtkPVFileInformationHelper::CompactListing is on. Each entry has a
+  // name, a type and a hidden flag, and FILE_GROUP entries the names of their
+  // files, all in this directory. Directories come first, then files and
+  // groups, each sorted by name. Link entries (Windows shortcuts) are named
+  // without their ".lnk" extension and GetListingEntryTarget() gives the full
+  // path they resolve to, NULL for other entries.
+  int GetNumberOfListingEntries();
+  const char* GetListingEntryName(int entry);
+  int GetListingEntryType(int entry);
+  bool GetListingEntryHidden(int entry);
+  const char* GetListingEntryTarget(int entry);
+  int GetNumberOfListingGroupFiles(int entry);
+  const char* GetListingGroupFileName(int entry, int file);
+
+  // Description:
+  // Get the number of entries of the directory matching the listing filter,
+  // of which the compact listing is the requested page. -1 when there is no
+  // compact listing.
+  int GetTotalNumberOfListingEntries();
+
 protected:
   vtkPVFileInformation();
   ~vtkPVFileInformation();
 
   vtkCollection* Contents;
+  vtkPVFileInformationListing* Listing;
   vtkFileSequenceParser * SequenceParser;
 
   char* Name;     // Name of this file/directory.
@@ -116,6 +141,11 @@ protected:
   void GetWindowsDirectoryListing();
   void GetDirectoryListing();
 
+  // Description:
+  // Fills the compact listing from a directory listing, filtered and paged
+  // as requested by the helper.
+  void GetCompactDirectoryListing(vtkPVFileInformationHelper* helper);
+
   // Goes thru the collection of vtkPVFileInformation objects
   // are creates file groups, if possible.
   void OrganizeCollection(vtkPVFileInformationSet& vector);
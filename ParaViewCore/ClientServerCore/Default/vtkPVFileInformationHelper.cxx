@@ -29,6 +29,10 @@ vtkPVFileInformationHelper::vtkPVFileInformationHelper()
   this->SetPath(".");
   this->PathSeparator = 0;
   this->FastFileTypeDetection = 1;
+  this->CompactListing = 0;
+  this->ListingFilter = 0;
+  this->ListingOffset = 0;
+  this->ListingLimit = 0;
 #if defined(_WIN32) && !defined(__CYGWIN__)
   this->SetPathSeparator("\\");
 #else
@@ -42,6 +46,7 @@ vtkPVFileInformationHelper::~vtkPVFileInformationHelper()
   this->SetPath(0);
   this->SetPathSeparator(0);
   this->SetWorkingDirectory(0);
+  this->SetListingFilter(0);
 }
 
 //-----------------------------------------------------------------------------
@@ -69,4 +74,9 @@ void vtkPVFileInformationHelper::PrintSelf(ostream& os, vtkIndent indent)
     <<  (this->PathSeparator? this->PathSeparator : "(null)") << endl;
   os << indent << "FastFileTypeDetection: "
     << this->FastFileTypeDetection << endl;
+  os << indent << "CompactListing: " << this->CompactListing << endl;
+  os << indent << "ListingFilter: "
+    << (this->ListingFilter? this->ListingFilter : "(null)") << endl;
+  os << indent << "ListingOffset: " << this->ListingOffset << endl;
+  os << indent << "ListingLimit: " << this->ListingLimit << endl;
 }
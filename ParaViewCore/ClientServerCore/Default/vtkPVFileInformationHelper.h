@@ -80,6 +80,32 @@ public:
   vtkGetMacro(FastFileTypeDetection, int);
   vtkSetMacro(FastFileTypeDetection, int);
 
+  // Description:
+  // When on, a directory listing is returned as the compact listing of
+  // vtkPVFileInformation, i.e. as columns of names and types, instead of one
+  // vtkPVFileInformation per entry in its Contents. Only the compact listing
+  // supports ListingFilter, ListingOffset and ListingLimit.
+  // Off by default.
+  vtkGetMacro(CompactListing, int);
+  vtkSetMacro(CompactListing, int);
+  vtkBooleanMacro(CompactListing, int);
+
+  // Description:
+  // Wildcard patterns, separated by spaces, e.g. "*.vtu *.pvtu", that the
+  // files of a compact listing must match. Directories are always listed.
+  // Empty (default) to list all files.
+  vtkSetStringMacro(ListingFilter);
+  vtkGetStringMacro(ListingFilter);
+
+  // Description:
+  // Page of a compact listing: the entries, sorted with directories first,
+  // from ListingOffset and at most ListingLimit of them, 0 for all of them.
+  // Defaults to 0 and 0, i.e. the whole listing.
+  vtkSetClampMacro(ListingOffset, int, 0, VTK_INT_MAX);
+  vtkGetMacro(ListingOffset, int);
+  vtkSetClampMacro(ListingLimit, int, 0, VTK_INT_MAX);
+  vtkGetMacro(ListingLimit, int);
+
   // Description:
   // Returns the platform specific path separator.
   vtkGetStringMacro(PathSeparator);
@@ -101,6 +127,10 @@ protected:
   int DirectoryListing;
   int SpecialDirectories;
   int FastFileTypeDetection;
+  int CompactListing;
+  char* ListingFilter;
+  int ListingOffset;
+  int ListingLimit;
 
   char* PathSeparator;
   vtkSetStringMacro(PathSeparator);
@@ -0,0 +1,154 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestGeometryRepresentationLODLevels.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Requests the levels of detail of a sphere from vtkGeometryRepresentation.
+// Checks that each level is only built when requested, that finer levels
+// have more triangles, and that the levels are rebuilt when the geometry
+// changes. With caching, checks that the levels of each cache key are kept
+// and reported to vtkCacheSizeKeeper, but only while they fit in the cache,
+// and that everything reported is freed with the representation.
+
+#include "vtkCacheSizeKeeper.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkCompositeDataSet.h"
+#include "vtkGeometryRepresentation.h"
+#include "vtkNew.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+
+#include <cstdlib>
+
+namespace
+{
+  vtkIdType CountCells(vtkDataObject* data)
+    {
+    vtkCompositeDataSet* composite = vtkCompositeDataSet::SafeDownCast(data);
+    if (!composite)
+      {
+      vtkDataSet* dataSet = vtkDataSet::SafeDownCast(data);
+      return dataSet? dataSet->GetNumberOfCells() : 0;
+      }
+    vtkIdType count = 0;
+    vtkCompositeDataIterator* iter = composite->NewIterator();
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal();
+      iter->GoToNextItem())
+      {
+      count += CountCells(iter->GetCurrentDataObject());
+      }
+    iter->Delete();
+    return count;
+    }
+
+  bool Check(bool condition, const char* message)
+    {
+    if (!condition)
+      {
+      cerr << "ERROR: " << message << endl;
+      }
+    return condition;
+    }
+
+  // Without caching: lazy levels, rebuilt when the geometry changes.
+  bool TestCurrentLevels()
+    {
+    vtkCacheSizeKeeper* keeper = vtkCacheSizeKeeper::GetInstance();
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetThetaResolution(128);
+    sphere->SetPhiResolution(128);
+    vtkNew<vtkGeometryRepresentation> representation;
+    representation->SetNumberOfLODLevels(3);
+    representation->SetInputConnection(sphere->GetOutputPort());
+    representation->Update();
+
+    bool status = Check(representation->GetLODLevel(3) == NULL &&
+      representation->GetLODLevel(-1) == NULL, "invalid levels returned");
+    vtkSmartPointer<vtkDataObject> coarse = representation->GetLODLevel(0);
+    vtkSmartPointer<vtkDataObject> fine = representation->GetLODLevel(2);
+    status = Check(coarse && fine &&
+      CountCells(coarse) < CountCells(fine) &&
+      CountCells(fine) < sphere->GetOutput()->GetNumberOfCells(),
+      "the levels are not decimated from coarse to fine") && status;
+    status = Check(representation->GetLODLevel(0) == coarse &&
+      representation->GetLODLevel(2) == fine,
+      "the levels are rebuilt for the same geometry") && status;
+    status = Check(keeper->GetCacheSize() == 0,
+      "levels reported to the cache without caching") && status;
+
+    sphere->SetCenter(1, 0, 0);
+    representation->Update();
+    status = Check(representation->GetLODLevel(0) != coarse,
+      "the levels are not rebuilt when the geometry changes") && status;
+    return status;
+    }
+
+  // With caching: the levels of each cache key are kept and counted.
+  bool TestCachedLevels()
+    {
+    vtkCacheSizeKeeper* keeper = vtkCacheSizeKeeper::GetInstance();
+    keeper->SetCacheLimit(VTK_UNSIGNED_LONG_MAX);
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetThetaResolution(128);
+    sphere->SetPhiResolution(128);
+    vtkGeometryRepresentation* representation =
+      vtkGeometryRepresentation::New();
+    representation->SetNumberOfLODLevels(3);
+    representation->SetInputConnection(sphere->GetOutputPort());
+    representation->SetForceUseCache(true);
+    representation->SetForcedCacheKey(0);
+    representation->Update();
+
+    // Only the requested level is built and reported.
+    unsigned long geometrySize = keeper->GetCacheSize();
+    vtkSmartPointer<vtkDataObject> fine = representation->GetLODLevel(2);
+    unsigned long fineSize = fine->GetActualMemorySize();
+    bool status = Check(geometrySize > 0 && fineSize > 0 &&
+      keeper->GetCacheSize() == geometrySize + fineSize,
+      "the finest level is not reported alone to the cache");
+
+    // Another cache key, then back to the first one.
+    representation->SetForcedCacheKey(1);
+    sphere->SetCenter(1, 0, 0);
+    representation->Update();
+    vtkSmartPointer<vtkDataObject> other = representation->GetLODLevel(2);
+    status = Check(other != fine, "the levels are shared by the cache keys") &&
+      status;
+    representation->SetForcedCacheKey(0);
+    representation->Modified();
+    representation->Update();
+    status = Check(representation->GetLODLevel(2) == fine,
+      "the levels of a cached geometry are not kept") && status;
+
+    // A level that doesn't fit is returned but not reported.
+    unsigned long size = keeper->GetCacheSize();
+    keeper->SetCacheLimit(size);
+    vtkSmartPointer<vtkDataObject> coarse = representation->GetLODLevel(0);
+    status = Check(coarse && keeper->GetCacheSize() == size,
+      "a level exceeding the cache limit is reported") && status;
+    status = Check(representation->GetLODLevel(0) == coarse,
+      "a level exceeding the cache limit is rebuilt") && status;
+    keeper->SetCacheLimit(VTK_UNSIGNED_LONG_MAX);
+
+    representation->Delete();
+    status = Check(keeper->GetCacheSize() == 0,
+      "the levels are still reported to the cache") && status;
+    return status;
+    }
+}
+
+int TestGeometryRepresentationLODLevels(int, char*[])
+{
+  bool status = TestCurrentLevels();
+  status = TestCachedLevels() && status;
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
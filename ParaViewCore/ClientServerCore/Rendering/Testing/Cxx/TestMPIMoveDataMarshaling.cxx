@@ -0,0 +1,424 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestMPIMoveDataMarshaling.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Marshals a polydata, an unstructured grid and an image data as
+// vtkMPIMoveData does before sending them, then reconstructs them, with the
+// legacy VTK writer and reader, natively and natively with LZ4 compression.
+// Checks that the reconstructed data sets match the originals and reports
+// the size of the buffers and the throughput of each path. The native
+// buffers are also reconstructed as if they came from a sender with the
+// other byte order or another size of vtkIdType.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkMPIMoveData.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkTimerLog.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// Exposes the marshaling of vtkMPIMoveData.
+class vtkMarshalingMoveData : public vtkMPIMoveData
+{
+public:
+  static vtkMarshalingMoveData* New();
+  vtkTypeMacro(vtkMarshalingMoveData, vtkMPIMoveData);
+
+  // Marshals input then reconstructs it in output, adding the seconds
+  // needed to each step. Returns the length of the buffer.
+  vtkIdType RoundTrip(vtkDataObject* input, vtkDataObject* output,
+    double& marshal, double& reconstruct)
+    {
+    this->ClearBuffer();
+    double start = vtkTimerLog::GetUniversalTime();
+    this->MarshalDataToBuffer(input);
+    double middle = vtkTimerLog::GetUniversalTime();
+    this->ReconstructDataFromBuffer(output);
+    double end = vtkTimerLog::GetUniversalTime();
+    marshal += middle - start;
+    reconstruct += end - middle;
+    return this->BufferTotalLength;
+    }
+
+  // Makes the native marshaling write the values as a sender with the
+  // other byte order and/or with ids of idTypeSize bytes would.
+  void SetNativeSender(bool swap, int idTypeSize)
+    {
+    this->SwapNativeBytes = swap;
+    this->NativeIdTypeSize = idTypeSize;
+    }
+
+  // Returns whether the last buffer was marshaled natively.
+  bool IsNative()
+    {
+    return this->NumberOfBuffers == 1 && this->BufferTotalLength >= 4 &&
+      strncmp(this->Buffers, "vtkn", 4) == 0;
+    }
+
+protected:
+  vtkMarshalingMoveData() {}
+
+private:
+  vtkMarshalingMoveData(const vtkMarshalingMoveData&); // Not implemented
+  void operator=(const vtkMarshalingMoveData&); // Not implemented
+};
+
+vtkStandardNewMacro(vtkMarshalingMoveData);
+
+namespace
+{
+  const int NumberOfRuns = 3;
+
+  // A triangulated height field of dimension^2 points.
+  void MakePolyData(vtkPolyData* polyData, int dimension)
+    {
+    vtkNew<vtkPoints> points;
+    vtkNew<vtkFloatArray> normals;
+    normals->SetName("Normals");
+    normals->SetNumberOfComponents(3);
+    vtkNew<vtkDoubleArray> elevation;
+    elevation->SetName("Elevation");
+    for (int j = 0; j < dimension; j++)
+      {
+      for (int i = 0; i < dimension; i++)
+        {
+        double z = sin(0.05 * i) * cos(0.05 * j);
+        points->InsertNextPoint(i, j, z);
+        normals->InsertNextTuple3(0, 0, 1);
+        elevation->InsertNextValue(z);
+        }
+      }
+    vtkNew<vtkCellArray> polys;
+    vtkNew<vtkIntArray> regions;
+    regions->SetName("Region");
+    for (int j = 0; j + 1 < dimension; j++)
+      {
+      for (int i = 0; i + 1 < dimension; i++)
+        {
+        vtkIdType p = i + j * dimension;
+        vtkIdType lower[3] = { p, p + 1, p + 1 + dimension };
+        vtkIdType upper[3] = { p, p + 1 + dimension, p + dimension };
+        polys->InsertNextCell(3, lower);
+        polys->InsertNextCell(3, upper);
+        regions->InsertNextValue(i / 16 + j / 16);
+        regions->InsertNextValue(i / 16 + j / 16);
+        }
+      }
+    polyData->SetPoints(points.GetPointer());
+    polyData->SetPolys(polys.GetPointer());
+    polyData->GetPointData()->SetNormals(normals.GetPointer());
+    polyData->GetPointData()->SetScalars(elevation.GetPointer());
+    polyData->GetCellData()->AddArray(regions.GetPointer());
+    }
+
+  // A grid of (dimension - 1)^3 hexahedra, each cell being split in two
+  // wedges every other cell, with an id array.
+  void MakeUnstructuredGrid(vtkUnstructuredGrid* grid, int dimension)
+    {
+    vtkNew<vtkPoints> points;
+    points->SetDataTypeToDouble();
+    vtkNew<vtkFloatArray> temperature;
+    temperature->SetName("Temperature");
+    for (int k = 0; k < dimension; k++)
+      {
+      for (int j = 0; j < dimension; j++)
+        {
+        for (int i = 0; i < dimension; i++)
+          {
+          points->InsertNextPoint(i, j + 0.1 * i, k);
+          temperature->InsertNextValue(static_cast<float>(i * j - k));
+          }
+        }
+      }
+    grid->SetPoints(points.GetPointer());
+    grid->Allocate();
+    vtkNew<vtkIdTypeArray> cellIds;
+    cellIds->SetName("CellIds");
+    vtkIdType dx = 1;
+    vtkIdType dy = dimension;
+    vtkIdType dz = dimension * dimension;
+    for (int k = 0; k + 1 < dimension; k++)
+      {
+      for (int j = 0; j + 1 < dimension; j++)
+        {
+        for (int i = 0; i + 1 < dimension; i++)
+          {
+          vtkIdType p = i * dx + j * dy + k * dz;
+          if ((i + j + k) % 2 == 0)
+            {
+            vtkIdType hexahedron[8] = { p, p + dx, p + dx + dy, p + dy,
+              p + dz, p + dx + dz, p + dx + dy + dz, p + dy + dz };
+            grid->InsertNextCell(VTK_HEXAHEDRON, 8, hexahedron);
+            cellIds->InsertNextValue(p);
+            }
+          else
+            {
+            vtkIdType lower[6] = { p, p + dx, p + dy,
+              p + dz, p + dx + dz, p + dy + dz };
+            vtkIdType upper[6] = { p + dx, p + dx + dy, p + dy,
+              p + dx + dz, p + dx + dy + dz, p + dy + dz };
+            grid->InsertNextCell(VTK_WEDGE, 6, lower);
+            grid->InsertNextCell(VTK_WEDGE, 6, upper);
+            cellIds->InsertNextValue(p);
+            cellIds->InsertNextValue(-p);
+            }
+          }
+        }
+      }
+    grid->GetPointData()->SetScalars(temperature.GetPointer());
+    grid->GetCellData()->AddArray(cellIds.GetPointer());
+    }
+
+  // An image of dimension^3 points with a scalar and a vector field.
+  void MakeImageData(vtkImageData* imageData, int dimension)
+    {
+    imageData->SetExtent(
+      -dimension / 2, dimension - 1 - dimension / 2, 0, dimension - 1, 0,
+      dimension - 1);
+    imageData->SetOrigin(1.5, -2, 0.25);
+    imageData->SetSpacing(0.5, 0.5, 2);
+    vtkIdType numPoints = imageData->GetNumberOfPoints();
+    vtkNew<vtkFloatArray> density;
+    density->SetName("Density");
+    density->SetNumberOfTuples(numPoints);
+    vtkNew<vtkDoubleArray> velocity;
+    velocity->SetName("Velocity");
+    velocity->SetNumberOfComponents(3);
+    velocity->SetNumberOfTuples(numPoints);
+    for (vtkIdType i = 0; i < numPoints; i++)
+      {
+      density->SetValue(i, static_cast<float>((i % 1000) * 0.001));
+      velocity->SetTuple3(i, i % dimension, 0, -1);
+      }
+    imageData->GetPointData()->SetScalars(density.GetPointer());
+    imageData->GetPointData()->SetVectors(velocity.GetPointer());
+    }
+
+  bool SameArray(vtkDataArray* expected, vtkDataArray* array)
+    {
+    if (!array || array->GetNumberOfTuples() != expected->GetNumberOfTuples() ||
+      array->GetNumberOfComponents() != expected->GetNumberOfComponents())
+      {
+      return false;
+      }
+    for (vtkIdType i = 0; i < expected->GetNumberOfTuples(); i++)
+      {
+      for (int c = 0; c < expected->GetNumberOfComponents(); c++)
+        {
+        if (array->GetComponent(i, c) != expected->GetComponent(i, c))
+          {
+          return false;
+          }
+        }
+      }
+    return true;
+    }
+
+  // Compares the arrays, the geometry and the cells of the data sets.
+  bool SameDataSet(vtkDataSet* expected, vtkDataSet* dataSet)
+    {
+    if (dataSet->GetNumberOfPoints() != expected->GetNumberOfPoints() ||
+      dataSet->GetNumberOfCells() != expected->GetNumberOfCells())
+      {
+      return false;
+      }
+    vtkFieldData* fields[2] = {
+      expected->GetPointData(), expected->GetCellData() };
+    vtkFieldData* outputFields[2] = {
+      dataSet->GetPointData(), dataSet->GetCellData() };
+    for (int cc = 0; cc < 2; cc++)
+      {
+      for (int i = 0; i < fields[cc]->GetNumberOfArrays(); i++)
+        {
+        vtkDataArray* array = fields[cc]->GetArray(i);
+        if (!SameArray(array, outputFields[cc]->GetArray(array->GetName())))
+          {
+          return false;
+          }
+        }
+      }
+
+    vtkPolyData* polyData = vtkPolyData::SafeDownCast(expected);
+    vtkUnstructuredGrid* grid = vtkUnstructuredGrid::SafeDownCast(expected);
+    vtkImageData* imageData = vtkImageData::SafeDownCast(expected);
+    if (polyData)
+      {
+      vtkPolyData* output = vtkPolyData::SafeDownCast(dataSet);
+      return output &&
+        SameArray(polyData->GetPoints()->GetData(),
+          output->GetPoints()->GetData()) &&
+        SameArray(polyData->GetPolys()->GetData(),
+          output->GetPolys()->GetData());
+      }
+    if (grid)
+      {
+      vtkUnstructuredGrid* output = vtkUnstructuredGrid::SafeDownCast(dataSet);
+      return output &&
+        SameArray(grid->GetPoints()->GetData(),
+          output->GetPoints()->GetData()) &&
+        SameArray(grid->GetCells()->GetData(),
+          output->GetCells()->GetData()) &&
+        SameArray(grid->GetCellTypesArray(), output->GetCellTypesArray()) &&
+        SameArray(grid->GetCellLocationsArray(),
+          output->GetCellLocationsArray());
+      }
+    if (imageData)
+      {
+      vtkImageData* output = vtkImageData::SafeDownCast(dataSet);
+      const int* extent = imageData->GetExtent();
+      const int* outputExtent = output? output->GetExtent() : NULL;
+      for (int cc = 0; output && cc < 6; cc++)
+        {
+        if (outputExtent[cc] != extent[cc])
+          {
+          return false;
+          }
+        }
+      for (int cc = 0; output && cc < 3; cc++)
+        {
+        if (fabs(output->GetOrigin()[cc] - imageData->GetOrigin()[cc]) > 1e-6 ||
+          output->GetSpacing()[cc] != imageData->GetSpacing()[cc])
+          {
+          return false;
+          }
+        }
+      return output != NULL;
+      }
+    return true;
+    }
+
+  // Round trips input with each marshaling, returns false on errors.
+  bool Benchmark(const char* name, vtkDataSet* input)
+    {
+    const char* paths[3] = { "legacy", "native", "native+lz4" };
+    double megabytes = input->GetActualMemorySize() / 1024.0;
+    bool status = true;
+    for (int path = 0; path < 3; path++)
+      {
+      vtkMPIMoveData::SetUseNativeMarshaling(path > 0);
+      vtkMPIMoveData::SetUseLZ4Compression(path == 2);
+      vtkNew<vtkMarshalingMoveData> moveData;
+      double marshal = 0;
+      double reconstruct = 0;
+      vtkIdType length = 0;
+      for (int run = 0; run < NumberOfRuns; run++)
+        {
+        vtkDataSet* output = input->NewInstance();
+        length = moveData->RoundTrip(input, output, marshal, reconstruct);
+        if (moveData->IsNative() != (path > 0))
+          {
+          cerr << "ERROR: " << name << " was not marshaled with the "
+               << paths[path] << " marshaling." << endl;
+          status = false;
+          }
+        if (!SameDataSet(input, output))
+          {
+          cerr << "ERROR: " << name << " changed by the " << paths[path]
+               << " marshaling." << endl;
+          status = false;
+          }
+        if (input->GetPointData()->GetNormals() &&
+          !output->GetPointData()->GetNormals())
+          {
+          cerr << "ERROR: " << name << " lost its normals with the "
+               << paths[path] << " marshaling." << endl;
+          status = false;
+          }
+        output->Delete();
+        }
+      cout << name << ", " << paths[path] << ": "
+           << length / (1024.0 * 1024.0) << " MiB buffer, marshal "
+           << megabytes * NumberOfRuns / marshal << " MiB/s, reconstruct "
+           << megabytes * NumberOfRuns / reconstruct << " MiB/s" << endl;
+      }
+    vtkMPIMoveData::SetUseNativeMarshaling(true);
+    vtkMPIMoveData::SetUseLZ4Compression(false);
+    return status;
+    }
+
+  // Round trips input natively, with and without LZ4, as sent by the other
+  // byte order and by each size of vtkIdType. Returns false on errors.
+  bool ForeignSenders(const char* name, vtkDataSet* input)
+    {
+    bool status = true;
+    for (int lz4 = 0; lz4 < 2; lz4++)
+      {
+      vtkMPIMoveData::SetUseLZ4Compression(lz4 == 1);
+      for (int swap = 0; swap < 2; swap++)
+        {
+        for (int idTypeSize = 4; idTypeSize <= 8; idTypeSize += 4)
+          {
+          vtkNew<vtkMarshalingMoveData> moveData;
+          moveData->SetNativeSender(swap == 1, idTypeSize);
+          vtkDataSet* output = input->NewInstance();
+          double marshal = 0;
+          double reconstruct = 0;
+          moveData->RoundTrip(input, output, marshal, reconstruct);
+          if (!SameDataSet(input, output))
+            {
+            cerr << "ERROR: " << name << " changed when sent "
+                 << (lz4? "with" : "without") << " LZ4 by a sender with "
+                 << (swap? "the other" : "the same") << " byte order and "
+                 << idTypeSize << " bytes ids." << endl;
+            status = false;
+            }
+          output->Delete();
+          }
+        }
+      }
+    vtkMPIMoveData::SetUseLZ4Compression(false);
+    return status;
+    }
+}
+
+int TestMPIMoveDataMarshaling(int, char*[])
+{
+  vtkNew<vtkPolyData> polyData;
+  MakePolyData(polyData.GetPointer(), 500);
+  vtkNew<vtkUnstructuredGrid> grid;
+  MakeUnstructuredGrid(grid.GetPointer(), 60);
+  vtkNew<vtkImageData> imageData;
+  MakeImageData(imageData.GetPointer(), 100);
+
+  bool status = Benchmark("polydata", polyData.GetPointer());
+  status = Benchmark("unstructured grid", grid.GetPointer()) && status;
+  status = Benchmark("image data", imageData.GetPointer()) && status;
+
+  vtkNew<vtkPolyData> smallPolyData;
+  MakePolyData(smallPolyData.GetPointer(), 50);
+  vtkNew<vtkUnstructuredGrid> smallGrid;
+  MakeUnstructuredGrid(smallGrid.GetPointer(), 10);
+  vtkNew<vtkImageData> smallImageData;
+  MakeImageData(smallImageData.GetPointer(), 10);
+  status = ForeignSenders("polydata", smallPolyData.GetPointer()) && status;
+  status = ForeignSenders("unstructured grid", smallGrid.GetPointer()) &&
+    status;
+  status = ForeignSenders("image data", smallImageData.GetPointer()) &&
+    status;
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
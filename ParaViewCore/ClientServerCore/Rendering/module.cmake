@@ -24,8 +24,12 @@ vtk_module(vtkPVClientServerCoreRendering
     vtkViewsCore
     ${__dependencies}
   PRIVATE_DEPENDS
+    vtklz4
     vtksys
     vtkzlib
+  TEST_DEPENDS
+    vtkFiltersSources
+    vtkTestingCore
   TEST_LABELS
     PARAVIEW
   KIT
@@ -49,11 +49,14 @@ vtkCacheSizeKeeper::vtkCacheSizeKeeper()
   this->CacheSize = 0;
   this->CacheFull = 0;
   this->CacheLimit = 100*1024; // 100 MBs.
+  this->SpillToDisk = false;
+  this->SpillDirectory = NULL;
 }
 
 //-----------------------------------------------------------------------------
 vtkCacheSizeKeeper::~vtkCacheSizeKeeper()
 {
+  this->SetSpillDirectory(NULL);
 }
 
 //-----------------------------------------------------------------------------
@@ -63,4 +66,7 @@ void vtkCacheSizeKeeper::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "CacheSize: " << this->CacheSize << endl;
   os << indent << "CacheFull: " << this->CacheFull << endl;
   os << indent << "CacheLimit: " << this->CacheLimit << endl;
+  os << indent << "SpillToDisk: " << this->SpillToDisk << endl;
+  os << indent << "SpillDirectory: "
+     << (this->SpillDirectory? this->SpillDirectory : "(none)") << endl;
 }
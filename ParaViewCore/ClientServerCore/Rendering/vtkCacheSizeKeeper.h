@@ -72,6 +72,21 @@ public:
   vtkGetMacro(CacheFull, int);
   vtkSetMacro(CacheFull, int);
 
+  // Description:
+  // Get/Set whether data evicted from the in-memory cache by
+  // vtkPVCacheKeeper should be written to a scratch directory instead of
+  // being discarded. Data spilled to disk does not count towards CacheSize.
+  // Default is false.
+  vtkGetMacro(SpillToDisk, bool);
+  vtkSetMacro(SpillToDisk, bool);
+  vtkBooleanMacro(SpillToDisk, bool);
+
+  // Description:
+  // Get/Set the local scratch directory used when SpillToDisk is enabled. When
+  // not set (or empty), the system temporary directory is used.
+  vtkGetStringMacro(SpillDirectory);
+  vtkSetStringMacro(SpillDirectory);
+
 protected:
   static vtkCacheSizeKeeper* New();
   vtkCacheSizeKeeper();
@@ -80,6 +95,8 @@ protected:
   unsigned long CacheSize;
   unsigned long CacheLimit;
   int CacheFull;
+  bool SpillToDisk;
+  char* SpillDirectory;
 private:
   vtkCacheSizeKeeper(const vtkCacheSizeKeeper&); // Not implemented.
   void operator=(const vtkCacheSizeKeeper&); // Not implemented.
@@ -21,6 +21,7 @@
 #endif
 #include "vtkAlgorithmOutput.h"
 #include "vtkBoundingBox.h"
+#include "vtkCacheSizeKeeper.h"
 #include "vtkCommand.h"
 #include "vtkCompositeDataDisplayAttributes.h"
 #include "vtkCompositeDataIterator.h"
@@ -34,6 +35,7 @@
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPolyData.h"
 #include "vtkProperty.h"
 #include "vtkPVCacheKeeper.h"
 #include "vtkPVConfig.h"
@@ -47,7 +49,9 @@
 #include "vtkSelectionConverter.h"
 #include "vtkSelection.h"
 #include "vtkSelectionNode.h"
+#include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTimerLog.h"
 #include "vtkTransform.h"
 #include "vtkUnstructuredGrid.h"
 
@@ -57,6 +61,10 @@
 
 #include <vtksys/SystemTools.hxx>
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 //*****************************************************************************
 // This is used to convert a vtkPolyData to a vtkMultiBlockDataSet. If input is
 // vtkMultiBlockDataSet, then this is simply a pass-through filter. This makes
@@ -101,6 +109,121 @@ vtkStandardNewMacro(vtkGeometryRepresentationMultiBlockMaker);
 //*****************************************************************************
 
 
+//*****************************************************************************
+// Levels of detail of the current geometry and, when caching is used, of the
+// geometry cached for each cache key. The levels kept for the cache keys are
+// reported to the vtkCacheSizeKeeper, like the cached geometry.
+class vtkGeometryRepresentation::vtkLODLevels
+{
+public:
+  typedef std::vector<vtkSmartPointer<vtkDataObject> > LevelsType;
+
+  // Levels built so far, NULL for the others, and their memory size (in
+  // kbytes) reported to the vtkCacheSizeKeeper.
+  struct Entry
+    {
+    LevelsType Levels;
+    unsigned long Size;
+    Entry() : Size(0) {}
+    };
+  typedef std::map<double, Entry> CachedLevelsType;
+
+  Entry Current;
+  // MTime of the geometry the current levels were built from.
+  unsigned long CurrentMTime;
+  CachedLevelsType Cached;
+
+  vtkLODLevels() : CurrentMTime(0) {}
+  ~vtkLODLevels() { this->Clear(); }
+
+  void Clear()
+    {
+    this->Reset(this->Current, 0);
+    this->CurrentMTime = 0;
+    for (CachedLevelsType::iterator iter = this->Cached.begin();
+      iter != this->Cached.end(); ++iter)
+      {
+      this->Reset(iter->second, 0);
+      }
+    this->Cached.clear();
+    }
+
+  // Drops the levels of entry, leaving room for numberOfLevels levels.
+  void Reset(Entry& entry, int numberOfLevels)
+    {
+    vtkCacheSizeKeeper::GetInstance()->FreeCacheSize(entry.Size);
+    entry.Size = 0;
+    entry.Levels.clear();
+    entry.Levels.resize(numberOfLevels);
+    }
+};
+
+namespace
+{
+  // Decimates each polydata of geometry with quadric clustering at a LOD
+  // resolution, with the settings of prototype. The decimator executes on
+  // the calling thread, as any other pipeline.
+  vtkSmartPointer<vtkDataObject> vtkBuildLODLevel(vtkDataObject* geometry,
+    vtkQuadricClustering* prototype, double resolution)
+  {
+    int division = static_cast<int>(150 * resolution) + 10;
+    vtkNew<vtkQuadricClustering> decimator;
+    decimator->SetUseInputPoints(prototype->GetUseInputPoints());
+    decimator->SetCopyCellData(prototype->GetCopyCellData());
+    decimator->SetUseInternalTriangles(prototype->GetUseInternalTriangles());
+    decimator->SetNumberOfDivisions(division, division, division);
+
+    vtkCompositeDataSet* composite = vtkCompositeDataSet::SafeDownCast(geometry);
+    vtkSmartPointer<vtkCompositeDataIterator> iter;
+    std::vector<vtkDataObject*> leaves;
+    if (composite)
+      {
+      iter.TakeReference(composite->NewIterator());
+      for (iter->InitTraversal(); !iter->IsDoneWithTraversal();
+        iter->GoToNextItem())
+        {
+        leaves.push_back(iter->GetCurrentDataObject());
+        }
+      }
+    else
+      {
+      leaves.push_back(geometry);
+      }
+
+    // empty leaves and other data sets are passed as they are.
+    std::vector<vtkSmartPointer<vtkDataObject> > outputs(leaves.size());
+    for (size_t leaf = 0; leaf < leaves.size(); ++leaf)
+      {
+      vtkPolyData* polyData = vtkPolyData::SafeDownCast(leaves[leaf]);
+      if (!polyData || polyData->GetNumberOfCells() == 0)
+        {
+        outputs[leaf] = leaves[leaf];
+        continue;
+        }
+      decimator->SetInputData(polyData);
+      decimator->Update();
+      outputs[leaf].TakeReference(vtkPolyData::New());
+      outputs[leaf]->ShallowCopy(decimator->GetOutput());
+      }
+    decimator->SetInputData(NULL);
+
+    if (!composite)
+      {
+      return outputs[0];
+      }
+    vtkSmartPointer<vtkCompositeDataSet> output;
+    output.TakeReference(composite->NewInstance());
+    output->CopyStructure(composite);
+    size_t leaf = 0;
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal();
+      iter->GoToNextItem(), ++leaf)
+      {
+      output->SetDataSet(iter, outputs[leaf]);
+      }
+    return output.GetPointer();
+  }
+}
+
 vtkStandardNewMacro(vtkGeometryRepresentation);
 //----------------------------------------------------------------------------
 vtkGeometryRepresentation::vtkGeometryRepresentation()
@@ -150,6 +273,8 @@ vtkGeometryRepresentation::vtkGeometryRepresentation()
   this->Representation = SURFACE;
 
   this->SuppressLOD = false;
+  this->LODLevels = new vtkLODLevels();
+  this->NumberOfLODLevels = 5;
   this->DebugString = 0;
   this->SetDebugString(this->GetClassName());
 
@@ -168,6 +293,7 @@ vtkGeometryRepresentation::~vtkGeometryRepresentation()
   this->GeometryFilter->Delete();
   this->MultiBlockMaker->Delete();
   this->Decimator->Delete();
+  delete this->LODLevels;
   this->LODOutlineFilter->Delete();
   this->Mapper->Delete();
   this->LODMapper->Delete();
@@ -197,7 +323,6 @@ void vtkGeometryRepresentation::SetupDefaults()
 
   this->MultiBlockMaker->SetInputConnection(this->GeometryFilter->GetOutputPort());
   this->CacheKeeper->SetInputConnection(this->MultiBlockMaker->GetOutputPort());
-  this->Decimator->SetInputConnection(this->CacheKeeper->GetOutputPort());
   this->LODOutlineFilter->SetInputConnection(this->CacheKeeper->GetOutputPort());
 
   this->Actor->SetMapper(this->Mapper);
@@ -306,10 +431,6 @@ int vtkGeometryRepresentation::ProcessViewRequest(
       {
       if (inInfo->Has(vtkPVRenderView::USE_OUTLINE_FOR_LOD()))
         {
-        // HACK to ensure that when Decimator is next employed, it delivers a
-        // new geometry.
-        this->Decimator->Modified();
-
         this->LODOutlineFilter->Update();
         // Pass along the LOD geometry to the view so that it can deliver it to
         // the rendering node as and when needed.
@@ -318,23 +439,22 @@ int vtkGeometryRepresentation::ProcessViewRequest(
         }
       else
         {
-        // HACK to ensure that when Decimator is next employed, it delivers a
-        // new geometry.
+        // HACK to ensure that when LODOutlineFilter is next employed, it
+        // delivers a new geometry.
         this->LODOutlineFilter->Modified();
 
+        // Pick the level of detail for the resolution requested by the view,
+        // the levels are built once for the current geometry.
+        double resolution = 0.0;
         if (inInfo->Has(vtkPVRenderView::LOD_RESOLUTION()))
           {
-          int division = static_cast<int>(150 *
-            inInfo->Get(vtkPVRenderView::LOD_RESOLUTION())) + 10;
-          this->Decimator->SetNumberOfDivisions(division, division, division);
+          resolution = inInfo->Get(vtkPVRenderView::LOD_RESOLUTION());
           }
 
-        this->Decimator->Update();
-
         // Pass along the LOD geometry to the view so that it can deliver it to
         // the rendering node as and when needed.
         vtkPVRenderView::SetPieceLOD(inInfo, this,
-          this->Decimator->GetOutputDataObject(0));
+          this->GetLODLevel(this->GetLODLevelForResolution(resolution)));
         }
       }
     }
@@ -496,6 +616,99 @@ bool vtkGeometryRepresentation::IsCached(double cache_key)
   return this->CacheKeeper->IsCached(cache_key);
 }
 
+//----------------------------------------------------------------------------
+vtkDataObject* vtkGeometryRepresentation::GetLODLevel(int level)
+{
+  vtkDataObject* geometry = this->CacheKeeper->GetOutputDataObject(0);
+  if (!geometry || level < 0 || level >= this->NumberOfLODLevels)
+    {
+    return NULL;
+    }
+
+  // Forget the levels of the geometries no longer cached.
+  vtkLODLevels::CachedLevelsType& cached = this->LODLevels->Cached;
+  for (vtkLODLevels::CachedLevelsType::iterator iter = cached.begin();
+    iter != cached.end();)
+    {
+    if (!this->GetUseCache() || !this->CacheKeeper->IsCached(iter->first))
+      {
+      this->LODLevels->Reset(iter->second, 0);
+      cached.erase(iter++);
+      }
+    else
+      {
+      ++iter;
+      }
+    }
+
+  // The levels of a cached geometry are kept with it, the others only until
+  // the geometry changes.
+  bool useCache = this->GetUseCache() &&
+    this->CacheKeeper->IsCached(this->GetCacheKey());
+  vtkLODLevels::Entry* entry = useCache?
+    &cached[this->GetCacheKey()] : &this->LODLevels->Current;
+  if (static_cast<int>(entry->Levels.size()) != this->NumberOfLODLevels ||
+    (!useCache && this->LODLevels->CurrentMTime != geometry->GetMTime()))
+    {
+    this->LODLevels->Reset(*entry, this->NumberOfLODLevels);
+    }
+  if (!useCache)
+    {
+    this->LODLevels->CurrentMTime = geometry->GetMTime();
+    }
+  if (entry->Levels[level])
+    {
+    return entry->Levels[level];
+    }
+  vtkLODLevels::Entry& current = this->LODLevels->Current;
+  if (useCache && this->LODLevels->CurrentMTime == geometry->GetMTime() &&
+    static_cast<int>(current.Levels.size()) == this->NumberOfLODLevels &&
+    current.Levels[level])
+    {
+    // built before, but did not fit in the cache.
+    return current.Levels[level];
+    }
+
+  // Each level is built the first time it is requested.
+  vtkTimerLog::MarkStartEvent("vtkGeometryRepresentation::BuildLODLevel");
+  double resolution =
+    static_cast<double>(level) / (this->NumberOfLODLevels - 1);
+  vtkSmartPointer<vtkDataObject> output =
+    vtkBuildLODLevel(geometry, this->Decimator, resolution);
+  vtkTimerLog::MarkEndEvent("vtkGeometryRepresentation::BuildLODLevel");
+
+  // Like the geometry, a level that doesn't fit in the cache is not cached:
+  // it is kept until the geometry changes.
+  vtkCacheSizeKeeper* keeper = vtkCacheSizeKeeper::GetInstance();
+  unsigned long size = output->GetActualMemorySize();
+  if (useCache && !keeper->GetCacheFull() &&
+    keeper->GetCacheSize() + size <= keeper->GetCacheLimit())
+    {
+    keeper->AddCacheSize(size);
+    entry->Size += size;
+    }
+  else if (useCache)
+    {
+    entry = &current;
+    if (static_cast<int>(current.Levels.size()) != this->NumberOfLODLevels ||
+      this->LODLevels->CurrentMTime != geometry->GetMTime())
+      {
+      this->LODLevels->Reset(current, this->NumberOfLODLevels);
+      this->LODLevels->CurrentMTime = geometry->GetMTime();
+      }
+    }
+  entry->Levels[level] = output;
+  return output;
+}
+
+//----------------------------------------------------------------------------
+int vtkGeometryRepresentation::GetLODLevelForResolution(double resolution)
+{
+  int level = static_cast<int>(
+    resolution * (this->NumberOfLODLevels - 1) + 1e-6);
+  return std::max(0, std::min(level, this->NumberOfLODLevels - 1));
+}
+
 //----------------------------------------------------------------------------
 vtkDataObject* vtkGeometryRepresentation::GetRenderedDataObject(int port)
 {
@@ -517,6 +730,7 @@ void vtkGeometryRepresentation::MarkModified()
     // Cleanup caches when not using cache.
     this->CacheKeeper->RemoveAllCaches();
     }
+  this->LODLevels->Clear();
   this->Superclass::MarkModified();
 }
 
@@ -697,6 +911,7 @@ void vtkGeometryRepresentation::SetVisibility(bool val)
 void vtkGeometryRepresentation::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfLODLevels: " << this->NumberOfLODLevels << endl;
 }
 
 //****************************************************************************
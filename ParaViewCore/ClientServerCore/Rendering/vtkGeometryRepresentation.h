@@ -78,6 +78,28 @@ public:
   virtual void SetSuppressLOD(bool suppress)
     { this->SuppressLOD = suppress; }
 
+  // Description:
+  // Get/Set the number of levels of detail, 5 by default. The levels are the
+  // geometry decimated with quadric clustering at LOD resolutions evenly
+  // spaced from 0 to 1. Each level is built the first time it is requested
+  // after the geometry changes. The levels of geometry cached by the
+  // vtkPVCacheKeeper are kept with it and count towards the limit of the
+  // vtkCacheSizeKeeper, so changing the LOD resolution of the view or going
+  // back to a cached time step only picks another level.
+  vtkSetClampMacro(NumberOfLODLevels, int, 2, 16);
+  vtkGetMacro(NumberOfLODLevels, int);
+
+  // Description:
+  // Returns a level of detail of the current geometry, from 0 (the coarsest)
+  // to NumberOfLODLevels - 1, building it if needed. Returns NULL
+  // for invalid levels.
+  vtkDataObject* GetLODLevel(int level);
+
+  // Description:
+  // Returns the level of detail used for a LOD resolution between 0 and 1:
+  // the finest level whose resolution doesn't exceed it.
+  int GetLODLevelForResolution(double resolution);
+
   // Description:
   // Set the lighting properties of the object. vtkGeometryRepresentation
   // overrides these based of the following conditions:
@@ -283,6 +305,13 @@ protected:
   vtkQuadricClustering* Decimator;
   vtkPVGeometryFilter* LODOutlineFilter;
 
+  // Description:
+  // Levels of detail of the current geometry and of the cached geometries.
+  // The settings of Decimator are used to build them.
+  class vtkLODLevels;
+  vtkLODLevels* LODLevels;
+  int NumberOfLODLevels;
+
   vtkMapper* Mapper;
   vtkMapper* LODMapper;
   vtkPVLODActor* Actor;
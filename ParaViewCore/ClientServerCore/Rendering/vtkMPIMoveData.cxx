@@ -14,16 +14,20 @@
 =========================================================================*/
 #include "vtkMPIMoveData.h"
 
+#include "vtkByteSwap.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCharArray.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
+#include "vtkDataObjectTypes.h"
 #include "vtkDataSetReader.h"
 #include "vtkDirectedGraph.h"
 #include "vtkGenericDataObjectReader.h"
 #include "vtkGenericDataObjectWriter.h"
 #include "vtkGraphReader.h"
 #include "vtkGraphWriter.h"
+#include "vtkIdTypeArray.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -47,10 +51,14 @@
 #include "vtkTimerLog.h"
 #include "vtkToolkits.h"
 #include "vtkUndirectedGraph.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
 
+#include "vtk_lz4.h"
 #include "vtk_zlib.h"
+#include <list>
 #include <sstream>
+#include <string>
 #include <vector>
 
 #ifdef PARAVIEW_USE_MPI
@@ -61,6 +69,8 @@
 #include <vector>
 
 bool vtkMPIMoveData::UseZLibCompression = false;
+bool vtkMPIMoveData::UseNativeMarshaling = true;
+bool vtkMPIMoveData::UseLZ4Compression = false;
 
 namespace
 {
@@ -96,6 +106,658 @@ namespace
       it->Delete();
       }
   }
+
+  // Native marshaling: the "vtkn" tag, a byte order mark, the size of
+  // vtkIdType, the type of the data set and its structure, then its arrays,
+  // each one as a header followed by its values, raw or compressed with LZ4.
+  const char vtkMPIMoveDataNativeTag[] = "vtkn";
+  const vtkTypeUInt32 vtkMPIMoveDataByteOrderMark = 0x01020304;
+
+  // Returns whether the values of array are contiguous in memory, so that
+  // GetVoidPointer() doesn't make a copy of them (as for mapped arrays).
+  bool vtkMPIMoveDataIsContiguous(vtkDataArray* array)
+  {
+    return array && array->GetDataType() != VTK_BIT &&
+      array->HasStandardMemoryLayout();
+  }
+
+  // Returns whether data can be marshaled natively: polydata, unstructured
+  // grids without polyhedra and image data, with contiguous points and all
+  // of their arrays being contiguous vtkDataArrays other than vtkBitArrays.
+  bool vtkMPIMoveDataCanMarshalNatively(vtkDataObject* data)
+  {
+    int type = data? data->GetDataObjectType() : VTK_DATA_OBJECT;
+    if (type != VTK_POLY_DATA && type != VTK_UNSTRUCTURED_GRID &&
+      type != VTK_IMAGE_DATA)
+      {
+      return false;
+      }
+    vtkUnstructuredGrid* grid = vtkUnstructuredGrid::SafeDownCast(data);
+    if (grid && grid->GetFaces())
+      {
+      return false;
+      }
+    vtkPointSet* pointSet = vtkPointSet::SafeDownCast(data);
+    if (pointSet && pointSet->GetPoints() &&
+      !vtkMPIMoveDataIsContiguous(pointSet->GetPoints()->GetData()))
+      {
+      return false;
+      }
+    vtkDataSet* dataSet = vtkDataSet::SafeDownCast(data);
+    vtkFieldData* fields[3] = { data->GetFieldData(),
+      dataSet->GetPointData(), dataSet->GetCellData() };
+    for (int cc = 0; cc < 3; cc++)
+      {
+      int numArrays = fields[cc]? fields[cc]->GetNumberOfArrays() : 0;
+      for (int i = 0; i < numArrays; i++)
+        {
+        vtkDataArray* array =
+          vtkDataArray::SafeDownCast(fields[cc]->GetAbstractArray(i));
+        if (!vtkMPIMoveDataIsContiguous(array))
+          {
+          return false;
+          }
+        }
+      }
+    return true;
+  }
+
+  // Writes a data set in the native format. The data set is written twice:
+  // a first time without buffer to compute the length of the buffer (and
+  // compress the arrays), then in the buffer allocated meanwhile.
+  // For testing, the values can be written in the other byte order and the
+  // ids with another size, as a sender on another platform would.
+  class vtkMPIMoveDataNativeWriter
+  {
+  public:
+    vtkMPIMoveDataNativeWriter(bool compress, bool swap = false,
+      int idTypeSize = static_cast<int>(sizeof(vtkIdType)))
+      : Compress(compress), Swap(swap), IdTypeSize(idTypeSize), Buffer(NULL),
+      Length(0) {}
+
+    vtkIdType GetLength() { return this->Length; }
+
+    void SetBuffer(char* buffer)
+      {
+      this->Buffer = buffer;
+      this->Length = 0;
+      this->NextCompressed = this->Compressed.begin();
+      }
+
+    void WriteDataObject(vtkDataObject* data)
+      {
+      this->WriteBytes(vtkMPIMoveDataNativeTag, 4);
+      this->WriteValue<vtkTypeUInt32>(vtkMPIMoveDataByteOrderMark);
+      this->WriteValue<vtkTypeInt32>(this->IdTypeSize);
+      this->WriteValue<vtkTypeInt32>(data->GetDataObjectType());
+
+      vtkImageData* image = vtkImageData::SafeDownCast(data);
+      vtkPolyData* poly = vtkPolyData::SafeDownCast(data);
+      vtkUnstructuredGrid* grid = vtkUnstructuredGrid::SafeDownCast(data);
+      if (image)
+        {
+        for (int cc = 0; cc < 6; cc++)
+          {
+          this->WriteValue<vtkTypeInt32>(image->GetExtent()[cc]);
+          }
+        for (int cc = 0; cc < 3; cc++)
+          {
+          this->WriteValue<double>(image->GetOrigin()[cc]);
+          }
+        for (int cc = 0; cc < 3; cc++)
+          {
+          this->WriteValue<double>(image->GetSpacing()[cc]);
+          }
+        }
+      else
+        {
+        vtkPoints* points = vtkPointSet::SafeDownCast(data)->GetPoints();
+        this->WriteArray(points? points->GetData() : NULL);
+        }
+      if (poly)
+        {
+        vtkCellArray* cells[4] = { poly->GetVerts(), poly->GetLines(),
+          poly->GetPolys(), poly->GetStrips() };
+        for (int cc = 0; cc < 4; cc++)
+          {
+          vtkIdType numCells = cells[cc]? cells[cc]->GetNumberOfCells() : 0;
+          this->WriteValue<vtkTypeInt64>(numCells);
+          if (numCells > 0)
+            {
+            this->WriteArray(cells[cc]->GetData());
+            }
+          }
+        }
+      if (grid)
+        {
+        vtkCellArray* cells = grid->GetCells();
+        vtkIdType numCells = cells? cells->GetNumberOfCells() : 0;
+        this->WriteValue<vtkTypeInt64>(numCells);
+        if (numCells > 0)
+          {
+          this->WriteArray(cells->GetData());
+          this->WriteArray(grid->GetCellTypesArray());
+          this->WriteArray(grid->GetCellLocationsArray());
+          }
+        }
+
+      vtkDataSet* dataSet = vtkDataSet::SafeDownCast(data);
+      this->WriteFieldData(data->GetFieldData());
+      this->WriteFieldData(dataSet->GetPointData());
+      this->WriteFieldData(dataSet->GetCellData());
+      }
+
+  private:
+    void WriteBytes(const void* data, vtkIdType length)
+      {
+      if (this->Buffer && length > 0)
+        {
+        memcpy(this->Buffer + this->Length, data, length);
+        }
+      this->Length += length;
+      }
+
+    template <class T>
+    void WriteValue(T value)
+      {
+      if (this->Swap)
+        {
+        vtkByteSwap::SwapVoidRange(&value, 1, sizeof(T));
+        }
+      this->WriteBytes(&value, sizeof(T));
+      }
+
+    void WriteString(const char* value)
+      {
+      vtkTypeInt32 length = value? static_cast<vtkTypeInt32>(strlen(value)) : -1;
+      this->WriteValue<vtkTypeInt32>(length);
+      this->WriteBytes(value, length > 0? length : 0);
+      }
+
+    void WriteFieldData(vtkFieldData* fields)
+      {
+      vtkDataSetAttributes* attributes =
+        vtkDataSetAttributes::SafeDownCast(fields);
+      int numArrays = fields? fields->GetNumberOfArrays() : 0;
+      this->WriteValue<vtkTypeInt32>(numArrays);
+      for (int i = 0; i < numArrays; i++)
+        {
+        this->WriteValue<vtkTypeInt32>(
+          attributes? attributes->IsArrayAnAttribute(i) : -1);
+        this->WriteArray(fields->GetArray(i));
+        }
+      }
+
+    void WriteArray(vtkDataArray* array)
+      {
+      this->WriteValue<vtkTypeInt8>(array? 1 : 0);
+      if (!array)
+        {
+        return;
+        }
+      int numComponents = array->GetNumberOfComponents();
+      vtkIdType numTuples = array->GetNumberOfTuples();
+      this->WriteString(array->GetName());
+      this->WriteValue<vtkTypeInt32>(array->GetDataType());
+      this->WriteValue<vtkTypeInt32>(numComponents);
+      this->WriteValue<vtkTypeInt64>(numTuples);
+      bool componentNames = array->HasAComponentName();
+      this->WriteValue<vtkTypeInt8>(componentNames? 1 : 0);
+      for (int cc = 0; componentNames && cc < numComponents; cc++)
+        {
+        this->WriteString(array->GetComponentName(cc));
+        }
+
+      // The arrays are contiguous (see vtkMPIMoveDataCanMarshalNatively), so
+      // GetVoidPointer() doesn't copy their values.
+      vtkIdType numValues = numTuples * numComponents;
+      int valueSize = array->GetDataTypeSize();
+      const char* values = numValues > 0?
+        static_cast<const char*>(array->GetVoidPointer(0)) : NULL;
+      bool converted = values && array->GetDataType() == VTK_ID_TYPE &&
+        valueSize != this->IdTypeSize;
+      if (converted)
+        {
+        valueSize = this->IdTypeSize;
+        values = this->ConvertIds(
+          reinterpret_cast<const vtkIdType*>(values), numValues);
+        }
+      if (values && this->Swap && valueSize > 1)
+        {
+        if (!converted)
+          {
+          this->Converted.assign(values, values + numValues * valueSize);
+          }
+        vtkByteSwap::SwapVoidRange(&this->Converted[0], numValues, valueSize);
+        values = &this->Converted[0];
+        }
+      vtkTypeInt64 length = static_cast<vtkTypeInt64>(numValues) * valueSize;
+      this->WriteValue<vtkTypeInt64>(length);
+      const std::vector<char>* compressed = this->CompressValues(values, length);
+      if (compressed)
+        {
+        this->WriteValue<vtkTypeInt8>(1);
+        this->WriteValue<vtkTypeInt64>(compressed->size());
+        this->WriteBytes(&(*compressed)[0], compressed->size());
+        }
+      else
+        {
+        this->WriteValue<vtkTypeInt8>(0);
+        this->WriteBytes(values, length);
+        }
+      }
+
+    // Returns the ids with IdTypeSize bytes each.
+    const char* ConvertIds(const vtkIdType* ids, vtkIdType numIds)
+      {
+      this->Converted.resize(numIds * this->IdTypeSize);
+      for (vtkIdType i = 0; i < numIds; i++)
+        {
+        if (this->IdTypeSize == 4)
+          {
+          reinterpret_cast<vtkTypeInt32*>(&this->Converted[0])[i] =
+            static_cast<vtkTypeInt32>(ids[i]);
+          }
+        else
+          {
+          reinterpret_cast<vtkTypeInt64*>(&this->Converted[0])[i] = ids[i];
+          }
+        }
+      return &this->Converted[0];
+      }
+
+    // Returns the values compressed with LZ4, NULL when compression is off,
+    // fails or doesn't make them smaller. The values are compressed during
+    // the first pass, the second one reuses the results in the same order.
+    const std::vector<char>* CompressValues(
+      const char* values, vtkTypeInt64 length)
+      {
+      if (!this->Compress || length <= 0 || length > LZ4_MAX_INPUT_SIZE)
+        {
+        return NULL;
+        }
+      if (this->Buffer)
+        {
+        const std::vector<char>& output = *this->NextCompressed++;
+        return output.empty()? NULL : &output;
+        }
+      int inputSize = static_cast<int>(length);
+      this->Compressed.push_back(std::vector<char>());
+      std::vector<char>& output = this->Compressed.back();
+      output.resize(LZ4_compressBound(inputSize));
+      int outputSize = LZ4_compress_fast(values, &output[0], inputSize,
+        static_cast<int>(output.size()), /* acceleration */ 1);
+      output.resize(outputSize > 0 && outputSize < inputSize? outputSize : 0);
+      return output.empty()? NULL : &output;
+      }
+
+    bool Compress;
+    bool Swap;
+    int IdTypeSize;
+    char* Buffer;
+    vtkIdType Length;
+    std::vector<char> Converted;
+    std::list<std::vector<char> > Compressed;
+    std::list<std::vector<char> >::const_iterator NextCompressed;
+  };
+
+  // Reads a data set written by vtkMPIMoveDataNativeWriter, swapping the
+  // bytes when the sender has another byte order and converting the ids
+  // when it has another size of vtkIdType.
+  class vtkMPIMoveDataNativeReader
+  {
+  public:
+    vtkMPIMoveDataNativeReader(const char* buffer, vtkIdType length)
+      : Buffer(buffer), Length(length), Position(0), Swap(false),
+      IdTypeSize(0), Failed(false) {}
+
+    // Returns a new data object, NULL if the buffer is not valid.
+    vtkDataObject* ReadDataObject()
+      {
+      char tag[4];
+      this->ReadBytes(tag, 4);
+      vtkTypeUInt32 mark = this->ReadValue<vtkTypeUInt32>();
+      if (mark != vtkMPIMoveDataByteOrderMark)
+        {
+        vtkByteSwap::SwapVoidRange(&mark, 1, sizeof(mark));
+        this->Swap = true;
+        }
+      this->IdTypeSize = this->ReadValue<vtkTypeInt32>();
+      int type = this->ReadValue<vtkTypeInt32>();
+      if (this->Failed || strncmp(tag, vtkMPIMoveDataNativeTag, 4) != 0 ||
+        mark != vtkMPIMoveDataByteOrderMark ||
+        (this->IdTypeSize != 4 && this->IdTypeSize != 8) ||
+        (type != VTK_POLY_DATA &&
+          type != VTK_UNSTRUCTURED_GRID && type != VTK_IMAGE_DATA))
+        {
+        return NULL;
+        }
+
+      vtkDataObject* data = vtkDataObjectTypes::NewDataObject(type);
+      vtkImageData* image = vtkImageData::SafeDownCast(data);
+      vtkPolyData* poly = vtkPolyData::SafeDownCast(data);
+      vtkUnstructuredGrid* grid = vtkUnstructuredGrid::SafeDownCast(data);
+      if (image)
+        {
+        int extent[6];
+        double origin[3];
+        double spacing[3];
+        for (int cc = 0; cc < 6; cc++)
+          {
+          extent[cc] = this->ReadValue<vtkTypeInt32>();
+          }
+        for (int cc = 0; cc < 3; cc++)
+          {
+          origin[cc] = this->ReadValue<double>();
+          }
+        for (int cc = 0; cc < 3; cc++)
+          {
+          spacing[cc] = this->ReadValue<double>();
+          }
+        image->SetExtent(extent);
+        image->SetOrigin(origin);
+        image->SetSpacing(spacing);
+        }
+      else
+        {
+        vtkDataArray* array = this->ReadArray();
+        if (array)
+          {
+          vtkPoints* points = vtkPoints::New();
+          points->SetData(array);
+          vtkPointSet::SafeDownCast(data)->SetPoints(points);
+          points->Delete();
+          array->Delete();
+          }
+        }
+      if (poly)
+        {
+        for (int cc = 0; cc < 4; cc++)
+          {
+          vtkCellArray* cells = this->ReadCells();
+          if (!cells)
+            {
+            continue;
+            }
+          switch (cc)
+            {
+            case 0: poly->SetVerts(cells); break;
+            case 1: poly->SetLines(cells); break;
+            case 2: poly->SetPolys(cells); break;
+            case 3: poly->SetStrips(cells); break;
+            }
+          cells->Delete();
+          }
+        }
+      if (grid && this->ReadValue<vtkTypeInt64>() > 0)
+        {
+        // the number of cells is the number of cell types.
+        vtkDataArray* cells = this->ReadArray();
+        vtkDataArray* types = this->ReadArray();
+        vtkDataArray* locations = this->ReadArray();
+        vtkIdTypeArray* cellsData = vtkIdTypeArray::SafeDownCast(cells);
+        vtkUnsignedCharArray* typesData =
+          vtkUnsignedCharArray::SafeDownCast(types);
+        vtkIdTypeArray* locationsData = vtkIdTypeArray::SafeDownCast(locations);
+        if (cellsData && typesData && locationsData &&
+          typesData->GetNumberOfTuples() == locationsData->GetNumberOfTuples())
+          {
+          vtkCellArray* cellArray = vtkCellArray::New();
+          cellArray->SetCells(typesData->GetNumberOfTuples(), cellsData);
+          grid->SetCells(typesData, locationsData, cellArray);
+          cellArray->Delete();
+          }
+        else
+          {
+          this->Failed = true;
+          }
+        vtkDataArray* arrays[3] = { cells, types, locations };
+        for (int cc = 0; cc < 3; cc++)
+          {
+          if (arrays[cc])
+            {
+            arrays[cc]->Delete();
+            }
+          }
+        }
+
+      vtkDataSet* dataSet = vtkDataSet::SafeDownCast(data);
+      this->ReadFieldData(data->GetFieldData());
+      this->ReadFieldData(dataSet->GetPointData());
+      this->ReadFieldData(dataSet->GetCellData());
+      if (this->Failed)
+        {
+        data->Delete();
+        return NULL;
+        }
+      return data;
+      }
+
+  private:
+    void ReadBytes(void* data, vtkTypeInt64 length)
+      {
+      if (this->Failed || length < 0 || length > this->Length - this->Position)
+        {
+        this->Failed = true;
+        return;
+        }
+      if (length > 0)
+        {
+        memcpy(data, this->Buffer + this->Position, length);
+        }
+      this->Position += length;
+      }
+
+    template <class T>
+    T ReadValue()
+      {
+      T value = T();
+      this->ReadBytes(&value, sizeof(T));
+      if (this->Swap)
+        {
+        vtkByteSwap::SwapVoidRange(&value, 1, sizeof(T));
+        }
+      return value;
+      }
+
+    // Returns false for a NULL string.
+    bool ReadString(std::string& value)
+      {
+      vtkTypeInt32 length = this->ReadValue<vtkTypeInt32>();
+      if (length == -1 && !this->Failed)
+        {
+        return false;
+        }
+      if (this->Failed || length < 0 || length > this->Length - this->Position)
+        {
+        this->Failed = true;
+        return false;
+        }
+      value.assign(this->Buffer + this->Position, length);
+      this->Position += length;
+      return true;
+      }
+
+    vtkCellArray* ReadCells()
+      {
+      vtkTypeInt64 numCells = this->ReadValue<vtkTypeInt64>();
+      if (numCells <= 0 || this->Failed)
+        {
+        return NULL;
+        }
+      vtkDataArray* array = this->ReadArray();
+      vtkIdTypeArray* ids = vtkIdTypeArray::SafeDownCast(array);
+      vtkCellArray* cells = NULL;
+      if (ids)
+        {
+        cells = vtkCellArray::New();
+        cells->SetCells(numCells, ids);
+        }
+      else
+        {
+        this->Failed = true;
+        }
+      if (array)
+        {
+        array->Delete();
+        }
+      return cells;
+      }
+
+    void ReadFieldData(vtkFieldData* fields)
+      {
+      vtkDataSetAttributes* attributes =
+        vtkDataSetAttributes::SafeDownCast(fields);
+      vtkTypeInt32 numArrays = this->ReadValue<vtkTypeInt32>();
+      for (vtkTypeInt32 i = 0; i < numArrays && !this->Failed; i++)
+        {
+        int attribute = this->ReadValue<vtkTypeInt32>();
+        vtkDataArray* array = this->ReadArray();
+        if (!array)
+          {
+          this->Failed = true;
+          break;
+          }
+        int index = fields->AddArray(array);
+        array->Delete();
+        if (attributes && attribute >= 0 &&
+          attribute < vtkDataSetAttributes::NUM_ATTRIBUTES)
+          {
+          attributes->SetActiveAttribute(index, attribute);
+          }
+        }
+      }
+
+    // Returns a new array, NULL if there is none or on errors.
+    vtkDataArray* ReadArray()
+      {
+      if (this->ReadValue<vtkTypeInt8>() == 0 || this->Failed)
+        {
+        return NULL;
+        }
+      std::string name;
+      bool hasName = this->ReadString(name);
+      int dataType = this->ReadValue<vtkTypeInt32>();
+      int numComponents = this->ReadValue<vtkTypeInt32>();
+      vtkTypeInt64 numTuples = this->ReadValue<vtkTypeInt64>();
+      std::vector<std::string> componentNames;
+      std::vector<bool> hasComponentNames;
+      if (this->ReadValue<vtkTypeInt8>() != 0)
+        {
+        for (int cc = 0; cc < numComponents && !this->Failed; cc++)
+          {
+          componentNames.push_back(std::string());
+          hasComponentNames.push_back(this->ReadString(componentNames.back()));
+          }
+        }
+      vtkTypeInt64 length = this->ReadValue<vtkTypeInt64>();
+      bool compressed = this->ReadValue<vtkTypeInt8>() != 0;
+
+      vtkDataArray* array = (this->Failed || dataType == VTK_BIT)? NULL :
+        vtkDataArray::CreateDataArray(dataType);
+      // The ids have the size of vtkIdType on the sender.
+      int valueSize = !array? 0 : dataType == VTK_ID_TYPE?
+        this->IdTypeSize : array->GetDataTypeSize();
+      if (!array || numComponents < 1 || numTuples < 0 ||
+        length != numTuples * numComponents * valueSize)
+        {
+        if (array)
+          {
+          array->Delete();
+          }
+        this->Failed = true;
+        return NULL;
+        }
+      if (hasName)
+        {
+        array->SetName(name.c_str());
+        }
+      array->SetNumberOfComponents(numComponents);
+      for (size_t cc = 0; cc < componentNames.size(); cc++)
+        {
+        if (hasComponentNames[cc])
+          {
+          array->SetComponentName(
+            static_cast<vtkIdType>(cc), componentNames[cc].c_str());
+          }
+        }
+      array->SetNumberOfTuples(numTuples);
+      // The new array is contiguous, so the values are read in place, unless
+      // the ids need to be converted.
+      vtkIdType numValues = static_cast<vtkIdType>(numTuples * numComponents);
+      bool convert = valueSize != array->GetDataTypeSize();
+      std::vector<char> received(convert? length : 0);
+      char* values = length <= 0? NULL : convert? &received[0] :
+        static_cast<char*>(array->GetVoidPointer(0));
+
+      if (compressed)
+        {
+        vtkTypeInt64 storedLength = this->ReadValue<vtkTypeInt64>();
+        if (this->Failed || storedLength <= 0 ||
+          storedLength > this->Length - this->Position ||
+          length > LZ4_MAX_INPUT_SIZE ||
+          LZ4_decompress_safe(this->Buffer + this->Position, values,
+            static_cast<int>(storedLength), static_cast<int>(length)) !=
+          length)
+          {
+          this->Failed = true;
+          }
+        else
+          {
+          this->Position += storedLength;
+          }
+        }
+      else
+        {
+        this->ReadBytes(values, length);
+        }
+      if (this->Failed)
+        {
+        array->Delete();
+        return NULL;
+        }
+      if (this->Swap && valueSize > 1)
+        {
+        vtkByteSwap::SwapVoidRange(values, numValues, valueSize);
+        }
+      if (convert && !this->ConvertIds(values,
+          static_cast<vtkIdTypeArray*>(array)->GetPointer(0), numValues))
+        {
+        array->Delete();
+        this->Failed = true;
+        return NULL;
+        }
+      return array;
+      }
+
+    // Converts the ids received with IdTypeSize bytes each to vtkIdType.
+    // Returns false if an id doesn't fit in vtkIdType.
+    bool ConvertIds(const char* values, vtkIdType* ids, vtkIdType numIds)
+      {
+      for (vtkIdType i = 0; i < numIds; i++)
+        {
+        if (this->IdTypeSize == 4)
+          {
+          ids[i] = reinterpret_cast<const vtkTypeInt32*>(values)[i];
+          continue;
+          }
+        vtkTypeInt64 id = reinterpret_cast<const vtkTypeInt64*>(values)[i];
+        if (id < VTK_ID_MIN || id > VTK_ID_MAX)
+          {
+          return false;
+          }
+        ids[i] = static_cast<vtkIdType>(id);
+        }
+      return true;
+      }
+
+    const char* Buffer;
+    vtkTypeInt64 Length;
+    vtkTypeInt64 Position;
+    bool Swap;
+    int IdTypeSize;
+    bool Failed;
+  };
 };
 
 
@@ -133,6 +795,9 @@ vtkMPIMoveData::vtkMPIMoveData()
   this->UpdatePiece = 0;
 
   this->SkipDataServerGatherToZero = false;
+
+  this->SwapNativeBytes = false;
+  this->NativeIdTypeSize = static_cast<int>(sizeof(vtkIdType));
 }
 
 //-----------------------------------------------------------------------------
@@ -199,6 +864,30 @@ bool vtkMPIMoveData::GetUseZLibCompression()
   return vtkMPIMoveData::UseZLibCompression;
 }
 
+//----------------------------------------------------------------------------
+void vtkMPIMoveData::SetUseNativeMarshaling(bool b)
+{
+  vtkMPIMoveData::UseNativeMarshaling = b;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMPIMoveData::GetUseNativeMarshaling()
+{
+  return vtkMPIMoveData::UseNativeMarshaling;
+}
+
+//----------------------------------------------------------------------------
+void vtkMPIMoveData::SetUseLZ4Compression(bool b)
+{
+  vtkMPIMoveData::UseLZ4Compression = b;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMPIMoveData::GetUseLZ4Compression()
+{
+  return vtkMPIMoveData::UseLZ4Compression;
+}
+
 //----------------------------------------------------------------------------
 int vtkMPIMoveData::FillInputPortInformation(int, vtkInformation *info)
 {
@@ -1059,47 +1748,71 @@ void vtkMPIMoveData::MarshalDataToBuffer(vtkDataObject* data)
     this->NumberOfBuffers = 0;
     }
 
-  // Copy input to isolate reader from the pipeline.
-  vtkDataWriter* writer = vtkGenericDataObjectWriter::New();
-  writer->SetInputData(data);
-  if (imageData)
-    {
-    // We add the image extents to the header, since the writer doesn't preserve
-    // the extents.
-    int *extent = imageData->GetExtent();
-    double* origin = imageData->GetOrigin();
-    std::ostringstream stream;
-    stream << "EXTENT " << extent[0] << " " <<
-      extent[1] << " " <<
-      extent[2] << " " <<
-      extent[3] << " " <<
-      extent[4] << " " <<
-      extent[5];
-    stream << " ORIGIN " << origin[0] << " " << origin[1] << " " << origin[2];
-    writer->SetHeader(stream.str().c_str());
-    }
-
-  writer->SetFileTypeToBinary();
-  writer->WriteToOutputStringOn();
-  writer->Write();
-
   char* buffer =NULL;
   vtkIdType buffer_length = 0;
 
+  if (vtkMPIMoveData::UseNativeMarshaling &&
+    vtkMPIMoveDataCanMarshalNatively(data))
+    {
+    // Send the arrays as they are, avoiding the legacy writer and reader.
+    vtkTimerLog::MarkStartEvent("Native marshal");
+    vtkMPIMoveDataNativeWriter nativeWriter(
+      vtkMPIMoveData::UseLZ4Compression, this->SwapNativeBytes,
+      this->NativeIdTypeSize);
+    nativeWriter.WriteDataObject(data);
+    buffer = new char[nativeWriter.GetLength()];
+    nativeWriter.SetBuffer(buffer);
+    nativeWriter.WriteDataObject(data);
+    buffer_length = nativeWriter.GetLength();
+    vtkTimerLog::MarkEndEvent("Native marshal");
+    }
+  else
+    {
+    // Copy input to isolate reader from the pipeline.
+    vtkDataWriter* writer = vtkGenericDataObjectWriter::New();
+    writer->SetInputData(data);
+    if (imageData)
+      {
+      // We add the image extents to the header, since the writer doesn't preserve
+      // the extents.
+      int *extent = imageData->GetExtent();
+      double* origin = imageData->GetOrigin();
+      std::ostringstream stream;
+      stream << "EXTENT " << extent[0] << " " <<
+        extent[1] << " " <<
+        extent[2] << " " <<
+        extent[3] << " " <<
+        extent[4] << " " <<
+        extent[5];
+      stream << " ORIGIN " << origin[0] << " " << origin[1] << " " << origin[2];
+      writer->SetHeader(stream.str().c_str());
+      }
+
+    writer->SetFileTypeToBinary();
+    writer->WriteToOutputStringOn();
+    writer->Write();
+    buffer_length = writer->GetOutputStringLength();
+    buffer = writer->RegisterAndGetOutputString();
+    writer->Delete();
+    writer = 0;
+    }
+
   if (vtkMPIMoveData::UseZLibCompression)
     {
     vtkTimerLog::MarkStartEvent("Zlib compress");
     // Use z-lib compression.
-    uLongf out_size =compressBound(writer->GetOutputStringLength());
+    uLongf out_size =compressBound(buffer_length);
+    char* uncompressed = buffer;
     buffer = new char[out_size + 8]; 
     memcpy(buffer, "zlib0000", 8);
 
     compress2(reinterpret_cast<Bytef*>(buffer + 8), 
       &out_size,
-      reinterpret_cast<const Bytef*>(writer->GetOutputString()),
-      writer->GetOutputStringLength(), /* compression_level */ Z_DEFAULT_COMPRESSION);
+      reinterpret_cast<const Bytef*>(uncompressed),
+      buffer_length, /* compression_level */ Z_DEFAULT_COMPRESSION);
     vtkTimerLog::MarkEndEvent("Zlib compress");
-    int in_size = static_cast<int>(writer->GetOutputStringLength());
+    delete [] uncompressed;
+    int in_size = static_cast<int>(buffer_length);
     for (int cc=0; cc < 4; cc++)
       {
       // the first 4 bytes in the header are "zlib" which helps the receiver
@@ -1111,11 +1824,6 @@ void vtkMPIMoveData::MarshalDataToBuffer(vtkDataObject* data)
       }
     buffer_length = out_size + 8;
     }
-  else
-    {
-    buffer_length = writer->GetOutputStringLength();
-    buffer = writer->RegisterAndGetOutputString();
-    }
 
   // Get string.
   this->NumberOfBuffers = 1;
@@ -1125,9 +1833,6 @@ void vtkMPIMoveData::MarshalDataToBuffer(vtkDataObject* data)
   this->BufferOffsets[0] = 0;
   this->Buffers = buffer;
   this->BufferTotalLength = this->BufferLengths[0];
-
-  writer->Delete();
-  writer = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -1171,6 +1876,30 @@ void vtkMPIMoveData::ReconstructDataFromBuffer(vtkDataObject* data)
       bufferLength = uncompressed_length;
       }
 
+    if (bufferLength > 4 &&
+      strncmp(bufferArray, vtkMPIMoveDataNativeTag, 4) == 0)
+      {
+      // sender used native marshaling, the data set is not in the legacy
+      // format.
+      vtkTimerLog::MarkStartEvent("Native unmarshal");
+      vtkMPIMoveDataNativeReader nativeReader(bufferArray, bufferLength);
+      vtkDataObject* output = nativeReader.ReadDataObject();
+      vtkTimerLog::MarkEndEvent("Native unmarshal");
+      if (output)
+        {
+        // reconstructing data distributted on MPI node, so global ids are valid
+        unsetGlobalIdsAttribute(output);
+        pieces.push_back(output);
+        output->Delete();
+        }
+      else
+        {
+        vtkErrorMacro("Failed to unmarshal natively marshaled data.");
+        }
+      delete [] realBuffer;
+      continue;
+      }
+
     // Setup a reader.
     vtkDataReader *reader = vtkGenericDataObjectReader::New();
     reader->ReadFromInputStringOn();
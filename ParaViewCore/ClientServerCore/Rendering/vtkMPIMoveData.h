@@ -96,6 +96,27 @@ public:
   static void SetUseZLibCompression(bool b);
   static bool GetUseZLibCompression();
 
+  // Description:
+  // When set to true (the default), vtkPolyData, vtkUnstructuredGrid and
+  // vtkImageData are marshaled natively: a small binary header describing
+  // the data set followed by the raw values of its arrays, instead of
+  // going through vtkGenericDataObjectWriter and vtkGenericDataObjectReader.
+  // Other data types, and data sets with arrays that aren't vtkDataArrays,
+  // always use the legacy format, as well as data sets with arrays whose
+  // values aren't contiguous in memory, such as mapped arrays. The receivers
+  // convert the values from another byte order and the ids from another
+  // size of vtkIdType. As for compression, this only has an effect on the
+  // senders.
+  static void SetUseNativeMarshaling(bool b);
+  static bool GetUseNativeMarshaling();
+
+  // Description:
+  // When set to true, the arrays of natively marshaled data sets are each
+  // compressed with LZ4, much faster than zlib but with lower ratios. False
+  // by default. Arrays that don't get smaller are sent uncompressed.
+  static void SetUseLZ4Compression(bool b);
+  static bool GetUseLZ4Compression();
+
   // Description:
   // vtkMPIMoveData doesn't necessarily generate a valid output data on all the
   // involved processes (depending on the MoveMode and Server ivars). This
@@ -167,6 +188,14 @@ protected:
 
   int OutputDataType;
 
+  // Description:
+  // For testing the native marshaling: when SwapNativeBytes is set, the
+  // values are written in the other byte order, and the ids are written
+  // with NativeIdTypeSize bytes (the size of vtkIdType by default), as a
+  // sender on another platform would.
+  bool SwapNativeBytes;
+  int NativeIdTypeSize;
+
 private:
   int UpdateNumberOfPieces;
   int UpdatePiece;
@@ -175,6 +204,8 @@ private:
   void operator=(const vtkMPIMoveData&); // Not implemented
 
   static bool UseZLibCompression;
+  static bool UseNativeMarshaling;
+  static bool UseLZ4Compression;
 };
 
 #endif
@@ -16,35 +16,234 @@
 
 #include "vtkCacheSizeKeeper.h"
 #include "vtkDataObject.h"
+#include "vtkGenericDataObjectReader.h"
+#include "vtkGenericDataObjectWriter.h"
+#include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMultiProcessController.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkProcessModule.h"
 #include "vtkPVCacheKeeperPipeline.h"
 #include "vtkSmartPointer.h"
 
+#include <vtksys/SystemTools.hxx>
+
+#include <cstdio>
 #include <map>
+#include <sstream>
+#include <string>
+
+#if defined(_WIN32)
+# include <process.h>
+#else
+# include <unistd.h>
+#endif
+
+namespace
+{
+  // The processes running the cache keepers together must take the same
+  // decisions, otherwise IsCached() differs between them and they hang while
+  // delivering the data. The local flag is reduced over the processes of the
+  // global controller, like the CacheFull state in vtkPVView::Update().
+  bool vtkAnyProcess(bool value)
+    {
+    vtkMultiProcessController* controller =
+      vtkMultiProcessController::GetGlobalController();
+    if (!controller || controller->GetNumberOfProcesses() <= 1)
+      {
+      return value;
+      }
+    int local = value? 1 : 0;
+    int global = 0;
+    controller->AllReduce(&local, &global, 1, vtkCommunicator::MAX_OP);
+    return global != 0;
+    }
+
+  bool vtkAllProcesses(bool value)
+    {
+    return !vtkAnyProcess(!value);
+    }
+
+  // Returns the directory to spill cached data to.
+  std::string vtkGetSpillDirectory(vtkCacheSizeKeeper* keeper)
+    {
+    const char* dir = keeper? keeper->GetSpillDirectory() : NULL;
+    if (dir && dir[0])
+      {
+      return dir;
+      }
+    const char* vars[] = { "TMPDIR", "TEMP", "TMP", NULL };
+    for (int cc = 0; vars[cc] != NULL; ++cc)
+      {
+      const char* value = vtksys::SystemTools::GetEnv(vars[cc]);
+      if (value && value[0])
+        {
+        return value;
+        }
+      }
+    return "/tmp";
+    }
+
+  int vtkGetProcessId()
+    {
+#if defined(_WIN32)
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+    }
+
+  // Reads back data spilled with vtkGenericDataObjectWriter.
+  vtkSmartPointer<vtkDataObject> vtkReadSpilledData(const std::string& fname)
+    {
+    if (!vtksys::SystemTools::FileExists(fname.c_str(), true))
+      {
+      return vtkSmartPointer<vtkDataObject>();
+      }
+    vtkNew<vtkGenericDataObjectReader> reader;
+    reader->SetFileName(fname.c_str());
+    reader->Update();
+
+    vtkDataObject* output = reader->GetOutputDataObject(0);
+    if (!output)
+      {
+      return vtkSmartPointer<vtkDataObject>();
+      }
+    vtkSmartPointer<vtkDataObject> data;
+    data.TakeReference(output->NewInstance());
+    data->ShallowCopy(output);
+
+    if (vtkImageData* image = vtkImageData::SafeDownCast(data))
+      {
+      // The legacy writer does not preserve extents, they are saved in the
+      // header (see vtkMPIMoveData).
+      int extent[6] = {0, 0, 0, 0, 0, 0};
+      double origin[3] = {0, 0, 0};
+      if (reader->GetHeader() && sscanf(reader->GetHeader(),
+          "EXTENT %d %d %d %d %d %d ORIGIN %lf %lf %lf", &extent[0], &extent[1],
+          &extent[2], &extent[3], &extent[4], &extent[5],
+          &origin[0], &origin[1], &origin[2]) == 9)
+        {
+        image->SetOrigin(origin);
+        image->SetExtent(extent);
+        }
+      }
+    return data;
+    }
+
+  bool vtkWriteSpilledData(vtkDataObject* data, const std::string& fname)
+    {
+    vtkNew<vtkGenericDataObjectWriter> writer;
+    writer->SetInputData(data);
+    if (vtkImageData* image = vtkImageData::SafeDownCast(data))
+      {
+      int* extent = image->GetExtent();
+      double* origin = image->GetOrigin();
+      std::ostringstream stream;
+      stream.precision(17);
+      stream << "EXTENT " << extent[0] << " " << extent[1] << " "
+             << extent[2] << " " << extent[3] << " "
+             << extent[4] << " " << extent[5]
+             << " ORIGIN " << origin[0] << " " << origin[1] << " " << origin[2];
+      writer->SetHeader(stream.str().c_str());
+      }
+    writer->SetFileTypeToBinary();
+    writer->SetFileName(fname.c_str());
+    if (writer->Write() == 0)
+      {
+      vtksys::SystemTools::RemoveFile(fname.c_str());
+      return false;
+      }
+    return true;
+    }
+}
+
 //----------------------------------------------------------------------------
-class vtkPVCacheKeeper::vtkCacheMap :
-  public std::map<double, vtkSmartPointer<vtkDataObject> >
+class vtkPVCacheKeeper::vtkCacheMap
 {
 public:
-  unsigned long GetActualMemorySize() 
+  struct vtkCacheItem
+    {
+    // Cached data, NULL when the item has been spilled to disk.
+    vtkSmartPointer<vtkDataObject> Data;
+    // Spill file, empty while the item is in memory.
+    std::string FileName;
+    // Memory size (in KB) reported to the vtkCacheSizeKeeper.
+    unsigned long Size;
+    // Value of AccessCounter when the item was last used.
+    unsigned long LastAccess;
+
+    vtkCacheItem() : Size(0), LastAccess(0) {}
+    };
+
+  typedef std::map<double, vtkCacheItem> MapType;
+  MapType Items;
+  unsigned long AccessCounter;
+  int SpillCounter;
+
+  vtkCacheMap() : AccessCounter(0), SpillCounter(0) {}
+
+  unsigned long GetActualMemorySize()
     {
     unsigned long actual_size = 0;
-    vtkCacheMap::iterator iter;
-    for (iter = this->begin(); iter != this->end(); ++iter)
+    for (MapType::iterator iter = this->Items.begin();
+      iter != this->Items.end(); ++iter)
       {
-      actual_size += iter->second.GetPointer()->GetActualMemorySize();
+      actual_size += iter->second.Data? iter->second.Size : 0;
       }
     return actual_size;
     }
+
+  void RemoveSpillFiles()
+    {
+    for (MapType::iterator iter = this->Items.begin();
+      iter != this->Items.end(); ++iter)
+      {
+      if (!iter->second.FileName.empty())
+        {
+        vtksys::SystemTools::RemoveFile(iter->second.FileName.c_str());
+        }
+      }
+    }
+
+  std::string GetNextSpillFileName(vtkPVCacheKeeper* self,
+    vtkCacheSizeKeeper* keeper)
+    {
+    std::ostringstream stream;
+    stream << vtkGetSpillDirectory(keeper) << "/vtkPVCacheKeeper-"
+           << vtkGetProcessId() << "-" << static_cast<void*>(self) << "-"
+           << this->SpillCounter++ << ".vtk";
+    return stream.str();
+    }
+
+  // Moves the item to disk. Returns false if it could not be written by all
+  // the processes, in which case the caller should drop it.
+  bool Spill(vtkCacheItem& item, vtkPVCacheKeeper* self,
+    vtkCacheSizeKeeper* keeper)
+    {
+    std::string fname = this->GetNextSpillFileName(self, keeper);
+    bool written = vtkWriteSpilledData(item.Data, fname);
+    if (!vtkAllProcesses(written))
+      {
+      if (written)
+        {
+        vtksys::SystemTools::RemoveFile(fname.c_str());
+        }
+      return false;
+      }
+    item.FileName = fname;
+    item.Data = NULL;
+    return true;
+    }
 };
 
 vtkStandardNewMacro(vtkPVCacheKeeper);
 vtkCxxSetObjectMacro(vtkPVCacheKeeper, CacheSizeKeeper, vtkCacheSizeKeeper);
 //----------------------------------------------------------------------------
-int vtkPVCacheKeeper::CacheHit = 0;
+int vtkPVCacheKeeper::CacheMemoryHit = 0;
+int vtkPVCacheKeeper::CacheDiskHit = 0;
 int vtkPVCacheKeeper::CacheMiss = 0;
 int vtkPVCacheKeeper::CacheSkips = 0;
 //----------------------------------------------------------------------------
@@ -74,7 +273,8 @@ void vtkPVCacheKeeper::RemoveAllCaches()
 {
   // cout << this << " RemoveAllCaches" << endl;
   unsigned long freed_size = this->Cache->GetActualMemorySize();
-  this->Cache->clear();
+  this->Cache->RemoveSpillFiles();
+  this->Cache->Items.clear();
   if (freed_size > 0 && this->CacheSizeKeeper)
     {
     // Tell the cache size keeper about the newly freed memory size.
@@ -87,27 +287,86 @@ void vtkPVCacheKeeper::RemoveAllCaches()
 //----------------------------------------------------------------------------
 bool vtkPVCacheKeeper::IsCached(double cacheTime)
 {
-  vtkPVCacheKeeper::vtkCacheMap::iterator iter = this->Cache->find(cacheTime);
-  return (iter != this->Cache->end());
+  // Only the collective decisions of SaveData() and RequestData() change the
+  // cached time steps, so this is the same on all the processes.
+  return this->Cache->Items.find(cacheTime) != this->Cache->Items.end();
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVCacheKeeper::EvictLeastRecentlyUsed()
+{
+  vtkPVCacheKeeper::vtkCacheMap::MapType& items = this->Cache->Items;
+  vtkPVCacheKeeper::vtkCacheMap::MapType::iterator lru = items.end();
+  for (vtkPVCacheKeeper::vtkCacheMap::MapType::iterator iter = items.begin();
+    iter != items.end(); ++iter)
+    {
+    if (iter->second.Data &&
+      (lru == items.end() || iter->second.LastAccess < lru->second.LastAccess))
+      {
+      lru = iter;
+      }
+    }
+  if (lru == items.end())
+    {
+    return false;
+    }
+
+  unsigned long size = lru->second.Size;
+  bool spill = this->CacheSizeKeeper && this->CacheSizeKeeper->GetSpillToDisk();
+  if (!spill || !this->Cache->Spill(lru->second, this, this->CacheSizeKeeper))
+    {
+    items.erase(lru);
+    }
+  if (this->CacheSizeKeeper)
+    {
+    this->CacheSizeKeeper->FreeCacheSize(size);
+    }
+  return true;
 }
 
 //----------------------------------------------------------------------------
 bool vtkPVCacheKeeper::SaveData(vtkDataObject* output)
 {
-  if (!this->CacheSizeKeeper  || !this->CacheSizeKeeper->GetCacheFull())
+  vtkPVCacheKeeper::vtkCacheMap::vtkCacheItem item;
+  item.Data.TakeReference(output->NewInstance());
+  item.Data->ShallowCopy(output);
+  item.Size = item.Data->GetActualMemorySize();
+  item.LastAccess = ++this->Cache->AccessCounter;
+
+  vtkCacheSizeKeeper* keeper = this->CacheSizeKeeper;
+  if (keeper && !keeper->GetCacheFull())
     {
-    vtkSmartPointer<vtkDataObject> cache;
-    cache.TakeReference(output->NewInstance());
-    cache->ShallowCopy(output);
-    (*this->Cache)[this->CacheTime] = cache;
+    // Make room by evicting the least recently used time steps held by this
+    // filter. Caches held by other filters are left alone. All the processes
+    // evict until the data fits on every one of them, so that they keep the
+    // same time steps.
+    while (vtkAnyProcess(
+        keeper->GetCacheSize() + item.Size > keeper->GetCacheLimit()) &&
+      this->EvictLeastRecentlyUsed())
+      {
+      }
+    }
 
-    if (this->CacheSizeKeeper)
+  if (vtkAllProcesses(!keeper ||
+      (!keeper->GetCacheFull() &&
+       keeper->GetCacheSize() + item.Size <= keeper->GetCacheLimit())))
+    {
+    this->Cache->Items[this->CacheTime] = item;
+    if (keeper)
       {
       // Register used cache size.
-      this->CacheSizeKeeper->AddCacheSize(cache->GetActualMemorySize());
+      keeper->AddCacheSize(item.Size);
       }
     return true;
     }
+
+  // Does not fit in memory, go straight to disk if allowed.
+  if (keeper->GetSpillToDisk() &&
+    this->Cache->Spill(item, this, keeper))
+    {
+    this->Cache->Items[this->CacheTime] = item;
+    return true;
+    }
   return false;
 }
 
@@ -164,11 +423,45 @@ int vtkPVCacheKeeper::RequestData(vtkInformation* vtkNotUsed(reqInfo),
 
   if (this->CachingEnabled)
     {
-    if (this->IsCached(this->CacheTime))
+    vtkPVCacheKeeper::vtkCacheMap::MapType::iterator iter =
+      this->Cache->Items.find(this->CacheTime);
+    vtkSmartPointer<vtkDataObject> cached;
+    if (iter != this->Cache->Items.end())
+      {
+      iter->second.LastAccess = ++this->Cache->AccessCounter;
+      if (iter->second.Data)
+        {
+        cached = iter->second.Data;
+        vtkPVCacheKeeper::CacheMemoryHit++;
+        }
+      else
+        {
+        cached = vtkReadSpilledData(iter->second.FileName);
+        if (vtkAllProcesses(cached.GetPointer() != NULL))
+          {
+          vtkPVCacheKeeper::CacheDiskHit++;
+          }
+        else
+          {
+          // Every process drops the time step if one of them could not read
+          // it back. The input was not updated for it, don't cache it either.
+          if (!cached)
+            {
+            vtkWarningMacro("Failed to read cached data from '"
+              << iter->second.FileName.c_str() << "'.");
+            }
+          vtksys::SystemTools::RemoveFile(iter->second.FileName.c_str());
+          this->Cache->Items.erase(iter);
+          output->ShallowCopy(input);
+          vtkPVCacheKeeper::CacheMiss++;
+          return 1;
+          }
+        }
+      }
+    if (cached)
       {
-      output->ShallowCopy((*this->Cache)[this->CacheTime]);
+      output->ShallowCopy(cached);
       //cout << this << " using Cache: " << this->CacheTime << endl;
-      vtkPVCacheKeeper::CacheHit++;
       }
     else
       {
@@ -190,7 +483,8 @@ int vtkPVCacheKeeper::RequestData(vtkInformation* vtkNotUsed(reqInfo),
 //----------------------------------------------------------------------------
 void vtkPVCacheKeeper::ClearCacheStateFlags()
 {
-  vtkPVCacheKeeper::CacheHit = 0;
+  vtkPVCacheKeeper::CacheMemoryHit = 0;
+  vtkPVCacheKeeper::CacheDiskHit = 0;
   vtkPVCacheKeeper::CacheMiss = 0;
   vtkPVCacheKeeper::CacheSkips = 0;
 }
@@ -198,7 +492,19 @@ void vtkPVCacheKeeper::ClearCacheStateFlags()
 //----------------------------------------------------------------------------
 int vtkPVCacheKeeper::GetCacheHits()
 {
-  return vtkPVCacheKeeper::CacheHit;
+  return vtkPVCacheKeeper::CacheMemoryHit + vtkPVCacheKeeper::CacheDiskHit;
+}
+
+//----------------------------------------------------------------------------
+int vtkPVCacheKeeper::GetCacheMemoryHits()
+{
+  return vtkPVCacheKeeper::CacheMemoryHit;
+}
+
+//----------------------------------------------------------------------------
+int vtkPVCacheKeeper::GetCacheDiskHits()
+{
+  return vtkPVCacheKeeper::CacheDiskHit;
 }
 
 //----------------------------------------------------------------------------
@@ -217,4 +523,7 @@ int vtkPVCacheKeeper::GetCacheSkips()
 void vtkPVCacheKeeper::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "CachingEnabled: " << this->CachingEnabled << endl;
+  os << indent << "CacheTime: " << this->CacheTime << endl;
+  os << indent << "CacheSizeKeeper: " << this->CacheSizeKeeper << endl;
 }
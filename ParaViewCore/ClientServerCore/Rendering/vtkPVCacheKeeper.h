@@ -20,6 +20,19 @@
 // then this filter shuts the update request, otherwise propagates the update
 // and then cache the result for later use.  The current time step is set using
 // SetCacheTime().
+//
+// The memory used by all cache keepers is bounded by vtkCacheSizeKeeper. When
+// saving a new time step would exceed that limit, the least recently used time
+// steps held by this filter are evicted. If vtkCacheSizeKeeper::SpillToDisk is
+// enabled, evicted data is written to a local scratch directory rather than
+// discarded and is read back when that time step is requested again. Data read
+// back from disk is not promoted back to memory, so that looping over more time
+// steps than fit in memory does not rewrite the spilled files on each pass.
+//
+// In parallel, the processes must agree on the cached time steps, since the
+// pipeline is only updated for the others. Eviction, spilling and dropping a
+// time step are therefore decided together by all the processes of the global
+// controller, which must execute the cache keepers in the same order.
 // .SECTION See Also
 // vtkPVCacheKeeperPipeline
 
@@ -65,8 +78,13 @@ public:
   // These methods are used for testing. Using this global state we can add
   // checks to ensure that cache was used or not used for a particular sequence
   // of actions.
+  // GetCacheHits() returns the total number of hits, while
+  // GetCacheMemoryHits() and GetCacheDiskHits() return the hits served from
+  // memory and from the spill directory respectively.
   static void ClearCacheStateFlags();
   static int GetCacheHits();
+  static int GetCacheMemoryHits();
+  static int GetCacheDiskHits();
   static int GetCacheMisses();
   static int GetCacheSkips();
 
@@ -88,9 +106,15 @@ protected:
 
   // Description:
   // Called to save the data in cache. Returns true if data is saved otherwise
-  // false.
+  // false. Must be called on all the processes.
   bool SaveData(vtkDataObject*);
 
+  // Description:
+  // Evicts the least recently used time step held in memory by this filter,
+  // spilling it to disk if requested. Returns false if there was nothing to
+  // evict. Must be called on all the processes.
+  bool EvictLeastRecentlyUsed();
+
   bool CachingEnabled;
   double CacheTime;
   vtkCacheSizeKeeper* CacheSizeKeeper;
@@ -102,7 +126,8 @@ private:
   class vtkCacheMap;
   vtkCacheMap* Cache;
 
-  static int CacheHit;
+  static int CacheMemoryHit;
+  static int CacheDiskHit;
   static int CacheMiss;
   static int CacheSkips;
 
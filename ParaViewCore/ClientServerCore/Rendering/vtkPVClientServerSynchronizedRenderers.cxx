@@ -19,6 +19,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkOpenGLRenderer.h"
 #include "vtkSquirtCompressor.h"
+#include "vtkTiledImageCompressor.h"
 #include "vtkUnsignedCharArray.h"
 #include "vtkZlibImageCompressor.h"
 
@@ -32,14 +33,55 @@ vtkCxxSetObjectMacro(vtkPVClientServerSynchronizedRenderers, Compressor,
 vtkPVClientServerSynchronizedRenderers::vtkPVClientServerSynchronizedRenderers()
 {
   this->Compressor = NULL;
+  this->TiledCompressor = vtkTiledImageCompressor::New();
+  this->TiledCompressor->SetNumberOfTiles(1);
   this->ConfigureCompressor("vtkLZ4Compressor 0 3");
   this->LossLessCompression = true;
+  this->NumberOfCompressionTiles = 1;
+  this->CompressionDeltaMode = false;
 }
 
 //----------------------------------------------------------------------------
 vtkPVClientServerSynchronizedRenderers::~vtkPVClientServerSynchronizedRenderers()
 {
   this->SetCompressor(NULL);
+  this->TiledCompressor->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkPVClientServerSynchronizedRenderers::SetNumberOfCompressionTiles(
+  int val)
+{
+  val = val < 1? 1 : val;
+  if (this->NumberOfCompressionTiles != val)
+    {
+    this->NumberOfCompressionTiles = val;
+    this->TiledCompressor->SetNumberOfTiles(val);
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkPVClientServerSynchronizedRenderers::SetCompressionDeltaMode(bool val)
+{
+  if (this->CompressionDeltaMode != val)
+    {
+    this->CompressionDeltaMode = val;
+    this->TiledCompressor->SetDeltaMode(val? 1 : 0);
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkImageCompressor* vtkPVClientServerSynchronizedRenderers::GetActiveCompressor()
+{
+  if (this->Compressor &&
+    (this->NumberOfCompressionTiles > 1 || this->CompressionDeltaMode))
+    {
+    this->TiledCompressor->SetCodec(this->Compressor);
+    return this->TiledCompressor;
+    }
+  return this->Compressor;
 }
 
 
@@ -121,16 +163,17 @@ void vtkPVClientServerSynchronizedRenderers::SlaveEndRender()
 vtkUnsignedCharArray* vtkPVClientServerSynchronizedRenderers::Compress(
   vtkUnsignedCharArray* data)
 {
-  if (this->Compressor)
+  vtkImageCompressor* compressor = this->GetActiveCompressor();
+  if (compressor)
     {
-    this->Compressor->SetLossLessMode(this->LossLessCompression);
-    this->Compressor->SetInput(data);
-    if (this->Compressor->Compress() == 0)
+    compressor->SetLossLessMode(this->LossLessCompression);
+    compressor->SetInput(data);
+    if (compressor->Compress() == 0)
       {
       vtkErrorMacro("Image compression failed!");
       return data;
       }
-    return this->Compressor->GetOutput();
+    return compressor->GetOutput();
     }
 
   return data;
@@ -140,12 +183,13 @@ vtkUnsignedCharArray* vtkPVClientServerSynchronizedRenderers::Compress(
 void vtkPVClientServerSynchronizedRenderers::Decompress(
   vtkUnsignedCharArray* data, vtkUnsignedCharArray* outputBuffer)
 {
-  if (this->Compressor)
+  vtkImageCompressor* compressor = this->GetActiveCompressor();
+  if (compressor)
     {
-    this->Compressor->SetLossLessMode(this->LossLessCompression);
-    this->Compressor->SetInput(data);
-    this->Compressor->SetOutput(outputBuffer);
-    if (this->Compressor->Decompress() == 0)
+    compressor->SetLossLessMode(this->LossLessCompression);
+    compressor->SetInput(data);
+    compressor->SetOutput(outputBuffer);
+    if (compressor->Decompress() == 0)
       {
       vtkErrorMacro("Image de-compression failed!");
       }
@@ -232,4 +276,8 @@ void vtkPVClientServerSynchronizedRenderers::PushImageToScreen()
 void vtkPVClientServerSynchronizedRenderers::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfCompressionTiles: "
+     << this->NumberOfCompressionTiles << endl;
+  os << indent << "CompressionDeltaMode: "
+     << this->CompressionDeltaMode << endl;
 }
@@ -25,6 +25,7 @@
 #include "vtkSynchronizedRenderers.h"
 
 class vtkImageCompressor;
+class vtkTiledImageCompressor;
 class vtkUnsignedCharArray;
 
 class VTKPVCLIENTSERVERCORERENDERING_EXPORT vtkPVClientServerSynchronizedRenderers : public vtkSynchronizedRenderers
@@ -47,6 +48,21 @@ public:
   // user settings.
   virtual void ConfigureCompressor(const char *stream);
 
+  // Description:
+  // When greater than 1, the image is split in that many tiles which are
+  // compressed concurrently by copies of the configured compressor (see
+  // vtkTiledImageCompressor). Default is 1. Must be the same on the client
+  // and the server.
+  void SetNumberOfCompressionTiles(int);
+  vtkGetMacro(NumberOfCompressionTiles, int);
+
+  // Description:
+  // When set, only the parts of the image that changed since the previous
+  // frame are compressed and sent (see vtkTiledImageCompressor::DeltaMode).
+  // Default is off. Must be the same on the client and the server.
+  void SetCompressionDeltaMode(bool);
+  vtkGetMacro(CompressionDeltaMode, bool);
+
 protected:
   vtkPVClientServerSynchronizedRenderers();
   ~vtkPVClientServerSynchronizedRenderers();
@@ -69,8 +85,16 @@ protected:
   virtual void SlaveStartRender();
   virtual void SlaveEndRender();
 
+  // Description:
+  // Returns the compressor to use for the current frame, i.e. the
+  // Compressor, wrapped in the TiledCompressor when tiling is enabled.
+  vtkImageCompressor* GetActiveCompressor();
+
   vtkImageCompressor* Compressor;
+  vtkTiledImageCompressor* TiledCompressor;
   bool LossLessCompression;
+  int NumberOfCompressionTiles;
+  bool CompressionDeltaMode;
 private:
   vtkPVClientServerSynchronizedRenderers(const vtkPVClientServerSynchronizedRenderers&); // Not implemented
   void operator=(const vtkPVClientServerSynchronizedRenderers&); // Not implemented
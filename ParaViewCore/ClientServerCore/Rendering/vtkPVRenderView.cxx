@@ -106,7 +106,9 @@
 #include "vtkOSPRayRendererNode.h"
 #endif
 
+#include <algorithm>
 #include <assert.h>
+#include <cmath>
 #include <vector>
 #include <set>
 #include <map>
@@ -332,6 +334,9 @@ vtkPVRenderView::vtkPVRenderView()
   this->RemoteRenderingThreshold = 0;
   this->LODRenderingThreshold = 0;
   this->LODResolution = 0.5;
+  this->LODFrameTimeBudget = 0.0;
+  this->BudgetLODResolution = -1.0;
+  this->LastLODRenderTime = 0.0;
   this->UseOutlineForLODRendering = false;
   this->UseLightKit = false;
   this->Interactor = 0;
@@ -1301,7 +1306,12 @@ void vtkPVRenderView::UpdateLOD()
 
   // Update LOD geometry.
 
-  this->RequestInformation->Set(LOD_RESOLUTION(), this->LODResolution);
+  double resolution = this->LODResolution;
+  if (this->LODFrameTimeBudget > 0 && this->BudgetLODResolution >= 0)
+    {
+    resolution = std::min(resolution, this->BudgetLODResolution);
+    }
+  this->RequestInformation->Set(LOD_RESOLUTION(), resolution);
   if (this->UseOutlineForLODRendering)
     {
     this->RequestInformation->Set(USE_OUTLINE_FOR_LOD(), 1);
@@ -1334,6 +1344,37 @@ void vtkPVRenderView::UpdateLOD()
   vtkTimerLog::MarkEndEvent("RenderView::UpdateLOD");
 }
 
+//----------------------------------------------------------------------------
+double vtkPVRenderView::GetLODResolutionForBudget()
+{
+  if (this->LODFrameTimeBudget <= 0)
+    {
+    return -1.0;
+    }
+  double time = this->LastLODRenderTime;
+  double budget = this->LODFrameTimeBudget;
+  if (time <= 0 || (time <= budget && time >= 0.5 * budget))
+    {
+    return this->BudgetLODResolution;
+    }
+
+  double current = this->BudgetLODResolution >= 0?
+    std::min(this->BudgetLODResolution, this->LODResolution) :
+    this->LODResolution;
+  // Quadric clustering uses (150 * resolution + 10)^3 bins and renders a
+  // surface, so the number of triangles, hence the render time, grows as
+  // the square of the number of divisions.
+  double divisions = (150 * current + 10) * sqrt(budget / time);
+  double resolution = std::max(0.0,
+    std::min((divisions - 10) / 150, this->LODResolution));
+  // Small changes would select the same level of detail.
+  if (fabs(resolution - current) < 0.05)
+    {
+    return this->BudgetLODResolution;
+    }
+  return resolution;
+}
+
 //----------------------------------------------------------------------------
 void vtkPVRenderView::StillRender()
 {
@@ -1507,6 +1548,10 @@ void vtkPVRenderView::Render(bool interactive, bool skip_rendering)
     if (!this->MakingSelection)
       {
       this->Timer->StopTimer();
+      if (use_lod_rendering)
+        {
+        this->LastLODRenderTime = this->Timer->GetElapsedTime();
+        }
       }
     }
 
@@ -2106,6 +2151,18 @@ void vtkPVRenderView::ConfigureCompressor(const char* configuration)
   this->SynchronizedRenderers->ConfigureCompressor(configuration);
 }
 
+//----------------------------------------------------------------------------
+void vtkPVRenderView::SetNumberOfCompressionTiles(int val)
+{
+  this->SynchronizedRenderers->SetNumberOfCompressionTiles(val);
+}
+
+//----------------------------------------------------------------------------
+void vtkPVRenderView::SetCompressionDeltaMode(bool val)
+{
+  this->SynchronizedRenderers->SetCompressionDeltaMode(val);
+}
+
 //----------------------------------------------------------------------------
 void vtkPVRenderView::InvalidateCachedSelection()
 {
@@ -206,6 +206,32 @@ public:
   vtkSetClampMacro(LODResolution, double, 0.0, 1.0);
   vtkGetMacro(LODResolution, double);
 
+  // Description:
+  // Get/Set the time budget, in seconds, for interactive renders using LOD.
+  // 0 (the default) disables it. With a budget, the LOD resolution is lowered
+  // when interactive renders take longer than the budget and raised back, up
+  // to LODResolution, when they take less than half of it. Representations
+  // keeping levels of detail (see vtkGeometryRepresentation) then only switch
+  // levels.
+  // @CallOnAllProcessess
+  vtkSetClampMacro(LODFrameTimeBudget, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(LODFrameTimeBudget, double);
+
+  // Description:
+  // Get/Set the LOD resolution chosen to meet LODFrameTimeBudget, -1 (the
+  // default) to use LODResolution. vtkSMRenderViewProxy sets it on all
+  // processes, from GetLODResolutionForBudget() on the client, before
+  // updating the LOD geometry.
+  // @CallOnAllProcessess
+  vtkSetMacro(BudgetLODResolution, double);
+  vtkGetMacro(BudgetLODResolution, double);
+
+  // Description:
+  // Returns the LOD resolution to use for the next interactive renders given
+  // LODFrameTimeBudget and the time taken by the last interactive render
+  // using LOD on this process, -1 when there is no budget.
+  double GetLODResolutionForBudget();
+
   // Description:
   // When set to true, instead of using simplified geometry for LOD rendering,
   // uses outline, if possible. Note that not all representations support this
@@ -223,6 +249,15 @@ public:
   // @CallOnAllProcessess
   void ConfigureCompressor(const char* configuration);
 
+  // Description:
+  // Passes the image compression tiling options to the client-server
+  // synchronizer, if any. See
+  // vtkPVClientServerSynchronizedRenderers::SetNumberOfCompressionTiles() and
+  // vtkPVClientServerSynchronizedRenderers::SetCompressionDeltaMode().
+  // @CallOnAllProcessess
+  void SetNumberOfCompressionTiles(int);
+  void SetCompressionDeltaMode(bool);
+
   // Description:
   // Resets the clipping range. One does not need to call this directly ever. It
   // is called periodically by the vtkRenderer to reset the camera range.
@@ -813,6 +848,9 @@ protected:
   bool RenderEmptyImages;
 
   double LODResolution;
+  double LODFrameTimeBudget;
+  double BudgetLODResolution;
+  double LastLODRenderTime;
   bool UseLightKit;
 
   bool UsedLODForLastRender;
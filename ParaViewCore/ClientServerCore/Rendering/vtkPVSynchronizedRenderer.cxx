@@ -281,6 +281,36 @@ void vtkPVSynchronizedRenderer::ConfigureCompressor(const char* configuration)
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkPVSynchronizedRenderer::SetNumberOfCompressionTiles(int val)
+{
+  vtkPVClientServerSynchronizedRenderers* cssync =
+    vtkPVClientServerSynchronizedRenderers::SafeDownCast(this->CSSynchronizer);
+  if (cssync)
+    {
+    cssync->SetNumberOfCompressionTiles(val);
+    }
+  else
+    {
+    vtkDebugMacro("Not in client-server mode.");
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkPVSynchronizedRenderer::SetCompressionDeltaMode(bool val)
+{
+  vtkPVClientServerSynchronizedRenderers* cssync =
+    vtkPVClientServerSynchronizedRenderers::SafeDownCast(this->CSSynchronizer);
+  if (cssync)
+    {
+    cssync->SetCompressionDeltaMode(val);
+    }
+  else
+    {
+    vtkDebugMacro("Not in client-server mode.");
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkPVSynchronizedRenderer::SetImageProcessingPass(
   vtkImageProcessingPass* pass)
@@ -105,6 +105,14 @@ public:
   void ConfigureCompressor(const char* configuration);
   void SetLossLessCompression(bool);
 
+  // Description:
+  // Passes the image compression tiling options to the client-server
+  // synchronizer, if any.
+  // See vtkPVClientServerSynchronizedRenderers::SetNumberOfCompressionTiles()
+  // and vtkPVClientServerSynchronizedRenderers::SetCompressionDeltaMode().
+  void SetNumberOfCompressionTiles(int);
+  void SetCompressionDeltaMode(bool);
+
   // Description:
   // Activates or de-activated the use of Depth Buffer in an ImageProcessingPass
   void SetUseDepthBuffer(bool);
@@ -0,0 +1,98 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestInterpreterObjectLookup.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Stress test for vtkClientServerInterpreter::GetIDFromObject(). Registers a
+// large number of objects, as happens when loading big state files, and
+// measures the lookup latency.
+
+#include "vtkClientServerInterpreter.h"
+#include "vtkClientServerStream.h"
+#include "vtkNew.h"
+#include "vtkObject.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+#include <vector>
+
+#define TEST_ASSERT(cond, msg) \
+  if (!(cond)) \
+    { \
+    cerr << "ERROR: " << msg << endl; \
+    return EXIT_FAILURE; \
+    }
+
+int TestInterpreterObjectLookup(int, char*[])
+{
+  const int numberOfObjects = 100000;
+  const vtkTypeUInt32 firstId = 100;
+
+  vtkNew<vtkClientServerInterpreter> interp;
+  std::vector<vtkSmartPointer<vtkObject> > objects(numberOfObjects);
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  vtkClientServerStream stream;
+  for (int cc = 0; cc < numberOfObjects; ++cc)
+    {
+    objects[cc] = vtkSmartPointer<vtkObject>::New();
+    stream << vtkClientServerStream::Assign
+           << vtkClientServerID(firstId + cc) << objects[cc].GetPointer()
+           << vtkClientServerStream::End;
+    }
+  TEST_ASSERT(interp->ProcessStream(stream), "failed to register objects.");
+  timer->StopTimer();
+  cout << "Registered " << numberOfObjects << " objects in "
+       << timer->GetElapsedTime() << " s" << endl;
+
+  timer->StartTimer();
+  for (int cc = 0; cc < numberOfObjects; ++cc)
+    {
+    vtkClientServerID id = interp->GetIDFromObject(objects[cc]);
+    TEST_ASSERT(id.ID == firstId + cc, "wrong ID for object " << cc);
+    }
+  timer->StopTimer();
+  cout << "Looked up " << numberOfObjects << " objects in "
+       << timer->GetElapsedTime() << " s ("
+       << 1e6 * timer->GetElapsedTime() / numberOfObjects
+       << " us/lookup)" << endl;
+
+  // Unknown objects are not found.
+  vtkNew<vtkObject> unknown;
+  TEST_ASSERT(interp->GetIDFromObject(unknown.GetPointer()).ID == 0,
+    "unregistered object was found.");
+
+  // An object assigned to several IDs resolves to the smallest one, and to
+  // the remaining one once that is deleted.
+  stream.Reset();
+  stream << vtkClientServerStream::Assign
+         << vtkClientServerID(firstId + numberOfObjects)
+         << objects[0].GetPointer() << vtkClientServerStream::End;
+  stream << vtkClientServerStream::Delete << vtkClientServerID(firstId + 1)
+         << vtkClientServerStream::End;
+  TEST_ASSERT(interp->ProcessStream(stream), "failed to assign/delete.");
+  TEST_ASSERT(interp->GetIDFromObject(objects[0]).ID == firstId,
+    "expected the smallest ID for an object with multiple IDs.");
+  TEST_ASSERT(interp->GetIDFromObject(objects[1]).ID == 0,
+    "deleted ID is still returned.");
+
+  stream.Reset();
+  stream << vtkClientServerStream::Delete << vtkClientServerID(firstId)
+         << vtkClientServerStream::End;
+  TEST_ASSERT(interp->ProcessStream(stream), "failed to delete.");
+  TEST_ASSERT(
+    interp->GetIDFromObject(objects[0]).ID == firstId + numberOfObjects,
+    "expected the remaining ID after deletion.");
+
+  return EXIT_SUCCESS;
+}
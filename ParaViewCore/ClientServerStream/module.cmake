@@ -12,6 +12,7 @@ vtk_module(vtkClientServer
     ${_dependencies}
   TEST_DEPENDS
     vtkCommonCore
+    vtkCommonSystem
     vtkTestingCore
   EXCLUDE_FROM_WRAPPING
   TEST_LABELS
@@ -20,6 +20,7 @@
 #include "vtkObjectFactory.h"
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -73,9 +74,44 @@ public:
   typedef std::map<std::string, const NewInstanceFunction*> NewInstanceFunctionsType;
   typedef std::map<std::string, const CommandFunction*> ClassToFunctionMapType;
   typedef std::map<vtkTypeUInt32, vtkClientServerStream*> IDToMessageMapType;
+  typedef std::map<vtkObjectBase*, std::set<vtkTypeUInt32> > ObjectToIDMapType;
   NewInstanceFunctionsType NewInstanceFunctions;
   ClassToFunctionMapType ClassToFunctionMap;
   IDToMessageMapType IDToMessageMap;
+
+  // Reverse index of IDToMessageMap for messages holding an object as first
+  // argument. Used by GetIDFromObject() to avoid scanning all messages. All
+  // IDs referring to an object are kept so that the smallest one is returned,
+  // as the scan did.
+  ObjectToIDMapType ObjectToIDMap;
+
+  // Add/remove a message in IDToMessageMap, keeping ObjectToIDMap in sync.
+  void AddMessage(vtkTypeUInt32 id, vtkClientServerStream* message)
+    {
+    this->IDToMessageMap[id] = message;
+    vtkObjectBase* obj;
+    if(message->GetArgument(0, 0, &obj))
+      {
+      this->ObjectToIDMap[obj].insert(id);
+      }
+    }
+  void RemoveMessage(vtkTypeUInt32 id, vtkClientServerStream* message)
+    {
+    this->IDToMessageMap.erase(id);
+    vtkObjectBase* obj;
+    if(message->GetArgument(0, 0, &obj))
+      {
+      ObjectToIDMapType::iterator iter = this->ObjectToIDMap.find(obj);
+      if(iter != this->ObjectToIDMap.end())
+        {
+        iter->second.erase(id);
+        if(iter->second.empty())
+          {
+          this->ObjectToIDMap.erase(iter);
+          }
+        }
+      }
+    }
 };
 
 //----------------------------------------------------------------------------
@@ -162,18 +198,13 @@ vtkClientServerInterpreter::GetObjectFromID(vtkClientServerID id, int noerror)
 vtkClientServerID
 vtkClientServerInterpreter::GetIDFromObject(vtkObjectBase* key)
 {
-  // Search the hash table for the given object.
+  // Search the reverse index for the given object.
   vtkClientServerID result;
-  vtkClientServerInterpreterInternals::IDToMessageMapType::iterator hi;
-  for(hi = this->Internal->IDToMessageMap.begin();
-      hi != this->Internal->IDToMessageMap.end(); ++hi)
+  vtkClientServerInterpreterInternals::ObjectToIDMapType::iterator hi =
+    this->Internal->ObjectToIDMap.find(key);
+  if(hi != this->Internal->ObjectToIDMap.end() && !hi->second.empty())
     {
-    vtkObjectBase* obj;
-    if(hi->second->GetArgument(0, 0, &obj) && obj == key)
-      {
-      result.ID = hi->first;
-      break;
-      }
+    result.ID = *hi->second.begin();
     }
   return result;
 }
@@ -516,7 +547,7 @@ vtkClientServerInterpreter
       }
 
     // Remove the ID from the map.
-    this->Internal->IDToMessageMap.erase(id.ID);
+    this->Internal->RemoveMessage(id.ID, item);
 
     // Delete the entry's value.
     delete item;
@@ -591,7 +622,7 @@ vtkClientServerInterpreter
     // remains unchanged.
     vtkClientServerStream* tmp;
     tmp = new vtkClientServerStream(*this->LastResultMessage, this);
-    this->Internal->IDToMessageMap[id.ID] = tmp;
+    this->Internal->AddMessage(id.ID, tmp);
     return 1;
     }
   else
@@ -627,11 +658,20 @@ int vtkClientServerInterpreter::ExpandMessage(const vtkClientServerStream& in,
     return 0;
     }
 
+  // Reserve the space needed by the arguments up-front so that large array
+  // arguments are copied once rather than through repeated reallocations.
+  int a;
+  size_t size = 0;
+  for(a=0; a < in.GetNumberOfArguments(inIndex); ++a)
+    {
+    size += in.GetArgument(inIndex, a).Size;
+    }
+  out.Reserve(size + 64);
+
   // Copy the command.
   out << in.GetCommand(inIndex);
 
   // Just copy the first arguments.
-  int a;
   for(a=0; a < startArgument && a < in.GetNumberOfArguments(inIndex); ++a)
     {
     out << in.GetArgument(inIndex, a);
@@ -742,7 +782,7 @@ int vtkClientServerInterpreter::NewInstance(vtkObjectBase* obj,
   // have to be checked.
   vtkClientServerStream* entry =
     new vtkClientServerStream(*this->LastResultMessage, this);
-  this->Internal->IDToMessageMap[id.ID] = entry;
+  this->Internal->AddMessage(id.ID, entry);
   return 1;
 }
 
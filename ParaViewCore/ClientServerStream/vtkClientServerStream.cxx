@@ -1345,6 +1345,54 @@ int vtkClientServerStream::GetArgument(int message, int& argument, vtkVariant* v
   return result;
 }
 
+//----------------------------------------------------------------------------
+int vtkClientServerStream::GetArgument(int message, int argument,
+                                       vtkClientServerStream::Array* value) const
+{
+  // Get a pointer to the type/value pair in the stream.
+  if(const unsigned char* data = this->GetValue(message, 1+argument))
+    {
+    // Get the type of the value in the stream.
+    vtkTypeUInt32 tp;
+    memcpy(&tp, data, sizeof(tp));
+    data += sizeof(tp);
+
+    // Make sure the type is an array type and get its word size.
+    vtkTypeUInt32 wordSize;
+    switch(static_cast<vtkClientServerStream::Types>(tp))
+      {
+      case vtkClientServerStream::int8_array:
+      case vtkClientServerStream::uint8_array:
+        wordSize = 1; break;
+      case vtkClientServerStream::int16_array:
+      case vtkClientServerStream::uint16_array:
+        wordSize = 2; break;
+      case vtkClientServerStream::int32_array:
+      case vtkClientServerStream::uint32_array:
+      case vtkClientServerStream::float32_array:
+        wordSize = 4; break;
+      case vtkClientServerStream::int64_array:
+      case vtkClientServerStream::uint64_array:
+      case vtkClientServerStream::float64_array:
+        wordSize = 8; break;
+      default:
+        return 0;
+      }
+
+    // Get the length of the array.  The data follows it.
+    vtkTypeUInt32 length;
+    memcpy(&length, data, sizeof(length));
+    data += sizeof(length);
+
+    value->Type = static_cast<vtkClientServerStream::Types>(tp);
+    value->Length = length;
+    value->Size = length*wordSize;
+    value->Data = data;
+    return 1;
+    }
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 int vtkClientServerStream::GetArgumentLength(int message, int argument,
                                              vtkTypeUInt32* length) const
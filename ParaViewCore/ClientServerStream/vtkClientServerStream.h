@@ -220,6 +220,18 @@ public:
     const void* Data;
   };
 
+  // Description:
+  // Get a read-only view of an array argument without copying its data.
+  // On success, the Type, Length and Size (in bytes) members of \a value
+  // are set and Data points into the stream buffer.  The view is
+  // invalidated when any further writing to the stream is done.  Data is
+  // already in the native byte order (SetData swaps incoming data once) but
+  // is not necessarily aligned for its element type, so elements should be
+  // read with memcpy.  The view may also be inserted into another stream.
+  // Returns whether the argument is really an array type.
+  int GetArgument(int message, int argument,
+                  vtkClientServerStream::Array* value) const;
+
   // Description:
   // Stream operators for special types.
   vtkClientServerStream& operator << (vtkClientServerStream::Commands);
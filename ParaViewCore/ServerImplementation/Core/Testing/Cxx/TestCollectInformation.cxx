@@ -0,0 +1,192 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestCollectInformation.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Collects the vtkPVDataInformation of a different sphere on every process
+// with vtkPVSessionCore::CollectInformation(), gathering to the root and
+// along the binomial tree, and checks that the root gets the information of
+// all the spheres either way. Only the root is given the mode, as
+// GatherInformation() sends it to the satellites. The tree must also survive
+// a satellite that failed to gather its information, and still merge what
+// its children sent. Reports the time of each collection.
+
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPVConfig.h"
+#include "vtkPVDataInformation.h"
+#include "vtkPVSessionCore.h"
+#include "vtkSphereSource.h"
+#include "vtkTimerLog.h"
+
+#ifdef PARAVIEW_USE_MPI
+# include "vtkMPIController.h"
+#else
+# include "vtkDummyController.h"
+#endif
+
+#include <cmath>
+#include <cstdlib>
+
+// Exposes the collection of information across the processes.
+class vtkCollectingSessionCore : public vtkPVSessionCore
+{
+public:
+  static vtkCollectingSessionCore* New();
+  vtkTypeMacro(vtkCollectingSessionCore, vtkPVSessionCore);
+
+  // Like GatherInformation(), the root sends its reduction mode.
+  bool Collect(vtkPVInformation* info)
+    {
+    int mode = this->InformationReductionMode;
+    this->ParallelController->Broadcast(&mode, 1, 0);
+    return this->CollectInformation(info, mode);
+    }
+
+protected:
+  vtkCollectingSessionCore() {}
+
+private:
+  vtkCollectingSessionCore(const vtkCollectingSessionCore&); // Not implemented
+  void operator=(const vtkCollectingSessionCore&); // Not implemented
+};
+
+vtkStandardNewMacro(vtkCollectingSessionCore);
+
+namespace
+{
+  // The sphere of each process is centered on its id, with a resolution
+  // depending on it, so that the merged information tells which processes
+  // contributed.
+  void GatherLocalInformation(int rank, vtkPVDataInformation* info)
+    {
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetCenter(rank, 0, 0);
+    sphere->SetThetaResolution(8 + rank % 8);
+    sphere->Update();
+    info->CopyFromObject(sphere->GetOutput());
+    }
+
+  // Checks the information collected on the root from all the processes
+  // but skipped, -1 for none.
+  bool CheckCollected(const char* name, vtkPVDataInformation* info,
+    int nranks, int skipped)
+    {
+    vtkIdType numPoints = 0;
+    vtkIdType numCells = 0;
+    int numDataSets = 0;
+    for (int cc = 0; cc < nranks; cc++)
+      {
+      if (cc == skipped)
+        {
+        continue;
+        }
+      vtkNew<vtkPVDataInformation> expected;
+      GatherLocalInformation(cc, expected.GetPointer());
+      numPoints += expected->GetNumberOfPoints();
+      numCells += expected->GetNumberOfCells();
+      numDataSets += expected->GetNumberOfDataSets();
+      }
+    int first = skipped == 0? 1 : 0;
+    int last = skipped == nranks - 1? nranks - 2 : nranks - 1;
+    double bounds[6];
+    info->GetBounds(bounds);
+    if (info->GetNumberOfPoints() != numPoints ||
+      info->GetNumberOfCells() != numCells ||
+      info->GetNumberOfDataSets() != numDataSets ||
+      std::fabs(bounds[0] - (first - 0.5)) > 1e-6 ||
+      std::fabs(bounds[1] - (last + 0.5)) > 1e-6)
+      {
+      cerr << "ERROR: " << name << " collected " << info->GetNumberOfPoints()
+           << " points, " << info->GetNumberOfCells() << " cells and "
+           << info->GetNumberOfDataSets() << " data sets in [" << bounds[0]
+           << ", " << bounds[1] << "] instead of " << numPoints << ", "
+           << numCells << " and " << numDataSets << " in [" << first - 0.5
+           << ", " << last + 0.5 << "]." << endl;
+      return false;
+      }
+    return true;
+    }
+
+  // Collects the information with the mode of the root, the satellites
+  // being set to the other mode, the skipped process not contributing any.
+  // Returns false on errors.
+  bool CollectWith(vtkCollectingSessionCore* core,
+    vtkMultiProcessController* contr, int mode, const char* name, int skipped)
+    {
+    int rank = contr->GetLocalProcessId();
+    int nranks = contr->GetNumberOfProcesses();
+    core->SetInformationReductionMode(rank == 0? mode :
+      vtkPVSessionCore::TREE_REDUCTION - mode);
+    vtkNew<vtkPVDataInformation> info;
+    GatherLocalInformation(rank, info.GetPointer());
+
+    contr->Barrier();
+    double start = vtkTimerLog::GetUniversalTime();
+    bool status = core->Collect(rank == skipped? NULL : info.GetPointer());
+    double seconds = vtkTimerLog::GetUniversalTime() - start;
+    if (!status)
+      {
+      cerr << "ERROR: " << name << " failed on process " << rank << "." << endl;
+      }
+    if (rank == 0)
+      {
+      status = CheckCollected(name, info.GetPointer(), nranks, skipped) &&
+        status;
+      cout << name << ", " << nranks << " processes: " << seconds
+           << " seconds" << endl;
+      }
+    return status;
+    }
+}
+
+int TestCollectInformation(int argc, char* argv[])
+{
+#ifdef PARAVIEW_USE_MPI
+  vtkNew<vtkMPIController> contr;
+#else
+  vtkNew<vtkDummyController> contr;
+#endif
+  contr->Initialize(&argc, &argv);
+  vtkMultiProcessController::SetGlobalController(contr.GetPointer());
+
+  int status = 1;
+  {
+  vtkNew<vtkCollectingSessionCore> core;
+  int nranks = contr->GetNumberOfProcesses();
+  status = CollectWith(core.GetPointer(), contr.GetPointer(),
+    vtkPVSessionCore::GATHER_TO_ROOT, "gather", -1)? 1 : 0;
+  status = CollectWith(core.GetPointer(), contr.GetPointer(),
+    vtkPVSessionCore::TREE_REDUCTION, "tree", -1) && status;
+  if (nranks > 1)
+    {
+    // The last process is a leaf of the tree.
+    status = CollectWith(core.GetPointer(), contr.GetPointer(),
+      vtkPVSessionCore::TREE_REDUCTION, "tree without the last process",
+      nranks - 1) && status;
+    }
+  if (nranks > 2)
+    {
+    // Process 2 has to forward the information of process 3.
+    status = CollectWith(core.GetPointer(), contr.GetPointer(),
+      vtkPVSessionCore::TREE_REDUCTION, "tree without process 2", 2) &&
+      status;
+    }
+  }
+
+  int global = 0;
+  contr->AllReduce(&status, &global, 1, vtkCommunicator::MIN_OP);
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  contr->Finalize();
+  return global? EXIT_SUCCESS : EXIT_FAILURE;
+}
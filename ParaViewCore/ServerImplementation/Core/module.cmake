@@ -6,6 +6,9 @@ vtk_module(vtkPVServerImplementationCore
     vtkprotobuf
   PRIVATE_DEPENDS
     vtksys
+  TEST_DEPENDS
+    vtkFiltersSources
+    vtkTestingCore
   TEST_LABELS
     PARAVIEW
 )
@@ -36,12 +36,14 @@
 #include "vtkSMMessage.h"
 #include "vtkSmartPointer.h"
 
+#include <vtksys/SystemTools.hxx>
 
 #include <assert.h>
 #include <fstream>
 #include <set>
 #include <string>
 #include <sstream>
+#include <vector>
 
 
 #define LOG(x)\
@@ -260,6 +262,9 @@ vtkPVSessionCore::vtkPVSessionCore()
     vtkClientServerInterpreterInitializer::GetInitializer()->NewInterpreter();
   this->MPIMToNSocketConnection = NULL;
   this->SymmetricMPIMode = false;
+  this->InformationReductionMode =
+    vtksys::SystemTools::GetEnv("PV_INFORMATION_TREE_REDUCTION") != NULL?
+    TREE_REDUCTION : GATHER_TO_ROOT;
 
   vtkPVSessionCoreInterpreterHelper* helper =
     vtkPVSessionCoreInterpreterHelper::New();
@@ -554,6 +559,8 @@ void vtkPVSessionCore::PushStateSatelliteCallback()
 void vtkPVSessionCore::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "InformationReductionMode: "
+     << this->InformationReductionMode << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -890,8 +897,10 @@ bool vtkPVSessionCore::GatherInformation( vtkTypeUInt32 location,
     this->ParallelController->TriggerRMIOnAllChildren(&type, 1,
                                                       ROOT_SATELLITE_RMI_TAG);
 
+    // The satellites follow the reduction mode of the root, whatever theirs.
     vtkMultiProcessStream stream;
-    stream << information->GetClassName() << globalid;
+    stream << information->GetClassName() << globalid
+           << this->InformationReductionMode;
 
     // serialize information parameters so all processes have the same ivars.
     information->CopyParametersToStream(stream);
@@ -899,7 +908,8 @@ bool vtkPVSessionCore::GatherInformation( vtkTypeUInt32 location,
     this->ParallelController->Broadcast(stream, 0);
     }
 
-  return this->CollectInformation(information);
+  return this->CollectInformation(information,
+    this->InformationReductionMode);
 }
 
 //----------------------------------------------------------------------------
@@ -910,7 +920,8 @@ void vtkPVSessionCore::GatherInformationStatelliteCallback()
 
   std::string classname;
   vtkTypeUInt32 globalid;
-  stream >> classname >> globalid;
+  int mode;
+  stream >> classname >> globalid >> mode;
 
   vtkSmartPointer<vtkObject> o;
   o.TakeReference(vtkPVInstantiator::CreateInstance(classname.c_str()));
@@ -919,13 +930,13 @@ void vtkPVSessionCore::GatherInformationStatelliteCallback()
     {
     info->CopyParametersFromStream(stream);
     this->GatherInformationInternal(info, globalid);
-    this->CollectInformation(info);
+    this->CollectInformation(info, mode);
     }
   else
     {
     vtkErrorMacro("Could not gather information on Satellite.");
     // let the parent know, otherwise root will hang.
-    this->CollectInformation(NULL);
+    this->CollectInformation(NULL, mode);
     }
 }
 
@@ -938,7 +949,17 @@ void vtkPVSessionCore::GatherInformationStatelliteCallback()
     }                                  \
 }
 
-bool vtkPVSessionCore::CollectInformation(vtkPVInformation* info)
+bool vtkPVSessionCore::CollectInformation(vtkPVInformation* info, int mode)
+{
+  if (mode == TREE_REDUCTION)
+    {
+    return this->CollectInformationTree(info);
+    }
+  return this->CollectInformationGather(info);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVSessionCore::CollectInformationGather(vtkPVInformation* info)
 {
   // Sanity checks
   assert("pre: NULL PV information!" && (info != NULL) );
@@ -1033,6 +1054,116 @@ bool vtkPVSessionCore::CollectInformation(vtkPVInformation* info)
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkPVSessionCore::CollectInformationTree(vtkPVInformation* info)
+{
+  int rank   = this->ParallelController->GetLocalProcessId();
+  int nranks = this->ParallelController->GetNumberOfProcesses();
+
+  if( nranks == 1 )
+    {
+    /* short-circuit */
+    return true;
+    }
+
+  // Binomial tree rooted at rank 0: at round k, every process whose k-th bit
+  // is set sends its partial result to (rank - 2^k) and leaves the reduction,
+  // while the others receive from (rank + 2^k), if such a process exists. The
+  // root thus only merges ceil(log2(nranks)) partial results.
+  // A message is a number of serialized information objects, their lengths
+  // and their bytes. A process with a NULL info (failure on this satellite)
+  // cannot merge: it forwards what its children sent instead, so that
+  // neither their information is lost nor the parent hangs.
+  std::vector<vtkIdType> pendingLengths;
+  std::vector<unsigned char> pendingData;
+  vtkClientServerStream rcvStream;
+  for (int step = 1; step < nranks; step <<= 1)
+    {
+    if ((rank & step) != 0)
+      {
+      vtkClientServerStream stream;
+      const unsigned char* data = pendingData.empty()? NULL : &pendingData[0];
+      if (info)
+        {
+        size_t length = 0;
+        info->CopyToStream(&stream);
+        stream.GetData(&data, &length);
+        pendingLengths.assign(1, static_cast<vtkIdType>(length));
+        }
+      vtkIdType count = static_cast<vtkIdType>(pendingLengths.size());
+      vtkIdType total = 0;
+      for (vtkIdType cc = 0; cc < count; ++cc)
+        {
+        total += pendingLengths[cc];
+        }
+      this->ParallelController->Send(&count, 1, rank - step,
+        ROOT_SATELLITE_INFO_TAG);
+      if (count > 0)
+        {
+        this->ParallelController->Send(&pendingLengths[0], count,
+          rank - step, ROOT_SATELLITE_INFO_TAG);
+        }
+      if (total > 0)
+        {
+        this->ParallelController->Send(data, total, rank - step,
+          ROOT_SATELLITE_INFO_TAG);
+        }
+      break;
+      }
+
+    int child = rank + step;
+    if (child < nranks)
+      {
+      vtkIdType count = 0;
+      this->ParallelController->Receive(&count, 1, child,
+        ROOT_SATELLITE_INFO_TAG);
+      if (count == 0)
+        {
+        continue;
+        }
+      std::vector<vtkIdType> lengths(count);
+      this->ParallelController->Receive(&lengths[0], count, child,
+        ROOT_SATELLITE_INFO_TAG);
+      vtkIdType total = 0;
+      for (vtkIdType cc = 0; cc < count; ++cc)
+        {
+        total += lengths[cc];
+        }
+      std::vector<unsigned char> rcvbuffer(total);
+      if (total > 0)
+        {
+        this->ParallelController->Receive(&rcvbuffer[0], total, child,
+          ROOT_SATELLITE_INFO_TAG);
+        }
+      if (!info)
+        {
+        pendingLengths.insert(pendingLengths.end(),
+          lengths.begin(), lengths.end());
+        pendingData.insert(pendingData.end(),
+          rcvbuffer.begin(), rcvbuffer.end());
+        continue;
+        }
+      vtkIdType offset = 0;
+      for (vtkIdType cc = 0; cc < count; ++cc)
+        {
+        if (lengths[cc] > 0)
+          {
+          rcvStream.SetData(&rcvbuffer[offset], lengths[cc]);
+          vtkPVInformation* tempInfo = info->NewInstance();
+          tempInfo->CopyFromStream(&rcvStream);
+          info->AddInformation(tempInfo);
+          tempInfo->Delete();
+          }
+        offset += lengths[cc];
+        }
+      }
+    }
+
+  // Unlike CollectInformationGather(), no barrier is needed: the root cannot
+  // leave the reduction before every satellite has contributed.
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void vtkPVSessionCore::RegisterRemoteObject(vtkTypeUInt32 gid, vtkObject* obj)
 {
@@ -115,6 +115,25 @@ public:
   // GetNumberOfProcesses() on this->ParallelController
   int GetNumberOfProcesses();
 
+  enum InformationReductionModes
+    {
+    GATHER_TO_ROOT = 0,
+    TREE_REDUCTION = 1
+    };
+
+  // Description:
+  // Get/Set how vtkPVInformation objects are collected from MPI satellites.
+  // GATHER_TO_ROOT (default) gathers the serialized information from every
+  // rank on the root and merges them one after the other. TREE_REDUCTION
+  // merges information pairwise along a binomial tree, so that the root only
+  // has to merge log(P) partial results. Only the mode of the root matters:
+  // GatherInformation() sends it to the satellites along with the request.
+  // The default can be changed by setting the PV_INFORMATION_TREE_REDUCTION
+  // environment variable.
+  vtkSetClampMacro(InformationReductionMode, int,
+    GATHER_TO_ROOT, TREE_REDUCTION);
+  vtkGetMacro(InformationReductionMode, int);
+
   // Description:
   // Get/Set the socket connection used to communicate betweeen data=server and
   // render-server processes. This is valid only on data-server and
@@ -185,8 +204,23 @@ protected:
                                   vtkTypeUInt32 globalid );
 
   // Description:
-  // Gather informations across MPI satellites.
-  bool CollectInformation(vtkPVInformation*);
+  // Gather informations across MPI satellites. Dispatches to
+  // CollectInformationGather() or CollectInformationTree() based on mode,
+  // which must be the InformationReductionMode of the root on all ranks.
+  bool CollectInformation(vtkPVInformation*, int mode);
+
+  // Description:
+  // Gather the serialized information from all satellites on the root and
+  // merge them sequentially.
+  bool CollectInformationGather(vtkPVInformation*);
+
+  // Description:
+  // Merge information pairwise along a binomial tree rooted at rank 0. Each
+  // process receives the partial results of its children, merges them using
+  // vtkPVInformation::AddInformation() and forwards the result to its parent.
+  // A process without information forwards the results of its children
+  // unmerged.
+  bool CollectInformationTree(vtkPVInformation*);
 
   // Description:
   // Increment reference count of a local vtkSIObject.
@@ -220,6 +254,7 @@ private:
   class vtkInternals;
   vtkInternals* Internals;
   bool SymmetricMPIMode;
+  int InformationReductionMode;
 
   // Local counter for global Ids
   vtkTypeUInt32 LocalGlobalID;
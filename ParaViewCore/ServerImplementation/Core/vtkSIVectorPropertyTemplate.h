@@ -60,7 +60,7 @@ protected:
 
   // Description:
   // Implements the actual push.
-  bool Push(T* values, int number_of_elements);
+  bool Push(const T* values, int number_of_elements);
 
   bool ArgumentIsArray;
 
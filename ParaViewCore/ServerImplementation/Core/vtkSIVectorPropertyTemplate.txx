@@ -22,10 +22,32 @@
 
 #include <vector>
 #include <assert.h>
+#include <cstring>
 #include <sstream>
 
 namespace
 {
+  // Append the elements of an array argument to values, converting them to
+  // T. The elements are read in place from the stream buffer (see
+  // vtkClientServerStream::GetArgument(int, int, Array*)) so no temporary
+  // buffer is needed when the stream type differs from T.
+  template <class SourceType, class T>
+  void AppendArray(std::vector<T>& values,
+    const vtkClientServerStream::Array& array)
+    {
+    size_t cur_size = values.size();
+    values.resize(cur_size + array.Length);
+    const unsigned char* data =
+      static_cast<const unsigned char*>(array.Data);
+    for (vtkTypeUInt32 cc = 0; cc < array.Length; ++cc)
+      {
+      // the stream does not guarantee alignment, use memcpy.
+      SourceType value;
+      memcpy(&value, data + cc * sizeof(SourceType), sizeof(SourceType));
+      values[cur_size + cc] = static_cast<T>(value);
+      }
+    }
+
   // ********* INT *************
   vtkMaybeUnused("not used for non-int specializations")
   std::vector<int>&
@@ -80,55 +102,29 @@ namespace
       values[cur_size] = ires;
       return true;
       }
-    // if array, only 32 bit ints work
-    else if (argType == vtkClientServerStream::int32_array)
-      {
-      vtkTypeUInt32 length;
-      stream.GetArgumentLength(0, 0, &length);
-      values.resize(cur_size + length);
-      int retVal = stream.GetArgument(0, 0, &values[cur_size], length);
-      if (!retVal)
-        {
-        values.resize(cur_size);
-        return false;
-        }
-      return true;
-      }
-
-#define copy_to_vector(type)                                      \
-  do                                                              \
-    {                                                             \
-    vtkTypeUInt32 length;                                         \
-    stream.GetArgumentLength(0, 0, &length);                      \
-    std::vector<type> tmp_vec(length);                            \
-    int retVal = stream.GetArgument(0, 0, &tmp_vec[0], length);   \
-    if (!retVal)                                                  \
-      {                                                           \
-      return false;                                               \
-      }                                                           \
-    values.resize(cur_size + length);                             \
-    std::copy(tmp_vec.begin(), tmp_vec.end(), &values[cur_size]); \
-    return true;                                                  \
-    } while (0)
-
-    // match the type for uint32
-    else if (argType == vtkClientServerStream::uint32_array)
+    // if array, 32 and 64 bit ints work; 64 bit ints are squashed into 32 bit
+    vtkClientServerStream::Array array;
+    if (!stream.GetArgument(0, 0, &array))
       {
-      copy_to_vector(vtkTypeUInt32);
+      return false;
       }
-    // if 64 bit array, squash into 32 bit
-    else if (argType == vtkClientServerStream::int64_array)
+    switch (array.Type)
       {
-      copy_to_vector(vtkTypeInt64);
-      }
-    else if (argType == vtkClientServerStream::uint64_array)
-      {
-      copy_to_vector(vtkTypeUInt64);
+      case vtkClientServerStream::int32_array:
+        AppendArray<vtkTypeInt32>(values, array);
+        return true;
+      case vtkClientServerStream::uint32_array:
+        AppendArray<vtkTypeUInt32>(values, array);
+        return true;
+      case vtkClientServerStream::int64_array:
+        AppendArray<vtkTypeInt64>(values, array);
+        return true;
+      case vtkClientServerStream::uint64_array:
+        AppendArray<vtkTypeUInt64>(values, array);
+        return true;
+      default:
+        return false;
       }
-
-#undef copy_to_vector
-
-    return false;
     }
 
   // ********* DOUBLE *************
@@ -176,35 +172,27 @@ namespace
       values.resize(cur_size + 1);
       values[cur_size] = ires;
       }
-    // If array, handle 32 bit and 64 bit separately
-    else if (argType == vtkClientServerStream::float64_array)
+    else
       {
-      vtkTypeUInt32 length;
-      stream.GetArgumentLength(0, 0, &length);
-      values.resize(cur_size + length);
-      int retVal = stream.GetArgument(0, 0, &values[cur_size], length);
-      if (!retVal)
+      // If array, both 32 bit and 64 bit floats work
+      vtkClientServerStream::Array array;
+      if (!stream.GetArgument(0, 0, &array))
         {
         return false;
         }
-      }
-    else if (argType == vtkClientServerStream::float32_array)
-      {
-      vtkTypeUInt32 length;
-      stream.GetArgumentLength(0, 0, &length);
-      float *fvalues = new float[length+1];
-      int retVal = stream.GetArgument(0, 0, fvalues, length);
-      if (!retVal)
+      switch (array.Type)
         {
-        delete [] fvalues;
-        return false;
+        case vtkClientServerStream::float64_array:
+          AppendArray<vtkTypeFloat64>(values, array);
+          break;
+        case vtkClientServerStream::float32_array:
+          AppendArray<vtkTypeFloat32>(values, array);
+          break;
+        default:
+          return false;
         }
-
-      values.resize(cur_size + length);
-      delete [] fvalues;
-      std::copy(fvalues, fvalues + length, &values[cur_size]);
       }
-    return false;
+    return true;
     }
 
   // ********* vtkIdType *************
@@ -250,21 +238,22 @@ namespace
       return true;
       }
     // if array, only 32 or 64 bit ints work
-    else if (argType == vtkClientServerStream::int32_array ||
-      argType == vtkClientServerStream::int64_value)
+    vtkClientServerStream::Array array;
+    if (!stream.GetArgument(0, 0, &array))
       {
-      vtkTypeUInt32 length;
-      stream.GetArgumentLength(0, 0, &length);
-      values.resize(cur_size + length);
-      int retVal = stream.GetArgument(0, 0, &values[cur_size], length);
-      if (!retVal)
-        {
-        values.resize(cur_size);
+      return false;
+      }
+    switch (array.Type)
+      {
+      case vtkClientServerStream::int32_array:
+        AppendArray<vtkTypeInt32>(values, array);
+        return true;
+      case vtkClientServerStream::int64_array:
+        AppendArray<vtkTypeInt64>(values, array);
+        return true;
+      default:
         return false;
-        }
-      return true;
       }
-    return false;
     }
 
 #if VTK_SIZEOF_ID_TYPE != VTK_SIZEOF_INT
@@ -290,6 +279,43 @@ namespace
     }
 #endif
 
+  // Access the values stored in a Variant in place, avoiding the copy into a
+  // std::vector when the protobuf storage already matches T.
+  template <class T>
+  bool GetVariantValues(const Variant&, const T**, int*)
+    {
+    return false;
+    }
+
+  vtkMaybeUnused("not used for non-int specializations")
+  bool GetVariantValues(const Variant& variant, const int** values, int* count)
+    {
+    *count = variant.integer_size();
+    *values = variant.integer().data();
+    return true;
+    }
+
+  vtkMaybeUnused("not used for non-double specializations")
+  bool GetVariantValues(const Variant& variant, const double** values, int* count)
+    {
+    *count = variant.float64_size();
+    *values = variant.float64().data();
+    return true;
+    }
+
+  vtkMaybeUnused("not used for non-vtkIdType specializations")
+  bool GetVariantIdTypeValues(const Variant& variant,
+    const vtkIdType** values, int* count)
+    {
+    if (sizeof(vtkIdType) != sizeof(*variant.idtype().data()))
+      {
+      return false;
+      }
+    *count = variant.idtype_size();
+    *values = reinterpret_cast<const vtkIdType*>(variant.idtype().data());
+    return true;
+    }
+
   // This absurdity is needed for cases where vtkIdType == int.
   template <class TARG1, class TARG2, class force_idtype>
   void AppendValues(TARG1& arg1, const TARG2& arg2, const force_idtype&)
@@ -302,6 +328,20 @@ namespace
     {
     OperatorIdType(arg1, arg2);
     }
+
+  template <class T, class force_idtype>
+  bool GetValues(const Variant& variant, const T** values, int* count,
+    const force_idtype&)
+    {
+    return GetVariantValues(variant, values, count);
+    }
+
+  template <class T>
+  bool GetValues(const Variant& variant, const T** values, int* count,
+    const bool&)
+    {
+    return GetVariantIdTypeValues(variant, values, count);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -331,6 +371,15 @@ bool vtkSIVectorPropertyTemplate<T, force_idtype>::Push(vtkSMMessage* message, i
   this->SaveValueToCache(message, offset);
 
   const Variant *variant = &prop->value();
+
+  // Push directly from the message storage when possible.
+  const T* data = NULL;
+  int count = 0;
+  if (GetValues(*variant, &data, &count, force_idtype()))
+    {
+    return this->Push(count > 0? data : NULL, count);
+    }
+
   std::vector<T> values;
 
   AppendValues(values, *variant, force_idtype());
@@ -393,7 +442,8 @@ bool vtkSIVectorPropertyTemplate<T, force_idtype>::Pull(vtkSMMessage* message)
 
 //---------------------------------------------------------------------------
 template <class T, class force_idtype>
-bool vtkSIVectorPropertyTemplate<T, force_idtype>::Push(T* values, int number_of_elements)
+bool vtkSIVectorPropertyTemplate<T, force_idtype>::Push(
+  const T* values, int number_of_elements)
 {
   if (this->InformationOnly || !this->Command)
     {
@@ -401,6 +451,8 @@ bool vtkSIVectorPropertyTemplate<T, force_idtype>::Push(T* values, int number_of
     }
 
   vtkClientServerStream stream;
+  // Avoid reallocations while streaming large vectors.
+  stream.Reserve(256 + number_of_elements * (sizeof(T) + 4));
   vtkObjectBase* object = this->GetVTKObject();
 
   if (this->CleanCommand)
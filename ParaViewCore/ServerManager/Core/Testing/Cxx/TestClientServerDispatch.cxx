@@ -0,0 +1,162 @@
+/*=========================================================================
+
+Program:   ParaView
+Module:    TestClientServerDispatch.cxx
+
+Copyright (c) Kitware, Inc.
+All rights reserved.
+See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Micro-benchmark for the method dispatch of the generated ClientServer
+// wrappers. It replays a stream similar to the one produced when loading a
+// state file (object creation followed by many property pushes) through
+// vtkClientServerInterpreter::ProcessStream() and reports messages/sec. It
+// also checks that overloads and superclass methods are still resolved.
+
+#include "vtkClientServerID.h"
+#include "vtkClientServerInterpreter.h"
+#include "vtkClientServerInterpreterInitializer.h"
+#include "vtkClientServerStream.h"
+#include "vtkInitializationHelper.h"
+#include "vtkProcessModule.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+namespace
+{
+  const int NumberOfObjects = 1000;
+  const int NumberOfRepeats = 10;
+
+  void BuildStateLoadStream(vtkClientServerStream& stream)
+    {
+    for (int cc = 0; cc < NumberOfObjects; ++cc)
+      {
+      vtkClientServerID sphere(1000 + 2*cc);
+      vtkClientServerID geometry(1000 + 2*cc + 1);
+      stream << vtkClientServerStream::New << "vtkSphereSource" << sphere
+             << vtkClientServerStream::End;
+      stream << vtkClientServerStream::New << "vtkPVGeometryFilter" << geometry
+             << vtkClientServerStream::End;
+
+      stream << vtkClientServerStream::Invoke << sphere << "SetRadius" << 0.5
+             << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << sphere << "SetCenter"
+             << 0.0 << 1.0 << 2.0 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << sphere
+             << "SetThetaResolution" << 16 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << sphere
+             << "SetPhiResolution" << 16 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << sphere
+             << "SetStartTheta" << 0.0 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << sphere
+             << "SetEndTheta" << 360.0 << vtkClientServerStream::End;
+
+      stream << vtkClientServerStream::Invoke << geometry
+             << "SetUseOutline" << 0 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << geometry
+             << "SetGenerateCellNormals" << 1 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << geometry
+             << "SetTriangulate" << 0 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << geometry
+             << "SetNonlinearSubdivisionLevel" << 1 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << geometry
+             << "SetPassThroughCellIds" << 1 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << geometry
+             << "SetPassThroughPointIds" << 1 << vtkClientServerStream::End;
+      // superclass methods (vtkAlgorithm, vtkObject).
+      stream << vtkClientServerStream::Invoke << geometry
+             << "SetReleaseDataFlag" << 0 << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Invoke << geometry
+             << "Modified" << vtkClientServerStream::End;
+
+      stream << vtkClientServerStream::Delete << geometry
+             << vtkClientServerStream::End;
+      stream << vtkClientServerStream::Delete << sphere
+             << vtkClientServerStream::End;
+      }
+    }
+}
+
+int TestClientServerDispatch(int argc, char* argv[])
+{
+  (void) argc;
+
+  vtkInitializationHelper::Initialize(argv[0], vtkProcessModule::PROCESS_CLIENT);
+
+  vtkSmartPointer<vtkClientServerInterpreter> interp;
+  interp.TakeReference(
+    vtkClientServerInterpreterInitializer::GetInitializer()->NewInterpreter());
+
+  // Check that methods from the class, an overload and a superclass method
+  // are all found.
+  vtkClientServerID id(10);
+  vtkClientServerStream check;
+  check << vtkClientServerStream::New << "vtkSphereSource" << id
+        << vtkClientServerStream::End;
+  check << vtkClientServerStream::Invoke << id << "SetCenter"
+        << 1.0 << 2.0 << 3.0 << vtkClientServerStream::End;
+  check << vtkClientServerStream::Invoke << id << "SetThetaResolution"
+        << 12 << vtkClientServerStream::End;
+  check << vtkClientServerStream::Invoke << id << "GetThetaResolution"
+        << vtkClientServerStream::End;
+  if (!interp->ProcessStream(check))
+    {
+    cerr << "ERROR: failed to process check stream." << endl;
+    return EXIT_FAILURE;
+    }
+  int resolution = 0;
+  if (!interp->GetLastResult().GetArgument(0, 0, &resolution) ||
+    resolution != 12)
+    {
+    cerr << "ERROR: unexpected GetThetaResolution result." << endl;
+    return EXIT_FAILURE;
+    }
+  check.Reset();
+  // vtkSphereSource inherits both from vtkAlgorithm.
+  check << vtkClientServerStream::Invoke << id << "SetReleaseDataFlag"
+        << 1 << vtkClientServerStream::End;
+  check << vtkClientServerStream::Invoke << id << "GetReleaseDataFlag"
+        << vtkClientServerStream::End;
+  int releaseDataFlag = 0;
+  if (!interp->ProcessStream(check) ||
+    !interp->GetLastResult().GetArgument(0, 0, &releaseDataFlag) ||
+    releaseDataFlag != 1)
+    {
+    cerr << "ERROR: superclass method not dispatched." << endl;
+    return EXIT_FAILURE;
+    }
+  check.Reset();
+  check << vtkClientServerStream::Delete << id << vtkClientServerStream::End;
+  interp->ProcessStream(check);
+
+  vtkClientServerStream stream;
+  BuildStateLoadStream(stream);
+  int numberOfMessages = stream.GetNumberOfMessages();
+
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  timer->StartTimer();
+  for (int cc = 0; cc < NumberOfRepeats; ++cc)
+    {
+    if (!interp->ProcessStream(stream))
+      {
+      cerr << "ERROR: failed to process state-load stream." << endl;
+      return EXIT_FAILURE;
+      }
+    }
+  timer->StopTimer();
+
+  double elapsed = timer->GetElapsedTime();
+  cout << "Processed " << numberOfMessages * NumberOfRepeats
+       << " messages in " << elapsed << " s ("
+       << (elapsed > 0? numberOfMessages * NumberOfRepeats / elapsed : 0.0)
+       << " messages/sec)" << endl;
+
+  interp = NULL;
+  vtkInitializationHelper::Finalize();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+/*=========================================================================
+
+Program:   ParaView
+Module:    TestLargeVectorPropertyPush.cxx
+
+Copyright (c) Kitware, Inc.
+All rights reserved.
+See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Benchmark pushing large vector properties (e.g. selection id lists) through
+// a builtin session.
+
+#include "vtkInitializationHelper.h"
+#include "vtkNew.h"
+#include "vtkProcessModule.h"
+#include "vtkSMIdTypeVectorProperty.h"
+#include "vtkSMProxy.h"
+#include "vtkSMSession.h"
+#include "vtkSMSessionProxyManager.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+#include <vector>
+
+int TestLargeVectorPropertyPush(int argc, char* argv[])
+{
+  (void) argc;
+  vtkInitializationHelper::Initialize(argv[0], vtkProcessModule::PROCESS_CLIENT);
+
+  vtkSMSession* session = vtkSMSession::New();
+  vtkSMSessionProxyManager* pxm = session->GetSessionProxyManager();
+
+  vtkSmartPointer<vtkSMProxy> selection;
+  selection.TakeReference(pxm->NewProxy("sources", "IDSelectionSource"));
+  selection->UpdateVTKObjects();
+
+  vtkSMIdTypeVectorProperty* ids = vtkSMIdTypeVectorProperty::SafeDownCast(
+    selection->GetProperty("IDs"));
+  if (!ids)
+    {
+    cerr << "Missing IDs property." << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkTimerLog> timer;
+  for (vtkIdType numIds = 1000; numIds <= 1000000; numIds *= 10)
+    {
+    // (process, id) pairs.
+    std::vector<vtkIdType> values(2 * numIds);
+    for (vtkIdType cc = 0; cc < numIds; ++cc)
+      {
+      values[2*cc] = 0;
+      values[2*cc + 1] = cc;
+      }
+    ids->SetElements(&values[0], static_cast<unsigned int>(values.size()));
+
+    timer->StartTimer();
+    selection->UpdateVTKObjects();
+    timer->StopTimer();
+
+    double elapsed = timer->GetElapsedTime();
+    cout << "Pushed " << values.size() << " elements in " << elapsed
+         << " s (" << (elapsed > 0? values.size() / elapsed : 0.0)
+         << " elements/sec)" << endl;
+    }
+
+  selection = NULL;
+  session->Delete();
+  vtkInitializationHelper::Finalize();
+  return EXIT_SUCCESS;
+}
@@ -15,6 +15,7 @@
 #include "vtkPVGeneralSettings.h"
 
 #include "vtkCacheSizeKeeper.h"
+#include "vtkFileSeriesReader.h"
 #include "vtkObjectFactory.h"
 #include "vtkProcessModuleAutoMPI.h"
 #include "vtkSISourceProxy.h"
@@ -48,6 +49,7 @@ vtkPVGeneralSettings::vtkPVGeneralSettings()
   ScalarBarMode(vtkPVGeneralSettings::AUTOMATICALLY_HIDE_SCALAR_BARS),
   CacheGeometryForAnimation(false),
   AnimationGeometryCacheLimit(0),
+  AnimationGeometryCacheSpillToDisk(false),
   PropertiesPanelMode(vtkPVGeneralSettings::ALL_IN_ONE)
 {
   this->SetDefaultViewType("RenderView");
@@ -135,6 +137,7 @@ void vtkPVGeneralSettings::SetAnimationGeometryCacheLimit(unsigned long val)
 {
   vtkCacheSizeKeeper::GetInstance()->SetCacheLimit(
     this->CacheGeometryForAnimation? val : 0);
+  vtkFileSeriesReader::SetPrefetchLimit(val);
   if (this->AnimationGeometryCacheLimit != val)
     {
     this->AnimationGeometryCacheLimit = val;
@@ -142,6 +145,46 @@ void vtkPVGeneralSettings::SetAnimationGeometryCacheLimit(unsigned long val)
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkPVGeneralSettings::SetAnimationGeometryCacheSpillToDisk(bool val)
+{
+  vtkCacheSizeKeeper::GetInstance()->SetSpillToDisk(val);
+  if (this->AnimationGeometryCacheSpillToDisk != val)
+    {
+    this->AnimationGeometryCacheSpillToDisk = val;
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkPVGeneralSettings::SetAnimationGeometryCacheDirectory(const char* dir)
+{
+  vtkCacheSizeKeeper::GetInstance()->SetSpillDirectory(dir);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+const char* vtkPVGeneralSettings::GetAnimationGeometryCacheDirectory()
+{
+  return vtkCacheSizeKeeper::GetInstance()->GetSpillDirectory();
+}
+
+//----------------------------------------------------------------------------
+void vtkPVGeneralSettings::SetAnimationPrefetchTimeSteps(int val)
+{
+  if (this->GetAnimationPrefetchTimeSteps() != val)
+    {
+    vtkFileSeriesReader::SetNumberOfPrefetchSteps(val);
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkPVGeneralSettings::GetAnimationPrefetchTimeSteps()
+{
+  return vtkFileSeriesReader::GetNumberOfPrefetchSteps();
+}
+
 //----------------------------------------------------------------------------
 void vtkPVGeneralSettings::SetScalarBarMode(int val)
 {
@@ -206,5 +249,9 @@ void vtkPVGeneralSettings::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "ScalarBarMode: " << this->ScalarBarMode << "\n";
   os << indent << "CacheGeometryForAnimation: " << this->CacheGeometryForAnimation << "\n";
   os << indent << "AnimationGeometryCacheLimit: " << this->AnimationGeometryCacheLimit << "\n";
+  os << indent << "AnimationGeometryCacheSpillToDisk: " << this->AnimationGeometryCacheSpillToDisk << "\n";
+  os << indent << "AnimationGeometryCacheDirectory: "
+     << (this->GetAnimationGeometryCacheDirectory()?
+       this->GetAnimationGeometryCacheDirectory() : "(none)") << "\n";
   os << indent << "PropertiesPanelMode: " << this->PropertiesPanelMode << "\n";
 }
@@ -119,10 +119,29 @@ public:
   vtkGetMacro(CacheGeometryForAnimation, bool);
 
   // Description:
-  // Set the animation cache limit in KBs.
+  // Set the animation cache limit in KBs. This also limits the total size of
+  // the files prefetched by file series readers.
   void SetAnimationGeometryCacheLimit(unsigned long val);
   vtkGetMacro(AnimationGeometryCacheLimit, unsigned long);
 
+  // Description:
+  // Set whether animation geometry evicted from the in-memory cache should be
+  // written to a scratch directory instead of being discarded.
+  void SetAnimationGeometryCacheSpillToDisk(bool val);
+  vtkGetMacro(AnimationGeometryCacheSpillToDisk, bool);
+
+  // Description:
+  // Forwarded to vtkCacheSizeKeeper::SetSpillDirectory(): the scratch
+  // directory used to spill the animation geometry cache. When empty, the
+  // system temporary directory is used.
+  void SetAnimationGeometryCacheDirectory(const char* dir);
+  const char* GetAnimationGeometryCacheDirectory();
+
+  // Description:
+  // Forwarded to vtkFileSeriesReader::SetNumberOfPrefetchSteps().
+  void SetAnimationPrefetchTimeSteps(int val);
+  int GetAnimationPrefetchTimeSteps();
+
   // Description:
   // Forwarded for vtkSMParaViewPipelineControllerWithRendering.
   void SetInheritRepresentationProperties(bool val);
@@ -160,6 +179,7 @@ protected:
   int ScalarBarMode;
   bool CacheGeometryForAnimation;
   unsigned long AnimationGeometryCacheLimit;
+  bool AnimationGeometryCacheSpillToDisk;
   int PropertiesPanelMode;
 
 private:
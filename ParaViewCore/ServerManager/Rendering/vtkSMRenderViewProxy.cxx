@@ -273,6 +273,21 @@ vtkTypeUInt32 vtkSMRenderViewProxy::PreRender(bool interactive)
 
   if (interactive && rv->GetUseLODForInteractiveRender())
     {
+    // With a frame-time budget, the time of the last interactive render may
+    // call for another LOD resolution, hence other LOD geometries.
+    double resolution = rv->GetLODResolutionForBudget();
+    if (resolution != rv->GetBudgetLODResolution())
+      {
+      vtkClientServerStream stream;
+      stream << vtkClientServerStream::Invoke
+             << VTKOBJECT(this)
+             << "SetBudgetLODResolution"
+             << resolution
+             << vtkClientServerStream::End;
+      this->ExecuteStream(stream);
+      this->NeedsUpdateLOD = true;
+      }
+
     // for interactive renders, we need to determine if we are going to use LOD.
     // If so, we may need to update the LOD geometries.
     this->UpdateLOD();
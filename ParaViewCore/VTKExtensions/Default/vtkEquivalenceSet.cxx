@@ -34,6 +34,7 @@ vtkStandardNewMacro(vtkEquivalenceSet);
 vtkEquivalenceSet::vtkEquivalenceSet()
 {
   this->Resolved = 0;
+  this->NumberOfResolvedSets = 0;
   this->EquivalenceArray = vtkIntArray::New();
 }
 
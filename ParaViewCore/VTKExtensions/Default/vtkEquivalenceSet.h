@@ -32,8 +32,8 @@ public:
   void PrintSelf(ostream& os, vtkIndent indent);
   static vtkEquivalenceSet *New();
   
-  void Initialize();
-  void AddEquivalence(int id1, int id2);
+  virtual void Initialize();
+  virtual void AddEquivalence(int id1, int id2);
 
   // The length of the equivalent array...
   // The Domain of the equivalance map is [0, numberOfMembers).
@@ -45,7 +45,7 @@ public:
 
 
   // Return the id of the equivalent set.
-  int GetEquivalentSetId(int memberId);
+  virtual int GetEquivalentSetId(int memberId);
 
   // Equivalent set ids are reassinged to be sequential.
   // You cannot add anymore equivalences after this is called.
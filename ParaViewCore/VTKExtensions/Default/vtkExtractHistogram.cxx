@@ -27,10 +27,13 @@
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTable.h"
 
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <string>
@@ -40,15 +43,188 @@ struct vtkEHInternals
   vtkEHInternals() : FieldAssociation(-1) {}
   struct ArrayValuesType
     {
-    // The total of the values per bin - the second vector
-    // is for arrays with multiple components
-    std::vector<std::vector<double> > TotalValues;
+    ArrayValuesType() : NumberOfComponents(0) {}
+    int NumberOfComponents;
+    // The total of the values per bin, NumberOfComponents values per bin.
+    std::vector<double> TotalValues;
     };
   typedef std::map<std::string, ArrayValuesType> ArrayMapType;
   ArrayMapType ArrayValues;
   int FieldAssociation;
 };
 
+namespace
+{
+  // Adds the values of the tuples [begin, end) of an array to the totals of
+  // the bins given by indices. totals has stride values per bin.
+  template <class T>
+  void vtkExtractHistogramAccumulate(const T* data, int numComps,
+    vtkIdType begin, vtkIdType end, const int* indices,
+    double* totals, int stride)
+    {
+    const T* tuple = data + begin * numComps;
+    for (vtkIdType i = begin; i < end; ++i, ++indices, tuple += numComps)
+      {
+      double* total = totals + (*indices) * stride;
+      for (int comp = 0; comp < numComps; ++comp)
+        {
+        total[comp] += static_cast<double>(tuple[comp]);
+        }
+      }
+    }
+
+  // Bins the values of a component of an array concurrently using
+  // vtkSMPTools. Every thread counts into its own bins, and totals the
+  // values of the arrays to average in its own flat buffer, Stride values per
+  // bin. The results of all threads are added in Merge().
+  template <class T>
+  class vtkExtractHistogramBinner
+    {
+  public:
+    // Tuples are binned by blocks of BlockSize, so that the bin index of a
+    // tuple is computed once for all arrays to average.
+    enum { BlockSize = 4096 };
+
+    const T* Data;
+    int NumberOfComponents;
+    double Min;
+    double Delta;
+    int BinCount;
+    const std::vector<vtkDataArray*>& Averaged;
+    const std::vector<int>& Offsets;
+    int Stride;
+    vtkSMPThreadLocal<std::vector<int> > Counts;
+    vtkSMPThreadLocal<std::vector<double> > Totals;
+    vtkSMPThreadLocal<std::vector<int> > Indices;
+
+    vtkExtractHistogramBinner(const T* data, int numComps,
+      double min, double delta, int binCount,
+      const std::vector<vtkDataArray*>& averaged,
+      const std::vector<int>& offsets, int stride) :
+      Data(data), NumberOfComponents(numComps), Min(min), Delta(delta),
+      BinCount(binCount), Averaged(averaged), Offsets(offsets), Stride(stride)
+      {
+      }
+
+    void Initialize()
+      {
+      this->Counts.Local().assign(this->BinCount, 0);
+      this->Totals.Local().assign(
+        static_cast<size_t>(this->BinCount) * this->Stride, 0.0);
+      this->Indices.Local().resize(this->Averaged.empty()? 0 : BlockSize);
+      }
+
+    void operator()(vtkIdType begin, vtkIdType end)
+      {
+      int* counts = &this->Counts.Local()[0];
+      std::vector<int>& indices = this->Indices.Local();
+      const int lastBin = this->BinCount - 1;
+      for (vtkIdType blockBegin = begin; blockBegin < end;
+        blockBegin += BlockSize)
+        {
+        vtkIdType blockEnd = std::min<vtkIdType>(blockBegin + BlockSize, end);
+        const T* value = this->Data + blockBegin * this->NumberOfComponents;
+        for (vtkIdType i = blockBegin; i < blockEnd;
+          ++i, value += this->NumberOfComponents)
+          {
+          int index = static_cast<int>(
+            (static_cast<double>(*value) - this->Min) / this->Delta);
+          // If the value is equal to max, include it in the last bin.
+          index = index < 0 ? 0 : (index > lastBin ? lastBin : index);
+          ++counts[index];
+          if (!indices.empty())
+            {
+            indices[i - blockBegin] = index;
+            }
+          }
+
+        for (size_t cc = 0; cc < this->Averaged.size(); ++cc)
+          {
+          vtkDataArray* array = this->Averaged[cc];
+          double* totals = &this->Totals.Local()[0] + this->Offsets[cc];
+          switch (array->GetDataType())
+            {
+            vtkTemplateMacro(vtkExtractHistogramAccumulate(
+                static_cast<const VTK_TT*>(array->GetVoidPointer(0)),
+                array->GetNumberOfComponents(), blockBegin, blockEnd,
+                &indices[0], totals, this->Stride));
+            }
+          }
+        }
+      }
+
+    void Reduce()
+      {
+      }
+
+    // Adds the counts and totals of all threads to bin_values and to the
+    // totals of the arrays to average.
+    void Merge(vtkIntArray* bin_values,
+      std::vector<vtkEHInternals::ArrayValuesType*>& arrayValues)
+      {
+      int* values = bin_values->GetPointer(0);
+      typename vtkSMPThreadLocal<std::vector<int> >::iterator countIter;
+      for (countIter = this->Counts.begin(); countIter != this->Counts.end();
+        ++countIter)
+        {
+        for (int bin = 0; bin < this->BinCount; ++bin)
+          {
+          values[bin] += (*countIter)[bin];
+          }
+        }
+
+      typename vtkSMPThreadLocal<std::vector<double> >::iterator totalIter;
+      for (totalIter = this->Totals.begin(); totalIter != this->Totals.end();
+        ++totalIter)
+        {
+        for (size_t cc = 0; cc < arrayValues.size(); ++cc)
+          {
+          int numComps = arrayValues[cc]->NumberOfComponents;
+          double* totals = &arrayValues[cc]->TotalValues[0];
+          const double* local = &(*totalIter)[0] + this->Offsets[cc];
+          for (int bin = 0; bin < this->BinCount; ++bin)
+            {
+            for (int comp = 0; comp < numComps; ++comp)
+              {
+              totals[bin * numComps + comp] += local[bin * this->Stride + comp];
+              }
+            }
+          }
+        }
+      }
+    };
+
+  template <class T>
+  void vtkExtractHistogramBin(const T* data, int numComps, int component,
+    vtkIdType numTuples, double min, double delta, int binCount,
+    const std::vector<vtkDataArray*>& averaged,
+    const std::vector<int>& offsets, int stride,
+    vtkIntArray* bin_values,
+    std::vector<vtkEHInternals::ArrayValuesType*>& arrayValues)
+    {
+    vtkExtractHistogramBinner<T> binner(data + component, numComps,
+      min, delta, binCount, averaged, offsets, stride);
+    vtkSMPTools::For(0, numTuples,
+      vtkExtractHistogramBinner<T>::BlockSize * 4, binner);
+    binner.Merge(bin_values, arrayValues);
+    }
+
+  // Returns an array with the values of array that can be accessed through
+  // its raw pointer, i.e. array itself unless it does not have the standard
+  // memory layout or is a bit array.
+  vtkSmartPointer<vtkDataArray> vtkExtractHistogramContiguous(
+    vtkDataArray* array)
+    {
+    if (array->HasStandardMemoryLayout() && array->GetDataType() != VTK_BIT)
+      {
+      return array;
+      }
+    vtkSmartPointer<vtkDoubleArray> copy = vtkSmartPointer<vtkDoubleArray>::New();
+    copy->DeepCopy(array);
+    return copy.GetPointer();
+    }
+}
+
 vtkStandardNewMacro(vtkExtractHistogram);
 //-----------------------------------------------------------------------------
 vtkExtractHistogram::vtkExtractHistogram() :
@@ -63,6 +239,7 @@ vtkExtractHistogram::vtkExtractHistogram() :
     vtkDataSetAttributes::SCALARS);
   this->Internal = new vtkEHInternals;
   this->CalculateAverages = 0;
+  this->UseConcurrentBinning = true;
   this->UseCustomBinRanges = false;
   this->CustomBinRanges[0] = 0;
   this->CustomBinRanges[1] = 100;
@@ -84,6 +261,8 @@ void vtkExtractHistogram::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "UseCustomBinRanges: " << this->UseCustomBinRanges << endl;
   os << indent << "CustomBinRanges: " <<
     this->CustomBinRanges[0] << ", " << this->CustomBinRanges[1] << endl;
+  os << indent << "UseConcurrentBinning: " << this->UseConcurrentBinning
+     << endl;
 }
 
 //-----------------------------------------------------------------------------
@@ -268,13 +447,6 @@ void vtkExtractHistogram::FillBinExtents(vtkDoubleArray* bin_extents,
 }
 
 
-inline int vtkExtractHistogramClamp(int value, int min, int max)
-{
-  value = value < min ? min : value;
-  value = value > max ? max : value;
-  return value;
-}
-
 //-----------------------------------------------------------------------------
 void vtkExtractHistogram::BinAnArray(vtkDataArray *data_array,
                                      vtkIntArray *bin_values,
@@ -290,6 +462,76 @@ void vtkExtractHistogram::BinAnArray(vtkDataArray *data_array,
     return;
     }
 
+  if (!this->UseConcurrentBinning)
+    {
+    this->BinAnArraySerially(data_array, bin_values, min, max, field);
+    return;
+    }
+
+  this->UpdateProgress(0.10);
+
+  vtkSmartPointer<vtkDataArray> data = ::vtkExtractHistogramContiguous(data_array);
+
+  // Arrays to average, their offset in the per bin totals of a thread and
+  // their accumulated totals. For each bin, the totals are divided by the
+  // number of elements at the end.
+  std::vector<vtkSmartPointer<vtkDataArray> > averagedArrays;
+  std::vector<vtkDataArray*> averaged;
+  std::vector<int> offsets;
+  std::vector<vtkEHInternals::ArrayValuesType*> arrayValues;
+  int stride = 0;
+  if (this->CalculateAverages && field)
+    {
+    int num_arrays = field->GetNumberOfArrays();
+    for (int idx=0; idx<num_arrays; idx++)
+      {
+      vtkDataArray* array = field->GetArray(idx);
+      if (!array || array == data_array || !array->GetName() ||
+        array->GetNumberOfTuples() < data_array->GetNumberOfTuples())
+        {
+        continue;
+        }
+      int numComps = array->GetNumberOfComponents();
+      vtkEHInternals::ArrayValuesType& values =
+        this->Internal->ArrayValues[array->GetName()];
+      if (values.TotalValues.empty())
+        {
+        values.NumberOfComponents = numComps;
+        values.TotalValues.resize(
+          static_cast<size_t>(this->BinCount) * numComps, 0.0);
+        }
+      else if (values.NumberOfComponents != numComps)
+        {
+        // Same name, different number of components in another block.
+        continue;
+        }
+      averagedArrays.push_back(::vtkExtractHistogramContiguous(array));
+      averaged.push_back(averagedArrays.back());
+      offsets.push_back(stride);
+      arrayValues.push_back(&values);
+      stride += numComps;
+      }
+    }
+
+  double bin_delta = (max-min)/this->BinCount;
+  switch (data->GetDataType())
+    {
+    vtkTemplateMacro(::vtkExtractHistogramBin(
+        static_cast<const VTK_TT*>(data->GetVoidPointer(0)),
+        data->GetNumberOfComponents(), this->Component,
+        data->GetNumberOfTuples(), min, bin_delta, this->BinCount,
+        averaged, offsets, stride, bin_values, arrayValues));
+    }
+
+  this->UpdateProgress(1.0);
+}
+
+//-----------------------------------------------------------------------------
+void vtkExtractHistogram::BinAnArraySerially(vtkDataArray *data_array,
+                                             vtkIntArray *bin_values,
+                                             double min, double max,
+                                             vtkFieldData* field)
+{
   int num_of_tuples = data_array->GetNumberOfTuples();
   double bin_delta = (max-min)/this->BinCount;
   for(int i = 0; i != num_of_tuples; ++i)
@@ -301,31 +543,39 @@ void vtkExtractHistogram::BinAnArray(vtkDataArray *data_array,
     const double value = data_array->GetComponent(i, this->Component);
     int index = static_cast<int>((value - min) / bin_delta);
     // If the value is equal to max, include it in the last bin.
-    index = ::vtkExtractHistogramClamp(index, 0, this->BinCount-1);
+    index = index < 0 ? 0 : (index > this->BinCount-1 ? this->BinCount-1 : index);
     bin_values->SetValue(index, bin_values->GetValue(index)+1);
 
-    if (this->CalculateAverages)
+    if (this->CalculateAverages && field)
       {
-      // Get all other arrays, add their value to the bin
-      // For each bin, we will need 2 values per array ->
-      // total, num. elements
-      // at the end, divide each total by num. elements
+      // Get all other arrays, add their value to the bin. For each bin, the
+      // totals are divided by the number of elements at the end.
       int num_arrays = field->GetNumberOfArrays();
       for (int idx=0; idx<num_arrays; idx++)
         {
         vtkDataArray* array = field->GetArray(idx);
-        if (array && array != data_array && array->GetName())
+        if (!array || array == data_array || !array->GetName() ||
+          array->GetNumberOfTuples() < num_of_tuples)
           {
-          vtkEHInternals::ArrayValuesType& arrayValues =
-            this->Internal->ArrayValues[array->GetName()];
-          arrayValues.TotalValues.resize(this->BinCount);
-          int numComps = array->GetNumberOfComponents();
-          arrayValues.TotalValues[index].resize(numComps);
-          for (int comp=0; comp<numComps; comp++)
-            {
-            arrayValues.TotalValues[index][comp] +=
-              array->GetComponent(i, comp);
-            }
+          continue;
+          }
+        int numComps = array->GetNumberOfComponents();
+        vtkEHInternals::ArrayValuesType& values =
+          this->Internal->ArrayValues[array->GetName()];
+        if (values.TotalValues.empty())
+          {
+          values.NumberOfComponents = numComps;
+          values.TotalValues.resize(
+            static_cast<size_t>(this->BinCount) * numComps, 0.0);
+          }
+        else if (values.NumberOfComponents != numComps)
+          {
+          continue;
+          }
+        for (int comp=0; comp<numComps; comp++)
+          {
+          values.TotalValues[index*numComps+comp] +=
+            array->GetComponent(i, comp);
           }
         }
       }
@@ -418,7 +668,7 @@ int vtkExtractHistogram::RequestData(vtkInformation* /*request*/,
         vtkSmartPointer<vtkDoubleArray>::New();
       std::string newname2 = iter->first + "_average";
       aa->SetName(newname2.c_str());
-      int numComps = static_cast<int>(iter->second.TotalValues[0].size());
+      int numComps = iter->second.NumberOfComponents;
       da->SetNumberOfComponents(numComps);
       da->SetNumberOfTuples(this->BinCount);
       aa->SetNumberOfComponents(numComps);
@@ -427,22 +677,14 @@ int vtkExtractHistogram::RequestData(vtkInformation* /*request*/,
         {
         for (int j=0; j<numComps; j++)
           {
-          if (iter->second.TotalValues[i].size() == (unsigned int)numComps)
+          double total = iter->second.TotalValues[i*numComps+j];
+          da->SetValue(i*numComps+j, total);
+          if (bin_values->GetValue(i))
             {
-            da->SetValue(i*numComps+j, iter->second.TotalValues[i][j]);
-            if (bin_values->GetValue(i))
-              {
-              aa->SetValue(i*numComps+j,
-                iter->second.TotalValues[i][j]/bin_values->GetValue(i));
-              }
-            else
-              {
-              aa->SetValue(i*numComps+j, 0);
-              }
+            aa->SetValue(i*numComps+j, total/bin_values->GetValue(i));
             }
           else
             {
-            da->SetValue(i*numComps+j, 0);
             aa->SetValue(i*numComps+j, 0);
             }
           }
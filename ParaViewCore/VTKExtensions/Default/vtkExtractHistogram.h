@@ -71,6 +71,14 @@ public:
   vtkSetMacro(CalculateAverages, int);
   vtkGetMacro(CalculateAverages, int);
   vtkBooleanMacro(CalculateAverages, int);
+
+  // Description:
+  // When on (the default), bin the values with a typed kernel, concurrently.
+  // When off, read them one at a time through vtkDataArray::GetComponent()
+  // on the calling thread, as earlier versions did.
+  vtkSetMacro(UseConcurrentBinning, bool);
+  vtkGetMacro(UseConcurrentBinning, bool);
+  vtkBooleanMacro(UseConcurrentBinning, bool);
   
 protected: 
   vtkExtractHistogram();
@@ -103,6 +111,15 @@ protected:
     double min, double max,
     vtkFieldData* field);
 
+  // Description:
+  // Bins the array one value at a time, used when UseConcurrentBinning is
+  // off.
+  void BinAnArraySerially(
+    vtkDataArray *src,
+    vtkIntArray *vals,
+    double min, double max,
+    vtkFieldData* field);
+
   void FillBinExtents(vtkDoubleArray* bin_extents, double min, double max);
 
   double CustomBinRanges[2];
@@ -110,6 +127,7 @@ protected:
   int Component;
   int BinCount;
   int CalculateAverages;
+  bool UseConcurrentBinning;
 
   vtkEHInternals* Internal;
   
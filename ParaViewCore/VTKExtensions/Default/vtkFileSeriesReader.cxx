@@ -27,22 +27,29 @@
 #include "vtkClientServerInterpreterInitializer.h"
 #include "vtkClientServerInterpreter.h"
 #include "vtkClientServerStream.h"
+#include "vtkConditionVariable.h"
 #include "vtkGenericDataObjectReader.h"
 #include "vtkInformation.h"
 #include "vtkInformationIntegerKey.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
 #include "vtkObjectFactory.h"
 #include "vtkStdString.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStringArray.h"
 #include "vtkTypeTraits.h"
 
+#include <vtksys/SystemTools.hxx>
+
 #include "vtkSmartPointer.h"
 #define VTK_CREATE(type, name) \
   vtkSmartPointer<type> name = vtkSmartPointer<type>::New()
 
 #include <algorithm>
+#include <cstdlib>
+#include <deque>
 #include <map>
 #include <set>
 #include <string>
@@ -367,14 +374,118 @@ namespace
     };
 }
 
+//=============================================================================
+// Reads files on a background thread so that they are in the operating
+// system's file cache by the time the reader asks for them.
+class vtkFileSeriesReaderPrefetcher
+{
+public:
+  vtkFileSeriesReaderPrefetcher()
+    : Mutex(vtkSmartPointer<vtkMutexLock>::New()),
+    Condition(vtkSmartPointer<vtkConditionVariable>::New()),
+    Threader(vtkSmartPointer<vtkMultiThreader>::New()),
+    ThreadId(-1), Terminate(false)
+    {
+    }
+
+  ~vtkFileSeriesReaderPrefetcher()
+    {
+    if (this->ThreadId >= 0)
+      {
+      this->Mutex->Lock();
+      this->Terminate = true;
+      this->Mutex->Unlock();
+      this->Condition->Broadcast();
+      this->Threader->TerminateThread(this->ThreadId);
+      }
+    }
+
+  // Queues files to be read. When \c replace is true, files still pending
+  // from previous calls are dropped.
+  void Schedule(const std::vector<std::string>& files, bool replace)
+    {
+    if (this->ThreadId < 0)
+      {
+      this->ThreadId = this->Threader->SpawnThread(
+        &vtkFileSeriesReaderPrefetcher::ThreadMain, this);
+      }
+    this->Mutex->Lock();
+    if (replace)
+      {
+      this->Queue.clear();
+      }
+    this->Queue.insert(this->Queue.end(), files.begin(), files.end());
+    this->Mutex->Unlock();
+    this->Condition->Signal();
+    }
+
+private:
+  static VTK_THREAD_RETURN_TYPE ThreadMain(void* arg)
+    {
+    vtkMultiThreader::ThreadInfo* info =
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    static_cast<vtkFileSeriesReaderPrefetcher*>(info->UserData)->Run();
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
+  void Run()
+    {
+    std::vector<char> buffer(1 << 20);
+    this->Mutex->Lock();
+    while (!this->Terminate)
+      {
+      if (this->Queue.empty())
+        {
+        this->Condition->Wait(this->Mutex);
+        continue;
+        }
+      std::string fname = this->Queue.front();
+      this->Queue.pop_front();
+      this->Mutex->Unlock();
+
+      // The data is discarded, reading it is enough to bring it in the file
+      // cache.
+      ifstream file(fname.c_str(), ios::in | ios::binary);
+      bool terminate = false;
+      while (file && !terminate)
+        {
+        file.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+        this->Mutex->Lock();
+        terminate = this->Terminate;
+        this->Mutex->Unlock();
+        }
+
+      this->Mutex->Lock();
+      }
+    this->Mutex->Unlock();
+    }
+
+  vtkSmartPointer<vtkMutexLock> Mutex;
+  vtkSmartPointer<vtkConditionVariable> Condition;
+  vtkSmartPointer<vtkMultiThreader> Threader;
+  int ThreadId;
+  std::deque<std::string> Queue;
+  bool Terminate;
+};
+
 //=============================================================================
 struct vtkFileSeriesReaderInternals
 {
   std::vector<std::string> FileNames;
   bool FileNameIsSet;
   vtkFileSeriesReaderTimeRanges *TimeRanges;
+
+  // Prefetching state. The last two requested indices give the direction of
+  // playback.
+  vtkFileSeriesReaderPrefetcher *Prefetcher;
+  int LastRequestedIndex;
+  int LastDirection;
+  std::set<int> PrefetchedIndices;
 };
 
+int vtkFileSeriesReader::NumberOfPrefetchSteps = 0;
+unsigned long vtkFileSeriesReader::PrefetchLimit = 100*1024; // 100 MBs.
+
 //=============================================================================
 vtkFileSeriesReader::vtkFileSeriesReader()
 {
@@ -384,6 +495,9 @@ vtkFileSeriesReader::vtkFileSeriesReader()
   this->Internal = new vtkFileSeriesReaderInternals;
   this->Internal->FileNameIsSet = false;
   this->Internal->TimeRanges = new vtkFileSeriesReaderTimeRanges;
+  this->Internal->Prefetcher = NULL;
+  this->Internal->LastRequestedIndex = -1;
+  this->Internal->LastDirection = 0;
 
   this->UseMetaFile = 0;
 
@@ -393,6 +507,7 @@ vtkFileSeriesReader::vtkFileSeriesReader()
 //-----------------------------------------------------------------------------
 vtkFileSeriesReader::~vtkFileSeriesReader()
 {
+  delete this->Internal->Prefetcher;
   delete this->Internal->TimeRanges;
   delete this->Internal;
 }
@@ -422,6 +537,9 @@ void vtkFileSeriesReader::AddFileNameInternal(const char* name)
 void vtkFileSeriesReader::RemoveAllFileNamesInternal()
 {
   this->Internal->FileNames.clear();
+  this->Internal->PrefetchedIndices.clear();
+  this->Internal->LastRequestedIndex = -1;
+  this->Internal->LastDirection = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -635,6 +753,8 @@ int vtkFileSeriesReader::RequestUpdateExtent(
   // RequestInformation has been called.
   this->RequestInformationForInput(index);
 
+  this->SchedulePrefetch(index);
+
   // I commented out the following block because it is probably not important
   // and it is causing a crash in some circumstances (bug #7253).
 #if 0
@@ -796,6 +916,9 @@ void vtkFileSeriesReader::UpdateMetaData()
     // RemoveAllFileNames() since those change the MTime of this class in
     // ProcessRequest() method.
     this->Internal->FileNames.clear();
+    this->Internal->PrefetchedIndices.clear();
+    this->Internal->LastRequestedIndex = -1;
+    this->Internal->LastDirection = 0;
     for (int i = 0; i < dataFiles->GetNumberOfValues(); i++)
       {
       this->Internal->FileNames.push_back(dataFiles->GetValue(i));
@@ -820,6 +943,9 @@ void vtkFileSeriesReader::PrintSelf(ostream& os, vtkIndent indent)
      << (this->_MetaFileName?this->_MetaFileName:"(none)") << endl;
   os << indent << "UseMetaFile: " << this->UseMetaFile << endl;
   os << indent << "IgnoreReaderTime: " << this->IgnoreReaderTime << endl;
+  os << indent << "NumberOfPrefetchSteps: "
+     << vtkFileSeriesReader::NumberOfPrefetchSteps << endl;
+  os << indent << "PrefetchLimit: " << vtkFileSeriesReader::PrefetchLimit << endl;
 }
 
 //-----------------------------------------------------------------------------
@@ -827,3 +953,89 @@ int vtkFileSeriesReader::ChooseInput(vtkInformation* outInfo)
 {
   return this->Internal->TimeRanges->ChooseInput(outInfo);
 }
+
+//-----------------------------------------------------------------------------
+void vtkFileSeriesReader::SchedulePrefetch(int index)
+{
+  int last = this->Internal->LastRequestedIndex;
+  this->Internal->LastRequestedIndex = index;
+
+  int numFiles = static_cast<int>(this->GetNumberOfFileNames());
+  if (vtkFileSeriesReader::NumberOfPrefetchSteps <= 0 || last < 0 ||
+    last == index || numFiles < 2)
+    {
+    return;
+    }
+
+  // Assume playback continues in the same direction, wrapping around as the
+  // animation does when looping. A jump over more than half of the series is
+  // taken to be such a wrap around rather than a change of direction.
+  int direction = (index > last)? 1 : -1;
+  if (2 * std::abs(index - last) > numFiles &&
+    this->Internal->LastDirection != 0)
+    {
+    direction = this->Internal->LastDirection;
+    }
+  // Files pending for the previous direction are no longer useful.
+  bool replace = (direction != this->Internal->LastDirection);
+  this->Internal->LastDirection = direction;
+
+  unsigned long long limit =
+    static_cast<unsigned long long>(vtkFileSeriesReader::PrefetchLimit) * 1024;
+  unsigned long long total = 0;
+  std::set<int> window;
+  std::vector<std::string> files;
+  window.insert(index);
+  for (int cc = 1; cc <= vtkFileSeriesReader::NumberOfPrefetchSteps &&
+    cc < numFiles; ++cc)
+    {
+    int next = ((index + direction * cc) % numFiles + numFiles) % numFiles;
+    const std::string& fname = this->Internal->FileNames[next];
+    total += vtksys::SystemTools::FileLength(fname.c_str());
+    if (total > limit)
+      {
+      break;
+      }
+    window.insert(next);
+    if (replace || this->Internal->PrefetchedIndices.count(next) == 0)
+      {
+      files.push_back(fname);
+      }
+    }
+  // Only remember the current window, files that left it may have been
+  // evicted from the file cache by the time they are needed again.
+  this->Internal->PrefetchedIndices.swap(window);
+
+  if (!files.empty())
+    {
+    if (!this->Internal->Prefetcher)
+      {
+      this->Internal->Prefetcher = new vtkFileSeriesReaderPrefetcher();
+      }
+    this->Internal->Prefetcher->Schedule(files, replace);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkFileSeriesReader::SetNumberOfPrefetchSteps(int steps)
+{
+  vtkFileSeriesReader::NumberOfPrefetchSteps = steps > 0? steps : 0;
+}
+
+//-----------------------------------------------------------------------------
+int vtkFileSeriesReader::GetNumberOfPrefetchSteps()
+{
+  return vtkFileSeriesReader::NumberOfPrefetchSteps;
+}
+
+//-----------------------------------------------------------------------------
+void vtkFileSeriesReader::SetPrefetchLimit(unsigned long kbytes)
+{
+  vtkFileSeriesReader::PrefetchLimit = kbytes;
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkFileSeriesReader::GetPrefetchLimit()
+{
+  return vtkFileSeriesReader::PrefetchLimit;
+}
@@ -43,6 +43,13 @@
 // method is useful when the actual reader points to a set of files itself.  The
 // UseMetaFile toggles between these two methods of specifying files.
 //
+// To hide I/O latency during animation playback, vtkFileSeriesReader can
+// prefetch the files for the next few time steps on a background thread (see
+// SetNumberOfPrefetchSteps()). The direction of playback is inferred from the
+// sequence of requested time steps. Prefetching streams the files through the
+// operating system's file cache: the internal reader is not thread safe, so
+// the data is still parsed by the reader when that time step is requested.
+//
 
 #ifndef vtkFileSeriesReader_h
 #define vtkFileSeriesReader_h
@@ -106,6 +113,21 @@ public:
   vtkSetMacro(IgnoreReaderTime, int);
   vtkBooleanMacro(IgnoreReaderTime, int);
 
+  // Description:
+  // Get/Set the number of time steps ahead of the current one, in the
+  // direction of playback, whose files are prefetched on a background thread.
+  // This is shared by all file series readers. 0 (default) disables
+  // prefetching.
+  static void SetNumberOfPrefetchSteps(int steps);
+  static int GetNumberOfPrefetchSteps();
+
+  // Description:
+  // Get/Set the maximum total size (in KBs) of the files prefetched ahead of
+  // the current time step. Files beyond this limit are not prefetched.
+  // Default is 100 MBs.
+  static void SetPrefetchLimit(unsigned long kbytes);
+  static unsigned long GetPrefetchLimit();
+
 protected:
   vtkFileSeriesReader();
   ~vtkFileSeriesReader();
@@ -163,11 +185,20 @@ protected:
   int IgnoreReaderTime;
 
   int ChooseInput(vtkInformation*);
+
+  // Description:
+  // Schedules the prefetch of the files following (or preceding, when playing
+  // backwards) the file with the given index.
+  void SchedulePrefetch(int index);
+
 private:
   vtkFileSeriesReader(const vtkFileSeriesReader&); // Not implemented.
   void operator=(const vtkFileSeriesReader&); // Not implemented.
 
   vtkFileSeriesReaderInternals* Internal;
+
+  static int NumberOfPrefetchSteps;
+  static unsigned long PrefetchLimit;
 };
 
 #endif
@@ -47,6 +47,8 @@
 #include "vtkPointData.h"
 #include "vtkCellData.h"
 #include "vtkCollection.h"
+#include "vtkMultiThreader.h"
+#include "vtkSMPTools.h"
 #include "vtkPointAccumulator.hxx"
 #include "vtkMaterialInterfacePieceLoading.h"
 #include "vtkMaterialInterfaceProcessLoading.h"
@@ -1759,6 +1761,10 @@ vtkMaterialInterfaceFilter::vtkMaterialInterfaceFilter()
 
   // 1 Layer of ghost cell by block by default
   this->BlockGhostLevel = 1;
+
+  this->ThreadedLabeling = false;
+  this->LabelingBlock = 0;
+  this->DeferredNeighbors = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -3663,11 +3669,20 @@ int vtkMaterialInterfaceFilter::RequestData(
     // Lets profile to see what takes the most time for large number of processes.
     this->ProcessBlocksTimer->StartTimer();
 #endif
-    int blockId;
-    for (blockId = 0; blockId < this->NumberOfInputBlocks; ++blockId)
+    // Clip depths of pieces are summed when resolving, so the pieces of
+    // the threaded labeling would change them.
+    if (this->ThreadedLabeling && !this->ClipWithPlane)
+      {
+      this->ProcessBlocksThreaded();
+      }
+    else
       {
-      // build fragments
-      this->ProcessBlock(blockId);
+      int blockId;
+      for (blockId = 0; blockId < this->NumberOfInputBlocks; ++blockId)
+        {
+        // build fragments
+        this->ProcessBlock(blockId);
+        }
       }
 #ifdef vtkMaterialInterfaceFilterPROFILE
     // Lets profile to see what takes the most time for large number of processes.
@@ -3817,6 +3832,145 @@ int vtkMaterialInterfaceFilter::RequestData(
   return 1;
 }
 
+//============================================================================
+// Labels the fragments of the input blocks concurrently, for
+// vtkMaterialInterfaceFilter::ProcessBlocksThreaded. The blocks are split in
+// consecutive ranges, each labeled by its own filter, a worker, that
+// connects fragments without leaving the block it processes, so that no
+// voxel is visited by two threads. The workers are made on the calling
+// thread, before the ranges are handed to vtkSMPTools. For each block we
+// keep the worker that labeled it and where the pieces and the deferred
+// neighbors of the block start in the results of the worker.
+class vtkMaterialInterfaceFilterBlockLabeling
+{
+public:
+  struct LabeledBlock
+  {
+    vtkMaterialInterfaceFilter* Worker;
+    int FirstPiece;
+    int NumberOfPieces;
+    size_t FirstDeferred;
+    size_t NumberOfDeferred;
+  };
+
+  // A few ranges per thread, so that threads done with theirs help others.
+  vtkMaterialInterfaceFilterBlockLabeling(vtkMaterialInterfaceFilter* filter)
+    : Filter(filter),
+      Blocks(filter->NumberOfInputBlocks)
+  {
+    int numRanges = std::min(filter->NumberOfInputBlocks,
+      4 * vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+    this->Workers.resize(numRanges);
+    this->DeferredNeighbors.resize(numRanges);
+    for (int range = 0; range < numRanges; ++range)
+      {
+      vtkMaterialInterfaceFilter* worker = vtkMaterialInterfaceFilter::New();
+      filter->InitializeLabelingWorker(worker);
+      worker->DeferredNeighbors = &this->DeferredNeighbors[range];
+      this->Workers[range] = worker;
+      }
+  }
+
+  ~vtkMaterialInterfaceFilterBlockLabeling()
+  {
+    for (size_t range = 0; range < this->Workers.size(); ++range)
+      {
+      ClearVectorOfVtkPointers(this->Workers[range]->FragmentMeshes);
+      this->Workers[range]->Delete();
+      }
+  }
+
+  int GetNumberOfRanges() const
+  {
+    return static_cast<int>(this->Workers.size());
+  }
+
+  void operator()(vtkIdType beginRange, vtkIdType endRange)
+  {
+    const vtkIdType numBlocks = this->Filter->NumberOfInputBlocks;
+    const vtkIdType numRanges = this->GetNumberOfRanges();
+    for (vtkIdType range = beginRange; range < endRange; ++range)
+      {
+      vtkMaterialInterfaceFilter* worker = this->Workers[range];
+      vtkIdType end = (range + 1) * numBlocks / numRanges;
+      for (vtkIdType blockId = range * numBlocks / numRanges;
+           blockId < end; ++blockId)
+        {
+        vtkMaterialInterfaceFilterBlock* block
+          = this->Filter->InputBlocks[blockId];
+        LabeledBlock& labeled = this->Blocks[blockId];
+        labeled.Worker = worker;
+        labeled.FirstPiece = worker->FragmentId;
+        labeled.FirstDeferred = worker->DeferredNeighbors->size();
+        if (block)
+          {
+          worker->LabelingBlock = block;
+          worker->ProcessBlockVoxels(block);
+          worker->LabelingBlock = 0;
+          }
+        labeled.NumberOfPieces = worker->FragmentId - labeled.FirstPiece;
+        labeled.NumberOfDeferred
+          = worker->DeferredNeighbors->size() - labeled.FirstDeferred;
+        }
+      }
+  }
+
+  vtkMaterialInterfaceFilter* Filter;
+  vector<LabeledBlock> Blocks;
+  vector<vtkMaterialInterfaceFilter*> Workers;
+  vector<vector<vtkMaterialInterfaceFilterIterator> > DeferredNeighbors;
+
+private:
+  vtkMaterialInterfaceFilterBlockLabeling(
+    const vtkMaterialInterfaceFilterBlockLabeling&); // Not implemented.
+  void operator=(const vtkMaterialInterfaceFilterBlockLabeling&); // Not implemented.
+};
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Adds the offset of each block to the fragment ids its worker gave to its
+// voxels, once the pieces of all the blocks are numbered.
+class vtkMaterialInterfaceFilterRenumberBlocks
+{
+public:
+  vtkMaterialInterfaceFilterBlock** Blocks;
+  const int* Offsets;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType blockId = begin; blockId < end; ++blockId)
+      {
+      vtkMaterialInterfaceFilterBlock* block = this->Blocks[blockId];
+      if (block == 0 || this->Offsets[blockId] == 0)
+        {
+        continue;
+        }
+      const int offset = this->Offsets[blockId];
+      const int* ext = block->GetBaseCellExtent();
+      int incs[3];
+      block->GetCellIncrements(incs);
+      int* zPtr = block->GetBaseFragmentIdPointer();
+      for (int iz = ext[4]; iz <= ext[5]; ++iz, zPtr += incs[2])
+        {
+        int* yPtr = zPtr;
+        for (int iy = ext[2]; iy <= ext[3]; ++iy, yPtr += incs[1])
+          {
+          int* xPtr = yPtr;
+          for (int ix = ext[0]; ix <= ext[1]; ++ix, xPtr += incs[0])
+            {
+            if (*xPtr != -1)
+              {
+              *xPtr += offset;
+              }
+            }
+          }
+        }
+      }
+  }
+};
+}
+
 //----------------------------------------------------------------------------
 int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
 {
@@ -3838,6 +3992,15 @@ int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
     return 0;
     }
 
+  this->ProcessBlockVoxels(block);
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMaterialInterfaceFilter::ProcessBlockVoxels(
+  vtkMaterialInterfaceFilterBlock* block)
+{
   vtkMaterialInterfaceFilterIterator* xIterator = new vtkMaterialInterfaceFilterIterator;
   vtkMaterialInterfaceFilterIterator* yIterator = new vtkMaterialInterfaceFilterIterator;
   vtkMaterialInterfaceFilterIterator* zIterator = new vtkMaterialInterfaceFilterIterator;
@@ -3871,67 +4034,7 @@ int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
         if (*(xIterator->FragmentIdPointer) == -1 &&
             *(xIterator->VolumeFractionPointer) > this->scaledMaterialFractionThreshold)
           { // We have a new fragment.
-          this->CurrentFragmentMesh=this->NewFragmentMesh();
-          this->EquivalenceSet->AddEquivalence(this->FragmentId,this->FragmentId);
-          // We have to mark every voxel we push on the queue.
-          *(xIterator->FragmentIdPointer) = this->FragmentId;
-          // There should be no need to clear the queue.
-          queue->Push(xIterator);
-          this->ConnectFragment(queue);
-          // save the current fragment mesh
-          // the id is implicit given by its position in the vector, but only
-          // until fragments are resolved. After resolution we add addributes such
-          // as id, volume, summations averages, etc..
-          this->CurrentFragmentMesh->Squeeze();
-          this->FragmentMeshes.push_back( this->CurrentFragmentMesh );
-          // Save the volume from the last fragment.
-          this->FragmentVolumes->InsertTuple1(this->FragmentId, this->FragmentVolume);
-          if (this->ClipWithPlane)
-            {
-            this->ClipDepthMaximums->InsertTuple1(this->FragmentId, this->ClipDepthMax);
-            this->ClipDepthMinimums->InsertTuple1(this->FragmentId, this->ClipDepthMin);
-            }
-          // clear the volume accumulator
-          this->FragmentVolume = 0.0;
-          this->ClipDepthMax = 0.0;
-          this->ClipDepthMin = VTK_FLOAT_MAX;
-          if (this->ComputeMoments)
-            {
-            // Save the moments from the last fragment
-            this->FragmentMoments->InsertTuple(this->FragmentId,
-                                               &this->FragmentMoment[0]);
-            // clear the moment accumulator
-            FillVector(this->FragmentMoment, 0.0);
-            }
-          // for the volume weighted averaged scalars/vectors...
-          for (int i=0; i<this->NVolumeWtdAvgs; ++i)
-            {
-            // update the integrated value, independent of ncomps
-            this->FragmentVolumeWtdAvgs[i]->InsertTuple(this->FragmentId,
-                                                        &this->FragmentVolumeWtdAvg[i][0]);
-            // clear the accumulator
-            FillVector(this->FragmentVolumeWtdAvg[i],0.0);
-            }
-          // for the mass weighted averaged scalars/vectors...
-          for (int i=0; i<this->NMassWtdAvgs; ++i)
-            {
-            // update the integrated value, independent of ncomps
-            this->FragmentMassWtdAvgs[i]->InsertTuple(this->FragmentId,
-                                                      &this->FragmentMassWtdAvg[i][0]);
-            // clear the accumulator
-            FillVector(this->FragmentMassWtdAvg[i],0.0);
-            }
-          // for the summed scalars/vectors...
-          for (int i=0; i<this->NToSum; ++i)
-            {
-            // update the integrated value, independent of ncomps
-            this->FragmentSums[i]->InsertTuple(this->FragmentId,
-                                               &this->FragmentSum[i][0]);
-            // clear the accumulator
-            FillVector(this->FragmentSum[i],0.0);
-            }
-          // Move to next fragment.
-          ++this->FragmentId;
+          this->ExtractFragment(queue, xIterator);
           }
         xIterator->FlatIndex += cellIncs[0]; // 1/ncomp
         xIterator->VolumeFractionPointer += cellIncs[0];
@@ -3950,7 +4053,263 @@ int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
   delete xIterator;
   delete yIterator;
   delete zIterator;
+}
 
+//----------------------------------------------------------------------------
+// Connect a new fragment from its first voxel, and save its mesh and
+// integrated attributes under the next fragment id.
+void vtkMaterialInterfaceFilter::ExtractFragment(
+  vtkMaterialInterfaceFilterRingBuffer *queue,
+  vtkMaterialInterfaceFilterIterator *seed)
+{
+  this->CurrentFragmentMesh=this->NewFragmentMesh();
+  this->EquivalenceSet->AddEquivalence(this->FragmentId,this->FragmentId);
+  // We have to mark every voxel we push on the queue.
+  *(seed->FragmentIdPointer) = this->FragmentId;
+  // There should be no need to clear the queue.
+  queue->Push(seed);
+  this->ConnectFragment(queue);
+  // save the current fragment mesh
+  // the id is implicit given by its position in the vector, but only
+  // until fragments are resolved. After resolution we add addributes such
+  // as id, volume, summations averages, etc..
+  this->CurrentFragmentMesh->Squeeze();
+  this->FragmentMeshes.push_back( this->CurrentFragmentMesh );
+  // Save the volume from the last fragment.
+  this->FragmentVolumes->InsertTuple1(this->FragmentId, this->FragmentVolume);
+  if (this->ClipWithPlane)
+    {
+    this->ClipDepthMaximums->InsertTuple1(this->FragmentId, this->ClipDepthMax);
+    this->ClipDepthMinimums->InsertTuple1(this->FragmentId, this->ClipDepthMin);
+    }
+  // clear the volume accumulator
+  this->FragmentVolume = 0.0;
+  this->ClipDepthMax = 0.0;
+  this->ClipDepthMin = VTK_FLOAT_MAX;
+  if (this->ComputeMoments)
+    {
+    // Save the moments from the last fragment
+    this->FragmentMoments->InsertTuple(this->FragmentId,
+                                       &this->FragmentMoment[0]);
+    // clear the moment accumulator
+    FillVector(this->FragmentMoment, 0.0);
+    }
+  // for the volume weighted averaged scalars/vectors...
+  for (int i=0; i<this->NVolumeWtdAvgs; ++i)
+    {
+    // update the integrated value, independent of ncomps
+    this->FragmentVolumeWtdAvgs[i]->InsertTuple(this->FragmentId,
+                                                &this->FragmentVolumeWtdAvg[i][0]);
+    // clear the accumulator
+    FillVector(this->FragmentVolumeWtdAvg[i],0.0);
+    }
+  // for the mass weighted averaged scalars/vectors...
+  for (int i=0; i<this->NMassWtdAvgs; ++i)
+    {
+    // update the integrated value, independent of ncomps
+    this->FragmentMassWtdAvgs[i]->InsertTuple(this->FragmentId,
+                                              &this->FragmentMassWtdAvg[i][0]);
+    // clear the accumulator
+    FillVector(this->FragmentMassWtdAvg[i],0.0);
+    }
+  // for the summed scalars/vectors...
+  for (int i=0; i<this->NToSum; ++i)
+    {
+    // update the integrated value, independent of ncomps
+    this->FragmentSums[i]->InsertTuple(this->FragmentId,
+                                       &this->FragmentSum[i][0]);
+    // clear the accumulator
+    FillVector(this->FragmentSum[i],0.0);
+    }
+  // Move to next fragment.
+  ++this->FragmentId;
+}
+
+//----------------------------------------------------------------------------
+// Concurrent alternative to calling ProcessBlock for every input block.
+// The workers of vtkMaterialInterfaceFilterBlockLabeling connect fragments
+// within a block, so a fragment crossing block faces is found as several
+// pieces. The pieces are numbered block after block in scan order, which is
+// the order ProcessBlock finds the first voxel of each fragment. The first
+// piece of a fragment thus has the smallest id of its equivalence set, and
+// resolving the equivalences gives the fragment ids of the serial search.
+// The geometry and the integrated attributes of the pieces are merged the
+// same way as those of fragments split across processes.
+void vtkMaterialInterfaceFilter::ProcessBlocksThreaded()
+{
+  const int numBlocks = this->NumberOfInputBlocks;
+  if (numBlocks == 0)
+    {
+    return;
+    }
+
+  vtkMaterialInterfaceFilterBlockLabeling labeling(this);
+  vtkSMPTools::For(0, labeling.GetNumberOfRanges(), 1, labeling);
+
+  this->Progress+=this->ProgressBlockInc*numBlocks;
+  this->UpdateProgress(this->Progress);
+
+  // Collect the pieces in block order.
+  vector<int> offsets(numBlocks, 0);
+  for (int blockId = 0; blockId < numBlocks; ++blockId)
+    {
+    const vtkMaterialInterfaceFilterBlockLabeling::LabeledBlock& labeled
+      = labeling.Blocks[blockId];
+    vtkMaterialInterfaceFilter* worker = labeled.Worker;
+    offsets[blockId] = this->FragmentId - labeled.FirstPiece;
+    int endPiece = labeled.FirstPiece + labeled.NumberOfPieces;
+    for (int piece = labeled.FirstPiece; piece < endPiece; ++piece)
+      {
+      this->EquivalenceSet->AddEquivalence(this->FragmentId,this->FragmentId);
+      this->FragmentMeshes.push_back(worker->FragmentMeshes[piece]);
+      worker->FragmentMeshes[piece] = 0;
+      this->FragmentVolumes->InsertTuple1(this->FragmentId,
+        worker->FragmentVolumes->GetValue(piece));
+      if (this->ComputeMoments)
+        {
+        this->FragmentMoments->InsertTuple(this->FragmentId,
+          worker->FragmentMoments->GetTuple(piece));
+        }
+      for (int i=0; i<this->NVolumeWtdAvgs; ++i)
+        {
+        this->FragmentVolumeWtdAvgs[i]->InsertTuple(this->FragmentId,
+          worker->FragmentVolumeWtdAvgs[i]->GetTuple(piece));
+        }
+      for (int i=0; i<this->NMassWtdAvgs; ++i)
+        {
+        this->FragmentMassWtdAvgs[i]->InsertTuple(this->FragmentId,
+          worker->FragmentMassWtdAvgs[i]->GetTuple(piece));
+        }
+      for (int i=0; i<this->NToSum; ++i)
+        {
+        this->FragmentSums[i]->InsertTuple(this->FragmentId,
+          worker->FragmentSums[i]->GetTuple(piece));
+        }
+      ++this->FragmentId;
+      }
+    // Pieces the worker found equivalent within the block.
+    for (int piece = labeled.FirstPiece; piece < endPiece; ++piece)
+      {
+      int setId = worker->EquivalenceSet->GetEquivalentSetId(piece);
+      if (setId != piece)
+        {
+        this->EquivalenceSet->AddEquivalence(setId + offsets[blockId],
+                                             piece + offsets[blockId]);
+        }
+      }
+    }
+
+  vtkMaterialInterfaceFilterRenumberBlocks renumber;
+  renumber.Blocks = this->InputBlocks;
+  renumber.Offsets = &offsets[0];
+  vtkSMPTools::For(0, numBlocks, 1, renumber);
+
+  // Connect the pieces through the block faces. A neighbor that is not
+  // labeled yet is in a ghost block (or exactly at the threshold, which
+  // does not start a fragment): the serial search would reach it from the
+  // voxel, so we connect it as a new piece equivalent to the voxel.
+  vtkMaterialInterfaceFilterRingBuffer *queue = new vtkMaterialInterfaceFilterRingBuffer;
+  for (int blockId = 0; blockId < numBlocks; ++blockId)
+    {
+    const vtkMaterialInterfaceFilterBlockLabeling::LabeledBlock& labeled
+      = labeling.Blocks[blockId];
+    vector<vtkMaterialInterfaceFilterIterator>& deferred
+      = *(labeled.Worker->DeferredNeighbors);
+    size_t end = labeled.FirstDeferred + labeled.NumberOfDeferred;
+    for (size_t ii = labeled.FirstDeferred; ii < end; ii += 2)
+      {
+      vtkMaterialInterfaceFilterIterator* voxel = &deferred[ii];
+      vtkMaterialInterfaceFilterIterator* neighbor = &deferred[ii+1];
+      if (*(neighbor->FragmentIdPointer) == -1)
+        {
+        int fragmentId = *(voxel->FragmentIdPointer);
+        int pieceId = this->FragmentId;
+        this->ExtractFragment(queue, neighbor);
+        this->EquivalenceSet->AddEquivalence(fragmentId, pieceId);
+        }
+      else
+        {
+        this->AddEquivalence(voxel, neighbor);
+        }
+      }
+    }
+  delete queue;
+}
+
+//----------------------------------------------------------------------------
+// Give a worker of ProcessBlocksThreaded the settings of this pass and
+// empty results.
+void vtkMaterialInterfaceFilter::InitializeLabelingWorker(
+  vtkMaterialInterfaceFilter* worker)
+{
+  worker->MaterialFractionThreshold = this->MaterialFractionThreshold;
+  worker->scaledMaterialFractionThreshold
+    = this->scaledMaterialFractionThreshold;
+  worker->ClipWithPlane = 0;
+  worker->ComputeMoments = this->ComputeMoments;
+  worker->NVolumeWtdAvgs = this->NVolumeWtdAvgs;
+  worker->NMassWtdAvgs = this->NMassWtdAvgs;
+  worker->NToSum = this->NToSum;
+  worker->NToIntegrate = this->NToIntegrate;
+  worker->IntegratedArrayNames = this->IntegratedArrayNames;
+  worker->IntegratedArrayNComp = this->IntegratedArrayNComp;
+
+  worker->FragmentId = 0;
+  worker->FragmentVolume = 0.0;
+  ReNewVtkPointer(worker->FragmentVolumes);
+  if (this->ComputeMoments)
+    {
+    FillVector(worker->FragmentMoment, 0.0);
+    ReNewVtkPointer(worker->FragmentMoments);
+    worker->FragmentMoments->SetNumberOfComponents(4);
+    }
+  // The accumulators are sized for the components of the arrays.
+  worker->FragmentVolumeWtdAvg = this->FragmentVolumeWtdAvg;
+  ClearVectorOfVtkPointers(worker->FragmentVolumeWtdAvgs);
+  for (int i=0; i<this->NVolumeWtdAvgs; ++i)
+    {
+    FillVector(worker->FragmentVolumeWtdAvg[i], 0.0);
+    worker->FragmentVolumeWtdAvgs.push_back(vtkDoubleArray::New());
+    worker->FragmentVolumeWtdAvgs[i]->SetNumberOfComponents(
+      this->FragmentVolumeWtdAvgs[i]->GetNumberOfComponents());
+    }
+  worker->FragmentMassWtdAvg = this->FragmentMassWtdAvg;
+  ClearVectorOfVtkPointers(worker->FragmentMassWtdAvgs);
+  for (int i=0; i<this->NMassWtdAvgs; ++i)
+    {
+    FillVector(worker->FragmentMassWtdAvg[i], 0.0);
+    worker->FragmentMassWtdAvgs.push_back(vtkDoubleArray::New());
+    worker->FragmentMassWtdAvgs[i]->SetNumberOfComponents(
+      this->FragmentMassWtdAvgs[i]->GetNumberOfComponents());
+    }
+  worker->FragmentSum = this->FragmentSum;
+  ClearVectorOfVtkPointers(worker->FragmentSums);
+  for (int i=0; i<this->NToSum; ++i)
+    {
+    FillVector(worker->FragmentSum[i], 0.0);
+    worker->FragmentSums.push_back(vtkDoubleArray::New());
+    worker->FragmentSums[i]->SetNumberOfComponents(
+      this->FragmentSums[i]->GetNumberOfComponents());
+    }
+
+  worker->EquivalenceSet->Initialize();
+}
+
+//----------------------------------------------------------------------------
+// While a worker of ProcessBlocksThreaded labels its block, the voxels of
+// other blocks may be labeled by other threads. Instead of visiting a
+// neighbor in another block, save it with the voxel it touches.
+// Returns 1 if the neighbor was saved.
+int vtkMaterialInterfaceFilter::DeferNeighbor(
+  vtkMaterialInterfaceFilterIterator *voxel,
+  vtkMaterialInterfaceFilterIterator *neighbor)
+{
+  if (this->LabelingBlock == 0 || neighbor->Block == this->LabelingBlock)
+    {
+    return 0;
+    }
+  this->DeferredNeighbors->push_back(*voxel);
+  this->DeferredNeighbors->push_back(*neighbor);
   return 1;
 }
 
@@ -5619,6 +5978,10 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
         // Neighbor is outside of fragment.  Make a face.
         this->CreateFace(&iterator, &next, ii, 0);
         }
+      else if (this->DeferNeighbor(&iterator, &next))
+        { // The neighbor is in a block labeled by another thread.
+        // It is connected once all the blocks are labeled.
+        }
       else if (next.FragmentIdPointer[0] == -1)
         { // We have not visited this neighbor yet. Mark the voxel and recurse.
         *(next.FragmentIdPointer) = this->FragmentId;
@@ -5650,6 +6013,9 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
             // Neighbor is outside of fragment.  Make a face.
             this->CreateFace(&iterator, &next2, ii, 0);
             }
+          else if (this->DeferNeighbor(&iterator, &next2))
+            { // The neighbor is in a block labeled by another thread.
+            }
           else if (next2.FragmentIdPointer[0] == -1)
             { // We have not visited this neighbor yet. Mark the voxel and recurse.
            *(next2.FragmentIdPointer) = this->FragmentId;
@@ -5671,6 +6037,9 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
             // Neighbor is outside of fragment.  Make a face.
             this->CreateFace(&iterator, &next2, ii, 0);
             }
+          else if (this->DeferNeighbor(&iterator, &next2))
+            { // The neighbor is in a block labeled by another thread.
+            }
           else if (next2.FragmentIdPointer[0] == -1)
             { // We have not visited this neighbor yet. Mark the voxel and recurse.
             *(next2.FragmentIdPointer) = this->FragmentId;
@@ -5692,6 +6061,9 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
             // Neighbor is outside of fragment.  Make a face.
             this->CreateFace(&iterator, &next, ii, 0);
             }
+          else if (this->DeferNeighbor(&iterator, &next))
+            { // The neighbor is in a block labeled by another thread.
+            }
           else if (next.FragmentIdPointer[0] == -1)
             { // We have not visited this neighbor yet. Mark the voxel and recurse.
             *(next.FragmentIdPointer) = this->FragmentId;
@@ -5712,6 +6084,9 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
         { // Neighbor is outside of fragment.  Make a face.
         this->CreateFace(&iterator, &next, ii, 1);
         }
+      else if (this->DeferNeighbor(&iterator, &next))
+        { // The neighbor is in a block labeled by another thread.
+        }
       else if (next.FragmentIdPointer[0] == -1)
         { // We have not visited this neighbor yet. Mark the voxel and recurse.
         *(next.FragmentIdPointer) = this->FragmentId;
@@ -5738,6 +6113,9 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
             // Neighbor is outside of fragment.  Make a face.
             this->CreateFace(&iterator, &next2, ii, 1);
             }
+          else if (this->DeferNeighbor(&iterator, &next2))
+            { // The neighbor is in a block labeled by another thread.
+            }
           else if (next2.FragmentIdPointer[0] == -1)
             { // We have not visited this neighbor yet. Mark the voxel and recurse.
             *(next2.FragmentIdPointer) = this->FragmentId;
@@ -5759,6 +6137,9 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
             // Neighbor is outside of fragment.  Make a face.
             this->CreateFace(&iterator, &next2, ii, 1);
             }
+          else if (this->DeferNeighbor(&iterator, &next2))
+            { // The neighbor is in a block labeled by another thread.
+            }
           else if (next2.FragmentIdPointer[0] == -1)
             { // We have not visited this neighbor yet. Mark the voxel and recurse.
             *(next2.FragmentIdPointer) = this->FragmentId;
@@ -5780,6 +6161,9 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
             // Neighbor is outside of fragment.  Make a face.
             this->CreateFace(&iterator, &next, ii, 1);
             }
+          else if (this->DeferNeighbor(&iterator, &next))
+            { // The neighbor is in a block labeled by another thread.
+            }
           else if (next.FragmentIdPointer[0] == -1)
             { // We have not visited this neighbor yet. Mark the voxel and recurse.
             *(next.FragmentIdPointer) = this->FragmentId;
@@ -6415,6 +6799,14 @@ void vtkMaterialInterfaceFilter::AddEquivalence(
   vtkMaterialInterfaceFilterIterator *neighbor1,
   vtkMaterialInterfaceFilterIterator *neighbor2)
 {
+  // A worker of ProcessBlocksThreaded does not read the ids of other
+  // blocks, it connects them through the deferred neighbors.
+  if (this->LabelingBlock && (neighbor1->Block != this->LabelingBlock ||
+                              neighbor2->Block != this->LabelingBlock))
+    {
+    return;
+    }
+
   int id1 = *(neighbor1->FragmentIdPointer);
   int id2 = *(neighbor2->FragmentIdPointer);
 
@@ -58,6 +58,7 @@ class vtkMaterialInterfaceEquivalenceSet;
 class vtkMaterialInterfaceFilterRingBuffer;
 class vtkMaterialInterfacePieceLoading;
 class vtkMaterialInterfaceCommBuffer;
+class vtkMaterialInterfaceFilterBlockLabeling;
 
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkMaterialInterfaceFilter : public vtkMultiBlockDataSetAlgorithm
@@ -240,6 +241,16 @@ public:
   vtkSetMacro(BlockGhostLevel, unsigned char);
   vtkGetMacro(BlockGhostLevel, unsigned char);
 
+  // Description:
+  // When on, the blocks of each process are labeled concurrently with
+  // vtkSMPTools. Each block is connected on its own, then the pieces of the
+  // fragments that cross block faces are merged, before fragments are
+  // resolved across processes as usual. Fragment ids are the same as when
+  // off, and integrated attributes differ only by the order of their sums.
+  // Ignored when clipping with a plane. Off by default.
+  vtkSetMacro(ThreadedLabeling, bool);
+  vtkGetMacro(ThreadedLabeling, bool);
+
   // Description:
   // Sets modified if array selection changes.
   static void SelectionModifiedCallback( vtkObject*,
@@ -281,6 +292,16 @@ protected:
   vtkPolyData *NewFragmentMesh();
   // Process each cell, looking for fragments.
   int ProcessBlock(int blockId);
+  void ProcessBlockVoxels(vtkMaterialInterfaceFilterBlock* block);
+  // Connect a new fragment from its first voxel and save it.
+  void ExtractFragment(vtkMaterialInterfaceFilterRingBuffer* queue,
+                       vtkMaterialInterfaceFilterIterator* seed);
+  // Process all the blocks concurrently, then connect the fragment
+  // pieces split by block faces.
+  void ProcessBlocksThreaded();
+  void InitializeLabelingWorker(vtkMaterialInterfaceFilter* worker);
+  int DeferNeighbor(vtkMaterialInterfaceFilterIterator* voxel,
+                    vtkMaterialInterfaceFilterIterator* neighbor);
   // Cell has been identified as inside the fragment. Integrate, and
   // generate fragement surface etc...
   void ConnectFragment(vtkMaterialInterfaceFilterRingBuffer* iterator);
@@ -711,6 +732,13 @@ protected:
   // By default set to 1
   unsigned char BlockGhostLevel;
 
+  // Label the blocks concurrently.
+  bool ThreadedLabeling;
+  // The block a labeling worker does not leave, and the neighbors in
+  // other blocks it found, by pairs (voxel, neighbor).
+  vtkMaterialInterfaceFilterBlock* LabelingBlock;
+  std::vector<vtkMaterialInterfaceFilterIterator>* DeferredNeighbors;
+
 
 #ifdef vtkMaterialInterfaceFilterPROFILE
 // Lets profile to see what takes the most time for large number of processes.
@@ -723,6 +751,8 @@ protected:
 #endif
 
 private:
+  friend class vtkMaterialInterfaceFilterBlockLabeling;
+
   vtkMaterialInterfaceFilter(const vtkMaterialInterfaceFilter&);  // Not implemented.
   void operator=(const vtkMaterialInterfaceFilter&);  // Not implemented.
 
@@ -40,6 +40,10 @@
 #include "vtkMultiProcessController.h"
 #include "vtkObject.h"
 
+#include <vtksys/SystemTools.hxx>
+
+#include <cstdio> /* rename */
+
 
 
 typedef std::vector< vtkPEnSightReader::vtkPEnSightReaderCellIds* > vtkPEnSightReaderCellIdsTypeBase;
@@ -47,6 +51,20 @@ class vtkPEnSightReaderCellIdsType: public vtkPEnSightReaderCellIdsTypeBase {};
 
 namespace
 {
+  // First line of the offset index files, to be changed with their format.
+  const char OffsetIndexHeader[] = "vtkPEnSightReader offset index 1";
+
+  size_t CountOffsets(const std::map<std::string, std::map<int, long> >& offsets)
+    {
+    size_t count = 0;
+    std::map<std::string, std::map<int, long> >::const_iterator iter;
+    for (iter = offsets.begin(); iter != offsets.end(); ++iter)
+      {
+      count += iter->second.size();
+      }
+    return count;
+    }
+
   void cleanup(vtkPEnSightReaderCellIdsType* foo)
     {
     if (!foo) { return; }
@@ -119,6 +137,17 @@ vtkPEnSightReader::vtkPEnSightReader()
   this->MultiProcessNumberOfProcesses = -2;
 
   this->GhostLevels = 0;
+
+  this->OffsetIndexFileTime = 0;
+  this->NumberOfIndexedOffsets = 0;
+
+  this->CachedGeometry = NULL;
+  this->CachedGeometryFileLength = 0;
+  this->CachedGeometryFileTime = 0;
+  this->CachedGeometryTimeStep = -1;
+  this->CachedGhostLevels = 0;
+  this->CachedNumberOfGeometryParts = 0;
+  this->CachedNumberOfNewOutputs = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -203,6 +232,12 @@ vtkPEnSightReader::~vtkPEnSightReader()
   this->FileSets->Delete();
   this->FileSets = NULL;
 
+  if (this->CachedGeometry)
+    {
+    this->CachedGeometry->Delete();
+    this->CachedGeometry = NULL;
+    }
+
   this->ActualTimeValue = 0.0;
 }
 
@@ -263,6 +298,12 @@ int vtkPEnSightReader::RequestData(
     return 0;
     }
 
+  // pick up the offsets found by the first process since the last update.
+  if (this->UseOffsetIndexFile)
+    {
+    this->ReadOffsetIndexFile();
+    }
+
   this->NumberOfNewOutputs = 0;
   this->NumberOfGeometryParts = 0;
   if (this->GeometryFileName)
@@ -344,12 +385,56 @@ int vtkPEnSightReader::RequestData(
         }
       }
 
-    int readGeom = this->ReadGeometryFile(fileName, timeStepInFile, output);
-    if (!readGeom)
+    // The parts, their cell and point ids included, are the ones of the last
+    // execution when it read the same time step of the same geometry file.
+    std::string fullName = this->GetFullFileName(fileName);
+    unsigned long fileLength = 0;
+    long fileTime = 0;
+    if (vtksys::SystemTools::FileExists(fullName.c_str(), true))
       {
-      vtkErrorMacro("error reading geometry file " << fileName << " " << readGeom );
-      delete [] fileName;
-      return 0;
+      fileLength = vtksys::SystemTools::FileLength(fullName.c_str());
+      fileTime = vtksys::SystemTools::ModifiedTime(fullName.c_str());
+      }
+    if (this->CacheGeometry && this->CachedGeometry &&
+        this->CachedGeometryFileName == fullName &&
+        this->CachedGeometryFileLength == fileLength &&
+        this->CachedGeometryFileTime == fileTime &&
+        this->CachedGeometryTimeStep == timeStepInFile &&
+        this->CachedGhostLevels == this->GhostLevels)
+      {
+      vtkDebugMacro("reusing the geometry read from " << fileName);
+      this->CopyGeometryBlocks(this->CachedGeometry, output);
+      this->NumberOfGeometryParts = this->CachedNumberOfGeometryParts;
+      this->NumberOfNewOutputs = this->CachedNumberOfNewOutputs;
+      }
+    else
+      {
+      if (this->CachedGeometry)
+        {
+        this->CachedGeometry->Delete();
+        this->CachedGeometry = NULL;
+        }
+
+      int readGeom = this->ReadGeometryFile(fileName, timeStepInFile, output);
+      if (!readGeom)
+        {
+        vtkErrorMacro("error reading geometry file " << fileName << " " << readGeom );
+        delete [] fileName;
+        return 0;
+        }
+
+      if (this->CacheGeometry)
+        {
+        this->CachedGeometry = vtkMultiBlockDataSet::New();
+        this->CopyGeometryBlocks(output, this->CachedGeometry);
+        this->CachedGeometryFileName = fullName;
+        this->CachedGeometryFileLength = fileLength;
+        this->CachedGeometryFileTime = fileTime;
+        this->CachedGeometryTimeStep = timeStepInFile;
+        this->CachedGhostLevels = this->GhostLevels;
+        this->CachedNumberOfGeometryParts = this->NumberOfGeometryParts;
+        this->CachedNumberOfNewOutputs = this->NumberOfNewOutputs;
+        }
       }
 
     delete [] fileName;
@@ -450,6 +535,11 @@ int vtkPEnSightReader::RequestData(
       }
     }
 
+  if (this->UseOffsetIndexFile && this->GetMultiProcessLocalProcessId() <= 0)
+    {
+    this->WriteOffsetIndexFile();
+    }
+
   return 1;
 }
 
@@ -461,6 +551,10 @@ int vtkPEnSightReader::RequestInformation(
 {
   vtkDebugMacro("In execute information");
   this->CaseFileRead = this->ReadCaseFile();
+  if (this->CaseFileRead && this->UseOffsetIndexFile)
+    {
+    this->ReadOffsetIndexFile();
+    }
 
   // Convert time steps to one sorted and uniquefied list.
   std::vector<double> timeValues;
@@ -2636,6 +2730,183 @@ void vtkPEnSightReader::SetBlockName(vtkMultiBlockDataSet* output,
   output->GetMetaData(blockNo)->Set(vtkCompositeDataSet::NAME(), name);
 }
 
+//----------------------------------------------------------------------------
+void vtkPEnSightReader::CopyGeometryBlocks(vtkMultiBlockDataSet* source,
+                                           vtkMultiBlockDataSet* target)
+{
+  unsigned int numBlocks = source->GetNumberOfBlocks();
+  target->SetNumberOfBlocks(numBlocks);
+  for (unsigned int i = 0; i < numBlocks; i++)
+    {
+    vtkDataSet* block = this->GetDataSetFromBlock(source, i);
+    if (!block)
+      {
+      target->SetBlock(i, NULL);
+      continue;
+      }
+    vtkDataSet* copy = block->NewInstance();
+    copy->ShallowCopy(block);
+    target->SetBlock(i, copy);
+    copy->Delete();
+    if (source->HasMetaData(i) &&
+        source->GetMetaData(i)->Has(vtkCompositeDataSet::NAME()))
+      {
+      this->SetBlockName(target, i,
+                         source->GetMetaData(i)->Get(vtkCompositeDataSet::NAME()));
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+std::string vtkPEnSightReader::GetFullFileName(const std::string& fileName)
+{
+  std::string sfilename;
+  if (this->FilePath && this->FilePath[0])
+    {
+    sfilename = this->FilePath;
+    if (sfilename.at(sfilename.length()-1) != '/')
+      {
+      sfilename += "/";
+      }
+    sfilename += fileName;
+    }
+  else
+    {
+    sfilename = fileName;
+    }
+  return sfilename;
+}
+
+//----------------------------------------------------------------------------
+// The offset index file lists, for each data file of which offsets are known,
+// the name of the file relative to FilePath on a line, its size, modification
+// time and number of offsets on the next one, then one line per offset with
+// the time step and the offset of that time step in the file.
+void vtkPEnSightReader::ReadOffsetIndexFile()
+{
+  if (!this->CaseFileName)
+    {
+    return;
+    }
+  std::string indexName = this->GetFullFileName(this->CaseFileName) + ".offsets";
+  if (!vtksys::SystemTools::FileExists(indexName.c_str(), true))
+    {
+    return;
+    }
+  long indexTime = vtksys::SystemTools::ModifiedTime(indexName.c_str());
+  if (indexTime == this->OffsetIndexFileTime)
+    {
+    return;
+    }
+
+  ifstream index(indexName.c_str());
+  std::string line;
+  if (!std::getline(index, line) || line != OffsetIndexHeader)
+    {
+    vtkWarningMacro("Ignoring offset index file with unknown format: "
+      << indexName.c_str());
+    return;
+    }
+  this->OffsetIndexFileTime = indexTime;
+
+  std::string fileName;
+  while (std::getline(index >> std::ws, fileName))
+    {
+    unsigned long size;
+    long time;
+    int count;
+    if (!(index >> size >> time >> count))
+      {
+      break;
+      }
+    // offsets are only valid as long as the data file is not rewritten.
+    std::string fullName = this->GetFullFileName(fileName);
+    bool valid =
+      vtksys::SystemTools::FileExists(fullName.c_str(), true) &&
+      vtksys::SystemTools::FileLength(fullName.c_str()) == size &&
+      vtksys::SystemTools::ModifiedTime(fullName.c_str()) == time;
+    std::map<int, long> offsets;
+    for (int cc = 0; cc < count; ++cc)
+      {
+      int step;
+      long offset;
+      if (!(index >> step >> offset))
+        {
+        valid = false;
+        break;
+        }
+      offsets[step] = offset;
+      }
+    if (valid)
+      {
+      this->FileOffsets[fileName].insert(offsets.begin(), offsets.end());
+      }
+    }
+  this->NumberOfIndexedOffsets = CountOffsets(this->FileOffsets);
+}
+
+//----------------------------------------------------------------------------
+void vtkPEnSightReader::WriteOffsetIndexFile()
+{
+  size_t numberOfOffsets = CountOffsets(this->FileOffsets);
+  if (!this->CaseFileName || numberOfOffsets <= this->NumberOfIndexedOffsets)
+    {
+    return;
+    }
+  std::string indexName = this->GetFullFileName(this->CaseFileName) + ".offsets";
+
+  // written aside then renamed so that other processes, or other sessions,
+  // never read a partial index.
+  std::string tmpName = indexName + ".tmp";
+  ofstream index(tmpName.c_str());
+  if (!index)
+    {
+    // e.g. read-only data directory, simply work without the index.
+    vtkDebugMacro("Cannot write offset index file: " << tmpName.c_str());
+    return;
+    }
+  index << OffsetIndexHeader << "\n";
+  std::map<std::string, std::map<int, long> >::const_iterator iter;
+  for (iter = this->FileOffsets.begin(); iter != this->FileOffsets.end(); ++iter)
+    {
+    if (iter->second.empty())
+      {
+      continue;
+      }
+    std::string fullName = this->GetFullFileName(iter->first);
+    index << iter->first << "\n"
+          << vtksys::SystemTools::FileLength(fullName.c_str()) << " "
+          << vtksys::SystemTools::ModifiedTime(fullName.c_str()) << " "
+          << iter->second.size() << "\n";
+    std::map<int, long>::const_iterator offset;
+    for (offset = iter->second.begin(); offset != iter->second.end(); ++offset)
+      {
+      index << offset->first << " " << offset->second << "\n";
+      }
+    }
+  index.close();
+  if (index.fail())
+    {
+    vtkDebugMacro("Cannot write offset index file: " << tmpName.c_str());
+    vtksys::SystemTools::RemoveFile(tmpName.c_str());
+    return;
+    }
+  if (rename(tmpName.c_str(), indexName.c_str()) != 0)
+    {
+    // rename does not replace an existing file on Windows.
+    vtksys::SystemTools::RemoveFile(indexName.c_str());
+    if (rename(tmpName.c_str(), indexName.c_str()) != 0)
+      {
+      vtkDebugMacro("Cannot write offset index file: " << indexName.c_str());
+      vtksys::SystemTools::RemoveFile(tmpName.c_str());
+      return;
+      }
+    }
+  this->NumberOfIndexedOffsets = numberOfOffsets;
+  this->OffsetIndexFileTime =
+    vtksys::SystemTools::ModifiedTime(indexName.c_str());
+}
+
 //----------------------------------------------------------------------------
 void vtkPEnSightReader::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -2645,6 +2916,8 @@ void vtkPEnSightReader::PrintSelf(ostream& os, vtkIndent indent)
      << (this->CaseFileName ? this->CaseFileName : "(none)") << endl;
   os << indent << "FilePath: "
      << (this->FilePath ? this->FilePath : "(none)") << endl;
+  os << indent << "NumberOfIndexedOffsets: "
+     << this->NumberOfIndexedOffsets << endl;
   os << indent << "NumberOfComplexScalarsPerNode: "
      << this->NumberOfComplexScalarsPerNode << endl;
   os << indent << "NumberOfVectorsPerElement :"
@@ -862,6 +862,48 @@ class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkPEnSightReader : public vtkPGenericEnS
 
   std::map<std::string, std::map<int, long> > FileOffsets;
 
+  // Description:
+  // Read the offset index file into FileOffsets, if it changed since it was
+  // last read, and write FileOffsets to it when offsets were added. See
+  // UseOffsetIndexFile.
+  void ReadOffsetIndexFile();
+  void WriteOffsetIndexFile();
+
+  // Description:
+  // Name of a file of the data set, relative to FilePath, with the path.
+  std::string GetFullFileName(const std::string& fileName);
+
+  // Modification time of the offset index file when last read or written.
+  long OffsetIndexFileTime;
+
+  // Number of offsets in FileOffsets when the offset index file was last
+  // read or written.
+  size_t NumberOfIndexedOffsets;
+
+  // Description:
+  // Set the blocks of target to shallow copies of the blocks of source, with
+  // their names, so that adding arrays to the copies does not change the
+  // originals. Used to keep and reuse the geometry, see CacheGeometry.
+  void CopyGeometryBlocks(vtkMultiBlockDataSet* source,
+                          vtkMultiBlockDataSet* target);
+
+  // Parts read from the geometry file, before the variables were added, NULL
+  // when the geometry is not kept.
+  vtkMultiBlockDataSet* CachedGeometry;
+
+  // Full name, size and modification time of the geometry file and time step
+  // in that file the kept geometry was read from, with the ghost levels.
+  std::string CachedGeometryFileName;
+  unsigned long CachedGeometryFileLength;
+  long CachedGeometryFileTime;
+  int CachedGeometryTimeStep;
+  int CachedGhostLevels;
+
+  // NumberOfGeometryParts and NumberOfNewOutputs after the geometry file
+  // was read.
+  int CachedNumberOfGeometryParts;
+  int CachedNumberOfNewOutputs;
+
  private:
   vtkPEnSightReader(const vtkPEnSightReader&);  // Not implemented.
   void operator=(const vtkPEnSightReader&);  // Not implemented.
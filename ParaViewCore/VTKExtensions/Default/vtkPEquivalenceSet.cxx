@@ -17,29 +17,486 @@
 #include "vtkIntArray.h"
 #include "vtkMultiProcessController.h"
 
+#include "vtkPVConfig.h"
+#ifdef PARAVIEW_USE_MPI
+#include "vtkMPIController.h"
+#endif
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#ifdef PARAVIEW_USE_MPI
+static const int SHARED_IDS_SIZE_TAG = 475893801;
+static const int SHARED_IDS_TAG = 475893802;
+static const int LABELS_TAG = 475893803;
+#endif
+
+class vtkPEquivalenceSet::vtkInternals
+{
+public:
+  // A process sharing members with this one. Both processes list the local
+  // indices of the shared members in the same order: the ids owned by the
+  // process of lower rank first, each in the order the other process sent
+  // them to their owner.
+  struct Neighbor
+    {
+    int Process;
+    std::vector<int> Members;
+    std::vector<int> SendBuffer;
+    std::vector<int> ReceiveBuffer;
+    };
+
+  // The ids of other processes, by local index - NumberOfLocalIds.
+  std::vector<int> RemoteIds;
+  std::map<int, int> RemoteIndices;
+  // The smallest id equivalent to each root.
+  std::vector<int> Labels;
+  std::vector<Neighbor> Neighbors;
+};
+
 vtkStandardNewMacro (vtkPEquivalenceSet);
+vtkCxxSetObjectMacro (vtkPEquivalenceSet, Controller, vtkMultiProcessController);
 
 vtkPEquivalenceSet::vtkPEquivalenceSet ()
 {
+  this->Controller = 0;
+  this->FirstLocalId = 0;
+  this->NumberOfLocalIds = -1;
+  this->NumberOfRounds = 0;
+  this->Internals = new vtkInternals;
+  this->SetController (vtkMultiProcessController::GetGlobalController ());
 }
 
 vtkPEquivalenceSet::~vtkPEquivalenceSet ()
 {
+  this->SetController (0);
+  delete this->Internals;
 }
 
 void vtkPEquivalenceSet::PrintSelf (ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf (os, indent);
+  os << indent << "Controller: " << this->Controller << endl;
+  os << indent << "FirstLocalId: " << this->FirstLocalId << endl;
+  os << indent << "NumberOfLocalIds: " << this->NumberOfLocalIds << endl;
+  os << indent << "NumberOfRounds: " << this->NumberOfRounds << endl;
+}
+
+void vtkPEquivalenceSet::SetLocalIds (int first, int number)
+{
+  this->FirstLocalId = first;
+  this->NumberOfLocalIds = number;
+  this->Initialize ();
+  this->Modified ();
+}
+
+void vtkPEquivalenceSet::Initialize ()
+{
+  this->Superclass::Initialize ();
+  this->Internals->RemoteIds.clear ();
+  this->Internals->RemoteIndices.clear ();
+  this->Internals->Labels.clear ();
+  this->Internals->Neighbors.clear ();
+  this->NumberOfRounds = 0;
+  if (this->NumberOfLocalIds < 0)
+    {
+    return;
+    }
+
+  // Every local id is a set of its own.
+  this->EquivalenceArray->SetNumberOfTuples (this->NumberOfLocalIds);
+  this->Internals->Labels.resize (this->NumberOfLocalIds);
+  for (int ii = 0; ii < this->NumberOfLocalIds; ++ii)
+    {
+    this->EquivalenceArray->SetValue (ii, ii);
+    this->Internals->Labels[ii] = this->FirstLocalId + ii;
+    }
+}
+
+void vtkPEquivalenceSet::AddEquivalence (int id1, int id2)
+{
+  if (this->NumberOfLocalIds < 0)
+    {
+    this->Superclass::AddEquivalence (id1, id2);
+    return;
+    }
+  if (this->Resolved)
+    {
+    vtkWarningMacro ("Set already resolved, you cannot add more equivalences.");
+    return;
+    }
+
+  int index1 = this->GetLocalIndex (id1, true);
+  int index2 = this->GetLocalIndex (id2, true);
+  if (index1 < 0 || index2 < 0)
+    {
+    vtkErrorMacro ("Negative ids are not allowed.");
+    return;
+    }
+  int root1 = this->FindRoot (index1);
+  int root2 = this->FindRoot (index2);
+  if (root1 == root2)
+    {
+    return;
+    }
+  // The root with the smallest label remains a root.
+  std::vector<int>& labels = this->Internals->Labels;
+  if (labels[root2] < labels[root1])
+    {
+    std::swap (root1, root2);
+    }
+  this->EquivalenceArray->SetValue (root2, root1);
+}
+
+int vtkPEquivalenceSet::GetEquivalentSetId (int memberId)
+{
+  if (this->NumberOfLocalIds < 0)
+    {
+    return this->Superclass::GetEquivalentSetId (memberId);
+    }
+  int index = this->GetLocalIndex (memberId, false);
+  if (index < 0)
+    {
+    return -1;
+    }
+  if (this->Resolved)
+    {
+    return this->EquivalenceArray->GetValue (index);
+    }
+  return this->Internals->Labels[this->FindRoot (index)];
+}
+
+int vtkPEquivalenceSet::GetLocalIndex (int id, bool insert)
+{
+  if (id < 0)
+    {
+    return -1;
+    }
+  if (id >= this->FirstLocalId && id - this->FirstLocalId < this->NumberOfLocalIds)
+    {
+    return id - this->FirstLocalId;
+    }
+  std::map<int, int>::iterator it = this->Internals->RemoteIndices.lower_bound (id);
+  if (it != this->Internals->RemoteIndices.end () && it->first == id)
+    {
+    return it->second;
+    }
+  if (!insert)
+    {
+    return -1;
+    }
+
+  int index = this->EquivalenceArray->GetNumberOfTuples ();
+  this->EquivalenceArray->InsertNextValue (index);
+  this->Internals->RemoteIds.push_back (id);
+  this->Internals->RemoteIndices.insert (it, std::make_pair (id, index));
+  this->Internals->Labels.push_back (id);
+  return index;
+}
+
+int vtkPEquivalenceSet::FindRoot (int index)
+{
+  int* parents = this->EquivalenceArray->GetPointer (0);
+  while (parents[index] != index)
+    {
+    // Path halving: every other member of the path skips its parent.
+    parents[index] = parents[parents[index]];
+    index = parents[index];
+    }
+  return index;
 }
 
 int vtkPEquivalenceSet::ResolveEquivalences ()
 {
-  vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController ();
+  if (this->NumberOfLocalIds < 0)
+    {
+    return this->GatherEquivalences ();
+    }
+  if (this->Resolved)
+    {
+    return this->NumberOfResolvedSets;
+    }
+
+  vtkInternals* internals = this->Internals;
+  int numMembers = this->EquivalenceArray->GetNumberOfTuples ();
+  int numProcs = this->Controller ? this->Controller->GetNumberOfProcesses () : 1;
+  if (!this->ExchangeSharedIds ())
+    {
+    return 0;
+    }
+
+  // Every root gets the smallest id equivalent to it in any process.
+  this->NumberOfRounds = this->PropagateMinimum (
+    numMembers > 0 ? &internals->Labels[0] : 0);
+
+  // The sets are numbered in the order of their smallest ids, by the
+  // processes owning them.
+  std::vector<int> setIds (numMembers, VTK_INT_MAX);
+  int numSets = 0;
+  for (int ii = 0; ii < this->NumberOfLocalIds; ++ii)
+    {
+    int root = this->FindRoot (ii);
+    if (internals->Labels[root] == this->FirstLocalId + ii)
+      {
+      setIds[root] = numSets++;
+      }
+    }
+  int totalSets = numSets;
+  if (numProcs > 1)
+    {
+    int myProc = this->Controller->GetLocalProcessId ();
+    int localSets[2] = { this->FirstLocalId, numSets };
+    std::vector<int> sets (2 * numProcs);
+    this->Controller->AllGather (localSets, &sets[0], 2);
+    int offset = 0;
+    totalSets = 0;
+    for (int p = 0; p < numProcs; ++p)
+      {
+      totalSets += sets[2 * p + 1];
+      if (sets[2 * p] < this->FirstLocalId ||
+          (sets[2 * p] == this->FirstLocalId && p < myProc))
+        {
+        offset += sets[2 * p + 1];
+        }
+      }
+    for (int ii = 0; ii < numMembers; ++ii)
+      {
+      if (setIds[ii] != VTK_INT_MAX)
+        {
+        setIds[ii] += offset;
+        }
+      }
+    }
+
+  // Every root gets the id of its set.
+  this->NumberOfRounds += this->PropagateMinimum (
+    numMembers > 0 ? &setIds[0] : 0);
+
+  std::vector<int> resolved (numMembers);
+  for (int ii = 0; ii < numMembers; ++ii)
+    {
+    resolved[ii] = setIds[this->FindRoot (ii)];
+    }
+  for (int ii = 0; ii < numMembers; ++ii)
+    {
+    this->EquivalenceArray->SetValue (ii, resolved[ii]);
+    }
+  internals->Neighbors.clear ();
+  this->Resolved = 1;
+  this->NumberOfResolvedSets = totalSets;
+
+  return totalSets;
+}
+
+int vtkPEquivalenceSet::ExchangeSharedIds ()
+{
+  vtkInternals* internals = this->Internals;
+  internals->Neighbors.clear ();
+  int numProcs = this->Controller ? this->Controller->GetNumberOfProcesses () : 1;
+  if (numProcs < 2)
+    {
+    if (!internals->RemoteIds.empty ())
+      {
+      vtkErrorMacro ("Id " << internals->RemoteIds[0] << " is not a local id.");
+      return 0;
+      }
+    return 1;
+    }
+
+#ifdef PARAVIEW_USE_MPI
+  vtkMPIController* controller = vtkMPIController::SafeDownCast (this->Controller);
+  if (controller == 0)
+    {
+    vtkErrorMacro ("Distributed equivalences need an MPI controller.");
+    return 0;
+    }
+  int myProc = controller->GetLocalProcessId ();
+
+  // The ids owned by every process.
+  int localIds[2] = { this->FirstLocalId, this->NumberOfLocalIds };
+  std::vector<int> ranges (2 * numProcs);
+  controller->AllGather (localIds, &ranges[0], 2);
+  std::vector<std::pair<int, int> > firsts;
+  for (int p = 0; p < numProcs; ++p)
+    {
+    if (ranges[2 * p + 1] > 0)
+      {
+      firsts.push_back (std::make_pair (ranges[2 * p], p));
+      }
+    }
+  std::sort (firsts.begin (), firsts.end ());
+
+  // The members owned by other processes, by owner.
+  std::vector<std::vector<int> > remoteMembers (numProcs);
+  for (size_t ii = 0; ii < internals->RemoteIds.size (); ++ii)
+    {
+    int id = internals->RemoteIds[ii];
+    std::vector<std::pair<int, int> >::iterator owner = std::upper_bound (
+      firsts.begin (), firsts.end (), std::make_pair (id, numProcs));
+    if (owner == firsts.begin () ||
+        id - (owner - 1)->first >= ranges[2 * (owner - 1)->second + 1])
+      {
+      vtkErrorMacro ("Id " << id << " is not owned by any process.");
+      continue;
+      }
+    --owner;
+    remoteMembers[owner->second].push_back (
+      this->NumberOfLocalIds + static_cast<int> (ii));
+    }
+
+  // Tell the owners which of their ids are shared with this process.
+  std::vector<int> shares (numProcs, 0);
+  std::vector<int> sharedBy (numProcs, 0);
+  int numOwners = 0;
+  for (int p = 0; p < numProcs; ++p)
+    {
+    if (!remoteMembers[p].empty ())
+      {
+      shares[p] = 1;
+      ++numOwners;
+      }
+    }
+  controller->AllReduce (&shares[0], &sharedBy[0], numProcs, vtkCommunicator::SUM_OP);
+
+  std::vector<int> headers (2 * numProcs);
+  std::vector<std::vector<int> > sentIds (numProcs);
+  std::vector<vtkMPICommunicator::Request> sends (2 * numOwners);
+  int numSends = 0;
+  for (int p = 0; p < numProcs; ++p)
+    {
+    if (remoteMembers[p].empty ())
+      {
+      continue;
+      }
+    std::vector<int>& ids = sentIds[p];
+    for (size_t ii = 0; ii < remoteMembers[p].size (); ++ii)
+      {
+      ids.push_back (internals->RemoteIds[remoteMembers[p][ii] - this->NumberOfLocalIds]);
+      }
+    headers[2 * p] = myProc;
+    headers[2 * p + 1] = static_cast<int> (ids.size ());
+    controller->NoBlockSend (&headers[2 * p], 2, p, SHARED_IDS_SIZE_TAG, sends[numSends++]);
+    controller->NoBlockSend (&ids[0], headers[2 * p + 1], p, SHARED_IDS_TAG, sends[numSends++]);
+    }
+
+  // The local members shared with each process, in the order it sent them.
+  std::vector<std::vector<int> > sharedMembers (numProcs);
+  for (int ii = 0; ii < sharedBy[myProc]; ++ii)
+    {
+    int header[2];
+    controller->Receive (header, 2, vtkMultiProcessController::ANY_SOURCE,
+                         SHARED_IDS_SIZE_TAG);
+    std::vector<int> ids (header[1]);
+    controller->Receive (&ids[0], header[1], header[0], SHARED_IDS_TAG);
+    std::vector<int>& members = sharedMembers[header[0]];
+    members.resize (ids.size ());
+    for (size_t jj = 0; jj < ids.size (); ++jj)
+      {
+      // The sender found this process owns the id.
+      members[jj] = ids[jj] - this->FirstLocalId;
+      }
+    }
+  for (int ii = 0; ii < numSends; ++ii)
+    {
+    sends[ii].Wait ();
+    }
+
+  for (int p = 0; p < numProcs; ++p)
+    {
+    if (remoteMembers[p].empty () && sharedMembers[p].empty ())
+      {
+      continue;
+      }
+    const std::vector<int>& lower = p < myProc ? remoteMembers[p] : sharedMembers[p];
+    const std::vector<int>& higher = p < myProc ? sharedMembers[p] : remoteMembers[p];
+    internals->Neighbors.push_back (vtkInternals::Neighbor ());
+    vtkInternals::Neighbor& neighbor = internals->Neighbors.back ();
+    neighbor.Process = p;
+    neighbor.Members = lower;
+    neighbor.Members.insert (neighbor.Members.end (), higher.begin (), higher.end ());
+    neighbor.SendBuffer.resize (neighbor.Members.size ());
+    neighbor.ReceiveBuffer.resize (neighbor.Members.size ());
+    }
+  return 1;
+#else
+  vtkErrorMacro ("Distributed equivalences need an MPI controller.");
+  return 0;
+#endif
+}
+
+int vtkPEquivalenceSet::PropagateMinimum (int* values)
+{
+  int numProcs = this->Controller ? this->Controller->GetNumberOfProcesses () : 1;
+  if (numProcs < 2)
+    {
+    return 0;
+    }
+
+  int rounds = 0;
+#ifdef PARAVIEW_USE_MPI
+  vtkMPIController* controller = vtkMPIController::SafeDownCast (this->Controller);
+  std::vector<vtkInternals::Neighbor>& neighbors = this->Internals->Neighbors;
+  size_t numNeighbors = neighbors.size ();
+  std::vector<vtkMPICommunicator::Request> receives (numNeighbors);
+  std::vector<vtkMPICommunicator::Request> sends (numNeighbors);
+
+  // Each round, the values of the roots of the shared members go to the
+  // neighbors only, so a value travels one process further per round.
+  int changed = 1;
+  while (changed)
+    {
+    for (size_t nn = 0; nn < numNeighbors; ++nn)
+      {
+      vtkInternals::Neighbor& neighbor = neighbors[nn];
+      int size = static_cast<int> (neighbor.Members.size ());
+      controller->NoBlockReceive (&neighbor.ReceiveBuffer[0], size,
+                                  neighbor.Process, LABELS_TAG, receives[nn]);
+      for (int ii = 0; ii < size; ++ii)
+        {
+        neighbor.SendBuffer[ii] = values[this->FindRoot (neighbor.Members[ii])];
+        }
+      controller->NoBlockSend (&neighbor.SendBuffer[0], size,
+                               neighbor.Process, LABELS_TAG, sends[nn]);
+      }
+
+    int lowered = 0;
+    for (size_t nn = 0; nn < numNeighbors; ++nn)
+      {
+      vtkInternals::Neighbor& neighbor = neighbors[nn];
+      receives[nn].Wait ();
+      for (size_t ii = 0; ii < neighbor.Members.size (); ++ii)
+        {
+        int root = this->FindRoot (neighbor.Members[ii]);
+        if (neighbor.ReceiveBuffer[ii] < values[root])
+          {
+          values[root] = neighbor.ReceiveBuffer[ii];
+          lowered = 1;
+          }
+        }
+      }
+    for (size_t nn = 0; nn < numNeighbors; ++nn)
+      {
+      sends[nn].Wait ();
+      }
+    ++rounds;
+    controller->AllReduce (&lowered, &changed, 1, vtkCommunicator::MAX_OP);
+    }
+#else
+  (void)values;
+#endif
+  return rounds;
+}
+
+int vtkPEquivalenceSet::GatherEquivalences ()
+{
+  vtkMultiProcessController* controller = this->Controller;
   int myProc = controller->GetLocalProcessId ();
   int numProcs = controller->GetNumberOfProcesses ();
 
   vtkIntArray* workingSet = vtkIntArray::New ();
-  workingSet->SetNumberOfComponents (1); 
+  workingSet->SetNumberOfComponents (1);
 
   int tag = 475893745;
   int pivot = (numProcs + 1) / 2;
@@ -68,7 +525,7 @@ int vtkPEquivalenceSet::ResolveEquivalences ()
         if (workingVal == 0) {
           continue;
         }
-        int existingVal = this->EquivalenceArray->GetValue (i); 
+        int existingVal = this->EquivalenceArray->GetValue (i);
         this->EquivalenceArray->SetValue (i, workingVal);
         if (existingVal != 0 && existingVal < workingVal)
           {
@@ -79,6 +536,7 @@ int vtkPEquivalenceSet::ResolveEquivalences ()
     pivot /= 2;
     }
   controller->Broadcast (this->EquivalenceArray, 0);
+  workingSet->Delete ();
 
   this->Superclass::ResolveEquivalences ();
   return 1;
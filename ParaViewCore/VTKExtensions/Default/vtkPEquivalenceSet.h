@@ -15,6 +15,18 @@
 // .NAME vtkPEquivalenceSet - distributed method of Equivalence
 // .SECTION Description
 // Same as EquivalenceSet, but resolving is a global operation.
+//
+// When every process gives the range of ids it owns with SetLocalIds(), the
+// set is a distributed union-find: a process only stores its own ids and
+// the ids of other processes made equivalent to them, and
+// ResolveEquivalences() exchanges the smallest equivalent id of these
+// shared ids with the processes that own them, over as many rounds as
+// needed. Its cost grows with the number of shared ids rather than with
+// the total number of ids. This needs a vtkMPIController when there is
+// more than one process.
+//
+// Otherwise, the sets of all the processes are reduced to the first one
+// and broadcast.
 // .SEE vtkEquivalenceSet
 
 #ifndef vtkPEquivalenceSet_h
@@ -23,6 +35,8 @@
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
 #include "vtkEquivalenceSet.h"
 
+class vtkMultiProcessController;
+
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkPEquivalenceSet : public vtkEquivalenceSet
 {
 public:
@@ -30,16 +44,79 @@ public:
   void PrintSelf(ostream& os, vtkIndent indent);
   static vtkPEquivalenceSet *New();
 
+  // Description:
+  // The controller of the processes resolving the equivalences. The global
+  // controller by default.
+  virtual void SetController(vtkMultiProcessController*);
+  vtkGetObjectMacro(Controller, vtkMultiProcessController);
+
+  // Description:
+  // Set the ids owned by this process, [first, first + number). They are
+  // all members of the set. Every other id given to AddEquivalence() must
+  // be owned by another process, usually a neighbor of this one. Clears
+  // the equivalences. A negative number (the default) means the ids are
+  // not distributed.
+  void SetLocalIds(int first, int number);
+  vtkGetMacro(FirstLocalId, int);
+  vtkGetMacro(NumberOfLocalIds, int);
+
+  virtual void Initialize();
+  virtual void AddEquivalence(int id1, int id2);
+
+  // Description:
+  // Return the id of the equivalent set. With local ids, only the ids of
+  // this process and the ids it made equivalent to them are known, -1 is
+  // returned for the others.
+  virtual int GetEquivalentSetId(int memberId);
+
   // Globally equivalent set IDs are reassigned to be sequential.
   virtual int ResolveEquivalences ();
 
+  // Description:
+  // The number of exchanges with the neighbors the last
+  // ResolveEquivalences() needed with local ids.
+  vtkGetMacro(NumberOfRounds, int);
+
 protected:
   vtkPEquivalenceSet();
   ~vtkPEquivalenceSet();
 
+  // Description:
+  // Resolves the equivalences when the ids are not distributed.
+  int GatherEquivalences();
+
+  // Description:
+  // Sends the ids of the other processes to their owners and finds the
+  // neighbors to exchange labels with.
+  int ExchangeSharedIds();
+
+  // Description:
+  // Lowers the value of each root to the smallest value of the roots
+  // equivalent to it in the neighbors, until no process lowers one.
+  int PropagateMinimum(int* values);
+
+  // Description:
+  // Local index of an id of this process or of an id of another process
+  // made equivalent to one of them, -1 if there is none. New ids of other
+  // processes are added when insert is true.
+  int GetLocalIndex(int id, bool insert);
+
+  // Description:
+  // The root of the tree of a local index. The tree is stored in the
+  // EquivalenceArray and its paths are compressed.
+  int FindRoot(int index);
+
+  vtkMultiProcessController* Controller;
+  int FirstLocalId;
+  int NumberOfLocalIds;
+  int NumberOfRounds;
+
 private:
   vtkPEquivalenceSet(const vtkPEquivalenceSet&);  // Not implemented.
   void operator=(const vtkPEquivalenceSet&);  // Not implemented.
+
+  class vtkInternals;
+  vtkInternals* Internals;
 };
 
 #endif /* vtkPEquivalenceSet_h */
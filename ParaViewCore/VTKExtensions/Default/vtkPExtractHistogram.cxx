@@ -104,15 +104,15 @@ int vtkPExtractHistogram::RequestData(vtkInformation *request,
   reduceFilter->SetController(this->Controller);
 
   bool isRoot = (this->Controller->GetLocalProcessId() ==0);
-  if (isRoot)
-    {
-    // PostGatherHelper needs to be set only on the root node.
-    vtkSmartPointer<vtkAttributeDataReductionFilter> rf = 
-      vtkSmartPointer<vtkAttributeDataReductionFilter>::New();
-    rf->SetAttributeType(vtkAttributeDataReductionFilter::ROW_DATA);
-    rf->SetReductionType(vtkAttributeDataReductionFilter::ADD);
-    reduceFilter->SetPostGatherHelper(rf);
-    }
+
+  // Adding bins is associative, so the histograms are added pairwise along a
+  // tree, which needs the PostGatherHelper on all nodes.
+  vtkSmartPointer<vtkAttributeDataReductionFilter> rf = 
+    vtkSmartPointer<vtkAttributeDataReductionFilter>::New();
+  rf->SetAttributeType(vtkAttributeDataReductionFilter::ROW_DATA);
+  rf->SetReductionType(vtkAttributeDataReductionFilter::ADD);
+  reduceFilter->SetPostGatherHelper(rf);
+  reduceFilter->SetTreeReduction(1);
 
   vtkSmartPointer<vtkTable> copy = vtkSmartPointer<vtkTable>::New();
   copy->ShallowCopy(output);
@@ -44,6 +44,9 @@ vtkPGenericEnSightReader::vtkPGenericEnSightReader()
   // -2 is the default starting value
   this->MultiProcessLocalProcessId = -2;
   this->MultiProcessNumberOfProcesses = -2;
+
+  this->UseOffsetIndexFile = 0;
+  this->CacheGeometry = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -143,6 +146,8 @@ int vtkPGenericEnSightReader::RequestInformation(
   if ( reader )
     {
     //this dynamic cast never should fail
+    reader->SetUseOffsetIndexFile(this->UseOffsetIndexFile);
+    reader->SetCacheGeometry(this->CacheGeometry);
     reader->RequestInformation(request, inputVector, outputVector);
     }
   this->Reader->SetParticleCoordinatesByIndex(this->ParticleCoordinatesByIndex);
@@ -205,4 +210,6 @@ void vtkPGenericEnSightReader::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
   os << indent << "MultiProcessLocalProcessId: " << this->MultiProcessLocalProcessId << endl;
   os << indent << "MultiProcessNumberOfProcesses: " << this->MultiProcessNumberOfProcesses << endl;
+  os << indent << "UseOffsetIndexFile: " << this->UseOffsetIndexFile << endl;
+  os << indent << "CacheGeometry: " << this->CacheGeometry << endl;
 }
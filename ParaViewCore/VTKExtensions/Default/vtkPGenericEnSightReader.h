@@ -35,6 +35,30 @@ public:
   vtkTypeMacro(vtkPGenericEnSightReader, vtkGenericEnSightReader);
   void PrintSelf(ostream& os, vtkIndent indent);
 
+  // Description:
+  // When on, the byte offsets of the time steps found in single file
+  // transient data are kept in an index file next to the case file, named
+  // after it with the ".offsets" extension, and reused when the data is read
+  // again and by all processes, so that reading a time step does not scan the
+  // file from its beginning. The index is written by the first process only,
+  // entries for data files that changed since are ignored. Only used by the
+  // parallel EnSight Gold readers. Off by default.
+  vtkSetMacro(UseOffsetIndexFile, int);
+  vtkGetMacro(UseOffsetIndexFile, int);
+  vtkBooleanMacro(UseOffsetIndexFile, int);
+
+  // Description:
+  // When on, the parts read from the geometry file are kept and reused, with
+  // their points, cells and distribution among the processes, for the time
+  // steps that map to the same geometry file and time step in that file, as
+  // for static geometry, i.e. a geometry file without time set in the case
+  // file. Only the variable files are then read. The geometry is read again
+  // when its file changes. Only used by the parallel EnSight Gold readers.
+  // On by default.
+  vtkSetMacro(CacheGeometry, int);
+  vtkGetMacro(CacheGeometry, int);
+  vtkBooleanMacro(CacheGeometry, int);
+
 protected:
   vtkPGenericEnSightReader();
   ~vtkPGenericEnSightReader();
@@ -53,6 +77,9 @@ protected:
   int MultiProcessLocalProcessId;
   int MultiProcessNumberOfProcesses;
 
+  int UseOffsetIndexFile;
+  int CacheGeometry;
+
 private:
   vtkPGenericEnSightReader(const vtkPGenericEnSightReader&);  // Not implemented.
   void operator=(const vtkPGenericEnSightReader&);  // Not implemented.
@@ -15,6 +15,7 @@
 #include "vtkPVArrayCalculator.h"
 
 #include "vtkCellData.h"
+#include "vtkDataArray.h"
 #include "vtkDataObject.h"
 #include "vtkDataSet.h"
 #include "vtkFunctionParser.h"
@@ -23,7 +24,11 @@
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPointSet.h"
+#include "vtkPVCompiledExpression.h"
 #include "vtkPVPostFilter.h"
+#include "vtkSmartPointer.h"
 
 #include <algorithm>
 #include <assert.h>
@@ -61,6 +66,7 @@ vtkStandardNewMacro( vtkPVArrayCalculator );
 // ----------------------------------------------------------------------------
 vtkPVArrayCalculator::vtkPVArrayCalculator()
 {
+  this->UseCompiledExpressions = true;
 }
 
 // ----------------------------------------------------------------------------
@@ -188,6 +194,13 @@ int vtkPVArrayCalculator::RequestData
     // put is the input of a (some) subsequent calculator(s) or the user changes
     // the input of a downstream calculator.
     this->UpdateArrayAndVariableNames( input, dataAttrs );
+
+    if ( dsInput && this->UseCompiledExpressions &&
+         this->RequestCompiledData( dsInput, dataAttrs, numTuples,
+                                    outputVector ) )
+      {
+      return 1;
+      }
     }
   
   input      = NULL;
@@ -198,8 +211,146 @@ int vtkPVArrayCalculator::RequestData
   return this->Superclass::RequestData( request, inputVector, outputVector );
 }
 
+// ----------------------------------------------------------------------------
+bool vtkPVArrayCalculator::RequestCompiledData
+  ( vtkDataSet * input, vtkDataSetAttributes * inDataAttrs,
+    vtkIdType numTuples, vtkInformationVector * outputVector )
+{
+  if ( !this->Function || !this->ResultArrayName ||
+       !*this->ResultArrayName )
+    {
+    return false;
+    }
+
+  bool pointData = this->AttributeMode == VTK_ATTRIBUTE_MODE_DEFAULT ||
+                   this->AttributeMode == VTK_ATTRIBUTE_MODE_USE_POINT_DATA;
+  vtkPointSet * psInput = vtkPointSet::SafeDownCast( input );
+  vtkDataArray * points = psInput && psInput->GetPoints() ?
+                          psInput->GetPoints()->GetData() : NULL;
+
+  // Register the variables of the superclass. Those whose values cannot be
+  // read, such as the coordinates when iterating over cells, are registered
+  // without array so that functions using them fail to compile.
+  vtkPVCompiledExpression expression;
+  for ( int i = 0; i < this->NumberOfScalarArrays; i ++ )
+    {
+    expression.AddScalarVariable( this->ScalarVariableNames[i],
+      inDataAttrs->GetArray( this->ScalarArrayNames[i] ),
+      this->SelectedScalarComponents[i] );
+    }
+  for ( int i = 0; i < this->NumberOfVectorArrays; i ++ )
+    {
+    expression.AddVectorVariable( this->VectorVariableNames[i],
+      inDataAttrs->GetArray( this->VectorArrayNames[i] ),
+      this->SelectedVectorComponents[i] );
+    }
+  for ( int i = 0; i < this->NumberOfCoordinateScalarArrays; i ++ )
+    {
+    const char * name = this->CoordinateScalarVariableNames[i];
+    int component = this->SelectedCoordinateScalarComponents[i];
+    if ( pointData && points )
+      {
+      expression.AddScalarVariable( name, points, component );
+      }
+    else
+      {
+      expression.AddCoordinateScalarVariable( name,
+        pointData ? input : NULL, component );
+      }
+    }
+  for ( int i = 0; i < this->NumberOfCoordinateVectorArrays; i ++ )
+    {
+    const char * name = this->CoordinateVectorVariableNames[i];
+    const int * components = this->SelectedCoordinateVectorComponents[i];
+    if ( pointData && points )
+      {
+      expression.AddVectorVariable( name, points, components );
+      }
+    else
+      {
+      expression.AddCoordinateVectorVariable( name,
+        pointData ? input : NULL, components );
+      }
+    }
+
+  if ( !expression.Compile( this->Function ) )
+    {
+    return false;
+    }
+
+  // Leave the error reporting of unsupported combinations to the superclass.
+  bool vectorResult = expression.IsVectorResult();
+  if ( ( this->CoordinateResults &&
+         ( !vectorResult || !pointData || !psInput ) ) ||
+       ( this->ResultNormals && !vectorResult ) )
+    {
+    return false;
+    }
+
+  vtkSmartPointer<vtkPoints> resultPoints;
+  vtkSmartPointer<vtkDataArray> resultArray;
+  if ( this->CoordinateResults )
+    {
+    resultPoints = vtkSmartPointer<vtkPoints>::New();
+    resultPoints->SetNumberOfPoints( numTuples );
+    if ( !expression.Evaluate( numTuples, resultPoints->GetData() ) )
+      {
+      return false;
+      }
+    }
+  else
+    {
+    resultArray.TakeReference(
+      vtkDataArray::CreateDataArray( this->ResultArrayType ) );
+    if ( !resultArray )
+      {
+      return false;
+      }
+    resultArray->SetNumberOfComponents( vectorResult ? 3 : 1 );
+    resultArray->SetNumberOfTuples( numTuples );
+    if ( !expression.Evaluate( numTuples, resultArray.GetPointer() ) )
+      {
+      return false;
+      }
+    }
+
+  vtkDataSet * output = vtkDataSet::GetData( outputVector, 0 );
+  output->CopyStructure( input );
+  output->CopyAttributes( input );
+  if ( resultPoints )
+    {
+    vtkPointSet::SafeDownCast( output )->SetPoints( resultPoints );
+    return true;
+    }
+
+  resultArray->SetName( this->ResultArrayName );
+  vtkDataSetAttributes * outDataAttrs = pointData ?
+    static_cast<vtkDataSetAttributes *>( output->GetPointData() ) :
+    static_cast<vtkDataSetAttributes *>( output->GetCellData() );
+  outDataAttrs->AddArray( resultArray );
+  if ( this->ResultNormals )
+    {
+    outDataAttrs->SetActiveNormals( this->ResultArrayName );
+    }
+  else if ( this->ResultTCoords )
+    {
+    outDataAttrs->SetActiveTCoords( this->ResultArrayName );
+    }
+  else if ( vectorResult )
+    {
+    outDataAttrs->SetActiveVectors( this->ResultArrayName );
+    }
+  else
+    {
+    outDataAttrs->SetActiveScalars( this->ResultArrayName );
+    }
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 void vtkPVArrayCalculator::PrintSelf( ostream & os, vtkIndent indent )
 {
   this->Superclass::PrintSelf( os, indent );
+  os << indent << "UseCompiledExpressions: "
+     << this->UseCompiledExpressions << endl;
 }
@@ -22,8 +22,13 @@
 //  their mapping with the input fields. We extend vtkArrayCalculator to
 //  automatically add scalar/vector fields mapping using the array available in
 //  the input.
+//
+//  The function is compiled by vtkPVCompiledExpression and evaluated by
+//  blocks of tuples on the threads of vtkSMPTools, unless it uses functions
+//  that are not supported or produces invalid values, in which case the
+//  vtkFunctionParser of vtkArrayCalculator evaluates it, one tuple at a time.
 // .SECTION See Also
-//  vtkArrayCalculator vtkFunctionParser
+//  vtkArrayCalculator vtkFunctionParser vtkPVCompiledExpression
 
 #ifndef vtkPVArrayCalculator_h
 #define vtkPVArrayCalculator_h
@@ -32,7 +37,9 @@
 #include "vtkArrayCalculator.h"
 
 class vtkDataObject;
+class vtkDataSet;
 class vtkDataSetAttributes;
+class vtkInformationVector;
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkPVArrayCalculator : public vtkArrayCalculator
 {
@@ -42,6 +49,14 @@ public:
 
   static vtkPVArrayCalculator * New();
 
+  // Description:
+  // When on (the default), compile the function to evaluate it concurrently,
+  // by blocks of tuples. Functions that cannot be compiled are still
+  // evaluated by vtkFunctionParser.
+  vtkSetMacro(UseCompiledExpressions, bool);
+  vtkGetMacro(UseCompiledExpressions, bool);
+  vtkBooleanMacro(UseCompiledExpressions, bool);
+
 protected:
   vtkPVArrayCalculator();
   ~vtkPVArrayCalculator();
@@ -59,6 +74,19 @@ protected:
   // RequestData() only.
   void    UpdateArrayAndVariableNames( vtkDataObject        * theInputObj, 
                                        vtkDataSetAttributes * inDataAttrs );
+
+  // Description:
+  // Evaluate the compiled function for the numTuples tuples of inDataAttrs
+  // and produce the output as the superclass does. Returns false, leaving
+  // the output untouched, if the function cannot be compiled or produces
+  // invalid values, for the superclass to evaluate it instead.
+  bool    RequestCompiledData( vtkDataSet           * input,
+                               vtkDataSetAttributes * inDataAttrs,
+                               vtkIdType              numTuples,
+                               vtkInformationVector * outputVector );
+
+  bool UseCompiledExpressions;
+
 private:
   vtkPVArrayCalculator( const vtkPVArrayCalculator & ); // Not implemented.
   void operator = ( const vtkPVArrayCalculator & );     // Not implemented.
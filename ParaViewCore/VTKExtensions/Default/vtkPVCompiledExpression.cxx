@@ -0,0 +1,1118 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkPVCompiledExpression.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkPVCompiledExpression.h"
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // Number of tuples each operation processes at once. The registers of a
+  // program, BlockSize doubles each, then stay in the cache.
+  enum { BlockSize = 256 };
+
+  enum vtkOperationType
+    {
+    LOAD,
+    NEGATE,
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    SQUARE,
+    POWER,
+    MINIMUM,
+    MAXIMUM,
+    ABSOLUTE_VALUE,
+    EXPONENTIAL,
+    CEILING,
+    FLOOR,
+    LOGARITHM10,
+    LOGARITHME,
+    SQUARE_ROOT,
+    SINE,
+    COSINE,
+    TANGENT,
+    ARCSINE,
+    ARCCOSINE,
+    ARCTANGENT,
+    HYPERBOLIC_SINE,
+    HYPERBOLIC_COSINE,
+    HYPERBOLIC_TANGENT,
+    // Vector functions, compiled into the operations above.
+    MAGNITUDE,
+    NORMALIZE,
+    CROSS_PRODUCT
+    };
+
+  struct vtkFunctionInfo
+    {
+    const char* Name;
+    int Operation;
+    int NumberOfArguments;
+    };
+
+  // The functions documented for the Calculator. log is left out: whether
+  // it is the natural or the decimal logarithm changed over time.
+  const vtkFunctionInfo Functions[] =
+    {
+      { "abs", ABSOLUTE_VALUE, 1 },
+      { "exp", EXPONENTIAL, 1 },
+      { "ceil", CEILING, 1 },
+      { "floor", FLOOR, 1 },
+      { "log10", LOGARITHM10, 1 },
+      { "ln", LOGARITHME, 1 },
+      { "sqrt", SQUARE_ROOT, 1 },
+      { "sin", SINE, 1 },
+      { "cos", COSINE, 1 },
+      { "tan", TANGENT, 1 },
+      { "asin", ARCSINE, 1 },
+      { "acos", ARCCOSINE, 1 },
+      { "atan", ARCTANGENT, 1 },
+      { "sinh", HYPERBOLIC_SINE, 1 },
+      { "cosh", HYPERBOLIC_COSINE, 1 },
+      { "tanh", HYPERBOLIC_TANGENT, 1 },
+      { "min", MINIMUM, 2 },
+      { "max", MAXIMUM, 2 },
+      { "mag", MAGNITUDE, 1 },
+      { "norm", NORMALIZE, 1 },
+      { "cross", CROSS_PRODUCT, 2 }
+    };
+  const int NumberOfFunctions =
+    static_cast<int>(sizeof(Functions) / sizeof(Functions[0]));
+
+  const char* const VectorConstants[3] = { "iHat", "jHat", "kHat" };
+
+  // Whether operation may produce the invalid values vtkFunctionParser checks
+  // for: divisions by zero, square roots and logarithms of negative values,
+  // arcsines and arccosines out of [-1, 1], etc. These produce NaNs or
+  // infinities.
+  bool vtkIsChecked(int operation)
+    {
+    switch (operation)
+      {
+      case DIVIDE:
+      case POWER:
+      case LOGARITHM10:
+      case LOGARITHME:
+      case SQUARE_ROOT:
+      case ARCSINE:
+      case ARCCOSINE:
+        return true;
+      default:
+        return false;
+      }
+    }
+
+  // Returns whether the n values are all finite. Multiplying by 0 keeps
+  // finite values to 0 and turns infinities and NaNs into NaNs.
+  bool vtkAllFinite(const double* values, int n)
+    {
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i)
+      {
+      sum += values[i] * 0.0;
+      }
+    return sum == 0.0;
+    }
+
+#define vtkCompiledLoop(expression) \
+  for (int i = 0; i < n; ++i) \
+    { \
+    r[i] = (expression); \
+    } \
+  break
+
+  // Computes the n results r of operation from the operands a and b. Used
+  // both to run the programs and to fold constants.
+  void vtkExecute(int operation, const double* a, const double* b, double* r,
+    int n)
+    {
+    switch (operation)
+      {
+      case NEGATE: vtkCompiledLoop(-a[i]);
+      case ADD: vtkCompiledLoop(a[i] + b[i]);
+      case SUBTRACT: vtkCompiledLoop(a[i] - b[i]);
+      case MULTIPLY: vtkCompiledLoop(a[i] * b[i]);
+      case DIVIDE: vtkCompiledLoop(a[i] / b[i]);
+      case SQUARE: vtkCompiledLoop(a[i] * a[i]);
+      case POWER: vtkCompiledLoop(pow(a[i], b[i]));
+      case MINIMUM: vtkCompiledLoop(a[i] < b[i]? a[i] : b[i]);
+      case MAXIMUM: vtkCompiledLoop(a[i] > b[i]? a[i] : b[i]);
+      case ABSOLUTE_VALUE: vtkCompiledLoop(fabs(a[i]));
+      case EXPONENTIAL: vtkCompiledLoop(exp(a[i]));
+      case CEILING: vtkCompiledLoop(ceil(a[i]));
+      case FLOOR: vtkCompiledLoop(floor(a[i]));
+      case LOGARITHM10: vtkCompiledLoop(log10(a[i]));
+      case LOGARITHME: vtkCompiledLoop(log(a[i]));
+      case SQUARE_ROOT: vtkCompiledLoop(sqrt(a[i]));
+      case SINE: vtkCompiledLoop(sin(a[i]));
+      case COSINE: vtkCompiledLoop(cos(a[i]));
+      case TANGENT: vtkCompiledLoop(tan(a[i]));
+      case ARCSINE: vtkCompiledLoop(asin(a[i]));
+      case ARCCOSINE: vtkCompiledLoop(acos(a[i]));
+      case ARCTANGENT: vtkCompiledLoop(atan(a[i]));
+      case HYPERBOLIC_SINE: vtkCompiledLoop(sinh(a[i]));
+      case HYPERBOLIC_COSINE: vtkCompiledLoop(cosh(a[i]));
+      case HYPERBOLIC_TANGENT: vtkCompiledLoop(tanh(a[i]));
+      }
+    }
+
+#undef vtkCompiledLoop
+
+  typedef void (*vtkLoadFunction)(const void* data, int numComps,
+    int component, vtkIdType begin, int n, double* values);
+
+  template <class T>
+  void vtkLoadComponent(const void* data, int numComps, int component,
+    vtkIdType begin, int n, double* values)
+    {
+    const T* value =
+      static_cast<const T*>(data) + begin * numComps + component;
+    for (int i = 0; i < n; ++i, value += numComps)
+      {
+      values[i] = static_cast<double>(*value);
+      }
+    }
+
+  typedef void (*vtkStoreFunction)(const double* const results[3],
+    int numComps, vtkIdType begin, int n, void* data);
+
+  template <class T>
+  void vtkStoreTuples(const double* const results[3], int numComps,
+    vtkIdType begin, int n, void* data)
+    {
+    T* tuples = static_cast<T*>(data) + begin * numComps;
+    for (int comp = 0; comp < numComps; ++comp)
+      {
+      const double* result = results[comp];
+      for (int i = 0; i < n; ++i)
+        {
+        tuples[i * numComps + comp] = static_cast<T>(result[i]);
+        }
+      }
+    }
+
+  // Where the values of variables come from: the components of an array
+  // read through its raw pointer, or the points of a data set.
+  struct vtkSource
+    {
+    vtkDataArray* Array;
+    vtkLoadFunction Load;
+    vtkDataSet* DataSet;
+    };
+
+  struct vtkVariable
+    {
+    std::string Name;
+    int Size; // 1 for scalars, 3 for vectors
+    int Source; // -1 if the variable cannot be compiled
+    int Components[3];
+    };
+
+  // An operation of a program. A and B are the registers of the operands,
+  // -1 if unused. Loads read Component of Source instead.
+  struct vtkOperation
+    {
+    int Type;
+    int Result;
+    int A;
+    int B;
+    int Source;
+    int Component;
+    };
+
+  struct vtkProgram
+    {
+    std::vector<vtkOperation> Operations;
+    // Registers holding constants, filled once per thread, and their value.
+    std::vector<std::pair<int, double> > Constants;
+    int NumberOfRegisters;
+    int ResultSize;
+    int Results[3];
+    };
+
+  // A value being compiled: the registers of its components, 1 for scalars
+  // and 3 for vectors. Size is 0 on errors.
+  struct vtkValue
+    {
+    int Size;
+    int Registers[3];
+    };
+
+  // Recursive descent parser of the functions of the Calculator, emitting the
+  // operations that compute them. Every emitted value gets its own register;
+  // the registers are allocated later. Operations whose operands are all
+  // constant are computed right away.
+  //
+  // The usual precedence applies: ^ binds tighter than unary minus, which
+  // binds tighter than * / and . (dot product), then + and -. Chained powers
+  // (a^b^c) and negated powers (-a^b) are rejected, as vtkFunctionParser
+  // does not document how it groups them.
+  class vtkExpressionCompiler
+    {
+  public:
+    std::vector<vtkOperation> Operations;
+    std::vector<bool> IsConstant;
+    std::vector<double> Values;
+
+    vtkExpressionCompiler(const std::vector<vtkVariable>& variables) :
+      Variables(variables), Position(0), Failed(false), PowerSeen(false)
+      {
+      }
+
+    vtkValue Compile(const std::string& function)
+      {
+      this->Function = function;
+      this->Position = 0;
+      vtkValue value = this->ParseExpression();
+      if (this->Failed || this->Position != this->Function.size())
+        {
+        return Error();
+        }
+      return value;
+      }
+
+  private:
+    const std::vector<vtkVariable>& Variables;
+    std::string Function;
+    size_t Position;
+    bool Failed;
+    // Whether the last value parsed is a power, see ParseUnary().
+    bool PowerSeen;
+    std::map<std::pair<int, int>, int> Loads;
+
+    static vtkValue Error()
+      {
+      vtkValue value = { 0, { -1, -1, -1 } };
+      return value;
+      }
+
+    static vtkValue Scalar(int r)
+      {
+      vtkValue value = { r < 0? 0 : 1, { r, r, r } };
+      return value;
+      }
+
+    char Peek(size_t offset = 0) const
+      {
+      size_t position = this->Position + offset;
+      return position < this->Function.size()? this->Function[position] : '\0';
+      }
+
+    int NewRegister(bool constant, double value)
+      {
+      this->IsConstant.push_back(constant);
+      this->Values.push_back(value);
+      return static_cast<int>(this->IsConstant.size()) - 1;
+      }
+
+    int Constant(double value)
+      {
+      return this->NewRegister(true, value);
+      }
+
+    int Load(int source, int component)
+      {
+      std::pair<int, int> key(source, component);
+      std::map<std::pair<int, int>, int>::iterator iter = this->Loads.find(key);
+      if (iter != this->Loads.end())
+        {
+        return iter->second;
+        }
+      vtkOperation operation =
+        { LOAD, this->NewRegister(false, 0.0), -1, -1, source, component };
+      this->Operations.push_back(operation);
+      this->Loads[key] = operation.Result;
+      return operation.Result;
+      }
+
+    int Emit(int type, int a, int b = -1)
+      {
+      if (a < 0 || this->Failed)
+        {
+        this->Failed = true;
+        return -1;
+        }
+      if (this->IsConstant[a] && (b < 0 || this->IsConstant[b]))
+        {
+        double valueA = this->Values[a];
+        double valueB = b < 0? 0.0 : this->Values[b];
+        double result;
+        vtkExecute(type, &valueA, &valueB, &result, 1);
+        if (vtkIsChecked(type) && !vtkAllFinite(&result, 1))
+          {
+          // Let vtkFunctionParser report or replace the invalid value.
+          this->Failed = true;
+          return -1;
+          }
+        return this->Constant(result);
+        }
+      vtkOperation operation =
+        { type, this->NewRegister(false, 0.0), a, b, -1, -1 };
+      this->Operations.push_back(operation);
+      return operation.Result;
+      }
+
+    int Dot(const vtkValue& a, const vtkValue& b)
+      {
+      int x = this->Emit(MULTIPLY, a.Registers[0], b.Registers[0]);
+      int y = this->Emit(MULTIPLY, a.Registers[1], b.Registers[1]);
+      int z = this->Emit(MULTIPLY, a.Registers[2], b.Registers[2]);
+      return this->Emit(ADD, this->Emit(ADD, x, y), z);
+      }
+
+    // expression: term (('+' | '-') term)*
+    vtkValue ParseExpression()
+      {
+      vtkValue left = this->ParseTerm();
+      while (left.Size && (this->Peek() == '+' || this->Peek() == '-'))
+        {
+        int type = this->Function[this->Position++] == '+'? ADD : SUBTRACT;
+        vtkValue right = this->ParseTerm();
+        if (right.Size != left.Size)
+          {
+          return Error();
+          }
+        for (int c = 0; c < left.Size; ++c)
+          {
+          left.Registers[c] =
+            this->Emit(type, left.Registers[c], right.Registers[c]);
+          }
+        }
+      return left;
+      }
+
+    // term: unary (('*' | '/' | '.') unary)*
+    vtkValue ParseTerm()
+      {
+      vtkValue left = this->ParseUnary();
+      while (left.Size &&
+        (this->Peek() == '*' || this->Peek() == '/' || this->Peek() == '.'))
+        {
+        char op = this->Function[this->Position++];
+        vtkValue right = this->ParseUnary();
+        if (!right.Size)
+          {
+          return Error();
+          }
+        if (op == '*' && (left.Size == 1 || right.Size == 1))
+          {
+          // scalar * scalar, scalar * vector or vector * scalar.
+          vtkValue product = left.Size == 1? right : left;
+          for (int c = 0; c < product.Size; ++c)
+            {
+            product.Registers[c] = this->Emit(MULTIPLY,
+              left.Registers[left.Size == 1? 0 : c],
+              right.Registers[right.Size == 1? 0 : c]);
+            }
+          left = product;
+          }
+        else if (op == '/' && left.Size == 1 && right.Size == 1)
+          {
+          left = Scalar(
+            this->Emit(DIVIDE, left.Registers[0], right.Registers[0]));
+          }
+        else if (op == '.' && left.Size == 3 && right.Size == 3)
+          {
+          left = Scalar(this->Dot(left, right));
+          }
+        else
+          {
+          return Error();
+          }
+        }
+      return left;
+      }
+
+    // unary: '-' unary | power
+    vtkValue ParseUnary()
+      {
+      if (this->Peek() != '-')
+        {
+        return this->ParsePower();
+        }
+      ++this->Position;
+      vtkValue value = this->ParseUnary();
+      if (this->PowerSeen)
+        {
+        return Error();
+        }
+      for (int c = 0; c < value.Size; ++c)
+        {
+        value.Registers[c] = this->Emit(NEGATE, value.Registers[c]);
+        }
+      return value;
+      }
+
+    // power: primary ('^' unary)?
+    vtkValue ParsePower()
+      {
+      vtkValue base = this->ParsePrimary();
+      if (!base.Size || this->Peek() != '^')
+        {
+        return base;
+        }
+      ++this->Position;
+      vtkValue exponent = this->ParseUnary();
+      if (base.Size != 1 || exponent.Size != 1 || this->PowerSeen)
+        {
+        return Error();
+        }
+      int e = exponent.Registers[0];
+      int result = this->IsConstant[e] && this->Values[e] == 2.0?
+        this->Emit(SQUARE, base.Registers[0]) :
+        this->Emit(POWER, base.Registers[0], e);
+      this->PowerSeen = true;
+      return Scalar(result);
+      }
+
+    // primary: number | '(' expression ')' | variable | constant | function
+    vtkValue ParsePrimary()
+      {
+      vtkValue value = Error();
+      char c = this->Peek();
+      if (isdigit(static_cast<unsigned char>(c)) ||
+        (c == '.' && isdigit(static_cast<unsigned char>(this->Peek(1)))))
+        {
+        value = this->ParseNumber();
+        }
+      else if (c == '(')
+        {
+        ++this->Position;
+        value = this->ParseExpression();
+        if (this->Peek() != ')')
+          {
+          return Error();
+          }
+        ++this->Position;
+        }
+      else
+        {
+        value = this->ParseName();
+        }
+      this->PowerSeen = false;
+      return value;
+      }
+
+    vtkValue ParseNumber()
+      {
+      size_t end = this->Position;
+      const std::string& f = this->Function;
+      while (end < f.size() && isdigit(static_cast<unsigned char>(f[end])))
+        {
+        ++end;
+        }
+      if (end < f.size() && f[end] == '.')
+        {
+        ++end;
+        while (end < f.size() && isdigit(static_cast<unsigned char>(f[end])))
+          {
+          ++end;
+          }
+        }
+      if (end < f.size() && (f[end] == 'e' || f[end] == 'E'))
+        {
+        size_t exponent = end + 1;
+        if (exponent < f.size() && (f[exponent] == '+' || f[exponent] == '-'))
+          {
+          ++exponent;
+          }
+        if (exponent < f.size() &&
+          isdigit(static_cast<unsigned char>(f[exponent])))
+          {
+          end = exponent;
+          while (end < f.size() && isdigit(static_cast<unsigned char>(f[end])))
+            {
+            ++end;
+            }
+          }
+        }
+      std::string number = f.substr(this->Position, end - this->Position);
+      this->Position = end;
+      return Scalar(this->Constant(strtod(number.c_str(), NULL)));
+      }
+
+    // The longest variable, constant or function name at the position wins.
+    // Function names must be followed by '('. Names of different kinds of
+    // the same length are ambiguous.
+    vtkValue ParseName()
+      {
+      const std::string& f = this->Function;
+      size_t length = 0;
+      bool ambiguous = false;
+      const vtkVariable* variable = NULL;
+      int constant = -1;
+      const vtkFunctionInfo* function = NULL;
+
+      for (size_t cc = 0; cc < this->Variables.size(); ++cc)
+        {
+        const std::string& name = this->Variables[cc].Name;
+        if (!name.empty() && f.compare(this->Position, name.size(), name) == 0 &&
+          name.size() >= length)
+          {
+          ambiguous = name.size() == length;
+          length = name.size();
+          variable = &this->Variables[cc];
+          }
+        }
+      for (int cc = 0; cc < 3; ++cc)
+        {
+        size_t size = strlen(VectorConstants[cc]);
+        if (f.compare(this->Position, size, VectorConstants[cc]) == 0 &&
+          size >= length)
+          {
+          ambiguous = size == length;
+          length = size;
+          variable = NULL;
+          constant = cc;
+          }
+        }
+      for (int cc = 0; cc < NumberOfFunctions; ++cc)
+        {
+        size_t size = strlen(Functions[cc].Name);
+        if (f.compare(this->Position, size, Functions[cc].Name) == 0 &&
+          this->Peek(size) == '(' && size >= length)
+          {
+          ambiguous = size == length;
+          length = size;
+          variable = NULL;
+          constant = -1;
+          function = &Functions[cc];
+          }
+        }
+      if (length == 0 || ambiguous)
+        {
+        return Error();
+        }
+      this->Position += length;
+
+      vtkValue value = Error();
+      if (variable)
+        {
+        if (variable->Source < 0)
+          {
+          return Error();
+          }
+        value.Size = variable->Size;
+        for (int c = 0; c < variable->Size; ++c)
+          {
+          value.Registers[c] =
+            this->Load(variable->Source, variable->Components[c]);
+          }
+        }
+      else if (constant >= 0)
+        {
+        value.Size = 3;
+        for (int c = 0; c < 3; ++c)
+          {
+          value.Registers[c] = this->Constant(c == constant? 1.0 : 0.0);
+          }
+        }
+      else
+        {
+        value = this->ParseFunction(*function);
+        }
+      return value;
+      }
+
+    vtkValue ParseFunction(const vtkFunctionInfo& function)
+      {
+      ++this->Position; // '('
+      vtkValue a = this->ParseExpression();
+      vtkValue b = Error();
+      if (function.NumberOfArguments == 2)
+        {
+        if (!a.Size || this->Peek() != ',')
+          {
+          return Error();
+          }
+        ++this->Position;
+        b = this->ParseExpression();
+        }
+      if (!a.Size || this->Peek() != ')')
+        {
+        return Error();
+        }
+      ++this->Position;
+
+      switch (function.Operation)
+        {
+        case MAGNITUDE:
+          if (a.Size != 3)
+            {
+            return Error();
+            }
+          return Scalar(this->Emit(SQUARE_ROOT, this->Dot(a, a)));
+
+        case NORMALIZE:
+          {
+          if (a.Size != 3)
+            {
+            return Error();
+            }
+          int magnitude = this->Emit(SQUARE_ROOT, this->Dot(a, a));
+          for (int c = 0; c < 3; ++c)
+            {
+            a.Registers[c] = this->Emit(DIVIDE, a.Registers[c], magnitude);
+            }
+          return a;
+          }
+
+        case CROSS_PRODUCT:
+          {
+          if (a.Size != 3 || b.Size != 3)
+            {
+            return Error();
+            }
+          vtkValue value = { 3, { -1, -1, -1 } };
+          for (int c = 0; c < 3; ++c)
+            {
+            int i = (c + 1) % 3;
+            int j = (c + 2) % 3;
+            value.Registers[c] = this->Emit(SUBTRACT,
+              this->Emit(MULTIPLY, a.Registers[i], b.Registers[j]),
+              this->Emit(MULTIPLY, a.Registers[j], b.Registers[i]));
+            }
+          return value;
+          }
+
+        default:
+          if (a.Size != 1 ||
+            (function.NumberOfArguments == 2 && b.Size != 1))
+            {
+            return Error();
+            }
+          return Scalar(
+            this->Emit(function.Operation, a.Registers[0], b.Registers[0]));
+        }
+      }
+    };
+
+  // Runs a program over ranges of tuples, by blocks of BlockSize tuples.
+  // Every thread has its own registers. A thread stops at the first invalid
+  // value, the results are then discarded anyway.
+  class vtkProgramEvaluator
+    {
+  public:
+    const vtkProgram& Program;
+    const std::vector<vtkSource>& Sources;
+    vtkStoreFunction Store;
+    void* Output;
+    vtkSMPThreadLocal<std::vector<double> > Registers;
+    vtkSMPThreadLocal<unsigned char> Invalid;
+
+    vtkProgramEvaluator(const vtkProgram& program,
+      const std::vector<vtkSource>& sources, vtkStoreFunction store,
+      void* output) :
+      Program(program), Sources(sources), Store(store), Output(output)
+      {
+      }
+
+    void Initialize()
+      {
+      std::vector<double>& registers = this->Registers.Local();
+      registers.resize(
+        static_cast<size_t>(this->Program.NumberOfRegisters) * BlockSize);
+      for (size_t cc = 0; cc < this->Program.Constants.size(); ++cc)
+        {
+        std::vector<double>::iterator first = registers.begin() +
+          this->Program.Constants[cc].first * BlockSize;
+        std::fill(first, first + BlockSize, this->Program.Constants[cc].second);
+        }
+      this->Invalid.Local() = 0;
+      }
+
+    void operator()(vtkIdType begin, vtkIdType end)
+      {
+      unsigned char& invalid = this->Invalid.Local();
+      double* registers = &this->Registers.Local()[0];
+      const double* results[3];
+      for (int c = 0; c < 3; ++c)
+        {
+        results[c] = registers + this->Program.Results[c] * BlockSize;
+        }
+
+      const std::vector<vtkOperation>& operations = this->Program.Operations;
+      for (vtkIdType blockBegin = begin; blockBegin < end && !invalid;
+        blockBegin += BlockSize)
+        {
+        int n = static_cast<int>(
+          std::min<vtkIdType>(BlockSize, end - blockBegin));
+        for (size_t cc = 0; cc < operations.size() && !invalid; ++cc)
+          {
+          const vtkOperation& operation = operations[cc];
+          double* r = registers + operation.Result * BlockSize;
+          if (operation.Type == LOAD)
+            {
+            this->Load(operation, blockBegin, n, r);
+            continue;
+            }
+          vtkExecute(operation.Type, registers + operation.A * BlockSize,
+            operation.B < 0? NULL : registers + operation.B * BlockSize, r, n);
+          if (vtkIsChecked(operation.Type) && !vtkAllFinite(r, n))
+            {
+            invalid = 1;
+            }
+          }
+        if (!invalid)
+          {
+          this->Store(
+            results, this->Program.ResultSize, blockBegin, n, this->Output);
+          }
+        }
+      }
+
+    void Reduce()
+      {
+      }
+
+    bool IsValid()
+      {
+      vtkSMPThreadLocal<unsigned char>::iterator iter;
+      for (iter = this->Invalid.begin(); iter != this->Invalid.end(); ++iter)
+        {
+        if (*iter)
+          {
+          return false;
+          }
+        }
+      return true;
+      }
+
+  private:
+    void Load(const vtkOperation& operation, vtkIdType begin, int n,
+      double* values) const
+      {
+      const vtkSource& source = this->Sources[operation.Source];
+      if (source.Load)
+        {
+        source.Load(source.Array->GetVoidPointer(0),
+          source.Array->GetNumberOfComponents(), operation.Component, begin,
+          n, values);
+        return;
+        }
+      double point[3];
+      for (int i = 0; i < n; ++i)
+        {
+        source.DataSet->GetPoint(begin + i, point);
+        values[i] = point[operation.Component];
+        }
+      }
+
+    void operator=(const vtkProgramEvaluator&); // Not implemented.
+    };
+}
+
+class vtkPVCompiledExpression::vtkInternals
+{
+public:
+  std::vector<vtkSource> Sources;
+  std::vector<vtkVariable> Variables;
+  bool Compiled;
+  vtkProgram Program;
+
+  vtkInternals() : Compiled(false)
+    {
+    }
+
+  // Returns the index of the source, -1 if the values cannot be read
+  // concurrently.
+  int AddSource(vtkDataArray* array, vtkDataSet* dataSet)
+    {
+    vtkSource source = { array, NULL, array? NULL : dataSet };
+    if (array && array->HasStandardMemoryLayout())
+      {
+      switch (array->GetDataType())
+        {
+        vtkTemplateMacro(source.Load = &vtkLoadComponent<VTK_TT>);
+        }
+      }
+    if (array? !source.Load : !(vtkImageData::SafeDownCast(dataSet) ||
+        vtkRectilinearGrid::SafeDownCast(dataSet)))
+      {
+      return -1;
+      }
+    for (size_t cc = 0; cc < this->Sources.size(); ++cc)
+      {
+      if (this->Sources[cc].Array == array &&
+        this->Sources[cc].DataSet == source.DataSet)
+        {
+        return static_cast<int>(cc);
+        }
+      }
+    this->Sources.push_back(source);
+    return static_cast<int>(this->Sources.size()) - 1;
+    }
+
+  void AddVariable(const char* name, int size, vtkDataArray* array,
+    vtkDataSet* dataSet, const int* components)
+    {
+    vtkVariable variable;
+    variable.Name = name? name : "";
+    variable.Size = size;
+    variable.Source = -1;
+    int numComps = array? array->GetNumberOfComponents() : 3;
+    bool valid = array || dataSet;
+    for (int c = 0; c < 3; ++c)
+      {
+      variable.Components[c] = components[c < size? c : 0];
+      valid = valid && variable.Components[c] >= 0 &&
+        variable.Components[c] < numComps;
+      }
+    if (valid)
+      {
+      variable.Source = this->AddSource(array, dataSet);
+      }
+    this->Variables.push_back(variable);
+    this->Compiled = false;
+    }
+};
+
+//----------------------------------------------------------------------------
+vtkPVCompiledExpression::vtkPVCompiledExpression()
+{
+  this->Internals = new vtkInternals();
+}
+
+//----------------------------------------------------------------------------
+vtkPVCompiledExpression::~vtkPVCompiledExpression()
+{
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCompiledExpression::AddScalarVariable(const char* name,
+  vtkDataArray* array, int component)
+{
+  this->Internals->AddVariable(name, 1, array, NULL, &component);
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCompiledExpression::AddVectorVariable(const char* name,
+  vtkDataArray* array, const int components[3])
+{
+  this->Internals->AddVariable(name, 3, array, NULL, components);
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCompiledExpression::AddCoordinateScalarVariable(const char* name,
+  vtkDataSet* dataSet, int component)
+{
+  this->Internals->AddVariable(name, 1, NULL, dataSet, &component);
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCompiledExpression::AddCoordinateVectorVariable(const char* name,
+  vtkDataSet* dataSet, const int components[3])
+{
+  this->Internals->AddVariable(name, 3, NULL, dataSet, components);
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCompiledExpression::RemoveAllVariables()
+{
+  this->Internals->Sources.clear();
+  this->Internals->Variables.clear();
+  this->Internals->Compiled = false;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVCompiledExpression::Compile(const char* function)
+{
+  vtkInternals* internals = this->Internals;
+  vtkProgram& program = internals->Program;
+  internals->Compiled = false;
+  program.Operations.clear();
+  program.Constants.clear();
+  program.NumberOfRegisters = 0;
+  if (!function)
+    {
+    return false;
+    }
+
+  // vtkFunctionParser ignores spaces as well.
+  std::string text(function);
+  text.erase(std::remove(text.begin(), text.end(), ' '), text.end());
+
+  vtkExpressionCompiler compiler(internals->Variables);
+  vtkValue result = compiler.Compile(text);
+  if (!result.Size)
+    {
+    return false;
+    }
+
+  // Allocate the registers. Constants get registers of their own, filled
+  // once per thread. The register of a value is reused once the last
+  // operation using it ran, possibly for the result of that operation since
+  // operations work tuple by tuple.
+  const std::vector<vtkOperation>& operations = compiler.Operations;
+  size_t numValues = compiler.IsConstant.size();
+  std::vector<size_t> lastUse(numValues, 0);
+  for (size_t cc = 0; cc < operations.size(); ++cc)
+    {
+    if (operations[cc].A >= 0)
+      {
+      lastUse[operations[cc].A] = cc;
+      }
+    if (operations[cc].B >= 0)
+      {
+      lastUse[operations[cc].B] = cc;
+      }
+    }
+  for (int c = 0; c < result.Size; ++c)
+    {
+    lastUse[result.Registers[c]] = operations.size();
+    }
+
+  std::vector<int> registers(numValues, -1);
+  std::vector<int> released;
+  for (size_t cc = 0; cc <= operations.size(); ++cc)
+    {
+    // The operands of each operation, then the results.
+    int values[3] = { -1, -1, -1 };
+    if (cc < operations.size())
+      {
+      values[0] = operations[cc].A;
+      values[1] = operations[cc].B;
+      }
+    else
+      {
+      std::copy(result.Registers, result.Registers + result.Size, values);
+      }
+    for (int k = 0; k < 3; ++k)
+      {
+      int value = values[k];
+      if (value >= 0 && registers[value] < 0 && compiler.IsConstant[value])
+        {
+        registers[value] = program.NumberOfRegisters++;
+        program.Constants.push_back(
+          std::make_pair(registers[value], compiler.Values[value]));
+        }
+      }
+    if (cc == operations.size())
+      {
+      break;
+      }
+
+    vtkOperation operation = operations[cc];
+    operation.A = operation.A < 0? -1 : registers[operation.A];
+    operation.B = operation.B < 0? -1 : registers[operation.B];
+    for (int k = 0; k < 2; ++k)
+      {
+      int value = values[k];
+      if (value >= 0 && !compiler.IsConstant[value] && lastUse[value] == cc &&
+        (k == 0 || value != values[0]))
+        {
+        released.push_back(registers[value]);
+        }
+      }
+    if (released.empty())
+      {
+      registers[operation.Result] = program.NumberOfRegisters++;
+      }
+    else
+      {
+      registers[operation.Result] = released.back();
+      released.pop_back();
+      }
+    operation.Result = registers[operation.Result];
+    program.Operations.push_back(operation);
+    }
+
+  program.ResultSize = result.Size;
+  for (int c = 0; c < 3; ++c)
+    {
+    program.Results[c] = registers[result.Registers[c < result.Size? c : 0]];
+    }
+  internals->Compiled = true;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVCompiledExpression::IsVectorResult() const
+{
+  return this->Internals->Compiled && this->Internals->Program.ResultSize == 3;
+}
+
+//----------------------------------------------------------------------------
+int vtkPVCompiledExpression::GetNumberOfOperations() const
+{
+  return this->Internals->Compiled?
+    static_cast<int>(this->Internals->Program.Operations.size()) : 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVCompiledExpression::Evaluate(vtkIdType numTuples,
+  vtkDataArray* result)
+{
+  vtkInternals* internals = this->Internals;
+  const vtkProgram& program = internals->Program;
+  if (!internals->Compiled || !result ||
+    result->GetNumberOfComponents() != program.ResultSize ||
+    result->GetNumberOfTuples() < numTuples ||
+    !result->HasStandardMemoryLayout())
+    {
+    return false;
+    }
+
+  vtkStoreFunction store = NULL;
+  switch (result->GetDataType())
+    {
+    vtkTemplateMacro(store = &vtkStoreTuples<VTK_TT>);
+    }
+  if (!store)
+    {
+    return false;
+    }
+
+  // Every variable used must have a value for every tuple.
+  for (size_t cc = 0; cc < program.Operations.size(); ++cc)
+    {
+    if (program.Operations[cc].Type == LOAD)
+      {
+      const vtkSource& source = internals->Sources[
+        program.Operations[cc].Source];
+      vtkIdType count = source.Array? source.Array->GetNumberOfTuples() :
+        source.DataSet->GetNumberOfPoints();
+      if (count < numTuples)
+        {
+        return false;
+        }
+      }
+    }
+  if (numTuples <= 0)
+    {
+    return true;
+    }
+
+  vtkProgramEvaluator evaluator(
+    program, internals->Sources, store, result->GetVoidPointer(0));
+  vtkSMPTools::For(0, numTuples, BlockSize * 16, evaluator);
+  return evaluator.IsValid();
+}
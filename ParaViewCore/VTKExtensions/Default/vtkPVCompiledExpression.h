@@ -0,0 +1,109 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkPVCompiledExpression.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkPVCompiledExpression - function of vtkPVArrayCalculator compiled
+// for evaluation by blocks of tuples
+// .SECTION Description
+// vtkPVCompiledExpression compiles the functions of the Calculator into a
+// program of operations on blocks of tuples, instead of interpreting them
+// one tuple at a time as vtkFunctionParser does. Vector values are kept as
+// three scalars, so every operation is a plain loop over the doubles of a
+// block that the compiler can vectorize. The values of the variables are
+// read from the arrays through their raw pointers, once per block, and
+// constant subexpressions are computed when compiling. Evaluate() runs the
+// program over the threads of vtkSMPTools.
+//
+// Only the operators and functions documented for the Calculator are
+// supported: + - * / ^ . (dot product), abs, exp, ceil, floor, log10, ln,
+// sqrt, the trigonometric and hyperbolic functions, min, max, mag, norm,
+// cross and the iHat, jHat and kHat constants. Compile() fails for anything
+// else, as for variables whose values cannot be read concurrently, and the
+// caller is expected to use vtkFunctionParser instead.
+//
+// This helper class is not derived from vtkObject.
+// .SECTION See Also
+// vtkPVArrayCalculator vtkFunctionParser
+
+#ifndef vtkPVCompiledExpression_h
+#define vtkPVCompiledExpression_h
+
+#include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
+#include "vtkSystemIncludes.h"
+
+class vtkDataArray;
+class vtkDataSet;
+
+class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkPVCompiledExpression
+{
+public:
+  vtkPVCompiledExpression();
+  ~vtkPVCompiledExpression();
+
+  // Description:
+  // Add a variable the function may use. Scalar variables read a component
+  // of array, vector variables three. array may be NULL, or unusable (e.g.
+  // a bit array), in which case functions using the variable do not
+  // compile.
+  void AddScalarVariable(const char* name, vtkDataArray* array,
+    int component);
+  void AddVectorVariable(const char* name, vtkDataArray* array,
+    const int components[3]);
+
+  // Description:
+  // Add a variable reading the coordinates of the points of dataSet, for
+  // data sets that do not store them in an array. Only vtkImageData and
+  // vtkRectilinearGrid, whose points can be computed concurrently, are
+  // supported.
+  void AddCoordinateScalarVariable(const char* name, vtkDataSet* dataSet,
+    int component);
+  void AddCoordinateVectorVariable(const char* name, vtkDataSet* dataSet,
+    const int components[3]);
+
+  // Description:
+  // Remove all the variables. The function has to be compiled again.
+  void RemoveAllVariables();
+
+  // Description:
+  // Compile function. Returns false if the function uses syntax or
+  // variables that are not supported.
+  bool Compile(const char* function);
+
+  // Description:
+  // Return whether the compiled function results in a vector (3 components)
+  // rather than a scalar.
+  bool IsVectorResult() const;
+
+  // Description:
+  // Return the number of operations run per block of tuples, once the
+  // function is compiled.
+  int GetNumberOfOperations() const;
+
+  // Description:
+  // Evaluate the compiled function for the first numTuples tuples of the
+  // variables and write the results to result, which must have the
+  // standard memory layout and the number of components of the result.
+  // Returns false, leaving result partially written, if the function is not
+  // compiled or if an operation produced an invalid value (e.g. the square
+  // root of a negative value), which vtkFunctionParser reports or replaces.
+  bool Evaluate(vtkIdType numTuples, vtkDataArray* result);
+
+private:
+  vtkPVCompiledExpression(const vtkPVCompiledExpression&); // Not implemented.
+  void operator=(const vtkPVCompiledExpression&); // Not implemented.
+
+  class vtkInternals;
+  vtkInternals* Internals;
+};
+
+#endif
@@ -1424,6 +1424,18 @@ void vtkSpyPlotReader::SetMergeXYZComponents(int merge)
   this->MergeXYZComponents = merge;
   this->Modified();
 }
+
+//-----------------------------------------------------------------------------
+void vtkSpyPlotReader::SetDecodedCacheSize(unsigned long size)
+{
+  vtkSpyPlotUniReader::SetCacheSize(size);
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkSpyPlotReader::GetDecodedCacheSize()
+{
+  return vtkSpyPlotUniReader::GetCacheSize();
+}
 //-----------------------------------------------------------------------------
 void vtkSpyPlotReader::PrintBlockList(vtkNonOverlappingAMR *hbds, int
   vtkNotUsed(myProcId))
@@ -163,6 +163,15 @@ public:
   vtkGetMacro(MergeXYZComponents,int);
   vtkBooleanMacro(MergeXYZComponents,int);
 
+  // Description:
+  // Set and get the size, in MiB, of the cache of decoded cell arrays shared
+  // by all the SpyPlot readers of the process. The arrays of the other time
+  // steps and of the unselected cell arrays are kept in it, so that going
+  // back to a time step or selecting an array again does not read and
+  // decode the file again. 0 disables the cache. Default is 256.
+  static void SetDecodedCacheSize(unsigned long size);
+  static unsigned long GetDecodedCacheSize();
+
   // Description:
   // Get the time step range.
   vtkGetVector2Macro(TimeStepRange, int);
@@ -8,9 +8,16 @@
 #include "vtkIntArray.h"
 #include "vtkUnsignedCharArray.h"
 #include "vtkByteSwap.h"
+#include "vtkSMPTools.h"
+#include "vtkMutexLock.h"
+#include <algorithm>
+#include <list>
+#include <map>
 #include <vector>
 #include <sstream>
+#include <string>
 #include <vtksys/RegularExpression.hxx>
+#include <vtksys/SystemTools.hxx>
 
 //=============================================================================
 //-----------------------------------------------------------------------------
@@ -34,6 +41,250 @@ inline ostream& operator<< (ostream& os, const vtkSpyPlotWriteString& c)
   return os;
 }
 
+// Returns 0 when the data decodes to more than outSize values. It reports no
+// error, so that it can run on any thread.
+template<class t>
+int vtkSpyPlotUniReaderRunLengthDataDecode(const unsigned char* in,
+                                           int inSize, t* out,
+                                           int outSize, t scale=1);
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Least recently used cache of the decoded arrays, shared by all the
+// readers. It holds a reference to the arrays it contains. Readers may run
+// on several threads, so every public method locks the cache.
+class vtkSpyPlotDecodedCache
+{
+public:
+  // The modification time of the file is part of the key, so that the
+  // arrays of a file that was written again are not reused.
+  struct Key
+    {
+    std::string FileName;
+    long FileTime;
+    int Dump;
+    int Block;
+    int Field;
+    int DataType;
+
+    bool operator<(const Key& other) const
+      {
+      if (this->Dump != other.Dump)
+        {
+        return this->Dump < other.Dump;
+        }
+      if (this->Block != other.Block)
+        {
+        return this->Block < other.Block;
+        }
+      if (this->Field != other.Field)
+        {
+        return this->Field < other.Field;
+        }
+      if (this->DataType != other.DataType)
+        {
+        return this->DataType < other.DataType;
+        }
+      if (this->FileTime != other.FileTime)
+        {
+        return this->FileTime < other.FileTime;
+        }
+      return this->FileName < other.FileName;
+      }
+    };
+
+  vtkSpyPlotDecodedCache() :
+    Capacity(256 * 1024), Size(0), NumberOfReaders(0) {}
+  ~vtkSpyPlotDecodedCache() { this->Shrink(0); }
+
+  // Adds the array, with the ghost cells fixed flag, as the most recently
+  // used one.
+  void Insert(const Key& key, vtkDataArray* array, int fixed)
+    {
+    this->Lock.Lock();
+    this->Remove(key);
+    unsigned long size = array->GetActualMemorySize();
+    if (size <= this->Capacity)
+      {
+      Entry entry;
+      entry.CacheKey = key;
+      entry.Array = array;
+      entry.Fixed = fixed;
+      array->Register(NULL);
+      this->Entries.push_front(entry);
+      this->Index[key] = this->Entries.begin();
+      this->Size += size;
+      this->Shrink(this->Capacity);
+      }
+    this->Lock.Unlock();
+    }
+
+  // Removes the array from the cache and returns it with its reference, or
+  // returns NULL when it is not in the cache.
+  vtkDataArray* Take(const Key& key, int* fixed)
+    {
+    this->Lock.Lock();
+    vtkDataArray* array = this->Extract(key, fixed);
+    this->Lock.Unlock();
+    return array;
+    }
+
+  void Clear()
+    {
+    this->Lock.Lock();
+    this->Shrink(0);
+    this->Lock.Unlock();
+    }
+
+  void SetCapacity(unsigned long capacity)
+    {
+    this->Lock.Lock();
+    this->Capacity = capacity;
+    this->Shrink(capacity);
+    this->Lock.Unlock();
+    }
+
+  unsigned long GetCapacity()
+    {
+    this->Lock.Lock();
+    unsigned long capacity = this->Capacity;
+    this->Lock.Unlock();
+    return capacity;
+    }
+
+  // The cache is cleared when the last reader is destroyed, so that no
+  // array outlives the readers.
+  void AddReader()
+    {
+    this->Lock.Lock();
+    ++this->NumberOfReaders;
+    this->Lock.Unlock();
+    }
+
+  void RemoveReader()
+    {
+    this->Lock.Lock();
+    if (--this->NumberOfReaders == 0)
+      {
+      this->Shrink(0);
+      }
+    this->Lock.Unlock();
+    }
+
+private:
+  struct Entry
+    {
+    Key CacheKey;
+    vtkDataArray* Array;
+    int Fixed;
+    };
+  typedef std::list<Entry> EntriesType;
+  typedef std::map<Key, EntriesType::iterator> IndexType;
+
+  // The following methods expect the cache to be locked.
+  vtkDataArray* Extract(const Key& key, int* fixed)
+    {
+    IndexType::iterator iter = this->Index.find(key);
+    if (iter == this->Index.end())
+      {
+      return NULL;
+      }
+    vtkDataArray* array = iter->second->Array;
+    *fixed = iter->second->Fixed;
+    this->Size -= array->GetActualMemorySize();
+    this->Entries.erase(iter->second);
+    this->Index.erase(iter);
+    return array;
+    }
+
+  void Remove(const Key& key)
+    {
+    int fixed;
+    vtkDataArray* array = this->Extract(key, &fixed);
+    if (array)
+      {
+      array->UnRegister(NULL);
+      }
+    }
+
+  // Releases the least recently used arrays until the size fits.
+  void Shrink(unsigned long size)
+    {
+    while (this->Size > size && !this->Entries.empty())
+      {
+      this->Remove(this->Entries.back().CacheKey);
+      }
+    }
+
+  EntriesType Entries; // the most recently used first
+  IndexType Index;
+  unsigned long Capacity; // in KiB, as GetActualMemorySize()
+  unsigned long Size;
+  int NumberOfReaders;
+  vtkSimpleMutexLock Lock;
+};
+
+vtkSpyPlotDecodedCache DecodedCache;
+
+//-----------------------------------------------------------------------------
+// A plane of a block of a variable to decode.
+struct vtkSpyPlotDecodeTask
+{
+  size_t Offset; // of the encoded plane in the buffer of the variable
+  int Size;
+  float* FloatOut;
+  unsigned char* UnsignedCharOut;
+  int OutSize;
+};
+
+// Decodes the planes of a variable concurrently, each plane is independent.
+// Errors are not reported from the threads, the reader checks
+// GetFirstFailure() once all the planes are decoded.
+class vtkSpyPlotDecoder
+{
+public:
+  vtkSpyPlotDecoder(const std::vector<unsigned char>& buffer,
+                    const std::vector<vtkSpyPlotDecodeTask>& tasks)
+    : Buffer(buffer), Tasks(tasks), Status(tasks.size(), 1) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType cc = begin; cc < end; ++cc)
+      {
+      const vtkSpyPlotDecodeTask& task = this->Tasks[cc];
+      const unsigned char* in = &this->Buffer[task.Offset];
+      if (task.FloatOut)
+        {
+        this->Status[cc] = static_cast<char>(
+          ::vtkSpyPlotUniReaderRunLengthDataDecode(in, task.Size,
+            task.FloatOut, task.OutSize));
+        }
+      else
+        {
+        this->Status[cc] = static_cast<char>(
+          ::vtkSpyPlotUniReaderRunLengthDataDecode(in, task.Size,
+            task.UnsignedCharOut, task.OutSize,
+            static_cast<unsigned char>(255)));
+        }
+      }
+    }
+
+  // Returns the index of the first plane that could not be decoded, or -1.
+  vtkIdType GetFirstFailure() const
+    {
+    std::vector<char>::const_iterator iter =
+      std::find(this->Status.begin(), this->Status.end(), 0);
+    return iter == this->Status.end()? -1 : iter - this->Status.begin();
+    }
+
+private:
+  const std::vector<unsigned char>& Buffer;
+  const std::vector<vtkSpyPlotDecodeTask>& Tasks;
+  std::vector<char> Status; // one per task, no need to synchronize
+};
+}
+
 
 
 //-----------------------------------------------------------------------------
@@ -83,6 +334,8 @@ vtkSpyPlotUniReader::vtkSpyPlotUniReader()
 
   this->MarkersOn = 0;
   this->GenerateMarkers = 1;
+  this->FileModifiedTime = 0;
+  DecodedCache.AddReader();
 }
 
 //-----------------------------------------------------------------------------
@@ -165,6 +418,58 @@ vtkSpyPlotUniReader::~vtkSpyPlotUniReader()
       }
     delete [] this->Markers;
     }
+
+  DecodedCache.RemoveReader();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSpyPlotUniReader::SetCacheSize(unsigned long size)
+{
+  DecodedCache.SetCapacity(size * 1024);
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkSpyPlotUniReader::GetCacheSize()
+{
+  return DecodedCache.GetCapacity() / 1024;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSpyPlotUniReader::ClearCache()
+{
+  DecodedCache.Clear();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSpyPlotUniReader::ReleaseDataBlocks(int dump, int field)
+{
+  vtkSpyPlotUniReader::DataDump* dp = this->DataDumps+dump;
+  vtkSpyPlotUniReader::Variable *cv = dp->Variables + field;
+  if ( !cv->DataBlocks )
+    {
+    return;
+    }
+  vtkSpyPlotDecodedCache::Key key;
+  key.FileName = this->FileName;
+  key.FileTime = this->FileModifiedTime;
+  key.Dump = dump;
+  key.Field = field;
+  for ( int ca = 0; ca < dp->ActualNumberOfBlocks; ++ ca )
+    {
+    if ( cv->DataBlocks[ca] )
+      {
+      key.Block = ca;
+      key.DataType = cv->DataBlocks[ca]->GetDataType();
+      DecodedCache.Insert(key, cv->DataBlocks[ca], cv->GhostCellsFixed[ca]);
+      cv->DataBlocks[ca]->Delete();
+      cv->DataBlocks[ca] = 0;
+      }
+    }
+  vtkDebugMacro( "* Release Data blocks for variable: " << cv->Name );
+  delete [] cv->DataBlocks;
+  cv->DataBlocks = 0;
+  delete [] cv->GhostCellsFixed;
+  cv->GhostCellsFixed = 0;
 }
 
 
@@ -215,6 +520,23 @@ int vtkSpyPlotUniReader::MakeCurrent()
   spis.SetStream(&ifs);
   int dump;
   vtkSpyPlotUniReader::DataDump* dp;
+
+  // The arrays decoded from a previous version of the file are released,
+  // they go to the cache under its modification time and are not reused.
+  long fileTime = vtksys::SystemTools::ModifiedTime(this->FileName);
+  if ( fileTime != this->FileModifiedTime )
+    {
+    for ( dump = 0; dump < this->NumberOfDataDumps; ++ dump )
+      {
+      dp = this->DataDumps+dump;
+      for ( int var = 0; var < dp->NumVars; ++ var )
+        {
+        this->ReleaseDataBlocks(dump, var);
+        }
+      }
+    this->FileModifiedTime = fileTime;
+    this->NeedToCheck = 1;
+    }
   int blocksUpdated = 0;
   int needMarkers = this->GenerateMarkers && this->MarkersOn;
 
@@ -299,24 +621,7 @@ int vtkSpyPlotUniReader::MakeCurrent()
       int var;
       for ( var = 0; var < dp->NumVars; ++ var)
         {
-        vtkSpyPlotUniReader::Variable *cv = dp->Variables + var;
-        if ( cv->DataBlocks )
-          {
-          int ca;
-          for ( ca = 0; ca < dp->ActualNumberOfBlocks; ++ ca )
-            {
-            if ( cv->DataBlocks[ca] )
-              {
-              cv->DataBlocks[ca]->Delete();
-              cv->DataBlocks[ca] = 0;
-              }
-            }
-          vtkDebugMacro( "* Delete Data blocks for variable: " << cv->Name );
-          delete [] cv->DataBlocks;
-          cv->DataBlocks = 0;
-          delete [] cv->GhostCellsFixed;
-          cv->GhostCellsFixed = 0;
-          }
+        this->ReleaseDataBlocks(dump, var);
         }
       }
     }
@@ -346,18 +651,7 @@ int vtkSpyPlotUniReader::MakeCurrent()
         {
         vtkDebugMacro( " ** Variable " << var->Name 
                        << " was unselected, so remove" );
-        int dataBlock;
-        for ( dataBlock = 0; 
-              dataBlock < dp->ActualNumberOfBlocks; ++ dataBlock )
-          {
-          var->DataBlocks[dataBlock]->Delete();
-          var->DataBlocks[dataBlock] = 0;
-          }
-        delete [] var->DataBlocks;
-        var->DataBlocks = 0;
-        delete [] var->GhostCellsFixed;
-        var->GhostCellsFixed = 0;
-        vtkDebugMacro( "* Delete Data blocks for variable: " << var->Name );
+        this->ReleaseDataBlocks(dump, fieldCnt);
         }
       vtkDebugMacro( " *** Ignore variable: " << var->Name );
       if ( !this->CellArraySelection->ArrayIsEnabled(var->Name) )
@@ -390,7 +684,16 @@ int vtkSpyPlotUniReader::MakeCurrent()
     //vtkDebugMacro( "  Field: " << fieldCnt << " / " << dp->NumVars 
     // << " [" << var->Name << "]" );
     //vtkDebugMacro( "    Jump to: " << dp->SavedVariableOffsets[fieldCnt] );
+    // The encoded planes of the variable are read first, then decoded
+    // concurrently. The arrays of the cache are reused.
     spis.Seek(dp->SavedVariableOffsets[fieldCnt]);
+    std::vector<vtkSpyPlotDecodeTask> tasks;
+    arrayBuffer.clear();
+    vtkSpyPlotDecodedCache::Key key;
+    key.FileName = this->FileName;
+    key.FileTime = this->FileModifiedTime;
+    key.Dump = dump;
+    key.Field = fieldCnt;
     int numBytes;
     int block;
     int actualBlockId = 0;
@@ -405,23 +708,40 @@ int vtkSpyPlotUniReader::MakeCurrent()
         if ( this->CellArraySelection->ArrayIsEnabled(var->Name) && 
               !var->DataBlocks[actualBlockId] )
           {
-          if ( this->DownConvertVolumeFraction && this->IsVolumeFraction(var) )
+          int downConvert =
+            this->DownConvertVolumeFraction && this->IsVolumeFraction(var);
+          key.Block = actualBlockId;
+          key.DataType = downConvert? VTK_UNSIGNED_CHAR : VTK_FLOAT;
+          int fixed = 0;
+          dataArray = DecodedCache.Take(key, &fixed);
+          if ( dataArray )
             {
-            unsignedCharArray = vtkUnsignedCharArray::New();
-            dataArray = unsignedCharArray;
+            vtkDebugMacro( " " << dataArray << " taken from the cache: " 
+                           << dataArray->GetName() );
+            var->GhostCellsFixed[actualBlockId] = fixed;
             }
           else
             {
-            floatArray = vtkFloatArray::New();
-            dataArray = floatArray;
+            if ( downConvert )
+              {
+              unsignedCharArray = vtkUnsignedCharArray::New();
+              dataArray = unsignedCharArray;
+              }
+            else
+              {
+              floatArray = vtkFloatArray::New();
+              dataArray = floatArray;
+              }
+            dataArray->SetNumberOfComponents(1);
+            dataArray->SetNumberOfTuples(bk->GetDimension(0) * 
+                                         bk->GetDimension(1) * 
+                                         bk->GetDimension(2));
+            dataArray->SetName(var->Name);
+            var->GhostCellsFixed[actualBlockId] = 0;
+            //vtkDebugMacro( "*** Create data array: " 
+            // << dataArray->GetNumberOfTuples() );
             }
-          dataArray->SetNumberOfComponents(1);
-          dataArray->SetNumberOfTuples(bk->GetDimension(0) * 
-                                       bk->GetDimension(1) * 
-                                       bk->GetDimension(2));
-          dataArray->SetName(var->Name);
-          //vtkDebugMacro( "*** Create data array: " 
-          // << dataArray->GetNumberOfTuples() );
+          var->DataBlocks[actualBlockId] = dataArray;
           }
         int zax;
         int bdims[3];
@@ -434,46 +754,47 @@ int vtkSpyPlotUniReader::MakeCurrent()
             vtkErrorMacro( "Problem reading the number of bytes" );
             return 0;
             }
-          if ( static_cast<int>(arrayBuffer.size()) < numBytes )
+          if ( (!floatArray && !unsignedCharArray) || numBytes <= 0 )
             {
-            arrayBuffer.resize(numBytes);
+            // Not needed, or already decoded
+            spis.Seek(numBytes, true);
+            continue;
             }
-          if ( !spis.ReadString(&*arrayBuffer.begin(), numBytes) )
+          vtkSpyPlotDecodeTask task;
+          task.Offset = arrayBuffer.size();
+          task.Size = numBytes;
+          task.FloatOut = floatArray? 
+            floatArray->GetPointer(zax * planeSize) : 0;
+          task.UnsignedCharOut = unsignedCharArray? 
+            unsignedCharArray->GetPointer(zax * planeSize) : 0;
+          task.OutSize = planeSize;
+          arrayBuffer.resize(task.Offset + numBytes);
+          if ( !spis.ReadString(&arrayBuffer[task.Offset], numBytes) )
             {
             vtkErrorMacro( "Problem reading the bytes" );
             return 0;
             }
-          if ( floatArray )
-            {
-            float* ptr = floatArray->GetPointer(zax * planeSize);
-            if ( !this->RunLengthDataDecode(&*arrayBuffer.begin(), 
-                                            numBytes, ptr, planeSize) )
-              {
-              vtkErrorMacro( "Problem RLD decoding float data array" );
-              return 0;
-              }
-            }
-          if ( unsignedCharArray )
-            {
-            unsigned char* ptr = unsignedCharArray->GetPointer(zax * planeSize);
-            if ( !this->RunLengthDataDecode(&*arrayBuffer.begin(), numBytes,
-                                            ptr, planeSize) )
-              {
-              vtkErrorMacro( "Problem RLD decoding unsigned char data array" );
-              return 0;
-              }
-            }
-          }
-        if ( dataArray )
-          {
-          var->DataBlocks[actualBlockId] = dataArray;
-          var->GhostCellsFixed[actualBlockId] = 0;
-          vtkDebugMacro( " " << dataArray << " initialized: " 
-                         << dataArray->GetName() );
-          actualBlockId++;
+          tasks.push_back(task);
           }
+        actualBlockId++;
         }
       }
+
+    if ( !tasks.empty() )
+      {
+      vtkSpyPlotDecoder decoder(arrayBuffer, tasks);
+      vtkSMPTools::For(0, static_cast<vtkIdType>(tasks.size()), decoder);
+      vtkIdType failure = decoder.GetFirstFailure();
+      if ( failure >= 0 )
+        {
+        vtkErrorMacro( "Problem RLD decoding data array: " << var->Name
+                       << ". Too much data generated. Expected: "
+                       << tasks[failure].OutSize );
+        return 0;
+        }
+      vtkDebugMacro( " " << tasks.size() << " planes decoded for: " 
+                     << var->Name );
+      }
     }
 
   if (blocksUpdated && needMarkers)
@@ -689,10 +1010,9 @@ void vtkSpyPlotUniReader::PrintInformation()
 
 //-----------------------------------------------------------------------------
 template<class t>
-int vtkSpyPlotUniReaderRunLengthDataDecode(vtkSpyPlotUniReader* self, 
-                                           const unsigned char* in, 
+int vtkSpyPlotUniReaderRunLengthDataDecode(const unsigned char* in, 
                                            int inSize, t* out, 
-                                           int outSize, t scale=1)
+                                           int outSize, t scale)
 {
   int outIndex = 0, inIndex = 0;
 
@@ -716,9 +1036,6 @@ int vtkSpyPlotUniReaderRunLengthDataDecode(vtkSpyPlotUniReader* self,
         {
         if ( outIndex >= outSize )
           {
-          vtkErrorWithObjectMacro(self, "Problem doing RLD decode. "
-                                  << "Too much data generated. Excpected: " 
-                                  << outSize );
           return 0;
           }
         out[outIndex] = static_cast<t>(val*scale);
@@ -733,9 +1050,6 @@ int vtkSpyPlotUniReaderRunLengthDataDecode(vtkSpyPlotUniReader* self,
         {
         if ( outIndex >= outSize )
           {
-          vtkErrorWithObjectMacro(self, "Problem doing RLD decode. "
-                                  << "Too much data generated. Excpected: " 
-                                  << outSize );
           return 0;
           }
         float val;
@@ -757,8 +1071,13 @@ int vtkSpyPlotUniReader::RunLengthDataDecode(const unsigned char* in,
                                              int inSize, float* out, 
                                              int outSize)
 {
-  return ::vtkSpyPlotUniReaderRunLengthDataDecode(this, in, inSize, out, 
-                                                  outSize);
+  if ( !::vtkSpyPlotUniReaderRunLengthDataDecode(in, inSize, out, outSize) )
+    {
+    vtkErrorMacro( "Problem doing RLD decode. "
+                   << "Too much data generated. Expected: " << outSize );
+    return 0;
+    }
+  return 1;
 }
 
 //-----------------------------------------------------------------------------
@@ -766,8 +1085,13 @@ int vtkSpyPlotUniReader::RunLengthDataDecode(const unsigned char* in,
                                              int inSize, int* out, 
                                              int outSize)
 {
-  return ::vtkSpyPlotUniReaderRunLengthDataDecode(this, in, inSize, out, 
-                                                  outSize);
+  if ( !::vtkSpyPlotUniReaderRunLengthDataDecode(in, inSize, out, outSize) )
+    {
+    vtkErrorMacro( "Problem doing RLD decode. "
+                   << "Too much data generated. Expected: " << outSize );
+    return 0;
+    }
+  return 1;
 }
 
 //-----------------------------------------------------------------------------
@@ -775,9 +1099,14 @@ int vtkSpyPlotUniReader::RunLengthDataDecode(const unsigned char* in,
                                              int inSize, unsigned char* out, 
                                              int outSize)
 {
-  return ::vtkSpyPlotUniReaderRunLengthDataDecode(this, in, inSize, out, 
-                                                  outSize, 
-                                                  static_cast<unsigned char>(255));
+  if ( !::vtkSpyPlotUniReaderRunLengthDataDecode(in, inSize, out, outSize,
+                                    static_cast<unsigned char>(255)) )
+    {
+    vtkErrorMacro( "Problem doing RLD decode. "
+                   << "Too much data generated. Expected: " << outSize );
+    return 0;
+    }
+  return 1;
 }
 
 //-----------------------------------------------------------------------------
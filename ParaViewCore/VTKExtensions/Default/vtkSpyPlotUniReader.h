@@ -208,12 +208,32 @@ public:
   vtkSetMacro(DataTypeChanged, int);
   void SetDownConvertVolumeFraction(int vf);
 
+  // Description:
+  // Set and get the size, in MiB, of the cache of decoded cell arrays
+  // shared by all the readers. The arrays of the other time steps and of
+  // the unselected fields are kept in it, the least recently used first
+  // released, and are reused instead of being read and decoded again,
+  // e.g. when going back to a time step or selecting a field again. They
+  // are not reused once the file is modified. The cache can be used by
+  // readers on several threads. 0 disables the cache. Default is 256.
+  static void SetCacheSize(unsigned long size);
+  static unsigned long GetCacheSize();
+
+  // Description:
+  // Releases the arrays of the cache.
+  static void ClearCache();
+
 protected:
   vtkSpyPlotUniReader();
   ~vtkSpyPlotUniReader();
   vtkSpyPlotBlock* Blocks;
 
 private:
+  // Description:
+  // Releases the data blocks of the field of the dump, the arrays go to
+  // the cache.
+  void ReleaseDataBlocks(int dump, int field);
+
   int RunLengthDataDecode(const unsigned char* in, int inSize, float* out, 
                           int outSize);
   int RunLengthDataDecode(const unsigned char* in, int inSize, int* out, 
@@ -267,6 +287,8 @@ private:
 
   // File name
   char* FileName;
+  // Modification time of the file when its arrays were last read
+  long FileModifiedTime;
 
   // Was information read
   int HaveInformation;
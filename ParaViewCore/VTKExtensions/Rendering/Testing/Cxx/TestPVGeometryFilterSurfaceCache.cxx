@@ -0,0 +1,225 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVGeometryFilterSurfaceCache.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Plays a transient dataset whose topology is fixed while its points and
+// attributes change at every time step, as written by most simulations, through
+// vtkPVGeometryFilter with and without the unstructured surface cache. Every
+// time step is a new grid with new arrays, like a reader would produce. The
+// outputs must match and the per-step cost of both is reported. Then checks
+// that a grid with a different connectivity of the same size, or a grid past
+// the cache limit, is not reused.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPVGeometryFilter.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  const int NumberOfTimeSteps = 10;
+
+  vtkSmartPointer<vtkUnstructuredGrid> GenerateTimeStep(
+    vtkUnstructuredGrid* mesh, int step)
+    {
+    vtkSmartPointer<vtkUnstructuredGrid> grid =
+      vtkSmartPointer<vtkUnstructuredGrid>::New();
+    grid->DeepCopy(mesh);
+
+    vtkPoints* points = grid->GetPoints();
+    vtkIdType numPts = points->GetNumberOfPoints();
+    vtkNew<vtkFloatArray> pressure;
+    pressure->SetName("pressure");
+    pressure->SetNumberOfTuples(numPts);
+    for (vtkIdType cc = 0; cc < numPts; ++cc)
+      {
+      double pt[3];
+      points->GetPoint(cc, pt);
+      pt[2] += 0.1 * sin(0.5 * step + pt[0]);
+      points->SetPoint(cc, pt);
+      pressure->SetValue(cc, static_cast<float>(cos(step + pt[1])));
+      }
+    grid->GetPointData()->AddArray(pressure.GetPointer());
+
+    vtkIdType numCells = grid->GetNumberOfCells();
+    vtkNew<vtkDoubleArray> temperature;
+    temperature->SetName("temperature");
+    temperature->SetNumberOfTuples(numCells);
+    for (vtkIdType cc = 0; cc < numCells; ++cc)
+      {
+      temperature->SetValue(cc, step * 1000.0 + cc);
+      }
+    grid->GetCellData()->AddArray(temperature.GetPointer());
+    return grid;
+    }
+
+  bool CompareArrays(vtkDataArray* a, vtkDataArray* b)
+    {
+    if (!a || !b || a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+      a->GetNumberOfComponents() != b->GetNumberOfComponents())
+      {
+      return false;
+      }
+    for (vtkIdType cc = 0; cc < a->GetNumberOfTuples(); ++cc)
+      {
+      for (int comp = 0; comp < a->GetNumberOfComponents(); ++comp)
+        {
+        if (a->GetComponent(cc, comp) != b->GetComponent(cc, comp))
+          {
+          return false;
+          }
+        }
+      }
+    return true;
+    }
+
+  bool Compare(vtkPolyData* a, vtkPolyData* b)
+    {
+    const char* pointArrays[] = { "pressure", "vtkOriginalPointIds" };
+    const char* cellArrays[] = { "temperature", "vtkOriginalCellIds" };
+    if (a->GetNumberOfCells() != b->GetNumberOfCells() ||
+      a->GetPolys()->GetNumberOfConnectivityEntries() !=
+      b->GetPolys()->GetNumberOfConnectivityEntries() ||
+      !CompareArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData()))
+      {
+      return false;
+      }
+    for (int cc = 0; cc < 2; ++cc)
+      {
+      if (!CompareArrays(a->GetPointData()->GetArray(pointArrays[cc]),
+          b->GetPointData()->GetArray(pointArrays[cc])) ||
+        !CompareArrays(a->GetCellData()->GetArray(cellArrays[cc]),
+          b->GetCellData()->GetArray(cellArrays[cc])))
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+}
+
+int TestPVGeometryFilterSurfaceCache(int, char*[])
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(40, 40, 40);
+  vtkNew<vtkDataSetTriangleFilter> tetrahedralize;
+  tetrahedralize->SetInputData(image.GetPointer());
+  tetrahedralize->Update();
+  vtkUnstructuredGrid* mesh = tetrahedralize->GetOutput();
+
+  vtkNew<vtkPVGeometryFilter> cached;
+  cached->SetController(NULL);
+  cached->SetUseOutline(0);
+  cached->SetCacheUnstructuredSurfaces(true);
+
+  vtkNew<vtkPVGeometryFilter> uncached;
+  uncached->SetController(NULL);
+  uncached->SetUseOutline(0);
+  uncached->SetCacheUnstructuredSurfaces(false);
+
+  vtkNew<vtkTimerLog> timer;
+  double cachedTotal = 0.0, uncachedTotal = 0.0;
+  for (int step = 0; step < NumberOfTimeSteps; ++step)
+    {
+    vtkSmartPointer<vtkUnstructuredGrid> grid = GenerateTimeStep(mesh, step);
+
+    cached->SetInputData(grid);
+    timer->StartTimer();
+    cached->Update();
+    timer->StopTimer();
+    double cachedTime = timer->GetElapsedTime();
+
+    uncached->SetInputData(grid);
+    timer->StartTimer();
+    uncached->Update();
+    timer->StopTimer();
+    double uncachedTime = timer->GetElapsedTime();
+
+    cout << "Step " << step << "  extract: " << uncachedTime
+         << "s  cached: " << cachedTime << "s" << endl;
+    if (step > 0)
+      {
+      // the first step fills the cache for both timings.
+      cachedTotal += cachedTime;
+      uncachedTotal += uncachedTime;
+      }
+
+    int expectedReuse = step > 0 ? 1 : 0;
+    if (cached->GetNumberOfReusedSurfaces() != expectedReuse ||
+      uncached->GetNumberOfReusedSurfaces() != 0)
+      {
+      cerr << "ERROR: unexpected number of reused surfaces at step " << step
+           << ": " << cached->GetNumberOfReusedSurfaces() << endl;
+      return EXIT_FAILURE;
+      }
+    if (!Compare(vtkPolyData::SafeDownCast(cached->GetOutputDataObject(0)),
+        vtkPolyData::SafeDownCast(uncached->GetOutputDataObject(0))))
+      {
+      cerr << "ERROR: reused surface does not match extracted surface at step "
+           << step << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A grid with as many points, cells and connectivity entries but other
+  // cells must not reuse the surface.
+  vtkSmartPointer<vtkUnstructuredGrid> shuffled =
+    GenerateTimeStep(mesh, NumberOfTimeSteps);
+  vtkIdTypeArray* connectivity = shuffled->GetCells()->GetData();
+  // Swap the first two points of the second tetrahedron.
+  std::swap(connectivity->GetPointer(0)[6], connectivity->GetPointer(0)[7]);
+  connectivity->Modified();
+  cached->SetInputData(shuffled);
+  cached->Update();
+  uncached->SetInputData(shuffled);
+  uncached->Update();
+  if (cached->GetNumberOfReusedSurfaces() != 0 ||
+    !Compare(vtkPolyData::SafeDownCast(cached->GetOutputDataObject(0)),
+      vtkPolyData::SafeDownCast(uncached->GetOutputDataObject(0))))
+    {
+    cerr << "ERROR: surface reused for a different connectivity" << endl;
+    return EXIT_FAILURE;
+    }
+
+  // Nothing is remembered past the cache limit.
+  cached->SetUnstructuredSurfaceCacheLimit(0);
+  for (int step = 0; step < 2; ++step)
+    {
+    cached->SetInputData(GenerateTimeStep(mesh, step));
+    cached->Update();
+    if (cached->GetNumberOfReusedSurfaces() != 0)
+      {
+      cerr << "ERROR: surface reused past the cache limit" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  cout << "Average per step  extract: "
+       << uncachedTotal / (NumberOfTimeSteps - 1)
+       << "s  cached: " << cachedTotal / (NumberOfTimeSteps - 1) << "s" << endl;
+  return EXIT_SUCCESS;
+}
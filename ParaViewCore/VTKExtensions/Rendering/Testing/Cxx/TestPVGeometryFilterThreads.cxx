@@ -0,0 +1,229 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVGeometryFilterThreads.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compares serial and concurrent surface extraction of the blocks of a
+// multiblock of unstructured grids with vtkPVGeometryFilter. Both must produce
+// the same output: points, cells and all the attribute arrays, including the
+// composite indices and block colors.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkFieldData.h"
+#include "vtkImageData.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPVGeometryFilter.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+namespace
+{
+  const int NumberOfBlocks = 512;
+
+  vtkSmartPointer<vtkMultiBlockDataSet> GenerateMultiBlock()
+    {
+    vtkSmartPointer<vtkMultiBlockDataSet> mb =
+      vtkSmartPointer<vtkMultiBlockDataSet>::New();
+    mb->SetNumberOfBlocks(NumberOfBlocks);
+    for (int cc = 0; cc < NumberOfBlocks; ++cc)
+      {
+      // leave a few empty blocks to check block ids are preserved.
+      if (cc % 61 == 7)
+        {
+        continue;
+        }
+      vtkNew<vtkImageData> image;
+      image->SetDimensions(12, 12, 12);
+      image->SetOrigin(12 * (cc % 8), 12 * ((cc / 8) % 8), 12 * (cc / 64));
+
+      vtkNew<vtkDataSetTriangleFilter> tetrahedralize;
+      tetrahedralize->SetInputData(image.GetPointer());
+      tetrahedralize->Update();
+
+      vtkNew<vtkUnstructuredGrid> grid;
+      grid->ShallowCopy(tetrahedralize->GetOutput());
+      vtkNew<vtkDoubleArray> pointValues;
+      pointValues->SetName("PointValues");
+      pointValues->SetNumberOfTuples(grid->GetNumberOfPoints());
+      for (vtkIdType id = 0; id < grid->GetNumberOfPoints(); ++id)
+        {
+        double* x = grid->GetPoint(id);
+        pointValues->SetValue(id, x[0] + 2 * x[1] + 3 * x[2]);
+        }
+      grid->GetPointData()->AddArray(pointValues.GetPointer());
+      vtkNew<vtkDoubleArray> cellValues;
+      cellValues->SetName("CellValues");
+      cellValues->SetNumberOfTuples(grid->GetNumberOfCells());
+      for (vtkIdType id = 0; id < grid->GetNumberOfCells(); ++id)
+        {
+        cellValues->SetValue(id, cc * grid->GetNumberOfCells() + id);
+        }
+      grid->GetCellData()->AddArray(cellValues.GetPointer());
+      mb->SetBlock(cc, grid.GetPointer());
+      }
+    return mb;
+    }
+
+  vtkSmartPointer<vtkMultiBlockDataSet> Extract(
+    vtkMultiBlockDataSet* input, bool parallel, double& elapsed)
+    {
+    vtkNew<vtkPVGeometryFilter> geometry;
+    geometry->SetController(NULL);
+    geometry->SetProcessBlocksInParallel(parallel);
+    geometry->SetInputData(input);
+
+    vtkNew<vtkTimerLog> timer;
+    timer->StartTimer();
+    geometry->Update();
+    timer->StopTimer();
+    elapsed = timer->GetElapsedTime();
+
+    vtkSmartPointer<vtkMultiBlockDataSet> output =
+      vtkSmartPointer<vtkMultiBlockDataSet>::New();
+    output->ShallowCopy(geometry->GetOutputDataObject(0));
+    return output;
+    }
+
+  bool CompareArrays(vtkDataArray* a, vtkDataArray* b)
+    {
+    if (!a || !b)
+      {
+      return a == b;
+      }
+    if (a->GetDataType() != b->GetDataType() ||
+      a->GetNumberOfComponents() != b->GetNumberOfComponents() ||
+      a->GetNumberOfTuples() != b->GetNumberOfTuples())
+      {
+      return false;
+      }
+    for (vtkIdType cc = 0; cc < a->GetNumberOfTuples(); ++cc)
+      {
+      for (int comp = 0; comp < a->GetNumberOfComponents(); ++comp)
+        {
+        if (a->GetComponent(cc, comp) != b->GetComponent(cc, comp))
+          {
+          return false;
+          }
+        }
+      }
+    return true;
+    }
+
+  bool CompareFields(vtkFieldData* a, vtkFieldData* b)
+    {
+    if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+      {
+      return false;
+      }
+    for (int cc = 0; cc < a->GetNumberOfArrays(); ++cc)
+      {
+      vtkDataArray* array = a->GetArray(cc);
+      if (!array || !array->GetName() ||
+        !CompareArrays(array, b->GetArray(array->GetName())))
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+
+  bool CompareCells(vtkCellArray* a, vtkCellArray* b)
+    {
+    if (!a || !b)
+      {
+      return a == b;
+      }
+    return a->GetNumberOfCells() == b->GetNumberOfCells() &&
+      CompareArrays(a->GetData(), b->GetData());
+    }
+
+  bool Compare(vtkMultiBlockDataSet* serial, vtkMultiBlockDataSet* parallel)
+    {
+    if (serial->GetNumberOfBlocks() != parallel->GetNumberOfBlocks())
+      {
+      return false;
+      }
+    for (unsigned int cc = 0; cc < serial->GetNumberOfBlocks(); ++cc)
+      {
+      vtkPolyData* a = vtkPolyData::SafeDownCast(serial->GetBlock(cc));
+      vtkPolyData* b = vtkPolyData::SafeDownCast(parallel->GetBlock(cc));
+      if (!a || !b)
+        {
+        if (a != b)
+          {
+          return false;
+          }
+        continue;
+        }
+      if (a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+        a->GetNumberOfCells() != b->GetNumberOfCells() ||
+        !CompareArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData()) ||
+        !CompareCells(a->GetVerts(), b->GetVerts()) ||
+        !CompareCells(a->GetLines(), b->GetLines()) ||
+        !CompareCells(a->GetPolys(), b->GetPolys()) ||
+        !CompareCells(a->GetStrips(), b->GetStrips()))
+        {
+        cerr << "ERROR: block " << cc << " has different geometry." << endl;
+        return false;
+        }
+      if (!CompareFields(a->GetPointData(), b->GetPointData()) ||
+        !CompareFields(a->GetCellData(), b->GetCellData()) ||
+        !CompareFields(a->GetFieldData(), b->GetFieldData()))
+        {
+        cerr << "ERROR: block " << cc << " has different attributes." << endl;
+        return false;
+        }
+      // Make sure the arrays set for the composite dataset were compared.
+      if (!a->GetCellData()->GetArray("vtkCompositeIndex") ||
+        !a->GetFieldData()->GetArray("vtkBlockColors") ||
+        !a->GetPointData()->GetArray("PointValues") ||
+        !a->GetCellData()->GetArray("CellValues"))
+        {
+        cerr << "ERROR: block " << cc << " misses arrays." << endl;
+        return false;
+        }
+      }
+    return true;
+    }
+}
+
+int TestPVGeometryFilterThreads(int, char*[])
+{
+  vtkSmartPointer<vtkMultiBlockDataSet> input = GenerateMultiBlock();
+
+  double serialTime, parallelTime;
+  vtkSmartPointer<vtkMultiBlockDataSet> serial =
+    Extract(input, false, serialTime);
+  vtkSmartPointer<vtkMultiBlockDataSet> parallel =
+    Extract(input, true, parallelTime);
+
+  cout << "Blocks: " << NumberOfBlocks
+       << "  serial: " << serialTime
+       << "s  parallel: " << parallelTime << "s" << endl;
+
+  if (!Compare(serial, parallel))
+    {
+    cerr << "ERROR: parallel extraction does not match serial extraction."
+         << endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
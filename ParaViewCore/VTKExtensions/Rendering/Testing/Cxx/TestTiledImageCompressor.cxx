@@ -0,0 +1,328 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestTiledImageCompressor.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Benchmarks the image compressors used for client-server image delivery on
+// a sequence of frames in which only a small region moves, as happens when
+// interacting with a widget: each codec is used directly, tiled with
+// vtkTiledImageCompressor and tiled in delta mode. Reports compression ratio
+// and MB/s for each and checks that the tiled frames decompress to the same
+// image as the ones compressed directly, and that corrupted tiled frames are
+// rejected.
+
+#include "vtkImageData.h"
+#include "vtkLZ4Compressor.h"
+#include "vtkNew.h"
+#include "vtkPNGReader.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSquirtCompressor.h"
+#include "vtkTesting.h"
+#include "vtkTiledImageCompressor.h"
+#include "vtkTimerLog.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkZlibImageCompressor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <vtksys/CommandLineArguments.hxx>
+
+namespace
+{
+  const int NumberOfFrames = 20;
+  const int NumberOfTiles = 8;
+
+  typedef std::vector<vtkSmartPointer<vtkUnsignedCharArray> > FrameVector;
+
+  // Frames showing the image with a square moving along its top rows.
+  void RecordFrames(vtkImageData* image, FrameVector& frames)
+    {
+    vtkUnsignedCharArray* scalars =
+      vtkUnsignedCharArray::SafeDownCast(image->GetPointData()->GetScalars());
+    int dims[3];
+    image->GetDimensions(dims);
+    int numComps = scalars->GetNumberOfComponents();
+    int square = std::min(32, std::min(dims[0], dims[1]));
+    for (int frame = 0; frame < NumberOfFrames; ++frame)
+      {
+      vtkSmartPointer<vtkUnsignedCharArray> pixels =
+        vtkSmartPointer<vtkUnsignedCharArray>::New();
+      pixels->DeepCopy(scalars);
+      int x0 = (frame * square / 2) % (dims[0] - square + 1);
+      int y0 = dims[1] - square;
+      for (int y = y0; y < y0 + square; ++y)
+        {
+        for (int x = x0; x < x0 + square; ++x)
+          {
+          unsigned char* pixel = pixels->GetPointer((y * dims[0] + x) * numComps);
+          pixel[0] = 255;
+          pixel[1] = static_cast<unsigned char>(frame * 10);
+          pixel[2] = 0;
+          }
+        }
+      frames.push_back(pixels);
+      }
+    }
+
+  struct Result
+    {
+    double CompressTime;
+    double DecompressTime;
+    vtkIdType CompressedSize;
+    int UnchangedTiles;
+    };
+
+  // Compresses and decompresses every frame, in order, and keeps the
+  // decompressed frames.
+  bool Run(vtkImageCompressor* encoder, vtkImageCompressor* decoder,
+    const FrameVector& frames, FrameVector& decoded, Result& result)
+    {
+    result.CompressTime = result.DecompressTime = 0.0;
+    result.CompressedSize = 0;
+    result.UnchangedTiles = 0;
+    vtkTiledImageCompressor* tiled =
+      vtkTiledImageCompressor::SafeDownCast(decoder);
+
+    vtkNew<vtkTimerLog> timer;
+    vtkNew<vtkUnsignedCharArray> compressed;
+    for (size_t cc = 0; cc < frames.size(); ++cc)
+      {
+      encoder->SetLossLessMode(1);
+      encoder->SetInput(frames[cc]);
+      encoder->SetOutput(compressed.GetPointer());
+      timer->StartTimer();
+      int status = encoder->Compress();
+      timer->StopTimer();
+      if (status != VTK_OK)
+        {
+        return false;
+        }
+      result.CompressTime += timer->GetElapsedTime();
+      result.CompressedSize +=
+        compressed->GetNumberOfTuples() * compressed->GetNumberOfComponents();
+
+      vtkSmartPointer<vtkUnsignedCharArray> output =
+        vtkSmartPointer<vtkUnsignedCharArray>::New();
+      output->SetNumberOfComponents(frames[cc]->GetNumberOfComponents());
+      output->SetNumberOfTuples(frames[cc]->GetNumberOfTuples());
+      decoder->SetLossLessMode(1);
+      decoder->SetInput(compressed.GetPointer());
+      decoder->SetOutput(output);
+      timer->StartTimer();
+      status = decoder->Decompress();
+      timer->StopTimer();
+      if (status != VTK_OK)
+        {
+        return false;
+        }
+      result.DecompressTime += timer->GetElapsedTime();
+      result.UnchangedTiles += tiled? tiled->GetNumberOfUnchangedTiles() : 0;
+      decoded.push_back(output);
+      }
+    return true;
+    }
+
+  bool SameFrames(const FrameVector& a, const FrameVector& b)
+    {
+    if (a.size() != b.size())
+      {
+      return false;
+      }
+    for (size_t cc = 0; cc < a.size(); ++cc)
+      {
+      vtkIdType size = a[cc]->GetNumberOfTuples() * a[cc]->GetNumberOfComponents();
+      if (size != b[cc]->GetNumberOfTuples() * b[cc]->GetNumberOfComponents() ||
+        memcmp(a[cc]->GetPointer(0), b[cc]->GetPointer(0), size) != 0)
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+
+  void Report(const char* name, const Result& result, double megabytes)
+    {
+    cout << name << " :"
+         << " compression ratio: "
+         << (result.CompressedSize > 0?
+           megabytes * 1024 * 1024 / result.CompressedSize : 0.0)
+         << " compress: "
+         << (result.CompressTime > 0? megabytes / result.CompressTime : 0.0)
+         << " MB/s decompress: "
+         << (result.DecompressTime > 0? megabytes / result.DecompressTime : 0.0)
+         << " MB/s unchanged tiles: " << result.UnchangedTiles
+         << endl;
+    }
+
+  // Benchmarks codec directly, tiled and tiled in delta mode.
+  bool Benchmark(const std::string& name, const char* configuration,
+    const FrameVector& frames, double megabytes)
+    {
+    vtkSmartPointer<vtkImageCompressor> encoder;
+    vtkSmartPointer<vtkImageCompressor> decoder;
+    encoder.TakeReference(vtkTiledImageCompressor::NewCodec(name.c_str()));
+    decoder.TakeReference(vtkTiledImageCompressor::NewCodec(name.c_str()));
+    encoder->RestoreConfiguration(configuration);
+    decoder->RestoreConfiguration(configuration);
+
+    FrameVector reference;
+    Result result;
+    if (!Run(encoder, decoder, frames, reference, result))
+      {
+      cerr << "ERROR: " << name << " failed." << endl;
+      return false;
+      }
+    Report(configuration, result, megabytes);
+
+    for (int delta = 0; delta < 2; ++delta)
+      {
+      vtkNew<vtkTiledImageCompressor> tiledEncoder;
+      vtkNew<vtkTiledImageCompressor> tiledDecoder;
+      tiledEncoder->SetCodec(encoder);
+      tiledEncoder->SetNumberOfTiles(NumberOfTiles);
+      tiledEncoder->SetDeltaMode(delta);
+      // the decoder is configured from the encoder like in client-server.
+      tiledDecoder->RestoreConfiguration(tiledEncoder->SaveConfiguration());
+
+      FrameVector decoded;
+      if (!Run(tiledEncoder.GetPointer(), tiledDecoder.GetPointer(), frames,
+          decoded, result))
+        {
+        cerr << "ERROR: tiled " << name << " failed." << endl;
+        return false;
+        }
+      Report(tiledEncoder->SaveConfiguration(), result, megabytes);
+      if (!SameFrames(reference, decoded))
+        {
+        cerr << "ERROR: tiled " << name << " (delta: " << delta
+             << ") frames differ from " << name << " frames." << endl;
+        return false;
+        }
+      if (delta && result.UnchangedTiles == 0)
+        {
+        cerr << "ERROR: delta mode did not skip any tile." << endl;
+        return false;
+        }
+      }
+    return true;
+    }
+
+  // Decompresses a tiled frame whose header entry at index was replaced by
+  // value, which must fail.
+  bool RejectCorruptFrame(vtkUnsignedCharArray* compressed,
+    vtkUnsignedCharArray* pixels, int index, vtkTypeInt32 value)
+    {
+    vtkNew<vtkUnsignedCharArray> corrupt;
+    corrupt->DeepCopy(compressed);
+    memcpy(corrupt->GetPointer(index * sizeof(vtkTypeInt32)), &value,
+      sizeof(value));
+    vtkNew<vtkUnsignedCharArray> output;
+    output->SetNumberOfComponents(pixels->GetNumberOfComponents());
+    output->SetNumberOfTuples(pixels->GetNumberOfTuples());
+    vtkNew<vtkTiledImageCompressor> decoder;
+    decoder->SetInput(corrupt.GetPointer());
+    decoder->SetOutput(output.GetPointer());
+    if (decoder->Decompress() != VTK_ERROR)
+      {
+      cerr << "ERROR: a frame with " << value << " at " << index
+           << " in its header was decompressed." << endl;
+      return false;
+      }
+    return true;
+    }
+
+  // Corrupts the number of tiles and the tile sizes of a tiled frame: the
+  // header is 3 values, flags, number of pixels and number of tiles,
+  // followed by the size of each tile, -1 for an unchanged tile.
+  bool RejectCorruptFrames(vtkUnsignedCharArray* pixels)
+    {
+    vtkNew<vtkTiledImageCompressor> encoder;
+    vtkNew<vtkUnsignedCharArray> compressed;
+    encoder->SetNumberOfTiles(NumberOfTiles);
+    encoder->SetInput(pixels);
+    encoder->SetOutput(compressed.GetPointer());
+    if (encoder->Compress() != VTK_OK)
+      {
+      cerr << "ERROR: tiled compression failed." << endl;
+      return false;
+      }
+    vtkTypeInt32 frameSize = static_cast<vtkTypeInt32>(
+      compressed->GetNumberOfTuples() * compressed->GetNumberOfComponents());
+
+    int errors = vtkObject::GetGlobalWarningDisplay();
+    vtkObject::GlobalWarningDisplayOff();
+    bool status = RejectCorruptFrame(compressed.GetPointer(), pixels, 2, -1) &&
+      RejectCorruptFrame(compressed.GetPointer(), pixels, 2, frameSize) &&
+      RejectCorruptFrame(compressed.GetPointer(), pixels, 3, -2) &&
+      RejectCorruptFrame(compressed.GetPointer(), pixels, 3, VTK_INT_MIN) &&
+      RejectCorruptFrame(compressed.GetPointer(), pixels, 3, frameSize) &&
+      RejectCorruptFrame(compressed.GetPointer(), pixels, 3, VTK_INT_MAX);
+    vtkObject::SetGlobalWarningDisplay(errors);
+    return status;
+    }
+}
+
+int TestTiledImageCompressor(int argc, char* argv[])
+{
+  std::string imageFile;
+
+  // Use --image argument to use this for benchmarking.
+  vtksys::CommandLineArguments arg;
+  arg.Initialize(argc, argv);
+  typedef vtksys::CommandLineArguments argT;
+  arg.AddArgument("--image", argT::EQUAL_ARGUMENT, &imageFile,
+    "Optionally specify an image to record the frames from.");
+  arg.StoreUnusedArguments(true);
+  if (!arg.Parse())
+    {
+    cerr << "Problem parsing arguments" << endl;
+    return EXIT_FAILURE;
+    }
+
+  if (imageFile.empty())
+    {
+    vtkNew<vtkTesting> testing;
+    testing->AddArguments(argc, (const char**)(argv));
+    imageFile = testing->GetDataRoot();
+    imageFile += "/NE2_ps_bath.png";
+    }
+
+  vtkNew<vtkPNGReader> reader;
+  reader->SetFileName(imageFile.c_str());
+  reader->Update();
+
+  FrameVector frames;
+  RecordFrames(reader->GetOutput(), frames);
+  double megabytes = 0.0;
+  for (size_t cc = 0; cc < frames.size(); ++cc)
+    {
+    megabytes += frames[cc]->GetNumberOfTuples() *
+      frames[cc]->GetNumberOfComponents() / (1024.0 * 1024.0);
+    }
+  cout << "Frames: " << frames.size() << " ("
+       << megabytes << " MB uncompressed)" << endl;
+
+  if (!Benchmark("vtkLZ4Compressor", "vtkLZ4Compressor 1 0",
+      frames, megabytes) ||
+    !Benchmark("vtkSquirtCompressor", "vtkSquirtCompressor 1 0",
+      frames, megabytes) ||
+    !Benchmark("vtkZlibImageCompressor", "vtkZlibImageCompressor 1 1 0 0",
+      frames, megabytes) ||
+    !RejectCorruptFrames(frames[0]))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
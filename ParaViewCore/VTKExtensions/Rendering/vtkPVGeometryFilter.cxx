@@ -39,6 +39,8 @@
 #include "vtkHyperTreeGrid.h"
 #include "vtkHyperTreeGridGeometry.h"
 #include "vtkImageData.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationIntegerVectorKey.h"
 #include "vtkInformationVector.h"
@@ -50,6 +52,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkOutlineSource.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
 #include "vtkPVRecoverGeometryWireframe.h"
@@ -58,6 +61,8 @@
 #include "vtkRectilinearGridOutlineFilter.h"
 #include "vtkSelectionNode.h"
 #include "vtkSmartPointer.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStripper.h"
 #include "vtkStructuredGrid.h"
@@ -70,6 +75,8 @@
 #include "vtkUnstructuredGridGeometryFilter.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <vtksys/SystemTools.hxx>
+
 #include <map>
 #include <vector>
 #include <string>
@@ -140,6 +147,462 @@ public:
     }
 };
 
+//----------------------------------------------------------------------------
+// Functor used to extract the surface of the leaves of a composite dataset
+// concurrently. Each thread gets its own vtkPVGeometryFilter since the
+// internal filters hold state between executions.
+class vtkPVGeometryFilter::BlockExecutor
+{
+public:
+  BlockExecutor(vtkPVGeometryFilter* self,
+    const std::vector<vtkDataObject*>& blocks,
+    const std::vector<size_t>& indices,
+    std::vector<vtkSmartPointer<vtkPolyData> >& outputs,
+    const int* wholeExtent)
+    : Self(self), Blocks(blocks), Indices(indices), Outputs(outputs),
+    WholeExtent(wholeExtent)
+    {
+    }
+
+  void Initialize()
+    {
+    vtkPVGeometryFilter* worker = this->Workers.Local();
+    vtkPVGeometryFilter* self = this->Self;
+    worker->SetController(self->Controller);
+    worker->GenerateProcessIds = self->GenerateProcessIds;
+    worker->UseOutline = self->UseOutline;
+    worker->GenerateCellNormals = self->GenerateCellNormals;
+    worker->Triangulate = self->Triangulate;
+    worker->ForceUseStrips = self->ForceUseStrips;
+    worker->SetUseStrips(self->UseStrips);
+    worker->SetNonlinearSubdivisionLevel(self->NonlinearSubdivisionLevel);
+    worker->SetPassThroughCellIds(self->PassThroughCellIds);
+    worker->SetPassThroughPointIds(self->PassThroughPointIds);
+    worker->HideInternalAMRFaces = self->HideInternalAMRFaces;
+    worker->UseNonOverlappingAMRMetaDataForOutlines =
+      self->UseNonOverlappingAMRMetaDataForOutlines;
+    // workers only live for one execution, there is nothing to reuse.
+    worker->CacheUnstructuredSurfaces = false;
+    // vtkTimerLog is not thread safe, the whole loop is timed by self.
+    worker->MarkTimerEvents = false;
+    }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    vtkPVGeometryFilter* worker = this->Workers.Local();
+    for (vtkIdType cc = begin; cc < end; ++cc)
+      {
+      size_t index = this->Indices[cc];
+      vtkPolyData* output = vtkPolyData::New();
+      worker->ExecuteBlock(
+        this->Blocks[index], output, 0, 0, 1, 0, this->WholeExtent);
+      worker->CleanupOutputData(output, 0);
+      this->Outputs[index].TakeReference(output);
+      }
+    }
+
+  void Reduce()
+    {
+    }
+
+private:
+  vtkPVGeometryFilter* Self;
+  const std::vector<vtkDataObject*>& Blocks;
+  const std::vector<size_t>& Indices;
+  std::vector<vtkSmartPointer<vtkPolyData> >& Outputs;
+  const int* WholeExtent;
+  vtkSMPThreadLocalObject<vtkPVGeometryFilter> Workers;
+
+  void operator=(const BlockExecutor&); // Not implemented.
+};
+
+//----------------------------------------------------------------------------
+// Remembers the external surfaces extracted from linear unstructured grids.
+// The external faces only depend on the connectivity (and the ghost cells),
+// so when a grid with the same connectivity comes back, the faces and the
+// original point/cell ids can be reused; the point coordinates and the
+// attributes are simply gathered from the new grid. Grids are identified by
+// the modification time of their connectivity arrays, falling back to a hash
+// of their content when readers produce new arrays for every time step. The
+// entries are indexed by both, and hash matches are verified against the
+// connectivity arrays the entry holds on to.
+class vtkPVGeometryFilter::UnstructuredSurfaceCache
+{
+public:
+  struct Signature
+    {
+    vtkObject* Arrays[3];
+    unsigned long MTimes[3];
+    vtkIdType NumberOfPoints;
+    vtkIdType NumberOfCells;
+    vtkIdType ConnectivitySize;
+    vtkTypeUInt64 Hash;
+    };
+
+  // The connectivity, cell types and ghost arrays of a grid.
+  struct ArraysKey
+    {
+    vtkObject* Arrays[3];
+
+    ArraysKey(const Signature& sig)
+      {
+      std::copy(sig.Arrays, sig.Arrays + 3, this->Arrays);
+      }
+    bool operator<(const ArraysKey& other) const
+      {
+      return std::lexicographical_compare(this->Arrays, this->Arrays + 3,
+        other.Arrays, other.Arrays + 3);
+      }
+    };
+
+  struct Entry
+    {
+    Signature Key;
+    bool Used;
+    // Memory used by the entry, in KB.
+    unsigned long Size;
+    // Keeps the arrays of the key alive, so that their addresses are not
+    // reused, and hash matches can be verified.
+    vtkSmartPointer<vtkObject> Arrays[3];
+    vtkSmartPointer<vtkCellArray> Verts;
+    vtkSmartPointer<vtkCellArray> Lines;
+    vtkSmartPointer<vtkCellArray> Polys;
+    vtkSmartPointer<vtkCellArray> Strips;
+    vtkSmartPointer<vtkIdTypeArray> OriginalPointIds;
+    vtkSmartPointer<vtkIdTypeArray> OriginalCellIds;
+    };
+
+  typedef std::map<ArraysKey, Entry> EntryMap;
+  typedef std::multimap<vtkTypeUInt64, ArraysKey> HashMap;
+
+  UnstructuredSurfaceCache() : Size(0)
+    {
+    }
+
+  // Description:
+  // Fills the part of the signature that only looks at the identity and the
+  // modification time of the connectivity arrays.
+  static void GetArrays(vtkUnstructuredGrid* grid, Signature& sig)
+    {
+    vtkCellArray* cells = grid->GetCells();
+    sig.Arrays[0] = cells? cells->GetData() : NULL;
+    sig.Arrays[1] = grid->GetCellTypesArray();
+    sig.Arrays[2] = grid->GetCellData()->GetArray(
+      vtkDataSetAttributes::GhostArrayName());
+    for (int cc = 0; cc < 3; ++cc)
+      {
+      sig.MTimes[cc] = sig.Arrays[cc]? sig.Arrays[cc]->GetMTime() : 0;
+      }
+    sig.NumberOfPoints = grid->GetNumberOfPoints();
+    sig.NumberOfCells = grid->GetNumberOfCells();
+    sig.ConnectivitySize = cells? cells->GetData()->GetNumberOfTuples() : 0;
+    sig.Hash = 0;
+    }
+
+  // Description:
+  // Hashes the connectivity. Returns false when the grid cannot be cached
+  // i.e. when it is empty or has nonlinear cells whose surface is subdivided.
+  static bool ComputeHash(vtkUnstructuredGrid* grid, Signature& sig)
+    {
+    vtkIdTypeArray* connectivity = vtkIdTypeArray::SafeDownCast(sig.Arrays[0]);
+    vtkUnsignedCharArray* types =
+      vtkUnsignedCharArray::SafeDownCast(sig.Arrays[1]);
+    if (!connectivity || !types || sig.NumberOfCells == 0 ||
+      !grid->GetPoints())
+      {
+      return false;
+      }
+
+    // 64 bit FNV-1a, fed one value at a time.
+    const vtkTypeUInt64 prime = 1099511628211ULL;
+    vtkTypeUInt64 hash = 14695981039346656037ULL;
+    const unsigned char* typePtr = types->GetPointer(0);
+    for (vtkIdType cc = 0; cc < sig.NumberOfCells; ++cc)
+      {
+      if (!vtkCellTypes::IsLinear(typePtr[cc]))
+        {
+        return false;
+        }
+      hash = (hash ^ typePtr[cc]) * prime;
+      }
+    const vtkIdType* connPtr = connectivity->GetPointer(0);
+    for (vtkIdType cc = 0; cc < sig.ConnectivitySize; ++cc)
+      {
+      hash = (hash ^ static_cast<vtkTypeUInt64>(connPtr[cc])) * prime;
+      }
+    vtkDataArray* ghosts = vtkDataArray::SafeDownCast(sig.Arrays[2]);
+    if (ghosts)
+      {
+      for (vtkIdType cc = 0; cc < ghosts->GetNumberOfTuples(); ++cc)
+        {
+        hash = (hash ^
+          static_cast<vtkTypeUInt64>(ghosts->GetComponent(cc, 0))) * prime;
+        }
+      }
+    sig.Hash = hash;
+    return true;
+    }
+
+  static bool SameSizes(const Signature& a, const Signature& b)
+    {
+    return a.NumberOfPoints == b.NumberOfPoints &&
+      a.NumberOfCells == b.NumberOfCells &&
+      a.ConnectivitySize == b.ConnectivitySize;
+    }
+
+  // Description:
+  // Compares the content of the arrays of an entry with the ones of a
+  // signature whose hash matches.
+  static bool SameContent(const Entry& entry, const Signature& sig)
+    {
+    vtkIdTypeArray* conn1 = vtkIdTypeArray::SafeDownCast(entry.Arrays[0]);
+    vtkIdTypeArray* conn2 = vtkIdTypeArray::SafeDownCast(sig.Arrays[0]);
+    vtkUnsignedCharArray* types1 =
+      vtkUnsignedCharArray::SafeDownCast(entry.Arrays[1]);
+    vtkUnsignedCharArray* types2 =
+      vtkUnsignedCharArray::SafeDownCast(sig.Arrays[1]);
+    if (!conn1 || !conn2 || !types1 || !types2 ||
+      !std::equal(conn1->GetPointer(0),
+        conn1->GetPointer(0) + sig.ConnectivitySize, conn2->GetPointer(0)) ||
+      !std::equal(types1->GetPointer(0),
+        types1->GetPointer(0) + sig.NumberOfCells, types2->GetPointer(0)))
+      {
+      return false;
+      }
+    vtkDataArray* ghosts1 = vtkDataArray::SafeDownCast(entry.Arrays[2]);
+    vtkDataArray* ghosts2 = vtkDataArray::SafeDownCast(sig.Arrays[2]);
+    if (!ghosts1 || !ghosts2)
+      {
+      return ghosts1 == ghosts2;
+      }
+    if (ghosts1->GetNumberOfTuples() != ghosts2->GetNumberOfTuples())
+      {
+      return false;
+      }
+    for (vtkIdType cc = 0; cc < ghosts1->GetNumberOfTuples(); ++cc)
+      {
+      if (ghosts1->GetComponent(cc, 0) != ghosts2->GetComponent(cc, 0))
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+
+  Entry* FindByArrays(const Signature& sig)
+    {
+    if (!sig.Arrays[0] || !sig.Arrays[1])
+      {
+      return NULL;
+      }
+    EntryMap::iterator iter = this->Entries.find(ArraysKey(sig));
+    if (iter == this->Entries.end() ||
+      !SameSizes(iter->second.Key, sig) ||
+      !std::equal(sig.MTimes, sig.MTimes + 3, iter->second.Key.MTimes))
+      {
+      return NULL;
+      }
+    iter->second.Used = true;
+    return &iter->second;
+    }
+
+  Entry* FindByHash(const Signature& sig)
+    {
+    std::pair<HashMap::iterator, HashMap::iterator> range =
+      this->Hashes.equal_range(sig.Hash);
+    for (HashMap::iterator iter = range.first; iter != range.second; ++iter)
+      {
+      EntryMap::iterator match = this->Entries.find(iter->second);
+      if (match == this->Entries.end() ||
+        !SameSizes(match->second.Key, sig) ||
+        !SameContent(match->second, sig))
+        {
+        continue;
+        }
+      // remember the new arrays so that the next lookup is cheap.
+      Entry entry = match->second;
+      this->Remove(match);
+      entry.Key = sig;
+      entry.Used = true;
+      for (int cc = 0; cc < 3; ++cc)
+        {
+        entry.Arrays[cc] = sig.Arrays[cc];
+        }
+      return this->Add(entry);
+      }
+    return NULL;
+    }
+
+  // Description:
+  // Remembers the surface extracted from a grid, unless the cache would then
+  // use more than limit KB. The surface must have the vtkOriginalPointIds and
+  // vtkOriginalCellIds arrays.
+  void Insert(const Signature& sig, vtkPolyData* surface, unsigned long limit)
+    {
+    vtkIdTypeArray* pointIds = vtkIdTypeArray::SafeDownCast(
+      surface->GetPointData()->GetArray("vtkOriginalPointIds"));
+    vtkIdTypeArray* cellIds = vtkIdTypeArray::SafeDownCast(
+      surface->GetCellData()->GetArray("vtkOriginalCellIds"));
+    if (!pointIds || !cellIds || !surface->GetPoints())
+      {
+      return;
+      }
+
+    // A previous surface for the same arrays is replaced.
+    EntryMap::iterator previous = this->Entries.find(ArraysKey(sig));
+    if (previous != this->Entries.end())
+      {
+      this->Remove(previous);
+      }
+
+    Entry entry;
+    entry.Key = sig;
+    entry.Used = true;
+    for (int cc = 0; cc < 3; ++cc)
+      {
+      entry.Arrays[cc] = sig.Arrays[cc];
+      }
+    entry.Verts = surface->GetVerts();
+    entry.Lines = surface->GetLines();
+    entry.Polys = surface->GetPolys();
+    entry.Strips = surface->GetStrips();
+    entry.OriginalPointIds = pointIds;
+    entry.OriginalCellIds = cellIds;
+    entry.Size = pointIds->GetActualMemorySize() +
+      cellIds->GetActualMemorySize();
+    vtkCellArray* cells[4] =
+      { entry.Verts, entry.Lines, entry.Polys, entry.Strips };
+    for (int cc = 0; cc < 4; ++cc)
+      {
+      entry.Size += cells[cc]? cells[cc]->GetActualMemorySize() : 0;
+      }
+    for (int cc = 0; cc < 3; ++cc)
+      {
+      vtkDataArray* array = vtkDataArray::SafeDownCast(sig.Arrays[cc]);
+      entry.Size += array? array->GetActualMemorySize() : 0;
+      }
+    if (this->Size + entry.Size <= limit)
+      {
+      this->Add(entry);
+      }
+    }
+
+  // Description:
+  // Produces the surface of grid, whose connectivity matches the entry.
+  static void Gather(Entry* entry, vtkUnstructuredGrid* grid,
+    vtkPolyData* output, bool passThroughPointIds, bool passThroughCellIds)
+    {
+    vtkIdType numPts = entry->OriginalPointIds->GetNumberOfTuples();
+    vtkIdType numCells = entry->OriginalCellIds->GetNumberOfTuples();
+    const vtkIdType* pointIds = entry->OriginalPointIds->GetPointer(0);
+    const vtkIdType* cellIds = entry->OriginalCellIds->GetPointer(0);
+
+    vtkNew<vtkPoints> points;
+    points->SetDataType(grid->GetPoints()->GetDataType());
+    points->SetNumberOfPoints(numPts);
+    vtkDataArray* inCoords = grid->GetPoints()->GetData();
+    vtkDataArray* outCoords = points->GetData();
+    for (vtkIdType cc = 0; cc < numPts; ++cc)
+      {
+      outCoords->SetTuple(cc, pointIds[cc], inCoords);
+      }
+    output->SetPoints(points.GetPointer());
+
+    output->SetVerts(entry->Verts);
+    output->SetLines(entry->Lines);
+    output->SetPolys(entry->Polys);
+    output->SetStrips(entry->Strips);
+
+    vtkPointData* inputPD = grid->GetPointData();
+    vtkPointData* outputPD = output->GetPointData();
+    outputPD->CopyGlobalIdsOn();
+    outputPD->CopyAllocate(inputPD, numPts);
+    for (vtkIdType cc = 0; cc < numPts; ++cc)
+      {
+      outputPD->CopyData(inputPD, pointIds[cc], cc);
+      }
+    if (passThroughPointIds)
+      {
+      outputPD->AddArray(entry->OriginalPointIds);
+      }
+
+    vtkCellData* inputCD = grid->GetCellData();
+    vtkCellData* outputCD = output->GetCellData();
+    outputCD->CopyGlobalIdsOn();
+    outputCD->CopyAllocate(inputCD, numCells);
+    for (vtkIdType cc = 0; cc < numCells; ++cc)
+      {
+      outputCD->CopyData(inputCD, cellIds[cc], cc);
+      }
+    if (passThroughCellIds)
+      {
+      outputCD->AddArray(entry->OriginalCellIds);
+      }
+    }
+
+  // Description:
+  // Forgets the surfaces that were not used since the last call.
+  void Prune()
+    {
+    EntryMap::iterator iter = this->Entries.begin();
+    while (iter != this->Entries.end())
+      {
+      EntryMap::iterator current = iter++;
+      if (current->second.Used)
+        {
+        current->second.Used = false;
+        }
+      else
+        {
+        this->Remove(current);
+        }
+      }
+    }
+
+  void Clear()
+    {
+    this->Entries.clear();
+    this->Hashes.clear();
+    this->Size = 0;
+    }
+
+private:
+  Entry* Add(const Entry& entry)
+    {
+    ArraysKey key(entry.Key);
+    EntryMap::iterator previous = this->Entries.find(key);
+    if (previous != this->Entries.end())
+      {
+      this->Remove(previous);
+      }
+    Entry& added = this->Entries[key];
+    added = entry;
+    this->Hashes.insert(HashMap::value_type(entry.Key.Hash, key));
+    this->Size += entry.Size;
+    return &added;
+    }
+
+  void Remove(EntryMap::iterator iter)
+    {
+    std::pair<HashMap::iterator, HashMap::iterator> range =
+      this->Hashes.equal_range(iter->second.Key.Hash);
+    for (HashMap::iterator hash = range.first; hash != range.second; ++hash)
+      {
+      if (!(hash->second < iter->first) && !(iter->first < hash->second))
+        {
+        this->Hashes.erase(hash);
+        break;
+        }
+      }
+    this->Size -= std::min(this->Size, iter->second.Size);
+    this->Entries.erase(iter);
+    }
+
+  EntryMap Entries;
+  HashMap Hashes;
+  unsigned long Size;
+};
+
 //----------------------------------------------------------------------------
 vtkPVGeometryFilter::vtkPVGeometryFilter ()
 {
@@ -184,6 +647,13 @@ vtkPVGeometryFilter::vtkPVGeometryFilter ()
 
   this->HideInternalAMRFaces = true;
   this->UseNonOverlappingAMRMetaDataForOutlines = true;
+  this->ProcessBlocksInParallel =
+    (vtksys::SystemTools::GetEnv("PV_GEOMETRY_FILTER_THREADS") != NULL);
+  this->CacheUnstructuredSurfaces = true;
+  this->UnstructuredSurfaceCacheLimit = 100 * 1024; // 100 MBs.
+  this->NumberOfReusedSurfaces = 0;
+  this->MarkTimerEvents = true;
+  this->SurfaceCache = new vtkPVGeometryFilter::UnstructuredSurfaceCache();
 }
 
 //----------------------------------------------------------------------------
@@ -218,6 +688,18 @@ vtkPVGeometryFilter::~vtkPVGeometryFilter ()
   this->OutlineSource->Delete();
   this->InternalProgressObserver->Delete();
   this->SetController(0);
+  delete this->SurfaceCache;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVGeometryFilter::SetCacheUnstructuredSurfaces(bool val)
+{
+  if (this->CacheUnstructuredSurfaces != val)
+    {
+    this->CacheUnstructuredSurfaces = val;
+    this->SurfaceCache->Clear();
+    this->Modified();
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -536,10 +1018,17 @@ int vtkPVGeometryFilter::RequestData(vtkInformation* request,
                                      vtkInformationVector* outputVector)
 {
   vtkDataObject* input = vtkDataObject::GetData(inputVector[0], 0);
+  this->NumberOfReusedSurfaces = 0;
   if (vtkCompositeDataSet::SafeDownCast(input))
     {
     vtkTimerLog::MarkStartEvent("vtkPVGeometryFilter::RequestData");
-    vtkGarbageCollector::DeferredCollectionPush();
+    // Deferred collection uses global state that must not be touched by the
+    // threads processing the blocks.
+    bool deferCollection = !this->ProcessBlocksInParallel;
+    if (deferCollection)
+      {
+      vtkGarbageCollector::DeferredCollectionPush();
+      }
     if (input->IsA( "vtkUniformGridAMR"))
       {
       this->RequestAMRData( request, inputVector, outputVector );
@@ -548,9 +1037,13 @@ int vtkPVGeometryFilter::RequestData(vtkInformation* request,
       {
       this->RequestCompositeData(request, inputVector, outputVector);
       }
-    vtkTimerLog::MarkStartEvent("vtkPVGeometryFilter::GarbageCollect");
-    vtkGarbageCollector::DeferredCollectionPop();
-    vtkTimerLog::MarkEndEvent("vtkPVGeometryFilter::GarbageCollect");
+    if (deferCollection)
+      {
+      vtkTimerLog::MarkStartEvent("vtkPVGeometryFilter::GarbageCollect");
+      vtkGarbageCollector::DeferredCollectionPop();
+      vtkTimerLog::MarkEndEvent("vtkPVGeometryFilter::GarbageCollect");
+      }
+    this->SurfaceCache->Prune();
     vtkTimerLog::MarkEndEvent("vtkPVGeometryFilter::RequestData");
     return 1;
     }
@@ -576,6 +1069,7 @@ int vtkPVGeometryFilter::RequestData(vtkInformation* request,
     0,
     wholeExtent);
   this->CleanupOutputData(output, 1);
+  this->SurfaceCache->Prune();
   return 1;
 }
 
@@ -937,22 +1431,84 @@ int vtkPVGeometryFilter::RequestCompositeData(vtkInformation*,
   non_null_leaves.reserve(totNumBlocks); //just an estimate.
   int* wholeExtent = vtkStreamingDemandDrivenPipeline::GetWholeExtent(
     inputVector[0]->GetInformationObject(0));
-  int numInputs = 0;
 
+  // Collect the leaves first, the surfaces are then extracted either serially
+  // or concurrently, and the output is assembled in traversal order so that
+  // the composite indices and block colors do not depend on the mode.
+  std::vector<vtkDataObject*> blocks;
+  std::vector<unsigned int> block_ids;
+  blocks.reserve(totNumBlocks);
+  block_ids.reserve(totNumBlocks);
   unsigned int block_id = 0;
   iter->SkipEmptyNodesOff(); // since we want to a get an accurtate block-id count to
                              // set vtkBlockColors correctly.
   for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem(), ++block_id)
     {
     vtkDataObject* block = iter->GetCurrentDataObject();
-    if (!block)
+    if (block)
       {
-      continue;
+      blocks.push_back(block);
+      block_ids.push_back(block_id);
+      }
+    }
+
+  std::vector<vtkSmartPointer<vtkPolyData> > outputs(blocks.size());
+  std::vector<size_t> serial_indices;
+  if (this->ProcessBlocksInParallel && blocks.size() > 1)
+    {
+    // A dataset referenced by more than one leaf is only processed by one
+    // thread, its other occurrences are processed serially afterwards.
+    std::set<vtkDataObject*> unique_blocks;
+    std::vector<size_t> parallel_indices;
+    for (size_t cc = 0; cc < blocks.size(); ++cc)
+      {
+      if (unique_blocks.insert(blocks[cc]).second)
+        {
+        parallel_indices.push_back(cc);
+        }
+      else
+        {
+        serial_indices.push_back(cc);
+        }
+      }
+    vtkTimerLog::MarkStartEvent("vtkPVGeometryFilter::ExecuteBlocksInParallel");
+    vtkPVGeometryFilter::BlockExecutor executor(
+      this, blocks, parallel_indices, outputs, wholeExtent);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(parallel_indices.size()), 1,
+      executor);
+    vtkTimerLog::MarkEndEvent("vtkPVGeometryFilter::ExecuteBlocksInParallel");
+    }
+  else
+    {
+    for (size_t cc = 0; cc < blocks.size(); ++cc)
+      {
+      serial_indices.push_back(cc);
       }
+    }
 
+  int numInputs = static_cast<int>(blocks.size() - serial_indices.size());
+  for (size_t cc = 0; cc < serial_indices.size(); ++cc)
+    {
+    size_t index = serial_indices[cc];
     vtkPolyData* tmpOut = vtkPolyData::New();
-    this->ExecuteBlock(block, tmpOut, 0, 0, 1, 0, wholeExtent);
+    this->ExecuteBlock(blocks[index], tmpOut, 0, 0, 1, 0, wholeExtent);
     this->CleanupOutputData(tmpOut, 0);
+    outputs[index].TakeReference(tmpOut);
+
+    numInputs++;
+    this->UpdateProgress(static_cast<float>(numInputs)/totNumBlocks);
+    }
+
+  size_t current = 0;
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+    if (!iter->GetCurrentDataObject())
+      {
+      continue;
+      }
+    vtkPolyData* tmpOut = outputs[current];
+    unsigned int current_block_id = block_ids[current];
+    ++current;
     //skip empty nodes.
     if (tmpOut->GetNumberOfPoints() > 0)
       {
@@ -960,20 +1516,12 @@ int vtkPVGeometryFilter::RequestCompositeData(vtkInformation*,
       non_null_leaves.resize(current_flat_index+1);
       non_null_leaves[current_flat_index] = 1;
       output->SetDataSet(iter, tmpOut);
-      tmpOut->FastDelete();
 
       this->AddCompositeIndex(tmpOut, current_flat_index);
-      this->AddBlockColors(tmpOut, block_id);
-      }
-    else
-      {
-      tmpOut->Delete();
-      tmpOut = NULL;
+      this->AddBlockColors(tmpOut, current_block_id);
       }
-
-    numInputs++;
-    this->UpdateProgress(static_cast<float>(numInputs)/totNumBlocks);
     }
+  outputs.clear();
   vtkTimerLog::MarkEndEvent("vtkPVGeometryFilter::ExecuteCompositeDataSet");
 
   // Merge mutli-pieces to avoid efficiency setbacks when ordered
@@ -1418,6 +1966,37 @@ void vtkPVGeometryFilter::UnstructuredGridExecute(
         }
       }
 
+    // When the connectivity did not change since a previous execution, the
+    // surface is reused and only the coordinates and attributes are gathered.
+    typedef vtkPVGeometryFilter::UnstructuredSurfaceCache SurfaceCacheType;
+    SurfaceCacheType::Signature signature;
+    vtkUnstructuredGrid* grid = vtkUnstructuredGrid::SafeDownCast(input);
+    bool cacheSurface = false;
+    if (this->CacheUnstructuredSurfaces && grid && !handleSubdivision)
+      {
+      vtkTimerLog::MarkStartEvent(
+        "vtkPVGeometryFilter::ReuseUnstructuredSurface");
+      SurfaceCacheType::GetArrays(grid, signature);
+      SurfaceCacheType::Entry* entry =
+        this->SurfaceCache->FindByArrays(signature);
+      if (!entry && SurfaceCacheType::ComputeHash(grid, signature))
+        {
+        cacheSurface = true;
+        entry = this->SurfaceCache->FindByHash(signature);
+        }
+      if (entry)
+        {
+        SurfaceCacheType::Gather(entry, grid, output,
+          this->PassThroughPointIds != 0, this->PassThroughCellIds != 0);
+        this->NumberOfReusedSurfaces++;
+        vtkTimerLog::MarkEndEvent(
+          "vtkPVGeometryFilter::ReuseUnstructuredSurface");
+        return;
+        }
+      vtkTimerLog::MarkEndEvent(
+        "vtkPVGeometryFilter::ReuseUnstructuredSurface");
+      }
+
     vtkSmartPointer<vtkIdTypeArray> facePtIds2OriginalPtIds;
 
     vtkSmartPointer<vtkUnstructuredGridBase> inputClone =
@@ -1486,10 +2065,45 @@ void vtkPVGeometryFilter::UnstructuredGridExecute(
         }
       }
 
+    if (cacheSurface)
+      {
+      // The cache needs the original ids, whether they are passed or not.
+      this->DataSetSurfaceFilter->PassThroughCellIdsOn();
+      this->DataSetSurfaceFilter->PassThroughPointIdsOn();
+      }
+
+    if (this->MarkTimerEvents)
+      {
+      vtkTimerLog::MarkStartEvent(
+        "vtkPVGeometryFilter::ExtractUnstructuredSurface");
+      }
     if (input->GetNumberOfCells() > 0)
       {
       this->DataSetSurfaceFilter->UnstructuredGridExecute(input, output);
       }
+    if (this->MarkTimerEvents)
+      {
+      vtkTimerLog::MarkEndEvent(
+        "vtkPVGeometryFilter::ExtractUnstructuredSurface");
+      }
+
+    if (cacheSurface)
+      {
+      this->SurfaceCache->Insert(
+        signature, output, this->UnstructuredSurfaceCacheLimit);
+      this->DataSetSurfaceFilter->SetPassThroughCellIds(
+                                                      this->PassThroughCellIds);
+      this->DataSetSurfaceFilter->SetPassThroughPointIds(
+                                                     this->PassThroughPointIds);
+      if (!this->PassThroughCellIds)
+        {
+        output->GetCellData()->RemoveArray("vtkOriginalCellIds");
+        }
+      if (!this->PassThroughPointIds)
+        {
+        output->GetPointData()->RemoveArray("vtkOriginalPointIds");
+        }
+      }
 
     if (this->Triangulate && (output->GetNumberOfPolys() > 0))
       {
@@ -1781,6 +2395,14 @@ void vtkPVGeometryFilter::PrintSelf(ostream& os, vtkIndent indent)
      << (this->PassThroughCellIds ? "On\n" : "Off\n");
   os << indent << "PassThroughPointIds: "
      << (this->PassThroughPointIds ? "On\n" : "Off\n");
+  os << indent << "ProcessBlocksInParallel: "
+     << (this->ProcessBlocksInParallel ? "On\n" : "Off\n");
+  os << indent << "CacheUnstructuredSurfaces: "
+     << (this->CacheUnstructuredSurfaces ? "On\n" : "Off\n");
+  os << indent << "UnstructuredSurfaceCacheLimit: "
+     << this->UnstructuredSurfaceCacheLimit << endl;
+  os << indent << "NumberOfReusedSurfaces: "
+     << this->NumberOfReusedSurfaces << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -155,6 +155,39 @@ public:
   vtkGetMacro(UseNonOverlappingAMRMetaDataForOutlines, bool);
   vtkBooleanMacro(UseNonOverlappingAMRMetaDataForOutlines, bool);
 
+  // Description:
+  // When set, the leaf blocks of composite datasets (other than AMR) are
+  // processed concurrently using vtkSMPTools, each thread using its own copy
+  // of the internal filters. The output is identical to the serial case.
+  // Default is off, unless the PV_GEOMETRY_FILTER_THREADS environment variable
+  // is set.
+  vtkSetMacro(ProcessBlocksInParallel, bool);
+  vtkGetMacro(ProcessBlocksInParallel, bool);
+  vtkBooleanMacro(ProcessBlocksInParallel, bool);
+
+  // Description:
+  // When set, the external surface extracted from linear unstructured grids
+  // is remembered along with the ids of the original points and cells it
+  // uses. When a later execution receives a grid with the same connectivity,
+  // as is the case for transient simulations with a fixed topology, the
+  // surface is reused and only the point coordinates and the attribute
+  // arrays are gathered again. Default is on.
+  void SetCacheUnstructuredSurfaces(bool);
+  vtkGetMacro(CacheUnstructuredSurfaces, bool);
+  vtkBooleanMacro(CacheUnstructuredSurfaces, bool);
+
+  // Description:
+  // Maximum memory, in KB, used by the surfaces remembered when
+  // CacheUnstructuredSurfaces is on. Surfaces that would exceed it are not
+  // remembered. Default is 100 MB.
+  vtkSetMacro(UnstructuredSurfaceCacheLimit, unsigned long);
+  vtkGetMacro(UnstructuredSurfaceCacheLimit, unsigned long);
+
+  // Description:
+  // Number of unstructured grid surfaces that were reused from the cache,
+  // rather than extracted, during the last execution.
+  vtkGetMacro(NumberOfReusedSurfaces, int);
+
   // These keys are put in the output composite-data metadata for multipieces
   // since this filter merges multipieces together.
   static vtkInformationIntegerVectorKey* POINT_OFFSETS();
@@ -308,6 +341,15 @@ protected:
 
   bool HideInternalAMRFaces;
   bool UseNonOverlappingAMRMetaDataForOutlines;
+  bool ProcessBlocksInParallel;
+  bool CacheUnstructuredSurfaces;
+  unsigned long UnstructuredSurfaceCacheLimit;
+  int NumberOfReusedSurfaces;
+
+  // Description:
+  // False for the copies extracting blocks on vtkSMPTools threads, which must
+  // not log vtkTimerLog events.
+  bool MarkTimerEvents;
 
 private:
   vtkPVGeometryFilter(const vtkPVGeometryFilter&); // Not implemented
@@ -322,6 +364,9 @@ private:
   void AddBlockColors(vtkPolyData* pd, unsigned int index);
   void AddHierarchicalIndex(vtkPolyData* pd, unsigned int level, unsigned int index);
   class BoundsReductionOperation;
+  class BlockExecutor;
+  class UnstructuredSurfaceCache;
+  UnstructuredSurfaceCache* SurfaceCache;
 
 };
 
@@ -26,6 +26,7 @@
 #include "vtkInformationExecutivePortKey.h"
 #include "vtkInformationVector.h"
 #include "vtkPVInstantiator.h"
+#include "vtkMultiProcessController.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
@@ -58,6 +59,7 @@ vtkReductionFilter::vtkReductionFilter()
   this->PostGatherHelper = 0;
   this->PassThrough = -1;
   this->GenerateProcessIds = 0;
+  this->TreeReduction = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -357,6 +359,28 @@ void vtkReductionFilter::Reduce(vtkDataObject* input, vtkDataObject* output)
     this->PassThrough = -1;
     }
 
+  // output has the same type on all processes, so that all of them take the
+  // same path. Intermediate nodes need the PostGatherHelper to merge their
+  // children's results: when any process lacks it, all of them gather.
+  if (this->TreeReduction && this->PassThrough < 0 &&
+    !vtkSelection::SafeDownCast(output))
+    {
+    int hasHelper = this->PostGatherHelper? 1 : 0;
+    int allHaveHelper = 0;
+    controller->AllReduce(&hasHelper, &allHaveHelper, 1,
+      vtkCommunicator::MIN_OP);
+    if (allHaveHelper)
+      {
+      this->TreeReduce(preOutput, output);
+      return;
+      }
+    if (myId == 0)
+      {
+      vtkWarningMacro("TreeReduction requires a PostGatherHelper on all "
+        "processes, gathering the results to the root node instead.");
+      }
+    }
+
   std::vector<vtkSmartPointer<vtkDataObject> > data_sets;
   std::vector<vtkSmartPointer<vtkDataObject> > receiveData(
     controller->GetNumberOfProcesses());
@@ -401,6 +425,78 @@ void vtkReductionFilter::Reduce(vtkDataObject* input, vtkDataObject* output)
     }
 }
 
+//-----------------------------------------------------------------------------
+void vtkReductionFilter::TreeReduce(
+  vtkDataObject* preOutput, vtkDataObject* output)
+{
+  vtkMultiProcessController* controller = this->Controller;
+  int myId = controller->GetLocalProcessId();
+  int numProcs = controller->GetNumberOfProcesses();
+
+  // At step s, processes that are multiples of 2s receive the result of
+  // process myId+s, those that are not send theirs to myId-s and are done.
+  vtkSmartPointer<vtkDataObject> partial = preOutput;
+  bool reduced = false;
+  for (int step = 1; step < numProcs; step <<= 1)
+    {
+    if (myId % (2 * step) != 0)
+      {
+      int hasData = partial? 1 : 0;
+      controller->Send(&hasData, 1, myId - step, TRANSMIT_DATA_OBJECT);
+      if (partial)
+        {
+        controller->Send(partial.GetPointer(), myId - step, TRANSMIT_DATA_OBJECT);
+        }
+      break;
+      }
+
+    int child = myId + step;
+    if (child >= numProcs)
+      {
+      continue;
+      }
+    int hasData = 0;
+    controller->Receive(&hasData, 1, child, TRANSMIT_DATA_OBJECT);
+    if (!hasData)
+      {
+      continue;
+      }
+    vtkSmartPointer<vtkDataObject> received;
+    received.TakeReference(
+      controller->ReceiveDataObject(child, TRANSMIT_DATA_OBJECT));
+    if (!partial)
+      {
+      partial = received;
+      continue;
+      }
+
+    vtkSmartPointer<vtkDataObject> inputs[2] = { partial, received };
+    vtkSmartPointer<vtkDataObject> merged;
+    merged.TakeReference(output->NewInstance());
+    this->PostProcess(merged.GetPointer(), inputs, 2);
+    partial = merged;
+    reduced = true;
+    }
+
+  // As with the gather, processes other than the root produce the reduction
+  // of their own result.
+  if (myId != 0)
+    {
+    partial = preOutput;
+    reduced = false;
+    }
+  if (reduced)
+    {
+    output->ShallowCopy(partial);
+    }
+  else if (partial)
+    {
+    vtkSmartPointer<vtkDataObject> inputs[1] = { partial };
+    this->PostProcess(output, inputs, 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
 int vtkReductionFilter::GatherV(
   vtkDataObject* sendData, vtkSmartPointer<vtkDataObject>* receiveData,
   int destProcessId)
@@ -463,4 +559,5 @@ void vtkReductionFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Controller: " << this->Controller << endl;
   os << indent << "PassThrough: " << this->PassThrough << endl;
   os << indent << "GenerateProcessIds: " << this->GenerateProcessIds << endl;
+  os << indent << "TreeReduction: " << this->TreeReduction << endl;
 }
@@ -26,6 +26,14 @@
 // In addition to doing reduction the PassThrough variable lets you choose
 // to pass through the results of any one node instead of aggregating all of
 // them together.
+//
+// When TreeReduction is set, the intermediate results are not gathered to the
+// root node. Instead they are reduced pairwise along a binomial tree: every
+// node runs the PostGatherHelper on its result and on the one of its child,
+// then sends the reduced result to its parent. This bounds the memory used on
+// the root node to a couple of results instead of one per node. It can only be
+// used with a PostGatherHelper that is associative and whose output can be
+// used as one of its inputs, e.g. vtkAttributeDataReductionFilter.
 
 #ifndef vtkReductionFilter_h
 #define vtkReductionFilter_h
@@ -78,6 +86,16 @@ public:
   vtkSetMacro(GenerateProcessIds, int);
   vtkGetMacro(GenerateProcessIds, int);
 
+  // Description:
+  // When set, the results are reduced along a binomial tree instead of being
+  // gathered to the root node, see class description. The PostGatherHelper
+  // must then be set on all processes, not only on the root node: when it
+  // is missing on any process, the results are gathered as usual. Ignored
+  // when PassThrough is set or for vtkSelection. Off by default.
+  vtkSetMacro(TreeReduction, int);
+  vtkGetMacro(TreeReduction, int);
+  vtkBooleanMacro(TreeReduction, int);
+
   enum Tags {
     TRANSMIT_DATA_OBJECT = 23484
   };
@@ -98,6 +116,10 @@ protected:
                           vtkInformationVector* outputVector);
 
   void Reduce(vtkDataObject* input, vtkDataObject* output);
+  // Description:
+  // Reduces preOutput of all processes along a binomial tree, see
+  // TreeReduction.
+  void TreeReduce(vtkDataObject* preOutput, vtkDataObject* output);
   vtkDataObject* PreProcess(vtkDataObject* input);
   void PostProcess(vtkDataObject* output,
     vtkSmartPointer<vtkDataObject> inputs[],
@@ -121,6 +143,7 @@ protected:
   vtkMultiProcessController* Controller;
   int PassThrough;
   int GenerateProcessIds;
+  int TreeReduction;
 
 private:
   vtkReductionFilter(const vtkReductionFilter&); // Not implemented.
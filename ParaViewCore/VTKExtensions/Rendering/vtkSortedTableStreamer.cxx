@@ -67,6 +67,7 @@ public:
   virtual ~InternalsBase() {}
 
   virtual void SetSelectedComponent(int newValue) = 0;
+  virtual void SetMaxBytesPerRound(vtkIdType maxBytes) = 0;
   virtual void InvalidateCache() = 0;
   virtual int  Extract( vtkTable* input, vtkTable* output,
                         vtkIdType block, vtkIdType blockSize,
@@ -504,25 +505,9 @@ public:
       for(vtkIdType i=0; i < this->ArraySize; ++i)
         {
         this->Array[i].OriginalIndex = i;
-        double value = 0;
-        double tmp;
-        if(selectedComponent < 0)
-          {
-          // Compute magnitude
-          for(int k=0;k<numComponents;k++)
-            {
-            tmp = static_cast<double>(dataPtr[k + i*numComponents]);
-            value +=  tmp*tmp;
-            }
-          value = sqrt(value) / sqrt(static_cast<double>(numComponents));
-          this->Array[i].Value = static_cast<T>(value);
-          }
-        else
-          {
-          this->Array[i].Value = dataPtr[selectedComponent + i*numComponents];
-          value = static_cast<double>(this->Array[i].Value);
-          }
-        this->Histo->AddValue(value);
+        this->Array[i].Value =
+          GetSortedValue(dataPtr, i, numComponents, selectedComponent);
+        this->Histo->AddValue(static_cast<double>(this->Array[i].Value));
         }
 
       // Sort it
@@ -536,6 +521,27 @@ public:
         }
       }
 
+    // Description:
+    // Value used to sort the tuple i: the selected component or, when
+    // selectedComponent is negative, the magnitude scaled to the range of T.
+    static T GetSortedValue(T* dataPtr, vtkIdType i, int numComponents,
+                            int selectedComponent)
+      {
+      if(selectedComponent >= 0)
+        {
+        return dataPtr[selectedComponent + i*numComponents];
+        }
+      double value = 0;
+      double tmp;
+      for(int k=0;k<numComponents;k++)
+        {
+        tmp = static_cast<double>(dataPtr[k + i*numComponents]);
+        value +=  tmp*tmp;
+        }
+      value = sqrt(value) / sqrt(static_cast<double>(numComponents));
+      return static_cast<T>(value);
+      }
+
     void SortProcessId(vtkIdType* dataPtr, vtkIdType numTuples,
                        vtkIdType histogramSize,
                        double* scalarRange, bool reverseOrder)
@@ -571,13 +577,49 @@ public:
       }
   };
 
+  // Description:
+  // Position of a row in the global sort: the sorted value, then the process
+  // and the row index in that process so that equal values are ordered the
+  // same way by all the processes.
+  struct SortKey
+  {
+    T Value;
+    vtkIdType ProcessId;
+    vtkIdType OriginalIndex;
+  };
+  class SortKeyCompare
+  {
+  public:
+    bool InvertOrder;
+
+    SortKeyCompare(bool invertOrder) : InvertOrder(invertOrder) {}
+
+    bool operator()(const SortKey& a, const SortKey& b) const
+      {
+      return this->InvertOrder ? Less(b, a) : Less(a, b);
+      }
+
+    static bool Less(const SortKey& a, const SortKey& b)
+      {
+      if (a.Value != b.Value)
+        {
+        return a.Value < b.Value;
+        }
+      if (a.ProcessId != b.ProcessId)
+        {
+        return a.ProcessId < b.ProcessId;
+        }
+      return a.OriginalIndex < b.OriginalIndex;
+      }
+  };
+
 public:
 
   Internals()
     {
     // Only used for testing
     this->LocalSorter = 0;
-    this->GlobalHistogram = 0;
+    this->MaxBytesPerRound = VTK_INT_MAX;
     this->Debug = false;
     }
 
@@ -586,6 +628,7 @@ public:
     {
     // Default values
     this->SelectedComponent = 0;
+    this->MaxBytesPerRound = VTK_INT_MAX;
     this->NeedToBuildCache = true;
     this->DataToSort = dataToSort;
 
@@ -603,13 +646,11 @@ public:
 
     // Create internal objects
     this->LocalSorter = new ArraySorter();
-    this->GlobalHistogram = new Histogram(HISTOGRAM_SIZE);
     }
 
   virtual ~Internals()
     {
     if (this->LocalSorter)     delete this->LocalSorter;
-    if (this->GlobalHistogram) delete this->GlobalHistogram;
     }
 
   // --------------------------------------------------------------------------
@@ -677,14 +718,20 @@ public:
     }
 
   // --------------------------------------------------------------------------
+  // Without sortableArray, keep the local order. Otherwise build the
+  // distributed index with a sample sort: the local rows are sorted, each
+  // process picks NumProcs regularly spaced samples of its sorted rows, the
+  // samples of all the processes give the NumProcs-1 splitters of the global
+  // order and the rows between two splitters are gathered, sorted, on one
+  // process. The rows held by each process then follow the ones held by the
+  // processes of lower id, and regular sampling keeps them below twice the
+  // average number of rows per process whatever the distribution of the
+  // values.
   int BuildCache(bool sortableArray, bool invertOrder)
     {
     // We are building the cache so no need to build it next time
     this->NeedToBuildCache = false;
 
-    // Communication buffer
-    vtkIdType* bufferHistogramValues = new vtkIdType[this->NumProcs *  HISTOGRAM_SIZE];
-
     // Is there something to sort ???
     if(!sortableArray)
       {
@@ -693,53 +740,163 @@ public:
         {
         this->LocalSorter->FillArray( this->DataToSort->GetNumberOfTuples());
         }
+      return 1;
       }
-    else
+
+    SortKeyCompare compare(invertOrder);
+
+    // Sort the local rows
+    std::vector<SortKey> localKeys;
+    if(this->DataToSort)
       {
-      if(this->DataToSort)
+      T* dataPtr = static_cast<T*>(this->DataToSort->GetVoidPointer(0));
+      int numComponents = this->DataToSort->GetNumberOfComponents();
+      int selectedComponent = this->SelectedComponent;
+      if(numComponents == 1 && selectedComponent < 0)
         {
-        // Sort and build local histogram
-        this->LocalSorter->Update(static_cast<T*>(this->DataToSort->GetVoidPointer(0)),
-                                  this->DataToSort->GetNumberOfTuples(),
-                                  this->DataToSort->GetNumberOfComponents(),
-                                  this->SelectedComponent,
-                                  HISTOGRAM_SIZE,
-                                  this->CommonRange,
-                                  invertOrder);
+        selectedComponent = 0; // We can not compute magnitude on scalar value
         }
-      else
+      localKeys.resize(this->DataToSort->GetNumberOfTuples());
+      for(vtkIdType i=0, nb=static_cast<vtkIdType>(localKeys.size()); i < nb; ++i)
         {
-        // Build empty local histogram
-        this->LocalSorter->Clear();
-        this->LocalSorter->Histo = new Histogram(HISTOGRAM_SIZE);
-        this->LocalSorter->Histo->SetScalarRange(this->CommonRange);
-        this->LocalSorter->Histo->Inverted = invertOrder;
+        localKeys[i].Value =
+          ArraySorter::GetSortedValue(dataPtr, i, numComponents, selectedComponent);
+        localKeys[i].ProcessId = this->Me;
+        localKeys[i].OriginalIndex = i;
         }
+      std::sort(localKeys.begin(), localKeys.end(), compare);
+      }
+    vtkIdType numLocalKeys = static_cast<vtkIdType>(localKeys.size());
 
-      // Initialize the global histogram with same range
-      this->LocalSorter->Histo->CopyRangeTo(*this->GlobalHistogram);
-
-      // Make sure that the global histogram is properly initialized
-      this->GlobalHistogram->ClearHistogramValues();
-      this->GlobalHistogram->Inverted = invertOrder;
+    // Gather the regular samples of every process and pick the splitters
+    std::vector<SortKey> samples;
+    for(int i=0; numLocalKeys > 0 && i < this->NumProcs; ++i)
+      {
+      samples.push_back(localKeys[i * numLocalKeys / this->NumProcs]);
+      }
+    std::vector<vtkIdType> lengths(this->NumProcs);
+    std::vector<vtkIdType> offsets(this->NumProcs);
+    vtkIdType length = static_cast<vtkIdType>(samples.size() * sizeof(SortKey));
+    this->MPI->AllGather(&length, &lengths[0], 1);
+    vtkIdType totalLength = 0;
+    for(int i=0; i < this->NumProcs; ++i)
+      {
+      offsets[i] = totalLength;
+      totalLength += lengths[i];
+      }
+    std::vector<SortKey> allSamples(totalLength / sizeof(SortKey));
+    this->MPI->AllGatherV(KeyBytes(samples), KeyBytes(allSamples), length,
+                          &lengths[0], &offsets[0]);
+    std::sort(allSamples.begin(), allSamples.end(), compare);
 
-      // Send local histogram and receive every histogram from everybody
-      this->MPI->AllGather(this->LocalSorter->Histo->Values,
-                           bufferHistogramValues,
-                           HISTOGRAM_SIZE);
+    // Split the local rows with the splitters
+    std::vector<vtkIdType> bounds(this->NumProcs + 1, numLocalKeys);
+    bounds[0] = 0;
+    for(int i=1; !allSamples.empty() && i < this->NumProcs; ++i)
+      {
+      const SortKey& splitter = allSamples[i * allSamples.size() / this->NumProcs];
+      bounds[i] = std::lower_bound(localKeys.begin(), localKeys.end(),
+                                   splitter, compare) - localKeys.begin();
+      }
 
-      // Merge all histogram into the GlobalHistogram
-      for(int idx=0, nb=this->NumProcs*HISTOGRAM_SIZE; idx < nb; ++idx)
+    // Gather the rows of each range on its process
+    std::vector<vtkIdType> counts(this->NumProcs);
+    std::vector<vtkIdType> allCounts(this->NumProcs * this->NumProcs);
+    for(int i=0; i < this->NumProcs; ++i)
+      {
+      counts[i] = bounds[i + 1] - bounds[i];
+      }
+    this->MPI->AllGather(&counts[0], &allCounts[0], this->NumProcs);
+    for(int dest=0; dest < this->NumProcs; ++dest)
+      {
+      for(int i=0; i < this->NumProcs; ++i)
         {
-        this->GlobalHistogram->TotalValues += bufferHistogramValues[idx];
-        this->GlobalHistogram->Values[idx % HISTOGRAM_SIZE] += bufferHistogramValues[idx];
+        counts[i] = allCounts[i * this->NumProcs + dest];
         }
+      this->GatherKeys(localKeys, bounds[dest], counts, dest);
       }
+    std::sort(this->SortedKeys.begin(), this->SortedKeys.end(), compare);
 
-    delete[] bufferHistogramValues;
+    // Global index of the first row held by each process
+    vtkIdType numKeys = static_cast<vtkIdType>(this->SortedKeys.size());
+    this->MPI->AllGather(&numKeys, &counts[0], 1);
+    this->KeyOffsets.resize(this->NumProcs + 1);
+    this->KeyOffsets[0] = 0;
+    for(int i=0; i < this->NumProcs; ++i)
+      {
+      this->KeyOffsets[i + 1] = this->KeyOffsets[i] + counts[i];
+      }
     return 1;
     }
 
+  // --------------------------------------------------------------------------
+  // Gathers in SortedKeys of process dest the counts[i] keys of each process
+  // i, in process order, the local ones starting at first in localKeys. MPI
+  // counts and displacements are ints, while a range can hold billions of
+  // keys: they are sent in rounds where each process sends at most as many
+  // keys as the bytes received by dest in a round fit in MaxBytesPerRound.
+  void GatherKeys(std::vector<SortKey>& localKeys, vtkIdType first,
+                  const std::vector<vtkIdType>& counts, int dest)
+    {
+    vtkIdType maxKeys = MAX(1, this->MaxBytesPerRound /
+      static_cast<vtkIdType>(sizeof(SortKey) * this->NumProcs));
+    std::vector<vtkIdType> starts(this->NumProcs);
+    vtkIdType total = 0;
+    vtkIdType largest = 0;
+    for(int i=0; i < this->NumProcs; ++i)
+      {
+      starts[i] = total;
+      total += counts[i];
+      largest = MAX(largest, counts[i]);
+      }
+    if(dest == this->Me)
+      {
+      this->SortedKeys.resize(total);
+      }
+
+    // With a single round, the keys are received in place.
+    bool inPlace = largest <= maxKeys;
+    std::vector<SortKey> received;
+    std::vector<vtkIdType> lengths(this->NumProcs);
+    std::vector<vtkIdType> offsets(this->NumProcs);
+    for(vtkIdType sent=0; sent < largest; sent += maxKeys)
+      {
+      vtkIdType length = 0;
+      for(int i=0; i < this->NumProcs; ++i)
+        {
+        lengths[i] =
+          MAX(0, MIN(maxKeys, counts[i] - sent)) * sizeof(SortKey);
+        offsets[i] = length;
+        length += lengths[i];
+        }
+      if(dest == this->Me && !inPlace)
+        {
+        received.resize(length / sizeof(SortKey));
+        }
+      this->MPI->GatherV(
+        lengths[this->Me] ? KeyBytes(localKeys, first + sent) : NULL,
+        inPlace ? KeyBytes(this->SortedKeys) : KeyBytes(received),
+        lengths[this->Me], &lengths[0], &offsets[0], dest);
+      if(dest != this->Me || inPlace)
+        {
+        continue;
+        }
+      for(int i=0; i < this->NumProcs; ++i)
+        {
+        std::copy(received.begin() + offsets[i] / sizeof(SortKey),
+                  received.begin() + (offsets[i] + lengths[i]) / sizeof(SortKey),
+                  this->SortedKeys.begin() + starts[i] + sent);
+        }
+      }
+    }
+
+  // --------------------------------------------------------------------------
+  // Keys as bytes for the communicator, NULL when there is none.
+  static char* KeyBytes(std::vector<SortKey>& keys, vtkIdType offset = 0)
+    {
+    return keys.empty() ? NULL : reinterpret_cast<char*>(&keys[0] + offset);
+    }
+
   // --------------------------------------------------------------------------
   // The sorting is based on processId and the current order
   int Extract(vtkTable* input, vtkTable* output,
@@ -893,8 +1050,9 @@ public:
     {
     // ------------------------------------------------------------------------
     // Make sure that the Cache is builded
-    //    This will sort the local array, that's why we don't want to do it
-    //    at each execution. Specialy when we only change the requested block.
+    //    This will sort the whole distributed array, that's why we don't want
+    //    to do it at each execution. Specialy when we only change the
+    //    requested block.
     // ------------------------------------------------------------------------
     if(this->NeedToBuildCache)
       {
@@ -902,70 +1060,58 @@ public:
       }
 
     // ------------------------------------------------------------------------
-    // Search for lower bound
-    // ------------------------------------------------------------------------
-    vtkIdType nbElementsToRemoveFromHead = 0;
-    vtkIdType localOffset = 0;
-    vtkIdType nbElementsInBar = 0;
-    this->SearchGlobalIndexLocation( (block * blockSize),
-                                     this->LocalSorter->Histo,
-                                     this->GlobalHistogram,
-                                     nbElementsToRemoveFromHead,
-                                     localOffset,
-                                     nbElementsInBar);
-
-
-
-    // ------------------------------------------------------------------------
-    // Search for upper bound
-    // ------------------------------------------------------------------------
-    vtkIdType upperOffset = 0;
-    vtkIdType globalUpperOffset = 0;
-    vtkIdType searchIdx =
-        (this->GlobalHistogram->TotalValues < (block + 1) * blockSize) ?
-        this->GlobalHistogram->TotalValues : ((block + 1) * blockSize);
-    searchIdx--; // It is not a size it is an index (so -1)
-
-    this->SearchGlobalIndexLocation( searchIdx,
-                                     this->LocalSorter->Histo,
-                                     this->GlobalHistogram,
-                                     globalUpperOffset,
-                                     upperOffset,
-                                     nbElementsInBar );
-
-
-    // We have to include our searched index (so +1)
-    vtkIdType localSize = (upperOffset + nbElementsInBar) - localOffset + 1;
-
-    // ------------------------------------------------------------------------
-    // Build local subset table
-    // ------------------------------------------------------------------------
-    vtkSmartPointer<vtkTable> localSubset;
-    localSubset.TakeReference( this->NewSubsetTable( input,
-                                                     this->LocalSorter,
-                                                     localOffset,
-                                                     localSize));
-
-    // ------------------------------------------------------------------------
-    // Find the process that will merge all subset table
+    // Every process knows which part of the block each process holds:
+    // gather the process and row index of the rows of the block, in order
     // ------------------------------------------------------------------------
-    int mergePid = GetMergingProcessId(localSubset.GetPointer());
+    vtkIdType total = this->KeyOffsets[this->NumProcs];
+    vtkIdType blockStart = MIN(block * blockSize, total);
+    vtkIdType blockEnd = MIN(blockStart + blockSize, total);
+    std::vector<vtkIdType> lengths(this->NumProcs);
+    std::vector<vtkIdType> offsets(this->NumProcs);
+    vtkIdType blockLength = 0;
+    for(int i=0; i < this->NumProcs; ++i)
+      {
+      vtkIdType first = MAX(blockStart, this->KeyOffsets[i]);
+      vtkIdType last = MIN(blockEnd, this->KeyOffsets[i + 1]);
+      lengths[i] = 2 * MAX(0, last - first);
+      offsets[i] = blockLength;
+      blockLength += lengths[i];
+      }
+
+    std::vector<vtkIdType> localRows;
+    vtkIdType first = MAX(blockStart, this->KeyOffsets[this->Me]);
+    for(vtkIdType idx=0; idx < lengths[this->Me] / 2; ++idx)
+      {
+      const SortKey& key =
+        this->SortedKeys[first - this->KeyOffsets[this->Me] + idx];
+      localRows.push_back(key.ProcessId);
+      localRows.push_back(key.OriginalIndex);
+      }
+    std::vector<vtkIdType> blockRows(blockLength);
+    this->MPI->AllGatherV(localRows.empty() ? NULL : &localRows[0],
+                          blockRows.empty() ? NULL : &blockRows[0],
+                          lengths[this->Me], &lengths[0], &offsets[0]);
 
     // ------------------------------------------------------------------------
-    // Add local meta-data in case of merge process
+    // Build local subset table with the rows of this process in the block
+    // order. The process that holds most of them merges all the subsets.
     // ------------------------------------------------------------------------
-    if(this->NumProcs > 1 && this->Me == mergePid)
+    std::vector<vtkIdType> rowsPerProcess(this->NumProcs, 0);
+    localRows.clear();
+    for(vtkIdType idx=0; idx < blockLength; idx += 2)
       {
-      vtkSmartPointer<vtkIdTypeArray> processIdArray = vtkSmartPointer<vtkIdTypeArray>::New();
-      processIdArray->SetName("vtkOriginalProcessIds");
-      processIdArray->SetNumberOfComponents(1);
-      processIdArray->Allocate( (blockSize<localSize) ? localSize : blockSize);
-      for(vtkIdType idx=0; idx < localSubset->GetNumberOfRows(); idx++)
+      rowsPerProcess[blockRows[idx]]++;
+      if(blockRows[idx] == this->Me)
         {
-        processIdArray->InsertNextTuple1(mergePid);
+        localRows.push_back(blockRows[idx + 1]);
         }
-      localSubset->GetRowData()->AddArray(processIdArray);
       }
+    int mergePid = static_cast<int>(
+      std::max_element(rowsPerProcess.begin(), rowsPerProcess.end()) -
+      rowsPerProcess.begin());
+
+    vtkSmartPointer<vtkTable> localSubset;
+    localSubset.TakeReference(this->NewRowsTable(input, localRows));
 
     // ------------------------------------------------------------------------
     // Send local subset array to process mergePid
@@ -973,142 +1119,100 @@ public:
     if( this->Me != mergePid )
       {
       this->MPI->Send(localSubset.GetPointer(), mergePid, VTK_TABLE_EXCHANGE_TAG);
+
+      // Ask other processes to provide metadata for table decoration
+      this->DecorateTable(input, NULL, mergePid);
+      return 1;
       }
 
     // ------------------------------------------------------------------------
-    // Merging procedure only on process mergePid
+    // Merging procedure only on process mergePid: interleave the rows of the
+    // subsets in the block order
     // ------------------------------------------------------------------------
-    if( this->Me == mergePid)
+    std::vector<vtkSmartPointer<vtkTable> > subsets(this->NumProcs);
+    for(int i=0; i < this->NumProcs; i++)
       {
-      vtkSmartPointer<vtkTable> tmp = vtkSmartPointer<vtkTable>::New();
-      for(int i=0; i < this->NumProcs; i++)
+      if(i == mergePid)
         {
-        if(i == mergePid)
-          continue;
-
-        this->MPI->Receive(tmp.GetPointer(), i, VTK_TABLE_EXCHANGE_TAG);
-        this->MergeTable(i,tmp.GetPointer(),localSubset.GetPointer(),blockSize);
+        subsets[i] = localSubset;
+        continue;
         }
+      subsets[i] = vtkSmartPointer<vtkTable>::New();
+      this->MPI->Receive(subsets[i].GetPointer(), i, VTK_TABLE_EXCHANGE_TAG);
+      }
 
-      // Sort new table/array
-      if(!this->DataToSort)
+    vtkSmartPointer<vtkTable> result;
+    result.TakeReference(this->NewSubsetTable(localSubset.GetPointer(), NULL,
+                                              0, 0));
+    vtkIdType numColumns = result->GetNumberOfColumns();
+    vtkSmartPointer<vtkIdTypeArray> processIdArray;
+    if(this->NumProcs > 1)
+      {
+      processIdArray = vtkSmartPointer<vtkIdTypeArray>::New();
+      processIdArray->SetName("vtkOriginalProcessIds");
+      processIdArray->SetNumberOfComponents(1);
+      processIdArray->Allocate(blockLength / 2);
+      result->GetRowData()->AddArray(processIdArray);
+      }
+    std::vector<vtkIdType> nextRow(this->NumProcs, 0);
+    for(vtkIdType idx=0; idx < blockLength; idx += 2)
+      {
+      vtkIdType pid = blockRows[idx];
+      vtkTable* subset = subsets[pid].GetPointer();
+      for(vtkIdType colIdx=0; colIdx < numColumns; ++colIdx)
         {
-        // This mean that no output can be provided
-        // cout << "ERROR the merge process have no DataArray." << endl;
-        return 1;
+        vtkAbstractArray* dstArray = result->GetColumn(colIdx);
+        vtkAbstractArray* srcArray =
+          subset->GetColumnByName(dstArray->GetName());
+        if( !srcArray ||
+            dstArray->InsertNextTuple(nextRow[pid], srcArray) == -1 )
+          {
+          cout << "ERROR Compute::InsertNextTuple is not working." << endl;
+          }
         }
-      vtkDataArray* subsetArray = vtkDataArray::SafeDownCast(
-          localSubset->GetColumnByName(this->DataToSort->GetName()));
-
-      if(!subsetArray)
+      nextRow[pid]++;
+      if(processIdArray)
         {
-        vtkSortedTableStreamer::PrintInfo(localSubset.GetPointer());
+        processIdArray->InsertNextTuple1(pid);
         }
-
-      ArraySorter sorter;
-      sorter.Update(static_cast<T*>(subsetArray->GetVoidPointer(0)),
-                    subsetArray->GetNumberOfTuples(),
-                    subsetArray->GetNumberOfComponents(),
-                    this->SelectedComponent,
-                    HISTOGRAM_SIZE,
-                    this->CommonRange,
-                    revertOrder);
-
-      // trim it (remove head and tail that don't belong to the result)
-      localSubset.TakeReference(
-          this->NewSubsetTable(localSubset.GetPointer(),
-                               &sorter,
-                               nbElementsToRemoveFromHead,
-                               blockSize));
-
-      // Add extra information such as structured indices, block number...
-      this->DecorateTable(input, localSubset.GetPointer(), mergePid);
-
-      // ShallowCopy it to the output
-      output->ShallowCopy(localSubset.GetPointer());
-      }
-    else
-      {
-      // Ask other processes to provide metadata for table decoration
-      this->DecorateTable(input, NULL, mergePid);
       }
 
+    // Add extra information such as structured indices, block number...
+    this->DecorateTable(input, result.GetPointer(), mergePid);
+
+    // ShallowCopy it to the output
+    output->ShallowCopy(result.GetPointer());
     return 1;
     }
 
   // --------------------------------------------------------------------------
-  // nbGlobalToSkip is the number of elements that should be skiped at the end
-  // if you exactly want to reach the searchedGlobalIndex.
-  // localOffset is the corresponding local index in the sorted table to the
-  // global index of (searchedGlobalIndex - nbGlobalToSkip)
-  // nbInLocalBar is the local number of elements that are available
-  // in the hitogram bar where the searchedGlobalIndex has been found.
-  // nbInLocalBar is used when you want to get an upper bound that
-  // will include the searchedGlobalIndex.
-  void SearchGlobalIndexLocation(vtkIdType searchedGlobalIndex,
-                                 Histogram* localHistogram,
-                                 Histogram* globalHistogram,
-                                 vtkIdType& nbGlobalToSkip,
-                                 vtkIdType& localOffset,
-                                 vtkIdType& nbInLocalBar)
+  // Return a new table with the given rows of srcTable, in that order.
+  static vtkTable* NewRowsTable(vtkTable* srcTable,
+                                const std::vector<vtkIdType>& rows)
     {
-    // Communication buffer
-    vtkIdType* bufferHistogramValues = new vtkIdType[this->NumProcs *  HISTOGRAM_SIZE];
-
-    // Local internal working var
-    vtkIdType histogramBarIdx = -1;
-    double currentRange[2];
-    vtkIdType idx, idxEnd;
-
-    // Setup inital hitogram range and values
-    Histogram _globalHistogram;
-    Histogram _localHistogram;
-    localHistogram->CopyTo(_localHistogram);
-    globalHistogram->CopyTo(_globalHistogram);
-
-    // Reset local offsets
-    localOffset = 0;
-    nbGlobalToSkip = searchedGlobalIndex;
+    vtkTable* subTable = vtkTable::New();
 
-    do
+    // Loop on all column of the table
+    for(vtkIdType colIdx=0; colIdx < srcTable->GetNumberOfColumns(); ++colIdx)
       {
-      nbGlobalToSkip -= _globalHistogram.GetNewRange(nbGlobalToSkip,
-                                                     histogramBarIdx,
-                                                     currentRange);
-
-      localOffset += _localHistogram.GetNumberOfElements(0, histogramBarIdx);
-      nbInLocalBar = _localHistogram.GetNumberOfElements(histogramBarIdx,
-                                                         histogramBarIdx+1);
-
-      // Based on a narrowed range, build local histogram to get closer to the
-      // real index of the object
-      _localHistogram.SetScalarRange(currentRange);
-      _localHistogram.ClearHistogramValues();
-
-      idxEnd = localOffset + nbInLocalBar;
-      for(idx = localOffset; idx < idxEnd; ++idx)
-        {
-        _localHistogram.AddValue(this->LocalSorter->Array[idx].Value);
-        }
-
-      // Exchange local histo with everyone
-      this->MPI->AllGather( _localHistogram.Values,
-                            bufferHistogramValues, HISTOGRAM_SIZE);
-
-      // Build global histogram
-      _globalHistogram.SetScalarRange(currentRange);
-      _globalHistogram.ClearHistogramValues();
-
-      idxEnd = this->NumProcs * HISTOGRAM_SIZE;
-      for(idx = 0; idx < idxEnd; ++idx)
+      vtkAbstractArray* srcArray = srcTable->GetColumn(colIdx);
+      vtkAbstractArray* subArray = srcArray->NewInstance();
+      subArray->SetNumberOfComponents(srcArray->GetNumberOfComponents());
+      subArray->SetName(srcArray->GetName());
+      subArray->Allocate(
+        static_cast<vtkIdType>(rows.size()) * srcArray->GetNumberOfComponents());
+      for(size_t idx=0; idx < rows.size(); ++idx)
         {
-        _globalHistogram.TotalValues += bufferHistogramValues[idx];
-        _globalHistogram.Values[idx % HISTOGRAM_SIZE] += bufferHistogramValues[idx];
+        if( subArray->InsertNextTuple(rows[idx], srcArray) == -1)
+          {
+          cout << "ERROR NewRowsTable::InsertNextTuple is not working." << endl;
+          }
         }
+      subTable->GetRowData()->AddArray(subArray);
+      subArray->FastDelete();
       }
-    while(nbGlobalToSkip > 0 && _globalHistogram.CanBeReduced());
 
-    delete[] bufferHistogramValues;
+    return subTable;
     }
 
   // --------------------------------------------------------------------------
@@ -1171,6 +1275,13 @@ public:
       }
     }
 
+  // --------------------------------------------------------------------------
+  void SetMaxBytesPerRound(vtkIdType maxBytes)
+    {
+    // Only the number of rounds depends on it, not the index.
+    this->MaxBytesPerRound = maxBytes;
+    }
+
   // --------------------------------------------------------------------------
   void InvalidateCache()
     {
@@ -1397,12 +1508,15 @@ private:
   unsigned long int DataMTime;  // Keep the original data MTime
   vtkDataArray* DataToSort;   // DataArray to sort
   ArraySorter* LocalSorter;   // Local ArraySorter based on global range
-  Histogram* GlobalHistogram; // Globaly merged Histogram based on global range
+  std::vector<SortKey> SortedKeys; // Rows held by this process, sorted
+  std::vector<vtkIdType> KeyOffsets; // Global index of the first row held
+                                     // by each process, then the total
   double CommonRange[2];      // Scalar range used across processes
   int Me;                     // Current process ID
   int NumProcs;               // Number of processes involved
   vtkCommunicator* MPI;       // MPI communicator to send/receive/gather
   int SelectedComponent;      // Component used to sort array
+  vtkIdType MaxBytesPerRound; // Bytes received per round of GatherKeys()
   bool NeedToBuildCache;
   bool Debug;
 
@@ -1430,6 +1544,7 @@ vtkSortedTableStreamer::vtkSortedTableStreamer()
   this->BlockSize = 1024;
   this->Internal = 0;
   this->SelectedComponent = 0;
+  this->MaxBytesPerRound = VTK_INT_MAX;
   this->SetController(vtkMultiProcessController::GetGlobalController());
 }
 
@@ -1582,6 +1697,7 @@ int vtkSortedTableStreamer::RequestData( vtkInformation* vtkNotUsed(request),
   int realComponent = (!arrayToProcess) ?  0 :
                       this->GetSelectedComponent() % arrayToProcess->GetNumberOfComponents();
   this->Internal->SetSelectedComponent(realComponent);
+  this->Internal->SetMaxBytesPerRound(this->MaxBytesPerRound);
 
 
   // Manage custom case where sorting occur on a virtual array (process id)
@@ -1606,6 +1722,7 @@ void vtkSortedTableStreamer::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
   os << indent << "Sorting column: "
      << (this->ColumnToSort?this->ColumnToSort:"(none)") << endl;
+  os << indent << "MaxBytesPerRound: " << this->MaxBytesPerRound << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -18,6 +18,10 @@
 // This filter is used quickly get a sorted subset of a given vtkTable.
 // By sorted we mean a subset build from a global sort even if some optimisation
 // allow us to skip a global table sorting.
+// The first request builds a distributed index of the rows, with a sample sort
+// across the processes, which is kept until the input, the column to sort, the
+// selected component or the order change. The following requests only gather
+// the rows of the requested block.
 
 #ifndef vtkSortedTableStreamer_h
 #define vtkSortedTableStreamer_h
@@ -80,6 +84,13 @@ public:
   void SetInvertOrder(int newValue);
   vtkGetMacro(InvertOrder, int);
 
+  // Description:
+  // Maximum number of bytes a process receives per round when the rows are
+  // gathered to build the sorted index. Default is VTK_INT_MAX, the largest
+  // count MPI takes. Smaller values only add rounds, e.g. for testing.
+  vtkSetClampMacro(MaxBytesPerRound, vtkIdType, 1, VTK_INT_MAX);
+  vtkGetMacro(MaxBytesPerRound, vtkIdType);
+
 protected:
   vtkSortedTableStreamer();
   ~vtkSortedTableStreamer();
@@ -104,6 +115,7 @@ protected:
   char* ColumnToSort;
   int SelectedComponent;
   int InvertOrder;
+  vtkIdType MaxBytesPerRound;
 private:
   vtkSortedTableStreamer(const vtkSortedTableStreamer&); // Not implemented
   void operator=(const vtkSortedTableStreamer&);   // Not implemented
@@ -0,0 +1,572 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkTiledImageCompressor.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkTiledImageCompressor.h"
+
+#include "vtkLZ4Compressor.h"
+#include "vtkMultiProcessStream.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkSmartPointer.h"
+#include "vtkSMPTools.h"
+#include "vtkSquirtCompressor.h"
+#include "vtkType.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkZlibImageCompressor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The compressed frame starts with a header of 32 bit integers:
+// [flags, number of pixels, number of tiles, size of tile 0, ...,
+// size of tile n-1] followed by the compressed tiles. A tile of size
+// UNCHANGED_TILE is not sent, the previous frame is used instead.
+namespace
+{
+  const int DELTA_FLAG = 0x1;
+  const vtkTypeInt32 UNCHANGED_TILE = -1;
+  const int HEADER_SIZE = 3;
+
+  inline vtkIdType vtkTileBegin(vtkIdType numPixels, int numTiles, int tile)
+    {
+    return (numPixels * tile) / numTiles;
+    }
+}
+
+class vtkTiledImageCompressor::vtkInternals
+{
+public:
+  // One codec per tile, configured like vtkTiledImageCompressor::Codec.
+  std::vector<vtkSmartPointer<vtkImageCompressor> > Codecs;
+  std::string CodecsConfiguration;
+
+  // Arrays wrapping the tiles of the input/output buffers.
+  std::vector<vtkSmartPointer<vtkUnsignedCharArray> > InputViews;
+  std::vector<vtkSmartPointer<vtkUnsignedCharArray> > OutputViews;
+  std::vector<vtkSmartPointer<vtkUnsignedCharArray> > CompressedTiles;
+  std::vector<int> Status;
+
+  // Last frame compressed, resp. decompressed, in delta mode.
+  vtkNew<vtkUnsignedCharArray> PreviousInput;
+  bool HasPreviousInput;
+  int PreviousLossLessMode;
+  int PreviousNumberOfTiles;
+  vtkNew<vtkUnsignedCharArray> PreviousOutput;
+  bool HasPreviousOutput;
+
+  vtkInternals()
+    : HasPreviousInput(false), PreviousLossLessMode(0),
+    PreviousNumberOfTiles(0), HasPreviousOutput(false)
+    {
+    }
+
+  // Makes sure there are numTiles codecs with the configuration of codec.
+  void UpdateCodecs(vtkImageCompressor* codec, int numTiles)
+    {
+    std::string configuration = codec->SaveConfiguration();
+    if (configuration != this->CodecsConfiguration ||
+      this->Codecs.size() == 0 || !this->Codecs[0]->IsA(codec->GetClassName()))
+      {
+      this->Codecs.clear();
+      this->CodecsConfiguration = configuration;
+      }
+    size_t count = static_cast<size_t>(numTiles);
+    while (this->Codecs.size() < count)
+      {
+      vtkSmartPointer<vtkImageCompressor> copy;
+      copy.TakeReference(codec->NewInstance());
+      copy->RestoreConfiguration(configuration.c_str());
+      this->Codecs.push_back(copy);
+      }
+    while (this->InputViews.size() < count)
+      {
+      this->InputViews.push_back(vtkSmartPointer<vtkUnsignedCharArray>::New());
+      this->OutputViews.push_back(vtkSmartPointer<vtkUnsignedCharArray>::New());
+      this->CompressedTiles.push_back(
+        vtkSmartPointer<vtkUnsignedCharArray>::New());
+      }
+    this->Status.resize(count);
+    }
+
+  // Compresses the tiles that changed since the previous frame, if any, and
+  // stores them in the previous frame.
+  class CompressTiles
+    {
+  public:
+    vtkInternals* Internals;
+    unsigned char* Input;
+    unsigned char* Previous;
+    bool ComparePrevious;
+    int NumberOfComponents;
+    vtkIdType NumberOfPixels;
+    int NumberOfTiles;
+    int LossLessMode;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType tile = begin; tile < end; ++tile)
+        {
+        int cc = static_cast<int>(tile);
+        vtkIdType first = vtkTileBegin(this->NumberOfPixels, this->NumberOfTiles, cc);
+        vtkIdType last = vtkTileBegin(this->NumberOfPixels, this->NumberOfTiles, cc + 1);
+        vtkIdType offset = first * this->NumberOfComponents;
+        vtkIdType length = (last - first) * this->NumberOfComponents;
+        if (this->ComparePrevious &&
+          memcmp(this->Input + offset, this->Previous + offset, length) == 0)
+          {
+          this->Internals->Status[cc] = UNCHANGED_TILE;
+          continue;
+          }
+
+        vtkUnsignedCharArray* view = this->Internals->InputViews[cc];
+        view->SetNumberOfComponents(this->NumberOfComponents);
+        view->SetArray(this->Input + offset, length, 1);
+
+        vtkImageCompressor* codec = this->Internals->Codecs[cc];
+        codec->SetLossLessMode(this->LossLessMode);
+        codec->SetInput(view);
+        codec->SetOutput(this->Internals->CompressedTiles[cc]);
+        this->Internals->Status[cc] = codec->Compress();
+        if (this->Previous)
+          {
+          memcpy(this->Previous + offset, this->Input + offset, length);
+          }
+        }
+      }
+    };
+
+  // Decompresses the tiles sent and copies the other ones from the previous
+  // frame.
+  class DecompressTiles
+    {
+  public:
+    vtkInternals* Internals;
+    const unsigned char* Input;
+    const vtkTypeInt32* Sizes;
+    std::vector<vtkIdType> Offsets;
+    unsigned char* Output;
+    unsigned char* Previous;
+    int NumberOfComponents;
+    vtkIdType NumberOfPixels;
+    int NumberOfTiles;
+    int LossLessMode;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType tile = begin; tile < end; ++tile)
+        {
+        int cc = static_cast<int>(tile);
+        vtkIdType first = vtkTileBegin(this->NumberOfPixels, this->NumberOfTiles, cc);
+        vtkIdType last = vtkTileBegin(this->NumberOfPixels, this->NumberOfTiles, cc + 1);
+        vtkIdType offset = first * this->NumberOfComponents;
+        vtkIdType length = (last - first) * this->NumberOfComponents;
+        if (this->Sizes[cc] == UNCHANGED_TILE)
+          {
+          memcpy(this->Output + offset, this->Previous + offset, length);
+          this->Internals->Status[cc] = VTK_OK;
+          continue;
+          }
+
+        vtkUnsignedCharArray* input = this->Internals->InputViews[cc];
+        input->SetNumberOfComponents(1);
+        input->SetArray(
+          const_cast<unsigned char*>(this->Input + this->Offsets[cc]),
+          this->Sizes[cc], 1);
+        vtkUnsignedCharArray* output = this->Internals->OutputViews[cc];
+        output->SetNumberOfComponents(this->NumberOfComponents);
+        output->SetArray(this->Output + offset, length, 1);
+
+        vtkImageCompressor* codec = this->Internals->Codecs[cc];
+        codec->SetLossLessMode(this->LossLessMode);
+        codec->SetInput(input);
+        codec->SetOutput(output);
+        this->Internals->Status[cc] = codec->Decompress();
+        if (this->Previous)
+          {
+          memcpy(this->Previous + offset, this->Output + offset, length);
+          }
+        }
+      }
+    };
+};
+
+vtkStandardNewMacro(vtkTiledImageCompressor);
+vtkCxxSetObjectMacro(vtkTiledImageCompressor, Codec, vtkImageCompressor);
+
+//----------------------------------------------------------------------------
+vtkTiledImageCompressor::vtkTiledImageCompressor()
+{
+  this->Codec = NULL;
+  this->NumberOfTiles = 8;
+  this->DeltaMode = 0;
+  this->NumberOfUnchangedTiles = 0;
+  this->Internals = new vtkInternals();
+
+  vtkLZ4Compressor* codec = vtkLZ4Compressor::New();
+  this->SetCodec(codec);
+  codec->Delete();
+}
+
+//----------------------------------------------------------------------------
+vtkTiledImageCompressor::~vtkTiledImageCompressor()
+{
+  this->SetCodec(NULL);
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+vtkImageCompressor* vtkTiledImageCompressor::NewCodec(const char* classname)
+{
+  std::string name = classname? classname : "";
+  if (name == "vtkLZ4Compressor")
+    {
+    return vtkLZ4Compressor::New();
+    }
+  if (name == "vtkSquirtCompressor")
+    {
+    return vtkSquirtCompressor::New();
+    }
+  if (name == "vtkZlibImageCompressor")
+    {
+    return vtkZlibImageCompressor::New();
+    }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkTiledImageCompressor::ResetDelta()
+{
+  this->Internals->HasPreviousInput = false;
+  this->Internals->PreviousInput->Initialize();
+  this->Internals->HasPreviousOutput = false;
+  this->Internals->PreviousOutput->Initialize();
+}
+
+//----------------------------------------------------------------------------
+int vtkTiledImageCompressor::Compress()
+{
+  if (!(this->Input && this->Output && this->Codec))
+    {
+    vtkWarningMacro("Cannot compress, empty input, output or codec detected.");
+    return VTK_ERROR;
+    }
+
+  vtkInternals* internals = this->Internals;
+  int numComps = this->Input->GetNumberOfComponents();
+  vtkIdType numPixels = this->Input->GetNumberOfTuples();
+  int numTiles = static_cast<int>(
+    std::min(static_cast<vtkIdType>(this->NumberOfTiles), numPixels));
+  internals->UpdateCodecs(this->Codec, numTiles);
+
+  bool keyFrame = !this->DeltaMode || !internals->HasPreviousInput ||
+    internals->PreviousInput->GetNumberOfComponents() != numComps ||
+    internals->PreviousInput->GetNumberOfTuples() != numPixels ||
+    internals->PreviousLossLessMode != this->LossLessMode ||
+    internals->PreviousNumberOfTiles != numTiles;
+  if (this->DeltaMode && keyFrame)
+    {
+    internals->PreviousInput->SetNumberOfComponents(numComps);
+    internals->PreviousInput->SetNumberOfTuples(numPixels);
+    }
+
+  vtkInternals::CompressTiles functor;
+  functor.Internals = internals;
+  functor.Input = this->Input->GetPointer(0);
+  functor.Previous = this->DeltaMode?
+    internals->PreviousInput->GetPointer(0) : NULL;
+  functor.ComparePrevious = !keyFrame;
+  functor.NumberOfComponents = numComps;
+  functor.NumberOfPixels = numPixels;
+  functor.NumberOfTiles = numTiles;
+  functor.LossLessMode = this->LossLessMode;
+  vtkSMPTools::For(0, numTiles, 1, functor);
+
+  // Assemble the frame.
+  std::vector<vtkTypeInt32> header(HEADER_SIZE + numTiles);
+  header[0] = this->DeltaMode? DELTA_FLAG : 0;
+  header[1] = static_cast<vtkTypeInt32>(numPixels);
+  header[2] = numTiles;
+  vtkIdType total = static_cast<vtkIdType>(header.size() * sizeof(vtkTypeInt32));
+  this->NumberOfUnchangedTiles = 0;
+  for (int cc = 0; cc < numTiles; ++cc)
+    {
+    // don't keep references to the caller's buffer.
+    internals->InputViews[cc]->Initialize();
+    if (internals->Status[cc] == UNCHANGED_TILE)
+      {
+      header[HEADER_SIZE + cc] = UNCHANGED_TILE;
+      this->NumberOfUnchangedTiles++;
+      continue;
+      }
+    if (internals->Status[cc] != VTK_OK)
+      {
+      vtkErrorMacro("Failed to compress tile " << cc << ".");
+      this->ResetDelta();
+      return VTK_ERROR;
+      }
+    vtkUnsignedCharArray* tile = internals->CompressedTiles[cc];
+    vtkIdType size = tile->GetNumberOfTuples() * tile->GetNumberOfComponents();
+    header[HEADER_SIZE + cc] = static_cast<vtkTypeInt32>(size);
+    total += size;
+    }
+
+  this->Output->SetNumberOfComponents(1);
+  this->Output->SetNumberOfTuples(total);
+  unsigned char* ptr = this->Output->GetPointer(0);
+  memcpy(ptr, &header[0], header.size() * sizeof(vtkTypeInt32));
+  ptr += header.size() * sizeof(vtkTypeInt32);
+  for (int cc = 0; cc < numTiles; ++cc)
+    {
+    if (header[HEADER_SIZE + cc] != UNCHANGED_TILE)
+      {
+      memcpy(ptr, internals->CompressedTiles[cc]->GetPointer(0),
+        header[HEADER_SIZE + cc]);
+      ptr += header[HEADER_SIZE + cc];
+      }
+    }
+
+  internals->HasPreviousInput = (this->DeltaMode != 0);
+  internals->PreviousLossLessMode = this->LossLessMode;
+  internals->PreviousNumberOfTiles = numTiles;
+  if (!this->DeltaMode)
+    {
+    internals->PreviousInput->Initialize();
+    }
+  return VTK_OK;
+}
+
+//----------------------------------------------------------------------------
+int vtkTiledImageCompressor::Decompress()
+{
+  if (!(this->Input && this->Output && this->Codec))
+    {
+    vtkWarningMacro("Cannot decompress, empty input, output or codec detected.");
+    return VTK_ERROR;
+    }
+
+  vtkInternals* internals = this->Internals;
+  const unsigned char* data = this->Input->GetPointer(0);
+  vtkIdType dataSize =
+    this->Input->GetNumberOfTuples() * this->Input->GetNumberOfComponents();
+  if (dataSize < static_cast<vtkIdType>(HEADER_SIZE * sizeof(vtkTypeInt32)))
+    {
+    vtkErrorMacro("Compressed frame is too small.");
+    return VTK_ERROR;
+    }
+
+  vtkTypeInt32 info[HEADER_SIZE];
+  memcpy(info, data, sizeof(info));
+  int flags = info[0];
+  vtkIdType numPixels = info[1];
+  int numTiles = info[2];
+  if (numTiles < 0 ||
+    numTiles > dataSize / static_cast<vtkIdType>(sizeof(vtkTypeInt32)) -
+      HEADER_SIZE ||
+    this->Output->GetNumberOfTuples() != numPixels)
+    {
+    vtkErrorMacro("Compressed frame does not match the output.");
+    return VTK_ERROR;
+    }
+  vtkIdType headerSize =
+    (HEADER_SIZE + static_cast<vtkIdType>(numTiles)) *
+    static_cast<vtkIdType>(sizeof(vtkTypeInt32));
+  std::vector<vtkTypeInt32> sizes(numTiles + 1);
+  memcpy(&sizes[0], data + HEADER_SIZE * sizeof(vtkTypeInt32),
+    numTiles * sizeof(vtkTypeInt32));
+
+  int numComps = this->Output->GetNumberOfComponents();
+  vtkInternals::DecompressTiles functor;
+  functor.Offsets.resize(numTiles);
+  vtkIdType offset = headerSize;
+  bool needPrevious = false;
+  for (int cc = 0; cc < numTiles; ++cc)
+    {
+    functor.Offsets[cc] = offset;
+    if (sizes[cc] == UNCHANGED_TILE)
+      {
+      needPrevious = true;
+      }
+    else if (sizes[cc] < 0)
+      {
+      vtkErrorMacro("Compressed frame has an invalid size for tile " << cc
+        << ".");
+      return VTK_ERROR;
+      }
+    else if (sizes[cc] > dataSize - offset)
+      {
+      vtkErrorMacro("Compressed frame is truncated.");
+      return VTK_ERROR;
+      }
+    else
+      {
+      offset += sizes[cc];
+      }
+    }
+
+  bool hasPrevious = internals->HasPreviousOutput &&
+    internals->PreviousOutput->GetNumberOfComponents() == numComps &&
+    internals->PreviousOutput->GetNumberOfTuples() == numPixels;
+  if (needPrevious && !hasPrevious)
+    {
+    vtkErrorMacro("Compressed frame refers to a missing previous frame.");
+    return VTK_ERROR;
+    }
+  if ((flags & DELTA_FLAG) && !hasPrevious)
+    {
+    internals->PreviousOutput->SetNumberOfComponents(numComps);
+    internals->PreviousOutput->SetNumberOfTuples(numPixels);
+    }
+
+  internals->UpdateCodecs(this->Codec, numTiles);
+  functor.Internals = internals;
+  functor.Input = data;
+  functor.Sizes = &sizes[0];
+  functor.Output = this->Output->GetPointer(0);
+  functor.Previous = (needPrevious || (flags & DELTA_FLAG))?
+    internals->PreviousOutput->GetPointer(0) : NULL;
+  functor.NumberOfComponents = numComps;
+  functor.NumberOfPixels = numPixels;
+  functor.NumberOfTiles = numTiles;
+  functor.LossLessMode = this->LossLessMode;
+  vtkSMPTools::For(0, numTiles, 1, functor);
+
+  this->NumberOfUnchangedTiles = 0;
+  int status = VTK_OK;
+  for (int cc = 0; cc < numTiles; ++cc)
+    {
+    if (sizes[cc] == UNCHANGED_TILE)
+      {
+      this->NumberOfUnchangedTiles++;
+      }
+    if (internals->Status[cc] != VTK_OK)
+      {
+      vtkErrorMacro("Failed to decompress tile " << cc << ".");
+      status = VTK_ERROR;
+      }
+    // don't keep references to the caller's buffers.
+    internals->OutputViews[cc]->Initialize();
+    internals->InputViews[cc]->Initialize();
+    }
+
+  internals->HasPreviousOutput = ((flags & DELTA_FLAG) != 0) && status == VTK_OK;
+  if (!internals->HasPreviousOutput)
+    {
+    internals->PreviousOutput->Initialize();
+    }
+  return status;
+}
+
+//-----------------------------------------------------------------------------
+void vtkTiledImageCompressor::SaveConfiguration(vtkMultiProcessStream *stream)
+{
+  this->Superclass::SaveConfiguration(stream);
+  *stream << this->NumberOfTiles << this->DeltaMode;
+  if (this->Codec)
+    {
+    *stream << std::string(this->Codec->GetClassName());
+    this->Codec->SaveConfiguration(stream);
+    }
+  else
+    {
+    *stream << std::string("NULL");
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkTiledImageCompressor::RestoreConfiguration(vtkMultiProcessStream *stream)
+{
+  if (this->Superclass::RestoreConfiguration(stream))
+    {
+    int numTiles, deltaMode;
+    std::string codecName;
+    *stream >> numTiles >> deltaMode >> codecName;
+    this->SetNumberOfTiles(numTiles);
+    this->SetDeltaMode(deltaMode);
+    if (!(this->Codec && this->Codec->IsA(codecName.c_str())))
+      {
+      vtkImageCompressor* codec =
+        vtkTiledImageCompressor::NewCodec(codecName.c_str());
+      this->SetCodec(codec);
+      if (!codec)
+        {
+        return codecName == "NULL";
+        }
+      codec->Delete();
+      }
+    return this->Codec->RestoreConfiguration(stream);
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+const char *vtkTiledImageCompressor::SaveConfiguration()
+{
+  std::ostringstream oss;
+  oss
+    << this->Superclass::SaveConfiguration()
+    << " "
+    << this->NumberOfTiles
+    << " "
+    << this->DeltaMode
+    << " "
+    << (this->Codec? this->Codec->SaveConfiguration() : "NULL");
+  this->SetConfiguration(oss.str().c_str());
+  return this->Configuration;
+}
+
+//-----------------------------------------------------------------------------
+const char *vtkTiledImageCompressor::RestoreConfiguration(const char *stream)
+{
+  stream = this->Superclass::RestoreConfiguration(stream);
+  if (stream)
+    {
+    std::istringstream iss(stream);
+    int numTiles, deltaMode;
+    iss >> numTiles >> deltaMode;
+    this->SetNumberOfTiles(numTiles);
+    this->SetDeltaMode(deltaMode);
+    // the codec configuration starts with its class name.
+    stream += iss.tellg();
+    std::istringstream codecIss(stream);
+    std::string codecName;
+    codecIss >> codecName;
+    if (!(this->Codec && this->Codec->IsA(codecName.c_str())))
+      {
+      vtkImageCompressor* codec =
+        vtkTiledImageCompressor::NewCodec(codecName.c_str());
+      this->SetCodec(codec);
+      if (!codec)
+        {
+        return codecName == "NULL"? stream + codecIss.tellg() : 0;
+        }
+      codec->Delete();
+      }
+    return this->Codec->RestoreConfiguration(stream);
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkTiledImageCompressor::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Codec: " << this->Codec << endl
+     << indent << "NumberOfTiles: " << this->NumberOfTiles << endl
+     << indent << "DeltaMode: " << this->DeltaMode << endl
+     << indent << "NumberOfUnchangedTiles: "
+     << this->NumberOfUnchangedTiles << endl;
+}
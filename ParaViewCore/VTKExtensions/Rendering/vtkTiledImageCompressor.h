@@ -0,0 +1,111 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkTiledImageCompressor.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkTiledImageCompressor - compresses an image as independent tiles.
+//
+// .SECTION Description
+// vtkTiledImageCompressor splits the image into NumberOfTiles bands of
+// consecutive pixels that are compressed, and decompressed, concurrently
+// using vtkSMPTools. Each tile is handled by its own copy of the codec, any
+// other vtkImageCompressor e.g. vtkLZ4Compressor, which keeps the codec
+// settings.
+//
+// When DeltaMode is on, tiles whose pixels did not change since the previous
+// frame are not sent at all and the decompressor reuses the pixels it decoded
+// for that tile in the previous frame. This requires that every compressed
+// frame is decompressed, in order, by the same decompressing instance, as is
+// the case for the image delivery done by
+// vtkPVClientServerSynchronizedRenderers. A complete frame is sent whenever
+// the image size, the number of tiles or the LossLessMode change.
+//
+// The configuration stream is: [vtkTiledImageCompressor, LossLessMode,
+// NumberOfTiles, DeltaMode, [Codec Configuration]].
+
+#ifndef vtkTiledImageCompressor_h
+#define vtkTiledImageCompressor_h
+
+#include "vtkImageCompressor.h"
+
+class VTKPVVTKEXTENSIONSRENDERING_EXPORT vtkTiledImageCompressor : public vtkImageCompressor
+{
+public:
+  static vtkTiledImageCompressor* New();
+  vtkTypeMacro(vtkTiledImageCompressor, vtkImageCompressor);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Get/Set the compressor used for every tile. Its settings can be changed
+  // directly, they are picked up on the next call to Compress/Decompress.
+  void SetCodec(vtkImageCompressor*);
+  vtkGetObjectMacro(Codec, vtkImageCompressor);
+
+  // Description:
+  // Get/Set the number of tiles the image is split into. Default is 8.
+  vtkSetClampMacro(NumberOfTiles, int, 1, 256);
+  vtkGetMacro(NumberOfTiles, int);
+
+  // Description:
+  // When set, only the tiles that changed since the previous frame are
+  // compressed and sent. Default is off.
+  vtkSetMacro(DeltaMode, int);
+  vtkGetMacro(DeltaMode, int);
+  vtkBooleanMacro(DeltaMode, int);
+
+  // Description:
+  // Number of tiles that were not sent, resp. not decoded, because they did
+  // not change during the last call to Compress, resp. Decompress.
+  vtkGetMacro(NumberOfUnchangedTiles, int);
+
+  // Description:
+  // Forget the previous frame. The next compressed frame is complete.
+  void ResetDelta();
+
+  // Description:
+  // Compress/Decompress data array on the objects input with results
+  // in the objects output. See also Set/GetInput/Output.
+  virtual int Compress();
+  virtual int Decompress();
+
+  // Description:
+  // Serialize/Restore compressor configuration (but not the data) into the
+  // stream. The codec is created from the class name found in the stream
+  // when needed.
+  virtual void SaveConfiguration(vtkMultiProcessStream *stream);
+  virtual bool RestoreConfiguration(vtkMultiProcessStream *stream);
+  virtual const char *SaveConfiguration();
+  virtual const char *RestoreConfiguration(const char *stream);
+
+  // Description:
+  // Creates one of the image compressors available in ParaView from its
+  // class name. Returns NULL for unknown names.
+  static vtkImageCompressor* NewCodec(const char* classname);
+
+protected:
+  vtkTiledImageCompressor();
+  ~vtkTiledImageCompressor();
+
+  vtkImageCompressor* Codec;
+  int NumberOfTiles;
+  int DeltaMode;
+  int NumberOfUnchangedTiles;
+
+private:
+  vtkTiledImageCompressor(const vtkTiledImageCompressor&); // Not implemented.
+  void operator=(const vtkTiledImageCompressor&); // Not implemented.
+
+  class vtkInternals;
+  vtkInternals* Internals;
+};
+
+#endif
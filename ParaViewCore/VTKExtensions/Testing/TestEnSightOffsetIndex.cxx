@@ -0,0 +1,407 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestEnSightOffsetIndex.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Writes an EnSight Gold binary case with a point variable stored as single
+// file transient data, then reads its last time step with
+// vtkPEnSightGoldBinaryReader and UseOffsetIndexFile on. Checks that:
+// - the offset index file is written next to the case file,
+// - a new reader loads it and seeks with its offsets,
+// - the values read are those read without the index,
+// - the entries of a data file rewritten since are ignored,
+// - in a read-only directory the data is read without the index.
+
+#include "vtkDataArray.h"
+#include "vtkDataSet.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPEnSightGoldBinaryReader.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTesting.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <vtksys/SystemTools.hxx>
+
+#ifndef _WIN32
+# include <sys/stat.h>
+#endif
+
+// Exposes the number of offsets known from the offset index file.
+class vtkIndexedEnSightReader : public vtkPEnSightGoldBinaryReader
+{
+public:
+  static vtkIndexedEnSightReader* New();
+  vtkTypeMacro(vtkIndexedEnSightReader, vtkPEnSightGoldBinaryReader);
+
+  size_t GetNumberOfIndexedOffsets()
+    {
+    return this->NumberOfIndexedOffsets;
+    }
+
+protected:
+  vtkIndexedEnSightReader() {}
+
+private:
+  vtkIndexedEnSightReader(const vtkIndexedEnSightReader&); // Not implemented
+  void operator=(const vtkIndexedEnSightReader&); // Not implemented
+};
+
+vtkStandardNewMacro(vtkIndexedEnSightReader);
+
+namespace
+{
+  const int NumberOfPoints = 100;
+  const int NumberOfTimeSteps = 50;
+  const int LastTimeStep = NumberOfTimeSteps - 1;
+
+  void WriteLine(FILE* file, const char* text)
+    {
+    char line[80];
+    memset(line, 0, sizeof(line));
+    strncpy(line, text, sizeof(line));
+    fwrite(line, 1, sizeof(line), file);
+    }
+
+  void WriteInt(FILE* file, int value)
+    {
+    fwrite(&value, sizeof(value), 1, file);
+    }
+
+  void WriteFloats(FILE* file, float value, bool increasing)
+    {
+    std::vector<float> values(NumberOfPoints);
+    for (int i = 0; i < NumberOfPoints; i++)
+      {
+      values[i] = increasing? value + i : value;
+      }
+    fwrite(&values[0], sizeof(float), NumberOfPoints, file);
+    }
+
+  // Writes the values of the time steps to value.scl, base + the step and
+  // point index for each point. An extra time step, which the case does not
+  // use, changes the size of the file.
+  bool WriteValues(const std::string& directory, float base, bool extraStep)
+    {
+    FILE* scl = fopen((directory + "/value.scl").c_str(), "wb");
+    if (!scl)
+      {
+      return false;
+      }
+    int numSteps = NumberOfTimeSteps + (extraStep? 1 : 0);
+    for (int step = 0; step < numSteps; step++)
+      {
+      WriteLine(scl, "BEGIN TIME STEP");
+      WriteLine(scl, "value");
+      WriteLine(scl, "part");
+      WriteInt(scl, 1);
+      WriteLine(scl, "coordinates");
+      WriteFloats(scl, base + step, true);
+      WriteLine(scl, "END TIME STEP");
+      }
+    fclose(scl);
+    return true;
+    }
+
+  bool WriteCase(const std::string& directory)
+    {
+    FILE* geo = fopen((directory + "/points.geo").c_str(), "wb");
+    if (!geo)
+      {
+      return false;
+      }
+    WriteLine(geo, "C Binary");
+    WriteLine(geo, "BEGIN TIME STEP");
+    WriteLine(geo, "TestEnSightOffsetIndex");
+    WriteLine(geo, "points");
+    WriteLine(geo, "node id off");
+    WriteLine(geo, "element id off");
+    WriteLine(geo, "part");
+    WriteInt(geo, 1);
+    WriteLine(geo, "points");
+    WriteLine(geo, "coordinates");
+    WriteInt(geo, NumberOfPoints);
+    WriteFloats(geo, 0, true);
+    WriteFloats(geo, 0, false);
+    WriteFloats(geo, 0, false);
+    WriteLine(geo, "point");
+    WriteInt(geo, NumberOfPoints);
+    for (int i = 1; i <= NumberOfPoints; i++)
+      {
+      WriteInt(geo, i);
+      }
+    WriteLine(geo, "END TIME STEP");
+    fclose(geo);
+
+    FILE* caseFile = fopen((directory + "/points.case").c_str(), "w");
+    if (!caseFile)
+      {
+      return false;
+      }
+    fprintf(caseFile, "FORMAT\ntype: ensight gold\n\n");
+    fprintf(caseFile, "GEOMETRY\nmodel: points.geo\n\n");
+    fprintf(caseFile, "VARIABLE\nscalar per node: 1 1 value value.scl\n\n");
+    fprintf(caseFile, "TIME\ntime set: 1\nnumber of steps: %d\n",
+      NumberOfTimeSteps);
+    fprintf(caseFile, "time values:\n");
+    for (int step = 0; step < NumberOfTimeSteps; step++)
+      {
+      fprintf(caseFile, "%d\n", step);
+      }
+    fprintf(caseFile, "\nFILE\nfile set: 1\nnumber of steps: %d\n",
+      NumberOfTimeSteps);
+    fclose(caseFile);
+    return WriteValues(directory, 0, false);
+    }
+
+  vtkSmartPointer<vtkIndexedEnSightReader> NewReader(
+    const std::string& directory, bool index)
+    {
+    vtkSmartPointer<vtkIndexedEnSightReader> reader =
+      vtkSmartPointer<vtkIndexedEnSightReader>::New();
+    reader->SetCaseFileName("points.case");
+    reader->SetFilePath(directory.c_str());
+    reader->SetUseOffsetIndexFile(index? 1 : 0);
+    reader->UpdateInformation();
+    return reader;
+    }
+
+  // Reads the last time step, returns the values or NULL on errors.
+  vtkSmartPointer<vtkDataArray> ReadLastStep(vtkIndexedEnSightReader* reader)
+    {
+    reader->SetTimeValue(LastTimeStep);
+    reader->Update();
+    vtkDataSet* points = vtkDataSet::SafeDownCast(
+      reader->GetOutput()->GetBlock(0));
+    vtkDataArray* value = points?
+      points->GetPointData()->GetArray("value") : NULL;
+    if (!value || value->GetNumberOfTuples() != NumberOfPoints)
+      {
+      cerr << "ERROR: cannot read time step " << LastTimeStep << endl;
+      return NULL;
+      }
+    return value;
+    }
+
+  bool SameValues(vtkDataArray* expected, vtkDataArray* value)
+    {
+    for (vtkIdType i = 0; i < NumberOfPoints; i++)
+      {
+      if (expected->GetTuple1(i) != value->GetTuple1(i))
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+
+  // Makes the index give the offset of time step `from` for the last time
+  // step of value.scl, keeping the size and time recorded for the file.
+  bool RedirectLastStep(const std::string& indexName, int from)
+    {
+    std::vector<std::string> lines;
+    std::string line;
+    ifstream input(indexName.c_str());
+    while (std::getline(input, line))
+      {
+      lines.push_back(line);
+      }
+    input.close();
+
+    std::string fromOffset;
+    size_t lastLine = 0;
+    for (size_t cc = 0; cc + 1 < lines.size(); cc++)
+      {
+      if (lines[cc] != "value.scl")
+        {
+        continue;
+        }
+      std::istringstream counts(lines[cc + 1]);
+      unsigned long size;
+      long time;
+      size_t count = 0;
+      counts >> size >> time >> count;
+      size_t end = std::min(cc + 2 + count, lines.size());
+      for (size_t ii = cc + 2; ii < end; ii++)
+        {
+        std::istringstream entry(lines[ii]);
+        int step;
+        std::string offset;
+        entry >> step >> offset;
+        if (step == from)
+          {
+          fromOffset = offset;
+          }
+        else if (step == LastTimeStep)
+          {
+          lastLine = ii;
+          }
+        }
+      }
+    if (fromOffset.empty() || lastLine == 0)
+      {
+      return false;
+      }
+    std::ostringstream redirected;
+    redirected << LastTimeStep << " " << fromOffset;
+    lines[lastLine] = redirected.str();
+
+    ofstream output(indexName.c_str());
+    for (size_t cc = 0; cc < lines.size(); cc++)
+      {
+      output << lines[cc] << "\n";
+      }
+    return !output.fail();
+    }
+}
+
+int TestEnSightOffsetIndex(int argc, char* argv[])
+{
+  vtkNew<vtkTesting> testing;
+  testing->AddArguments(argc, const_cast<const char**>(argv));
+  std::string directory = testing->GetTempDirectory();
+  directory += "/TestEnSightOffsetIndex";
+  vtksys::SystemTools::RemoveADirectory(directory.c_str());
+  if (!vtksys::SystemTools::MakeDirectory(directory.c_str()) ||
+    !WriteCase(directory))
+    {
+    cerr << "Cannot write the case in " << directory << endl;
+    return EXIT_FAILURE;
+    }
+  std::string indexName = directory + "/points.case.offsets";
+  bool status = true;
+
+  // Without the index, the file is scanned and no index is written.
+  vtkSmartPointer<vtkIndexedEnSightReader> reader =
+    NewReader(directory, false);
+  vtkSmartPointer<vtkDataArray> expected = ReadLastStep(reader);
+  if (!expected || expected->GetTuple1(0) != LastTimeStep)
+    {
+    cerr << "ERROR: wrong values without the index" << endl;
+    vtksys::SystemTools::RemoveADirectory(directory.c_str());
+    return EXIT_FAILURE;
+    }
+  if (vtksys::SystemTools::FileExists(indexName.c_str(), true))
+    {
+    cerr << "ERROR: index written while UseOffsetIndexFile is off" << endl;
+    status = false;
+    }
+
+  // The first read with the index writes it.
+  reader = NewReader(directory, true);
+  vtkDataArray* value = ReadLastStep(reader);
+  if (!value || !SameValues(expected, value))
+    {
+    cerr << "ERROR: wrong values while writing the index" << endl;
+    status = false;
+    }
+  if (!vtksys::SystemTools::FileExists(indexName.c_str(), true))
+    {
+    cerr << "ERROR: " << indexName << " not written" << endl;
+    vtksys::SystemTools::RemoveADirectory(directory.c_str());
+    return EXIT_FAILURE;
+    }
+
+  // A new reader loads the index before reading any data.
+  reader = NewReader(directory, true);
+  if (reader->GetNumberOfIndexedOffsets() == 0)
+    {
+    cerr << "ERROR: the index is not loaded on reopen" << endl;
+    status = false;
+    }
+  value = ReadLastStep(reader);
+  if (!value || !SameValues(expected, value))
+    {
+    cerr << "ERROR: wrong values with the index" << endl;
+    status = false;
+    }
+
+  // The offsets of the index are used as they are: pointing the last time
+  // step at time step 10 reads the values of time step 10.
+  if (!RedirectLastStep(indexName, 10))
+    {
+    cerr << "ERROR: no offset of value.scl in " << indexName << endl;
+    status = false;
+    }
+  else
+    {
+    reader = NewReader(directory, true);
+    value = ReadLastStep(reader);
+    if (!value || value->GetTuple1(0) != 10)
+      {
+      cerr << "ERROR: the offset of the index is not used" << endl;
+      status = false;
+      }
+    }
+
+  // Once value.scl is rewritten, its entry is ignored, redirected or not.
+  if (!WriteValues(directory, 1000, true))
+    {
+    cerr << "Cannot rewrite value.scl" << endl;
+    status = false;
+    }
+  else
+    {
+    reader = NewReader(directory, true);
+    value = ReadLastStep(reader);
+    if (!value || value->GetTuple1(0) != 1000 + LastTimeStep)
+      {
+      cerr << "ERROR: the entry of the rewritten value.scl is used" << endl;
+      status = false;
+      }
+    }
+
+  // In a read-only directory, the data is read without writing the index.
+  vtksys::SystemTools::RemoveFile(indexName.c_str());
+#ifndef _WIN32
+  chmod(directory.c_str(), 0555);
+#endif
+  std::string probeName = directory + "/probe";
+  bool readOnly;
+    {
+    ofstream probe(probeName.c_str());
+    readOnly = !probe;
+    }
+  vtksys::SystemTools::RemoveFile(probeName.c_str());
+  reader = NewReader(directory, true);
+  value = ReadLastStep(reader);
+  if (!value || value->GetTuple1(0) != 1000 + LastTimeStep)
+    {
+    cerr << "ERROR: wrong values in a read-only directory" << endl;
+    status = false;
+    }
+  if (!readOnly)
+    {
+    cout << "The directory is still writable, e.g. for root: not checking "
+         << "that the index is skipped." << endl;
+    }
+  else if (vtksys::SystemTools::FileExists(indexName.c_str(), true))
+    {
+    cerr << "ERROR: index written in a read-only directory" << endl;
+    status = false;
+    }
+#ifndef _WIN32
+  chmod(directory.c_str(), 0755);
+#endif
+
+  reader = NULL;
+  vtksys::SystemTools::RemoveADirectory(directory.c_str());
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
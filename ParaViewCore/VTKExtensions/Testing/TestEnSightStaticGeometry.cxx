@@ -0,0 +1,196 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestEnSightStaticGeometry.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Writes an EnSight Gold case with a static hexahedral mesh and a point
+// variable per time step, then reads the time steps with
+// vtkPEnSightGoldReader, with and without CacheGeometry. Checks the values
+// of each time step and that the points and cells of the mesh are reused
+// when the geometry is kept, and reports the seconds needed per time step.
+
+#include "vtkDataArray.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPEnSightGoldReader.h"
+#include "vtkPointData.h"
+#include "vtkTesting.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vtksys/SystemTools.hxx>
+
+namespace
+{
+  const int Dimension = 30; // cells per side
+  const int NumberOfTimeSteps = 10;
+
+  // Index of the point (i, j, k) of the mesh, from 1 as in EnSight.
+  int PointId(int i, int j, int k)
+    {
+    return 1 + i + (Dimension + 1) * (j + (Dimension + 1) * k);
+    }
+
+  bool WriteCase(const std::string& directory)
+    {
+    std::string geoName = directory + "/mesh.geo";
+    FILE* geo = fopen(geoName.c_str(), "w");
+    if (!geo)
+      {
+      return false;
+      }
+    int numPoints = (Dimension + 1) * (Dimension + 1) * (Dimension + 1);
+    fprintf(geo, "TestEnSightStaticGeometry\nstatic mesh\n");
+    fprintf(geo, "node id off\nelement id off\n");
+    fprintf(geo, "part\n%10d\nmesh\ncoordinates\n%10d\n", 1, numPoints);
+    for (int c = 0; c < 3; c++)
+      {
+      for (int k = 0; k <= Dimension; k++)
+        {
+        for (int j = 0; j <= Dimension; j++)
+          {
+          for (int i = 0; i <= Dimension; i++)
+            {
+            int coordinate = c == 0? i : (c == 1? j : k);
+            fprintf(geo, "%12.5e\n", static_cast<double>(coordinate));
+            }
+          }
+        }
+      }
+    fprintf(geo, "hexa8\n%10d\n", Dimension * Dimension * Dimension);
+    for (int k = 0; k < Dimension; k++)
+      {
+      for (int j = 0; j < Dimension; j++)
+        {
+        for (int i = 0; i < Dimension; i++)
+          {
+          fprintf(geo, "%10d%10d%10d%10d%10d%10d%10d%10d\n",
+            PointId(i, j, k), PointId(i + 1, j, k),
+            PointId(i + 1, j + 1, k), PointId(i, j + 1, k),
+            PointId(i, j, k + 1), PointId(i + 1, j, k + 1),
+            PointId(i + 1, j + 1, k + 1), PointId(i, j + 1, k + 1));
+          }
+        }
+      }
+    fclose(geo);
+
+    for (int step = 0; step < NumberOfTimeSteps; step++)
+      {
+      char sclName[32];
+      sprintf(sclName, "/value%02d.scl", step);
+      FILE* scl = fopen((directory + sclName).c_str(), "w");
+      if (!scl)
+        {
+        return false;
+        }
+      fprintf(scl, "value\npart\n%10d\ncoordinates\n", 1);
+      for (int i = 0; i < numPoints; i++)
+        {
+        fprintf(scl, "%12.5e\n", static_cast<double>(step));
+        }
+      fclose(scl);
+      }
+
+    std::string caseName = directory + "/mesh.case";
+    FILE* caseFile = fopen(caseName.c_str(), "w");
+    if (!caseFile)
+      {
+      return false;
+      }
+    fprintf(caseFile, "FORMAT\ntype: ensight gold\n\n");
+    fprintf(caseFile, "GEOMETRY\nmodel: mesh.geo\n\n");
+    fprintf(caseFile, "VARIABLE\nscalar per node: 1 value value**.scl\n\n");
+    fprintf(caseFile, "TIME\ntime set: 1\nnumber of steps: %d\n",
+      NumberOfTimeSteps);
+    fprintf(caseFile, "filename start number: 0\nfilename increment: 1\n");
+    fprintf(caseFile, "time values:\n");
+    for (int step = 0; step < NumberOfTimeSteps; step++)
+      {
+      fprintf(caseFile, "%d\n", step);
+      }
+    fclose(caseFile);
+    return true;
+    }
+
+  // Reads the time steps, returns false on errors.
+  bool Read(const std::string& directory, bool cacheGeometry)
+    {
+    vtkNew<vtkPEnSightGoldReader> reader;
+    reader->SetCaseFileName("mesh.case");
+    reader->SetFilePath(directory.c_str());
+    reader->SetCacheGeometry(cacheGeometry? 1 : 0);
+    reader->UpdateInformation();
+
+    bool status = true;
+    double total = 0;
+    vtkPoints* firstPoints = NULL;
+    for (int step = 0; step < NumberOfTimeSteps; step++)
+      {
+      double start = vtkTimerLog::GetUniversalTime();
+      reader->SetTimeValue(step);
+      reader->Update();
+      double seconds = vtkTimerLog::GetUniversalTime() - start;
+      total += seconds;
+      cout << "CacheGeometry " << (cacheGeometry? "on" : "off")
+           << ", time step " << step << ": " << seconds << " seconds" << endl;
+
+      vtkUnstructuredGrid* mesh = vtkUnstructuredGrid::SafeDownCast(
+        reader->GetOutput()->GetBlock(0));
+      vtkDataArray* value = mesh?
+        mesh->GetPointData()->GetArray("value") : NULL;
+      vtkIdType numPoints = (Dimension + 1) * (Dimension + 1) * (Dimension + 1);
+      if (!value || mesh->GetNumberOfPoints() != numPoints ||
+        mesh->GetNumberOfCells() != Dimension * Dimension * Dimension ||
+        value->GetNumberOfTuples() != numPoints ||
+        value->GetTuple1(0) != step || value->GetTuple1(numPoints - 1) != step)
+        {
+        cerr << "ERROR: wrong output for time step " << step << endl;
+        status = false;
+        continue;
+        }
+      if (step == 0)
+        {
+        firstPoints = mesh->GetPoints();
+        }
+      else if (cacheGeometry && mesh->GetPoints() != firstPoints)
+        {
+        cerr << "ERROR: geometry read again for time step " << step << endl;
+        status = false;
+        }
+      }
+    cout << "CacheGeometry " << (cacheGeometry? "on" : "off") << ": "
+         << total / NumberOfTimeSteps << " seconds per time step" << endl;
+    return status;
+    }
+}
+
+int TestEnSightStaticGeometry(int argc, char* argv[])
+{
+  vtkNew<vtkTesting> testing;
+  testing->AddArguments(argc, const_cast<const char**>(argv));
+  std::string directory = testing->GetTempDirectory();
+  directory += "/TestEnSightStaticGeometry";
+  if (!vtksys::SystemTools::MakeDirectory(directory.c_str()) ||
+    !WriteCase(directory))
+    {
+    cerr << "Cannot write the case in " << directory << endl;
+    return EXIT_FAILURE;
+    }
+
+  bool status = Read(directory, false);
+  status = Read(directory, true) && status;
+  vtksys::SystemTools::RemoveADirectory(directory.c_str());
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -16,10 +16,210 @@
 #include "vtkCellData.h"
 #include "vtkDoubleArray.h"
 #include "vtkExtractHistogram.h"
+#include "vtkFloatArray.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
 #include "vtkTable.h"
 #include "vtkSmartPointer.h"
 #include "vtkSphereSource.h"
 #include "vtkIntArray.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+// Ten points whose "int", "float" and "uchar" arrays have the values 0 to 9,
+// and whose "vec" array has vecComps components, (c + 1) * i for point i.
+vtkSmartPointer<vtkPolyData> MakePoints(int vecComps)
+{
+  const int count = 10;
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkIntArray> ints = vtkSmartPointer<vtkIntArray>::New();
+  ints->SetName("int");
+  vtkSmartPointer<vtkFloatArray> floats = vtkSmartPointer<vtkFloatArray>::New();
+  floats->SetName("float");
+  vtkSmartPointer<vtkUnsignedCharArray> uchars =
+    vtkSmartPointer<vtkUnsignedCharArray>::New();
+  uchars->SetName("uchar");
+  vtkSmartPointer<vtkDoubleArray> vec = vtkSmartPointer<vtkDoubleArray>::New();
+  vec->SetName("vec");
+  vec->SetNumberOfComponents(vecComps);
+  vec->SetNumberOfTuples(count);
+  for (int i = 0; i < count; ++i)
+    {
+    points->InsertNextPoint(i, 0, 0);
+    ints->InsertNextValue(i);
+    floats->InsertNextValue(i);
+    uchars->InsertNextValue(static_cast<unsigned char>(i));
+    for (int c = 0; c < vecComps; ++c)
+      {
+      vec->SetComponent(i, c, (c + 1) * i);
+      }
+    }
+  data->SetPoints(points);
+  data->GetPointData()->AddArray(ints);
+  data->GetPointData()->AddArray(floats);
+  data->GetPointData()->AddArray(uchars);
+  data->GetPointData()->AddArray(vec);
+  return data;
+}
+
+vtkSmartPointer<vtkTable> Histogram(vtkDataObject* input, const char* name,
+  int bin_count, bool averages, const double* range, bool concurrent)
+{
+  vtkSmartPointer<vtkExtractHistogram> extraction =
+    vtkSmartPointer<vtkExtractHistogram>::New();
+  extraction->SetInputData(input);
+  extraction->SetInputArrayToProcess(0, 0, 0,
+    vtkDataObject::FIELD_ASSOCIATION_POINTS, name);
+  extraction->SetComponent(0);
+  extraction->SetBinCount(bin_count);
+  extraction->SetCalculateAverages(averages? 1 : 0);
+  extraction->SetUseConcurrentBinning(concurrent);
+  if (range)
+    {
+    extraction->SetUseCustomBinRanges(true);
+    extraction->SetCustomBinRanges(range[0], range[1]);
+    }
+  extraction->Update();
+  return extraction->GetOutput();
+}
+
+bool CheckCounts(vtkTable* histogram, const int* expected, int bin_count)
+{
+  vtkIntArray* bin_values = vtkIntArray::SafeDownCast(
+    histogram->GetRowData()->GetArray("bin_values"));
+  if (!bin_values || bin_values->GetNumberOfTuples() != bin_count)
+    {
+    vtkGenericWarningMacro("bin_values missing or of the wrong size.");
+    return false;
+    }
+  for (int i = 0; i < bin_count; ++i)
+    {
+    if (bin_values->GetValue(i) != expected[i])
+      {
+      vtkGenericWarningMacro("incorrect bin value " << bin_values->GetValue(i)
+        << " in bin " << i << ", expected " << expected[i] << ".");
+      return false;
+      }
+    }
+  return true;
+}
+
+// Checks an array of per bin values with comps components, expected gives
+// the first component of each bin, the others are multiples of it like the
+// "vec" array.
+bool CheckVec(vtkTable* histogram, const char* name, int comps,
+  const double* expected, int bin_count)
+{
+  vtkDoubleArray* array = vtkDoubleArray::SafeDownCast(
+    histogram->GetRowData()->GetArray(name));
+  if (!array || array->GetNumberOfComponents() != comps ||
+    array->GetNumberOfTuples() != bin_count)
+    {
+    vtkGenericWarningMacro(<< name << " missing or of the wrong size.");
+    return false;
+    }
+  for (int i = 0; i < bin_count; ++i)
+    {
+    for (int c = 0; c < comps; ++c)
+      {
+      if (std::fabs(array->GetComponent(i, c) - (c + 1) * expected[i]) > 1e-9)
+        {
+        vtkGenericWarningMacro("incorrect " << name << " value "
+          << array->GetComponent(i, c) << " in bin " << i << ".");
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+// Bins arrays of several types, with the averages of the other arrays.
+int TestArrayTypes(bool concurrent)
+{
+  vtkSmartPointer<vtkPolyData> data = MakePoints(3);
+  const char* names[] = { "int", "float", "uchar" };
+  // 5 bins over [0, 9]: 2 values per bin, 9 is in the last one.
+  const int counts[] = { 2, 2, 2, 2, 2 };
+  const double totals[] = { 1, 5, 9, 13, 17 };
+  const double averages[] = { 0.5, 2.5, 4.5, 6.5, 8.5 };
+  for (int cc = 0; cc < 3; ++cc)
+    {
+    vtkSmartPointer<vtkTable> histogram =
+      Histogram(data, names[cc], 5, true, NULL, concurrent);
+    if (!CheckCounts(histogram, counts, 5) ||
+      !CheckVec(histogram, "vec_total", 3, totals, 5) ||
+      !CheckVec(histogram, "vec_average", 3, averages, 5))
+      {
+      vtkGenericWarningMacro("failed to bin the " << names[cc] << " array.");
+      return 1;
+      }
+    for (int other = 0; other < 3; ++other)
+      {
+      std::string name = std::string(names[other]) + "_average";
+      if ((histogram->GetRowData()->GetArray(name.c_str()) != NULL) !=
+        (other != cc))
+        {
+        vtkGenericWarningMacro("only the other arrays must be averaged.");
+        return 1;
+        }
+      }
+    }
+  return 0;
+}
+
+// The averages keep their components when the first bin is empty.
+int TestEmptyFirstBin(bool concurrent)
+{
+  vtkSmartPointer<vtkPolyData> data = MakePoints(3);
+  const double range[] = { -10, 9 };
+  const int counts[] = { 0, 10 };
+  const double totals[] = { 0, 45 };
+  const double averages[] = { 0, 4.5 };
+  vtkSmartPointer<vtkTable> histogram = Histogram(data, "int", 2, true, range,
+    concurrent);
+  if (!CheckCounts(histogram, counts, 2) ||
+    !CheckVec(histogram, "vec_total", 3, totals, 2) ||
+    !CheckVec(histogram, "vec_average", 3, averages, 2))
+    {
+    vtkGenericWarningMacro("failed with an empty first bin.");
+    return 1;
+    }
+  return 0;
+}
+
+// An array to average with a different number of components in another
+// block is skipped for that block.
+int TestMismatchedComponents(bool concurrent)
+{
+  vtkSmartPointer<vtkMultiBlockDataSet> blocks =
+    vtkSmartPointer<vtkMultiBlockDataSet>::New();
+  blocks->SetNumberOfBlocks(2);
+  blocks->SetBlock(0, MakePoints(3));
+  blocks->SetBlock(1, MakePoints(2));
+  const int counts[] = { 4, 4, 4, 4, 4 };
+  // Only the first block is added to the totals, but all the values are
+  // counted in the averages.
+  const double totals[] = { 1, 5, 9, 13, 17 };
+  const double averages[] = { 0.25, 1.25, 2.25, 3.25, 4.25 };
+  vtkSmartPointer<vtkTable> histogram = Histogram(blocks, "int", 5, true, NULL,
+    concurrent);
+  if (!CheckCounts(histogram, counts, 5) ||
+    !CheckVec(histogram, "vec_total", 3, totals, 5) ||
+    !CheckVec(histogram, "vec_average", 3, averages, 5))
+    {
+    vtkGenericWarningMacro("failed with mismatched components.");
+    return 1;
+    }
+  return 0;
+}
+}
 
 /// Test the output of the vtkExtractHistogram filter in a simple serial case
 int TestExtractHistogram(int, char*[])
@@ -93,5 +293,9 @@ int TestExtractHistogram(int, char*[])
     vtkGenericWarningMacro("incorrect bin value.");
     return 1;
     }
-  return 0;
+
+  // The concurrent binning and the serial one it replaces must agree.
+  return TestArrayTypes(true) || TestEmptyFirstBin(true) ||
+    TestMismatchedComponents(true) || TestArrayTypes(false) ||
+    TestEmptyFirstBin(false) || TestMismatchedComponents(false);
 }
@@ -0,0 +1,335 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestMaterialInterfaceFilterThreaded.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Extracts the fragments of an AMR data set made with vtkHierarchicalFractal
+// with vtkMaterialInterfaceFilter, with and without threaded labeling,
+// checks that both give the same fragments and reports the seconds needed
+// by each. This is done without ghost layers, then with one ghost layer
+// around the blocks as the SpyPlot reader gives them.
+// The blocks are dealt to the processes in turn: in parallel, the filter
+// also makes ghost blocks of the neighbors of other processes, which the
+// threaded labeling connects after the blocks of the process.
+
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFieldData.h"
+#include "vtkHierarchicalFractal.h"
+#include "vtkIntArray.h"
+#include "vtkMaterialInterfaceFilter.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkMultiPieceDataSet.h"
+#include "vtkNew.h"
+#include "vtkNonOverlappingAMR.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkPVConfig.h"
+#include "vtkTimerLog.h"
+#include "vtkUniformGrid.h"
+#include "vtkUnsignedCharArray.h"
+
+#ifdef PARAVIEW_USE_MPI
+# include "vtkMPIController.h"
+#else
+# include "vtkDummyController.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+  const int BlockCells = 8;
+
+  // Copies the blocks of the fractal, which do not overlap when its Overlap
+  // is off, into a vtkNonOverlappingAMR with the arrays of a CTH material:
+  // an unsigned char volume fraction, a mass and a pressure. Only every
+  // numProcs-th block, starting at rank, is kept. Like the SpyPlot reader,
+  // the field data gives the global bounds, the block size including the
+  // ghost layers and the spacing of level 0, which the filter needs to place
+  // the blocks when they have ghost layers.
+  void MakeMaterial(vtkNonOverlappingAMR* amr, vtkUniformGridAMR* fractal,
+    int ghostLevels, int rank, int numProcs)
+    {
+    unsigned int numLevels = fractal->GetNumberOfLevels();
+    std::vector<int> blocksPerLevel(numLevels);
+    for (unsigned int level = 0; level < numLevels; level++)
+      {
+      blocksPerLevel[level] =
+        static_cast<int>(fractal->GetNumberOfDataSets(level));
+      }
+    amr->Initialize(static_cast<int>(numLevels), &blocksPerLevel[0]);
+
+    double globalBounds[6] =
+      { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX,
+        VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+    double rootSpacing[3] = { 0, 0, 0 };
+    int blockIndex = 0;
+    for (unsigned int level = 0; level < numLevels; level++)
+      {
+      for (int idx = 0; idx < blocksPerLevel[level]; idx++)
+        {
+        vtkUniformGrid* grid = fractal->GetDataSet(level, idx);
+        if (!grid)
+          {
+          continue;
+          }
+        double bounds[6];
+        grid->GetBounds(bounds);
+        for (int i = 0; i < 3; i++)
+          {
+          globalBounds[2 * i] = std::min(globalBounds[2 * i], bounds[2 * i]);
+          globalBounds[2 * i + 1] =
+            std::max(globalBounds[2 * i + 1], bounds[2 * i + 1]);
+          }
+        if (level == 0)
+          {
+          grid->GetSpacing(rootSpacing);
+          }
+        if (blockIndex++ % numProcs != rank)
+          {
+          continue;
+          }
+        vtkDataArray* fraction =
+          grid->GetCellData()->GetArray("Fractal Volume Fraction");
+        vtkIdType numCells = grid->GetNumberOfCells();
+        int dims[3];
+        double origin[3], spacing[3];
+        grid->GetDimensions(dims);
+        grid->GetOrigin(origin);
+        grid->GetSpacing(spacing);
+        double cellVolume = spacing[0] * spacing[1] * spacing[2];
+
+        vtkNew<vtkUnsignedCharArray> material;
+        material->SetName("Material");
+        material->SetNumberOfTuples(numCells);
+        vtkNew<vtkDoubleArray> mass;
+        mass->SetName("Mass");
+        mass->SetNumberOfTuples(numCells);
+        vtkNew<vtkDoubleArray> pressure;
+        pressure->SetName("Pressure");
+        pressure->SetNumberOfTuples(numCells);
+        for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+          {
+          double value = fraction->GetTuple1(cellId);
+          value = value < 0? 0 : (value > 1? 1 : value);
+          material->SetValue(cellId,
+            static_cast<unsigned char>(value * 255 + 0.5));
+          mass->SetValue(cellId, 2 * value * cellVolume);
+          int i = static_cast<int>(cellId % (dims[0] - 1));
+          int j = static_cast<int>(cellId / (dims[0] - 1) % (dims[1] - 1));
+          int k = static_cast<int>(cellId / (dims[0] - 1) / (dims[1] - 1));
+          double x = origin[0] + (i + 0.5) * spacing[0];
+          double y = origin[1] + (j + 0.5) * spacing[1];
+          double z = origin[2] + (k + 0.5) * spacing[2];
+          pressure->SetValue(cellId, x + 2 * y - z);
+          }
+
+        vtkNew<vtkUniformGrid> block;
+        block->CopyStructure(grid);
+        block->GetCellData()->AddArray(material.GetPointer());
+        block->GetCellData()->AddArray(mass.GetPointer());
+        block->GetCellData()->AddArray(pressure.GetPointer());
+        amr->SetDataSet(level, idx, block.GetPointer());
+        }
+      }
+
+    vtkNew<vtkDoubleArray> bounds;
+    bounds->SetName("GlobalBounds");
+    bounds->SetNumberOfTuples(6);
+    vtkNew<vtkIntArray> boxSize;
+    boxSize->SetName("GlobalBoxSize");
+    boxSize->SetNumberOfTuples(3);
+    vtkNew<vtkIntArray> minLevel;
+    minLevel->SetName("MinLevel");
+    minLevel->SetNumberOfTuples(1);
+    minLevel->SetValue(0, 0);
+    vtkNew<vtkDoubleArray> minLevelSpacing;
+    minLevelSpacing->SetName("MinLevelSpacing");
+    minLevelSpacing->SetNumberOfTuples(3);
+    vtkNew<vtkUnsignedCharArray> ghostLayer;
+    ghostLayer->SetName("GhostLayer");
+    ghostLayer->SetNumberOfTuples(1);
+    ghostLayer->SetValue(0, static_cast<unsigned char>(ghostLevels));
+    for (int i = 0; i < 3; i++)
+      {
+      bounds->SetValue(2 * i, globalBounds[2 * i]);
+      bounds->SetValue(2 * i + 1, globalBounds[2 * i + 1]);
+      boxSize->SetValue(i, BlockCells + 1 + ghostLevels);
+      minLevelSpacing->SetValue(i, rootSpacing[i]);
+      }
+    vtkFieldData* fd = amr->GetFieldData();
+    fd->AddArray(bounds.GetPointer());
+    fd->AddArray(boxSize.GetPointer());
+    fd->AddArray(minLevel.GetPointer());
+    fd->AddArray(minLevelSpacing.GetPointer());
+    fd->AddArray(ghostLayer.GetPointer());
+    }
+
+  bool SameArray(vtkDataArray* expected, vtkDataArray* array)
+    {
+    if (!expected || !array ||
+      array->GetNumberOfTuples() != expected->GetNumberOfTuples() ||
+      array->GetNumberOfComponents() != expected->GetNumberOfComponents())
+      {
+      return false;
+      }
+    for (vtkIdType i = 0; i < expected->GetNumberOfTuples(); i++)
+      {
+      for (int c = 0; c < expected->GetNumberOfComponents(); c++)
+        {
+        double a = expected->GetComponent(i, c);
+        double b = array->GetComponent(i, c);
+        if (fabs(a - b) > 1e-9 * (1 + fabs(a)))
+          {
+          return false;
+          }
+        }
+      }
+    return true;
+    }
+
+  // Compares the fragment attributes (output 1), which only the first
+  // process has, and the number of points and triangles of each fragment
+  // (output 0) of this process.
+  bool SameFragments(vtkMaterialInterfaceFilter* serial,
+    vtkMaterialInterfaceFilter* threaded, bool root)
+    {
+    bool status = true;
+    if (root)
+      {
+      vtkPolyData* expected = vtkPolyData::SafeDownCast(
+        vtkMultiBlockDataSet::SafeDownCast(
+          serial->GetOutputDataObject(1))->GetBlock(0));
+      vtkPolyData* attributes = vtkPolyData::SafeDownCast(
+        vtkMultiBlockDataSet::SafeDownCast(
+          threaded->GetOutputDataObject(1))->GetBlock(0));
+      if (!expected || !attributes ||
+        expected->GetNumberOfPoints() != attributes->GetNumberOfPoints())
+        {
+        cerr << "ERROR: the number of fragments differs." << endl;
+        return false;
+        }
+
+      vtkPointData* pd = expected->GetPointData();
+      for (int i = 0; i < pd->GetNumberOfArrays(); i++)
+        {
+        const char* name = pd->GetArrayName(i);
+        if (!SameArray(pd->GetArray(i),
+            attributes->GetPointData()->GetArray(name)))
+          {
+          cerr << "ERROR: fragment attribute " << name << " differs." << endl;
+          status = false;
+          }
+        }
+      }
+
+    vtkMultiPieceDataSet* expectedPieces = vtkMultiPieceDataSet::SafeDownCast(
+      vtkMultiBlockDataSet::SafeDownCast(
+        serial->GetOutputDataObject(0))->GetBlock(0));
+    vtkMultiPieceDataSet* pieces = vtkMultiPieceDataSet::SafeDownCast(
+      vtkMultiBlockDataSet::SafeDownCast(
+        threaded->GetOutputDataObject(0))->GetBlock(0));
+    if (!expectedPieces || !pieces ||
+      expectedPieces->GetNumberOfPieces() != pieces->GetNumberOfPieces())
+      {
+      cerr << "ERROR: the fragment geometry differs." << endl;
+      return false;
+      }
+    for (unsigned int i = 0; i < pieces->GetNumberOfPieces(); i++)
+      {
+      vtkDataSet* a = expectedPieces->GetPiece(i);
+      vtkDataSet* b = pieces->GetPiece(i);
+      if ((a? a->GetNumberOfPoints() : 0) != (b? b->GetNumberOfPoints() : 0) ||
+        (a? a->GetNumberOfCells() : 0) != (b? b->GetNumberOfCells() : 0))
+        {
+        cerr << "ERROR: the surface of fragment " << i << " differs." << endl;
+        status = false;
+        }
+      }
+    return status;
+    }
+
+  // Extracts the fragments of the fractal with ghostLevels ghost layers
+  // around its blocks, with and without threaded labeling.
+  bool CompareLabeling(vtkMultiProcessController* controller, int ghostLevels)
+    {
+    vtkNew<vtkHierarchicalFractal> fractal;
+    fractal->SetDimensions(BlockCells);
+    fractal->SetMaximumLevel(4);
+    fractal->SetGhostLevels(ghostLevels);
+    fractal->SetTwoDimensional(0);
+    fractal->SetAsymetric(0);
+    fractal->SetOverlap(0);
+    fractal->Update();
+
+    int rank = controller->GetLocalProcessId();
+    vtkNew<vtkNonOverlappingAMR> amr;
+    MakeMaterial(amr.GetPointer(),
+      vtkUniformGridAMR::SafeDownCast(fractal->GetOutputDataObject(0)),
+      ghostLevels, rank, controller->GetNumberOfProcesses());
+
+    vtkNew<vtkMaterialInterfaceFilter> filters[2];
+    double seconds[2];
+    for (int threaded = 0; threaded < 2; threaded++)
+      {
+      vtkMaterialInterfaceFilter* filter = filters[threaded].GetPointer();
+      filter->SetInputData(amr.GetPointer());
+      filter->SelectMaterialArray("Material");
+      filter->SelectMassArray("Mass");
+      filter->SelectVolumeWtdAvgArray("Pressure");
+      filter->SelectMassWtdAvgArray("Pressure");
+      filter->SelectSummationArray("Pressure");
+      filter->SetBlockGhostLevel(ghostLevels);
+      filter->SetThreadedLabeling(threaded == 1);
+      double start = vtkTimerLog::GetUniversalTime();
+      filter->Update();
+      seconds[threaded] = vtkTimerLog::GetUniversalTime() - start;
+      }
+
+    bool status = SameFragments(filters[0].GetPointer(),
+      filters[1].GetPointer(), rank == 0);
+    if (rank == 0)
+      {
+      cout << amr->GetTotalNumberOfBlocks() << " blocks, " << ghostLevels
+           << " ghost levels: " << seconds[0] << " seconds serial, "
+           << seconds[1] << " seconds threaded" << endl;
+      }
+    return status;
+    }
+}
+
+int TestMaterialInterfaceFilterThreaded(int argc, char* argv[])
+{
+#ifdef PARAVIEW_USE_MPI
+  vtkNew<vtkMPIController> controller;
+#else
+  vtkNew<vtkDummyController> controller;
+#endif
+  controller->Initialize(&argc, &argv);
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  bool status = CompareLabeling(controller.GetPointer(), 0);
+  status = CompareLabeling(controller.GetPointer(), 1) && status;
+
+  int local = status? 1 : 0;
+  int global = 0;
+  controller->AllReduce(&local, &global, 1, vtkCommunicator::MIN_OP);
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return global? EXIT_SUCCESS : EXIT_FAILURE;
+}
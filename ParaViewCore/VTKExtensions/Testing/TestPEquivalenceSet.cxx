@@ -0,0 +1,155 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPEquivalenceSet.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Resolves synthetic equivalences distributed over all the processes with
+// vtkPEquivalenceSet and checks the set of every id.
+//
+// Every process owns --ids-per-process ids (100000 by default), split in
+// 1000 sets by their index modulo 1000. The even sets are chained with the
+// same sets of the next process, so each spans all the processes, while the
+// odd ones stay in their process. Run it on 64 processes for a stress test
+// with millions of equivalences.
+// This test requires MPI.
+
+#include "vtkMPIController.h"
+#include "vtkObjectFactory.h"
+#include "vtkPEquivalenceSet.h"
+#include "vtkProcess.h"
+#include "vtkTimerLog.h"
+
+#include <cstdlib>
+#include <cstring>
+
+class PEquivalenceSetProcess : public vtkProcess
+{
+public:
+  static PEquivalenceSetProcess *New();
+  vtkTypeMacro(PEquivalenceSetProcess, vtkProcess);
+
+  virtual void Execute();
+
+  int IdsPerProcess;
+
+protected:
+  PEquivalenceSetProcess() { this->IdsPerProcess = 100000; }
+};
+
+vtkStandardNewMacro(PEquivalenceSetProcess);
+
+void PEquivalenceSetProcess::Execute()
+{
+  const int numSets = 1000;
+  int me = this->Controller->GetLocalProcessId();
+  int numProcs = this->Controller->GetNumberOfProcesses();
+  int numIds = this->IdsPerProcess;
+  int first = me * numIds;
+
+  vtkPEquivalenceSet* set = vtkPEquivalenceSet::New();
+  set->SetController(this->Controller);
+  set->SetLocalIds(first, numIds);
+  for (int j = numIds - 1; j >= numSets; --j)
+    {
+    set->AddEquivalence(first + j, first + j - numSets);
+    }
+  // Half of the links between processes are added by each side.
+  for (int c = 0; c < numSets; c += 2)
+    {
+    if (c % 4 == 0 && me + 1 < numProcs)
+      {
+      set->AddEquivalence(first + c, first + numIds + c);
+      }
+    else if (c % 4 == 2 && me > 0)
+      {
+      set->AddEquivalence(first - numIds + c, first + c);
+      }
+    }
+
+  this->Controller->Barrier();
+  double start = vtkTimerLog::GetUniversalTime();
+  int total = set->ResolveEquivalences();
+  double seconds = vtkTimerLog::GetUniversalTime() - start;
+
+  // The sets are numbered in the order of their smallest ids: the sets of
+  // the first process, then the odd sets of each other process.
+  int status = 1;
+  int expectedTotal = numSets + (numProcs - 1) * numSets / 2;
+  if (total != expectedTotal || set->GetNumberOfResolvedSets() != expectedTotal)
+    {
+    cerr << "ERROR: process " << me << " found " << total << " sets instead of "
+         << expectedTotal << "." << endl;
+    status = 0;
+    }
+  for (int j = 0; j < numIds && status; ++j)
+    {
+    int c = j % numSets;
+    int expected = c;
+    if (c % 2 == 1 && me > 0)
+      {
+      expected = numSets + (me - 1) * numSets / 2 + c / 2;
+      }
+    if (set->GetEquivalentSetId(first + j) != expected)
+      {
+      cerr << "ERROR: id " << first + j << " is in set "
+           << set->GetEquivalentSetId(first + j) << " instead of " << expected
+           << "." << endl;
+      status = 0;
+      }
+    }
+  // The ids of the neighbors added to the set are resolved too.
+  if (me + 1 < numProcs && set->GetEquivalentSetId(first + numIds) != 0)
+    {
+    cerr << "ERROR: id " << first + numIds << " of the next process is not "
+         << "resolved." << endl;
+    status = 0;
+    }
+
+  this->Controller->AllReduce(&status, &this->ReturnValue, 1,
+    vtkCommunicator::MIN_OP);
+  if (me == 0)
+    {
+    cout << numProcs << " processes, " << numIds * numProcs << " ids: "
+         << set->GetNumberOfRounds() << " rounds, " << seconds << " seconds"
+         << endl;
+    }
+  set->Delete();
+}
+
+int main(int argc, char **argv)
+{
+  int retVal = 1;
+
+  vtkMPIController *contr = vtkMPIController::New();
+  contr->Initialize(&argc, &argv);
+
+  vtkMultiProcessController::SetGlobalController(contr);
+
+  PEquivalenceSetProcess *p = PEquivalenceSetProcess::New();
+  for (int i = 1; i < argc - 1; i++)
+    {
+    if (strcmp(argv[i], "--ids-per-process") == 0)
+      {
+      p->IdsPerProcess = atoi(argv[i + 1]);
+      }
+    }
+  contr->SetSingleProcessObject(p);
+  contr->SingleMethodExecute();
+
+  retVal = p->GetReturnValue();
+  p->Delete();
+
+  contr->Finalize();
+  contr->Delete();
+
+  return !retVal;
+}
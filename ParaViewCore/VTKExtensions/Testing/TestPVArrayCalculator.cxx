@@ -0,0 +1,288 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVArrayCalculator.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Evaluates typical Calculator functions over an image data and a polydata
+// with vtkPVArrayCalculator, with and without compiled expressions, checks
+// that both give the same results and reports the seconds needed by each.
+// Also checks which functions vtkPVCompiledExpression compiles.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPVArrayCalculator.h"
+#include "vtkPVCompiledExpression.h"
+#include "vtkTimerLog.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+  struct Function
+    {
+    const char* Text;
+    bool Compiled;
+    };
+
+  // Functions over the point data, and whether they compile.
+  const Function PointFunctions[] =
+    {
+      { "Pressure*2+1", true },
+      { "mag(Velocity)", true },
+      { "Velocity.coords", true },
+      { "norm(cross(Velocity, coords))", true },
+      { "sqrt(coordsX^2 + coordsY^2) + Velocity_X", true },
+      { "sin(Pressure)*iHat + exp(-abs(Pressure))*jHat + max(coordsZ, 0.5)*kHat",
+        true },
+      { "2^(Pressure/10) - ln(1 + mag(coords))", true },
+      // invalid for some points, replaced by vtkFunctionParser.
+      { "sqrt(Pressure - 0.5)", true },
+      { "-Pressure^2", false },
+      { "log(Pressure + 1)", false }
+    };
+  const int NumberOfPointFunctions =
+    static_cast<int>(sizeof(PointFunctions) / sizeof(PointFunctions[0]));
+
+  // An image of dimension^3 points with a scalar and a vector point array
+  // and an integer cell array.
+  void MakeImageData(vtkImageData* image, int dimension)
+    {
+    image->SetDimensions(dimension, dimension, dimension);
+    image->SetOrigin(-1, -1, -1);
+    image->SetSpacing(2.0 / dimension, 2.0 / dimension, 2.0 / dimension);
+    vtkIdType numPoints = image->GetNumberOfPoints();
+    vtkNew<vtkFloatArray> pressure;
+    pressure->SetName("Pressure");
+    pressure->SetNumberOfTuples(numPoints);
+    vtkNew<vtkDoubleArray> velocity;
+    velocity->SetName("Velocity");
+    velocity->SetNumberOfComponents(3);
+    velocity->SetNumberOfTuples(numPoints);
+    for (vtkIdType i = 0; i < numPoints; i++)
+      {
+      double x[3];
+      image->GetPoint(i, x);
+      pressure->SetValue(i, static_cast<float>(x[0] * x[0] + x[1] - x[2]));
+      velocity->SetTuple3(i, -x[1], x[0], 0.25 * x[2]);
+      }
+    image->GetPointData()->SetScalars(pressure.GetPointer());
+    image->GetPointData()->SetVectors(velocity.GetPointer());
+
+    vtkIdType numCells = image->GetNumberOfCells();
+    vtkNew<vtkIntArray> ids;
+    ids->SetName("Id");
+    ids->SetNumberOfTuples(numCells);
+    for (vtkIdType i = 0; i < numCells; i++)
+      {
+      ids->SetValue(i, static_cast<int>(i % 1000));
+      }
+    image->GetCellData()->AddArray(ids.GetPointer());
+    }
+
+  // The points of image as vertices, with its point data.
+  void MakePolyData(vtkPolyData* polyData, vtkImageData* image)
+    {
+    vtkNew<vtkPoints> points;
+    points->SetDataTypeToDouble();
+    points->SetNumberOfPoints(image->GetNumberOfPoints());
+    vtkNew<vtkCellArray> verts;
+    for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+      {
+      points->SetPoint(i, image->GetPoint(i));
+      verts->InsertNextCell(1, &i);
+      }
+    polyData->SetPoints(points.GetPointer());
+    polyData->SetVerts(verts.GetPointer());
+    polyData->GetPointData()->ShallowCopy(image->GetPointData());
+    }
+
+  bool SameArray(vtkDataArray* expected, vtkDataArray* array,
+    double tolerance)
+    {
+    if (!expected || !array ||
+      array->GetNumberOfTuples() != expected->GetNumberOfTuples() ||
+      array->GetNumberOfComponents() != expected->GetNumberOfComponents())
+      {
+      return false;
+      }
+    for (vtkIdType i = 0; i < expected->GetNumberOfTuples(); i++)
+      {
+      for (int c = 0; c < expected->GetNumberOfComponents(); c++)
+        {
+        double a = expected->GetComponent(i, c);
+        double b = array->GetComponent(i, c);
+        if (fabs(a - b) > tolerance * (1 + fabs(a)))
+          {
+          return false;
+          }
+        }
+      }
+    return true;
+    }
+
+  // Runs calculator with and without compiled expressions and compares
+  // the results with getResult. Returns false on errors.
+  bool Compare(const char* name, vtkPVArrayCalculator* calculator,
+    const char* function, vtkDataArray* (*getResult)(vtkDataSet*),
+    double tolerance = 1e-12)
+    {
+    calculator->SetFunction(function);
+    vtkDataArray* results[2];
+    vtkDataSet* outputs[2];
+    double seconds[2];
+    for (int compiled = 0; compiled < 2; compiled++)
+      {
+      calculator->SetUseCompiledExpressions(compiled == 1);
+      double start = vtkTimerLog::GetUniversalTime();
+      calculator->Update();
+      seconds[compiled] = vtkTimerLog::GetUniversalTime() - start;
+      vtkDataSet* output =
+        vtkDataSet::SafeDownCast(calculator->GetOutputDataObject(0));
+      outputs[compiled] = output->NewInstance();
+      outputs[compiled]->ShallowCopy(output);
+      results[compiled] = getResult(outputs[compiled]);
+      }
+    bool status = SameArray(results[0], results[1], tolerance);
+    if (!status)
+      {
+      cerr << "ERROR: " << name << ", " << function
+           << ": compiled results differ." << endl;
+      }
+    cout << name << ", " << function << ": " << seconds[0]
+         << " seconds interpreted, " << seconds[1] << " seconds compiled"
+         << endl;
+    outputs[0]->Delete();
+    outputs[1]->Delete();
+    return status;
+    }
+
+  vtkDataArray* GetPointResult(vtkDataSet* output)
+    {
+    return output->GetPointData()->GetArray("Result");
+    }
+
+  vtkDataArray* GetCellResult(vtkDataSet* output)
+    {
+    return output->GetCellData()->GetArray("Result");
+    }
+
+  vtkDataArray* GetCoordinates(vtkDataSet* output)
+    {
+    vtkPolyData* polyData = vtkPolyData::SafeDownCast(output);
+    return polyData? polyData->GetPoints()->GetData() : NULL;
+    }
+
+  // Checks which functions compile with the variables vtkPVArrayCalculator
+  // registers for the point data.
+  bool TestCompile(vtkImageData* image)
+    {
+    vtkDataArray* pressure = image->GetPointData()->GetArray("Pressure");
+    vtkDataArray* velocity = image->GetPointData()->GetArray("Velocity");
+    const int xyz[3] = { 0, 1, 2 };
+    const char* coordinates[3] = { "coordsX", "coordsY", "coordsZ" };
+    vtkPVCompiledExpression expression;
+    expression.AddScalarVariable("Pressure", pressure, 0);
+    expression.AddScalarVariable("Velocity_X", velocity, 0);
+    expression.AddVectorVariable("Velocity", velocity, xyz);
+    for (int c = 0; c < 3; c++)
+      {
+      expression.AddCoordinateScalarVariable(coordinates[c], image, c);
+      }
+    expression.AddCoordinateVectorVariable("coords", image, xyz);
+
+    bool status = true;
+    for (int i = 0; i < NumberOfPointFunctions; i++)
+      {
+      if (expression.Compile(PointFunctions[i].Text) !=
+        PointFunctions[i].Compiled)
+        {
+        cerr << "ERROR: " << PointFunctions[i].Text << " should "
+             << (PointFunctions[i].Compiled? "" : "not ") << "compile."
+             << endl;
+        status = false;
+        }
+      }
+
+    // Invalid functions, reported by vtkFunctionParser.
+    const char* invalid[3] = { "Velocity/Pressure", "Pressure+Velocity", "" };
+    for (int i = 0; i < 3; i++)
+      {
+      if (expression.Compile(invalid[i]))
+        {
+        cerr << "ERROR: " << invalid[i] << " should not compile." << endl;
+        status = false;
+        }
+      }
+
+    // Constant subexpressions are computed when compiling.
+    if (!expression.Compile("Pressure*(2^3 - cos(0))") ||
+      expression.GetNumberOfOperations() != 2)
+      {
+      cerr << "ERROR: constants are not folded." << endl;
+      status = false;
+      }
+    return status;
+    }
+}
+
+int TestPVArrayCalculator(int, char*[])
+{
+  vtkNew<vtkImageData> image;
+  MakeImageData(image.GetPointer(), 64);
+  vtkNew<vtkPolyData> polyData;
+  MakePolyData(polyData.GetPointer(), image.GetPointer());
+
+  bool status = TestCompile(image.GetPointer());
+
+  vtkDataSet* inputs[2] = { image.GetPointer(), polyData.GetPointer() };
+  const char* names[2] = { "image data", "polydata" };
+  for (int cc = 0; cc < 2; cc++)
+    {
+    vtkNew<vtkPVArrayCalculator> calculator;
+    calculator->SetInputData(inputs[cc]);
+    calculator->SetResultArrayName("Result");
+    calculator->SetReplaceInvalidValues(1);
+    calculator->SetReplacementValue(-1);
+    for (int i = 0; i < NumberOfPointFunctions; i++)
+      {
+      status = Compare(names[cc], calculator.GetPointer(),
+        PointFunctions[i].Text, GetPointResult) && status;
+      }
+    }
+
+  // Cell data.
+  vtkNew<vtkPVArrayCalculator> cellCalculator;
+  cellCalculator->SetInputData(image.GetPointer());
+  cellCalculator->SetAttributeModeToUseCellData();
+  cellCalculator->SetResultArrayName("Result");
+  status = Compare("image cells", cellCalculator.GetPointer(),
+    "Id*0.5 - floor(Id/3)", GetCellResult) && status;
+
+  // Results as coordinates, which may be stored as floats.
+  vtkNew<vtkPVArrayCalculator> coordinatesCalculator;
+  coordinatesCalculator->SetInputData(polyData.GetPointer());
+  coordinatesCalculator->SetCoordinateResults(1);
+  status = Compare("polydata coordinates", coordinatesCalculator.GetPointer(),
+    "coords + 0.1*Velocity", GetCoordinates, 1e-6) && status;
+
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,169 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestReductionFilterTree.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Reduces a point and a cell array of a plane, identical on all ranks, with
+// vtkReductionFilter and vtkAttributeDataReductionFilter, first along a tree
+// then through a gather to the root. Both must add the values of all ranks.
+// Reports the time and the peak memory of the root for both: the tree is run
+// first, since the peak can only grow. The test runs on 4 ranks, and on
+// VTK_MPI_MAX_NUMPROCS ranks as well when it is larger, to see the root's
+// peak memory grow with the number of ranks for the gather only.
+// Last, the tree reduction is asked for with the helper missing on the last
+// rank: the results must be gathered instead.
+// This test requires MPI.
+
+#include "vtkAttributeDataReductionFilter.h"
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkMPIController.h"
+#include "vtkNew.h"
+#include "vtkPlaneSource.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkReductionFilter.h"
+#include "vtkTimerLog.h"
+
+#include <cstdlib>
+
+#if !defined(_WIN32)
+# include <sys/resource.h>
+#endif
+
+namespace
+{
+  // Peak resident memory of the process in KiB, 0 when not available.
+  long PeakMemory()
+    {
+#if !defined(_WIN32)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+      {
+# if defined(__APPLE__)
+      return static_cast<long>(usage.ru_maxrss / 1024);
+# else
+      return static_cast<long>(usage.ru_maxrss);
+# endif
+      }
+#endif
+    return 0;
+    }
+
+  void AddArray(vtkDataSetAttributes* attributes, vtkIdType size, double value)
+    {
+    vtkNew<vtkDoubleArray> array;
+    array->SetName("value");
+    array->SetNumberOfTuples(size);
+    array->FillComponent(0, value);
+    attributes->AddArray(array.GetPointer());
+    }
+
+  bool Check(vtkDataSetAttributes* attributes, double expected)
+    {
+    vtkDataArray* array = attributes->GetArray("value");
+    if (!array)
+      {
+      return false;
+      }
+    for (vtkIdType cc = 0; cc < array->GetNumberOfTuples(); ++cc)
+      {
+      if (array->GetTuple1(cc) != expected)
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+
+  bool Reduce(vtkPolyData* input, bool tree, vtkMultiProcessController* contr,
+    bool helperOnAll = true)
+    {
+    vtkNew<vtkAttributeDataReductionFilter> helper;
+    helper->SetReductionTypeToAdd();
+
+    int numProcs = contr->GetNumberOfProcesses();
+    vtkNew<vtkReductionFilter> reduction;
+    reduction->SetController(contr);
+    if (helperOnAll || contr->GetLocalProcessId() != numProcs - 1)
+      {
+      reduction->SetPostGatherHelper(helper.GetPointer());
+      }
+    reduction->SetTreeReduction(tree? 1 : 0);
+    reduction->SetInputData(input);
+
+    contr->Barrier();
+    vtkNew<vtkTimerLog> timer;
+    timer->StartTimer();
+    reduction->Update();
+    contr->Barrier();
+    timer->StopTimer();
+
+    if (contr->GetLocalProcessId() != 0)
+      {
+      return true;
+      }
+
+    cout << (tree? "tree" : "gather") << " ranks: " << numProcs
+         << "  time: " << timer->GetElapsedTime()
+         << "s  root peak memory: " << PeakMemory() << " KiB" << endl;
+
+    vtkPolyData* output = vtkPolyData::SafeDownCast(reduction->GetOutput());
+    double expected = numProcs * (numProcs + 1) / 2.0;
+    if (!output ||
+      output->GetNumberOfPoints() != input->GetNumberOfPoints() ||
+      !Check(output->GetPointData(), expected) ||
+      !Check(output->GetCellData(), expected))
+      {
+      cerr << "ERROR: incorrect " << (tree? "tree" : "gather")
+           << " reduction." << endl;
+      return false;
+      }
+    return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+  vtkNew<vtkMPIController> contr;
+  contr->Initialize(&argc, &argv);
+  vtkMultiProcessController::SetGlobalController(contr.GetPointer());
+
+  int myId = contr->GetLocalProcessId();
+
+  vtkNew<vtkPlaneSource> plane;
+  plane->SetResolution(400, 400);
+  plane->Update();
+
+  vtkNew<vtkPolyData> input;
+  input->ShallowCopy(plane->GetOutput());
+  AddArray(input->GetPointData(), input->GetNumberOfPoints(), myId + 1);
+  AddArray(input->GetCellData(), input->GetNumberOfCells(), myId + 1);
+
+  int status = 1;
+  if (myId == 0)
+    {
+    cout << "root peak memory before reduction: " << PeakMemory()
+         << " KiB" << endl;
+    }
+  if (!Reduce(input.GetPointer(), true, contr.GetPointer()) ||
+    !Reduce(input.GetPointer(), false, contr.GetPointer()) ||
+    !Reduce(input.GetPointer(), true, contr.GetPointer(), false))
+    {
+    status = 0;
+    }
+  contr->Broadcast(&status, 1, 0);
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  contr->Finalize();
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -23,8 +23,17 @@
 #include "vtkSmartPointer.h"
 #include "vtkMultiProcessController.h"
 #include "vtkDummyController.h"
+#include "vtkPVConfig.h"
+#include "vtkTimerLog.h"
 
+#ifdef PARAVIEW_USE_MPI
+# include "vtkMPIController.h"
+#endif
+
+#include <algorithm>
 #include <float.h>
+#include <math.h>
+#include <vector>
 // ----------------------------------------------------------------------------
 void fillArray(vtkDoubleArray* array, double* dataPointer, int dataSize, const char* name)
 {
@@ -59,7 +68,7 @@ bool compareArray(vtkTable* table, const char* arrayName, double* dataPointer, i
 }
 
 // ----------------------------------------------------------------------------
-int sortWithSimilarValues(bool debug)
+int sortWithSimilarValues(vtkMultiProcessController* controller, bool debug)
 {
   const int size = 10;
   double dataArray[size] =   { 0,1,2,1,3,1,3,1,2,100000 };
@@ -72,6 +81,7 @@ int sortWithSimilarValues(bool debug)
   input->AddColumn(dataToSort);;
   vtkSmartPointer<vtkSortedTableStreamer> sortingfilter = vtkSmartPointer<vtkSortedTableStreamer>::New();
 
+  sortingfilter->SetController(controller);
   sortingfilter->SetInputData(input.GetPointer());
   sortingfilter->SetSelectedComponent(0);
   sortingfilter->SetColumnNameToSort("data");
@@ -89,7 +99,7 @@ int sortWithSimilarValues(bool debug)
 }
 
 // ----------------------------------------------------------------------------
-int sortWithEpsilonValues(bool debug)
+int sortWithEpsilonValues(vtkMultiProcessController* controller, bool debug)
 {
   double epsilon = 1000 * FLT_EPSILON; // FIXME why the delta need to be so big ???
   const int size = 10;
@@ -107,6 +117,7 @@ int sortWithEpsilonValues(bool debug)
   input->AddColumn(dataToSort);;
   vtkSmartPointer<vtkSortedTableStreamer> sortingfilter = vtkSmartPointer<vtkSortedTableStreamer>::New();
 
+  sortingfilter->SetController(controller);
   sortingfilter->SetInputData(input.GetPointer());
   sortingfilter->SetSelectedComponent(0);
   sortingfilter->SetColumnNameToSort("data");
@@ -124,7 +135,7 @@ int sortWithEpsilonValues(bool debug)
 }
 
 // ----------------------------------------------------------------------------
-int sortMagnitudeOnUnsignedCharVector()
+int sortMagnitudeOnUnsignedCharVector(vtkMultiProcessController* controller)
 {
   vtkSmartPointer<vtkUnsignedCharArray> dataToSort = vtkSmartPointer<vtkUnsignedCharArray>::New();
   dataToSort->SetNumberOfComponents(3);
@@ -145,6 +156,7 @@ int sortMagnitudeOnUnsignedCharVector()
   input->AddColumn(dataToSort);;
   vtkSmartPointer<vtkSortedTableStreamer> sortingfilter = vtkSmartPointer<vtkSortedTableStreamer>::New();
 
+  sortingfilter->SetController(controller);
   sortingfilter->SetInputData(input.GetPointer());
   sortingfilter->SetSelectedComponent(-1); // Magnitude
   sortingfilter->SetColumnNameToSort("data");
@@ -157,33 +169,312 @@ int sortMagnitudeOnUnsignedCharVector()
 }
 
 // ----------------------------------------------------------------------------
-int TestSortingTable(int vtkNotUsed(argc), char **vtkNotUsed(argv))
+// Position of a row in the global order, as sent by the process that merged
+// a block.
+struct SortedRow
+{
+  double Value;
+  double ProcessId;
+  double Row;
+
+  bool operator<(const SortedRow& other) const
+    {
+    if(this->Value != other.Value)
+      {
+      return this->Value < other.Value;
+      }
+    if(this->ProcessId != other.ProcessId)
+      {
+      return this->ProcessId < other.ProcessId;
+      }
+    return this->Row < other.Row;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// Sort a large table where most of the values are equal and the others spread
+// over several orders of magnitude, distributed over all the processes, then
+// page through it. Check the order across the blocks, whichever process
+// merged them, and report the time to build the index and per block.
+int sortSkewedValues(vtkMultiProcessController* controller)
+{
+  const int me = controller->GetLocalProcessId();
+  const int numProcs = controller->GetNumberOfProcesses();
+  const vtkIdType localSize = 1000000 / numProcs;
+  const vtkIdType size = localSize * numProcs;
+  const vtkIdType blockSize = 1024;
+  const int numBlocks = 50;
+
+  vtkSmartPointer<vtkDoubleArray> dataToSort = vtkSmartPointer<vtkDoubleArray>::New();
+  dataToSort->SetName("data");
+  dataToSort->SetNumberOfTuples(localSize);
+  vtkSmartPointer<vtkDoubleArray> rowIndex = vtkSmartPointer<vtkDoubleArray>::New();
+  rowIndex->SetName("row");
+  rowIndex->SetNumberOfTuples(localSize);
+  for(vtkIdType i=0;i<localSize;i++)
+    {
+    vtkIdType global = me * localSize + i;
+    dataToSort->SetValue(i, (global % 10) ? 0.0 : pow(1.5, static_cast<double>((global * 7919) % 60)));
+    rowIndex->SetValue(i, static_cast<double>(i));
+    }
+
+  vtkSmartPointer<vtkTable> input = vtkSmartPointer<vtkTable>::New();
+  input->AddColumn(dataToSort);
+  input->AddColumn(rowIndex);
+  vtkSmartPointer<vtkSortedTableStreamer> sortingfilter = vtkSmartPointer<vtkSortedTableStreamer>::New();
+  sortingfilter->SetController(controller);
+  sortingfilter->SetInputData(input.GetPointer());
+  sortingfilter->SetSelectedComponent(0);
+  sortingfilter->SetColumnNameToSort("data");
+  sortingfilter->SetBlockSize(blockSize);
+
+  // The first block builds the index
+  controller->Barrier();
+  double start = vtkTimerLog::GetUniversalTime();
+  sortingfilter->SetBlock(0);
+  sortingfilter->Update();
+  controller->Barrier();
+  if(me == 0)
+    {
+    cout << "Skewed values on " << numProcs << " processes, first block: "
+         << vtkTimerLog::GetUniversalTime() - start << " seconds" << endl;
+    }
+
+  // Page through blocks taken over the whole table. Only the process that
+  // merged a block has rows: it checks them and sends the first and last
+  // ones to the others, so that consecutive blocks can be compared.
+  SortedRow previous = { -1, -1, -1 };
+  vtkIdType previousBlock = -1;
+  int status = 1;
+  start = vtkTimerLog::GetUniversalTime();
+  for(int b=0;b<numBlocks && status;b++)
+    {
+    vtkIdType block = b * (size / blockSize) / (numBlocks - 1);
+    sortingfilter->SetBlock(block);
+    sortingfilter->Update();
+    vtkTable* output = sortingfilter->GetOutput();
+    vtkIdType expectedRows = std::min(blockSize, size - block * blockSize);
+
+    int merged = output->GetNumberOfRows() > 0 ? me : -1;
+    int mergePid = -1;
+    controller->AllReduce(&merged, &mergePid, 1, vtkCommunicator::MAX_OP);
+    if(mergePid < 0)
+      {
+      cout << "Empty block " << block << endl;
+      return EXIT_FAILURE;
+      }
+    if(block != previousBlock + 1)
+      {
+      // Only consecutive blocks can be compared
+      previous.Value = previous.ProcessId = previous.Row = -1;
+      }
+    previousBlock = block;
+
+    SortedRow bounds[2] = { previous, previous };
+    if(me == mergePid)
+      {
+      vtkDataArray* values = vtkDataArray::SafeDownCast(output->GetColumnByName("data"));
+      vtkDataArray* rows = vtkDataArray::SafeDownCast(output->GetColumnByName("row"));
+      vtkDataArray* pids = vtkDataArray::SafeDownCast(output->GetColumnByName("vtkOriginalProcessIds"));
+      if(!values || !rows || (numProcs > 1 && !pids) ||
+        output->GetNumberOfRows() != expectedRows)
+        {
+        cout << "Wrong block " << block << endl;
+        status = 0;
+        }
+      for(vtkIdType i=0;status && i<expectedRows;i++)
+        {
+        SortedRow row = { values->GetTuple1(i),
+          pids ? pids->GetTuple1(i) : 0, rows->GetTuple1(i) };
+        if(!(previous < row))
+          {
+          cout << "Wrong order in block " << block << " at row " << i << endl;
+          status = 0;
+          }
+        if(i == 0)
+          {
+          bounds[0] = row;
+          }
+        previous = row;
+        }
+      bounds[1] = previous;
+      }
+    controller->Broadcast(reinterpret_cast<double*>(bounds), 6, mergePid);
+    controller->Broadcast(&status, 1, mergePid);
+    previous = bounds[1];
+    }
+  if(!status)
+    {
+    return EXIT_FAILURE;
+    }
+  controller->Barrier();
+  if(me == 0)
+    {
+    cout << "Skewed values, other blocks: "
+         << (vtkTimerLog::GetUniversalTime() - start) / numBlocks
+         << " seconds per block" << endl;
+    }
+
+  // The inverted order starts with the largest value
+  sortingfilter->SetInvertOrder(1);
+  sortingfilter->SetBlock(0);
+  sortingfilter->Update();
+  double localMax = dataToSort->GetRange()[1];
+  double globalMax = 0;
+  controller->AllReduce(&localMax, &globalMax, 1, vtkCommunicator::MAX_OP);
+  vtkDataArray* values =
+    vtkDataArray::SafeDownCast(sortingfilter->GetOutput()->GetColumnByName("data"));
+  int local = (values && values->GetNumberOfTuples() > 0) ?
+    (values->GetTuple1(0) == globalMax ? 1 : 0) : -1;
+  int first = -1;
+  controller->AllReduce(&local, &first, 1, vtkCommunicator::MAX_OP);
+  if(first != 1)
+    {
+    cout << "Wrong first block in inverted order" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// ----------------------------------------------------------------------------
+// Sort a table distributed over all the processes with a small budget per
+// round, so that the rows of each range are gathered in many rounds, and
+// check the whole table, merged in one block, against the expected order.
+int sortInRounds(vtkMultiProcessController* controller)
+{
+  const int me = controller->GetLocalProcessId();
+  const int numProcs = controller->GetNumberOfProcesses();
+  const vtkIdType localSize = 2000;
+  const vtkIdType size = localSize * numProcs;
+
+  // Many equal values, so that the order of the ties is checked too.
+  std::vector<SortedRow> expected(size);
+  for(vtkIdType global=0;global<size;global++)
+    {
+    SortedRow row = { static_cast<double>((global * 7919) % 97),
+      static_cast<double>(global / localSize),
+      static_cast<double>(global % localSize) };
+    expected[global] = row;
+    }
+  std::sort(expected.begin(), expected.end());
+
+  vtkSmartPointer<vtkDoubleArray> dataToSort = vtkSmartPointer<vtkDoubleArray>::New();
+  dataToSort->SetName("data");
+  dataToSort->SetNumberOfTuples(localSize);
+  vtkSmartPointer<vtkDoubleArray> rowIndex = vtkSmartPointer<vtkDoubleArray>::New();
+  rowIndex->SetName("row");
+  rowIndex->SetNumberOfTuples(localSize);
+  for(vtkIdType i=0;i<localSize;i++)
+    {
+    vtkIdType global = me * localSize + i;
+    dataToSort->SetValue(i, static_cast<double>((global * 7919) % 97));
+    rowIndex->SetValue(i, static_cast<double>(i));
+    }
+
+  vtkSmartPointer<vtkTable> input = vtkSmartPointer<vtkTable>::New();
+  input->AddColumn(dataToSort);
+  input->AddColumn(rowIndex);
+  vtkSmartPointer<vtkSortedTableStreamer> sortingfilter = vtkSmartPointer<vtkSortedTableStreamer>::New();
+  sortingfilter->SetController(controller);
+  sortingfilter->SetInputData(input.GetPointer());
+  sortingfilter->SetSelectedComponent(0);
+  sortingfilter->SetColumnNameToSort("data");
+  // A few keys per process and round, while each range holds about
+  // localSize keys.
+  sortingfilter->SetMaxBytesPerRound(1000);
+  sortingfilter->SetBlock(0);
+  sortingfilter->SetBlockSize(size);
+  sortingfilter->Update();
+
+  vtkTable* output = sortingfilter->GetOutput();
+  int merged = output->GetNumberOfRows() > 0 ? me : -1;
+  int mergePid = -1;
+  controller->AllReduce(&merged, &mergePid, 1, vtkCommunicator::MAX_OP);
+  int status = mergePid >= 0 ? 1 : 0;
+  if(me == mergePid)
+    {
+    vtkDataArray* values = vtkDataArray::SafeDownCast(output->GetColumnByName("data"));
+    vtkDataArray* rows = vtkDataArray::SafeDownCast(output->GetColumnByName("row"));
+    vtkDataArray* pids = vtkDataArray::SafeDownCast(output->GetColumnByName("vtkOriginalProcessIds"));
+    if(!values || !rows || (numProcs > 1 && !pids) ||
+      output->GetNumberOfRows() != size)
+      {
+      status = 0;
+      }
+    for(vtkIdType i=0;status && i<size;i++)
+      {
+      if(values->GetTuple1(i) != expected[i].Value ||
+        (pids ? pids->GetTuple1(i) : 0) != expected[i].ProcessId ||
+        rows->GetTuple1(i) != expected[i].Row)
+        {
+        cout << "Wrong row " << i << " sorted in rounds" << endl;
+        status = 0;
+        }
+      }
+    }
+  if(mergePid >= 0)
+    {
+    controller->Broadcast(&status, 1, mergePid);
+    }
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// ----------------------------------------------------------------------------
+// Run with MPI, the skewed values are sorted over all the processes, the
+// other tests run on the first process only.
+int TestSortingTable(int argc, char* argv[])
 {
-  // Create Fake MPI controller
+#ifdef PARAVIEW_USE_MPI
+  vtkMPIController* ctrl = vtkMPIController::New();
+#else
   vtkDummyController* ctrl = vtkDummyController::New();
+#endif
+  ctrl->Initialize(&argc, &argv);
   vtkMultiProcessController::SetGlobalController(ctrl);
+  vtkSmartPointer<vtkDummyController> serial = vtkSmartPointer<vtkDummyController>::New();
   int result = 0;
   bool debug = false;
 
+  if(ctrl->GetLocalProcessId() == 0)
+    {
+    // ------------------------------------------------------------------------
+    cout << "Testing sorting with similar values: "
+         << ((result += sortWithSimilarValues(serial, debug)) ? "FAILED" :  "SUCCESS")
+         << endl;
+    // ------------------------------------------------------------------------
+    cout << "Testing sorting with epsilon values: "
+         << ((result += sortWithEpsilonValues(serial, debug)) ? "FAILED" :  "SUCCESS")
+         << endl;
+    // ------------------------------------------------------------------------
+    cout << "Testing sorting with magnitude on unsigned char: "
+         << ((result += sortMagnitudeOnUnsignedCharVector(serial))
+             ? "FAILED" :  "SUCCESS")
+         << endl;
+    }
   // --------------------------------------------------------------------------
-  cout << "Testing sorting with similar values: "
-       << ((result += sortWithSimilarValues(debug)) ? "FAILED" :  "SUCCESS")
-       << endl;
-  // --------------------------------------------------------------------------
-  cout << "Testing sorting with epsilon values: "
-       << ((result += sortWithEpsilonValues(debug)) ? "FAILED" :  "SUCCESS")
-       << endl;
-  // --------------------------------------------------------------------------
-  cout << "Testing sorting with magnitude on unsigned char: "
-       << ((result += sortMagnitudeOnUnsignedCharVector())
-           ? "FAILED" :  "SUCCESS")
-       << endl;
+  int skewed = sortSkewedValues(ctrl);
+  if(ctrl->GetLocalProcessId() == 0)
+    {
+    cout << "Testing sorting with skewed values: "
+         << ((result += skewed) ? "FAILED" :  "SUCCESS")
+         << endl;
+    }
   // --------------------------------------------------------------------------
+  int rounds = sortInRounds(ctrl);
+  if(ctrl->GetLocalProcessId() == 0)
+    {
+    cout << "Testing sorting gathered in rounds: "
+         << ((result += rounds) ? "FAILED" :  "SUCCESS")
+         << endl;
+    }
   // --------------------------------------------------------------------------
+  int globalResult = 0;
+  ctrl->AllReduce(&result, &globalResult, 1, vtkCommunicator::MAX_OP);
 
-  // Delete Fake MPI controller
   vtkMultiProcessController::SetGlobalController(0);
+  ctrl->Finalize();
   ctrl->Delete();
 
-  return result;
+  return globalResult;
 }
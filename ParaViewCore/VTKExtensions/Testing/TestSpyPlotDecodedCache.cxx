@@ -0,0 +1,367 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestSpyPlotDecodedCache.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Writes a SPCTH SpyPlot file with two blocks, two cell fields and two time
+// steps, then goes back and forth between the time steps with
+// vtkSpyPlotUniReader. Checks the decoded values, and that the arrays of a
+// time step left, with their ghost cells fixed state, are taken back from
+// the cache of the readers: by the same reader, by another one, but not
+// when the cache is disabled nor once the file is written again.
+
+#include "vtkByteSwap.h"
+#include "vtkDataArray.h"
+#include "vtkDataArraySelection.h"
+#include "vtkNew.h"
+#include "vtkSpyPlotUniReader.h"
+#include "vtkTesting.h"
+
+#include <cstdlib>
+#include <string>
+#include <vtksys/SystemTools.hxx>
+
+namespace
+{
+  const int NumberOfBlocks = 2;
+  const int Dimension = 4; // cells per side of a block
+  const int NumberOfTimeSteps = 2;
+  const int NumberOfDumps = 100; // the size of the tables of the header
+  const char* Fields[2] = { "density", "pressure" };
+
+  // Big endian file content, written at once.
+  class Buffer
+  {
+  public:
+    void Int(int value)
+      {
+      vtkByteSwap::SwapBE(&value);
+      this->Data.append(reinterpret_cast<char*>(&value), sizeof(value));
+      }
+    void Int64(vtkTypeInt64 value)
+      {
+      vtkByteSwap::SwapBE(&value);
+      this->Data.append(reinterpret_cast<char*>(&value), sizeof(value));
+      }
+    void Float(float value)
+      {
+      vtkByteSwap::SwapBE(&value);
+      this->Data.append(reinterpret_cast<char*>(&value), sizeof(value));
+      }
+    void Double(double value)
+      {
+      vtkByteSwap::SwapBE(&value);
+      this->Data.append(reinterpret_cast<char*>(&value), sizeof(value));
+      }
+    void String(const std::string& text, size_t length)
+      {
+      std::string padded(text, 0, length);
+      padded.resize(length, '\0');
+      this->Data += padded;
+      }
+    void Byte(int value)
+      {
+      this->Data += static_cast<char>(value);
+      }
+    void SetInt64(size_t position, vtkTypeInt64 value)
+      {
+      vtkByteSwap::SwapBE(&value);
+      this->Data.replace(position, sizeof(value),
+        reinterpret_cast<char*>(&value), sizeof(value));
+      }
+    size_t Size() const { return this->Data.size(); }
+
+    std::string Data;
+  };
+
+  // The value of the cell i of the plane z of a block. The version changes
+  // when the file is written again.
+  float Value(int version, int step, int field, int block, int z, int i)
+    {
+    return static_cast<float>(100 * version + step + field * 10 + block +
+      z * 0.001 + i * 1e-6);
+    }
+
+  // Encodes count regularly spaced coordinates.
+  void EncodeCoordinates(Buffer& buffer, float origin, int count)
+    {
+    Buffer runs;
+    runs.Float(origin);
+    runs.Float(1.0);
+    while (count > 0)
+      {
+      int run = count < 127? count : 127;
+      runs.Byte(run);
+      runs.Float(0.0);
+      count -= run;
+      }
+    buffer.Int(static_cast<int>(runs.Size()));
+    buffer.Data += runs.Data;
+    }
+
+  // Encodes the values of a plane as literal runs.
+  void EncodePlane(Buffer& buffer, int version, int step, int field,
+    int block, int z)
+    {
+    Buffer runs;
+    int plane = Dimension * Dimension;
+    for (int start = 0; start < plane; start += 127)
+      {
+      int count = plane - start < 127? plane - start : 127;
+      runs.Byte(128 + count);
+      for (int i = start; i < start + count; ++i)
+        {
+        runs.Float(Value(version, step, field, block, z, i));
+        }
+      }
+    buffer.Int(static_cast<int>(runs.Size()));
+    buffer.Data += runs.Data;
+    }
+
+  bool WriteFile(const std::string& fileName, int version)
+    {
+    Buffer buffer;
+    buffer.String("spydata", 8);
+    buffer.String("TestSpyPlotDecodedCache", 128);
+    // version, size of file pointers, compression, processor id, number of
+    // processors, coordinate system (3D cartesian), dimensions, materials,
+    // maximum number of materials
+    int header[9] = { 104, 64, 1, 0, 1, 30, 3, 1, 1 };
+    for (int cc = 0; cc < 9; ++cc)
+      {
+      buffer.Int(header[cc]);
+      }
+    for (int cc = 0; cc < 3; ++cc)
+      {
+      buffer.Double(0);
+      }
+    buffer.Double(NumberOfBlocks * Dimension);
+    buffer.Double(Dimension);
+    buffer.Double(Dimension);
+    buffer.Int(NumberOfBlocks);
+    buffer.Int(1);
+
+    // cell fields, then no material field
+    int numFields = static_cast<int>(sizeof(Fields) / sizeof(Fields[0]));
+    buffer.Int(numFields);
+    for (int field = 0; field < numFields; ++field)
+      {
+      buffer.String(vtksys::SystemTools::UpperCase(Fields[field]), 30);
+      buffer.String(Fields[field], 80);
+      buffer.Int(field + 1);
+      }
+    buffer.Int(0);
+
+    // the group header follows its offset, the dump offsets are set once
+    // the dumps are written.
+    buffer.Int64(static_cast<vtkTypeInt64>(buffer.Size() + 8));
+    buffer.Int(NumberOfTimeSteps);
+    for (int cc = 0; cc < NumberOfDumps; ++cc)
+      {
+      buffer.Int(cc);
+      }
+    for (int cc = 0; cc < NumberOfDumps; ++cc)
+      {
+      buffer.Double(cc);
+      }
+    for (int cc = 0; cc < NumberOfDumps; ++cc)
+      {
+      buffer.Double(1.0);
+      }
+    size_t dumpOffsets = buffer.Size();
+    for (int cc = 0; cc < NumberOfDumps; ++cc)
+      {
+      buffer.Int64(0);
+      }
+
+    for (int step = 0; step < NumberOfTimeSteps; ++step)
+      {
+      buffer.SetInt64(dumpOffsets + 8 * step, buffer.Size());
+      buffer.Int(numFields);
+      for (int field = 0; field < numFields; ++field)
+        {
+        buffer.Int(field + 1);
+        }
+      size_t variableOffsets = buffer.Size();
+      for (int field = 0; field < numFields; ++field)
+        {
+        buffer.Int64(0);
+        }
+      // no tracers, no histograms
+      buffer.Int(0);
+      buffer.Int(0);
+      buffer.Int(NumberOfBlocks);
+      for (int block = 0; block < NumberOfBlocks; ++block)
+        {
+        // dimensions, allocated, active, level, bounds
+        int description[12] = { Dimension, Dimension, Dimension, 1, 1, 0,
+          block * Dimension, (block + 1) * Dimension - 1, 0, Dimension - 1,
+          0, Dimension - 1 };
+        for (int cc = 0; cc < 12; ++cc)
+          {
+          buffer.Int(description[cc]);
+          }
+        }
+      for (int block = 0; block < NumberOfBlocks; ++block)
+        {
+        EncodeCoordinates(buffer, block * Dimension, Dimension + 1);
+        EncodeCoordinates(buffer, 0, Dimension + 1);
+        EncodeCoordinates(buffer, 0, Dimension + 1);
+        }
+      for (int field = 0; field < numFields; ++field)
+        {
+        buffer.SetInt64(variableOffsets + 8 * field, buffer.Size());
+        for (int block = 0; block < NumberOfBlocks; ++block)
+          {
+          for (int z = 0; z < Dimension; ++z)
+            {
+            EncodePlane(buffer, version, step, field, block, z);
+            }
+          }
+        }
+      }
+
+    ofstream file(fileName.c_str(), ios::out | ios::binary);
+    file.write(buffer.Data.c_str(), buffer.Size());
+    return !file.fail();
+    }
+
+  // Makes the time step of the reader current and returns the density of
+  // the block. Checks its values and whether its ghost cells are marked as
+  // fixed, i.e. whether it comes from the cache.
+  vtkDataArray* Show(vtkSpyPlotUniReader* reader, int step, int block,
+    int version, int fixed, const char* what, bool& status)
+    {
+    reader->SetCurrentTimeStep(step);
+    reader->SetNeedToCheck(1);
+    int isFixed = 0;
+    vtkDataArray* array = reader->MakeCurrent()?
+      reader->GetCellFieldData(block, 0, &isFixed) : NULL;
+    if (!array || array->GetNumberOfTuples() !=
+      Dimension * Dimension * Dimension)
+      {
+      cerr << "ERROR: " << what << ": density not read" << endl;
+      status = false;
+      return NULL;
+      }
+    for (int z = 0; z < Dimension; ++z)
+      {
+      for (int i = 0; i < Dimension * Dimension; ++i)
+        {
+        double value = array->GetTuple1(z * Dimension * Dimension + i);
+        if (value != Value(version, step, 0, block, z, i))
+          {
+          cerr << "ERROR: " << what << ": wrong density " << value
+               << " for the cell " << i << " of the plane " << z << endl;
+          status = false;
+          return array;
+          }
+        }
+      }
+    if (isFixed != fixed)
+      {
+      cerr << "ERROR: " << what << ": the density should "
+           << (fixed? "" : "not ") << "come from the cache" << endl;
+      status = false;
+      }
+    return array;
+    }
+}
+
+int TestSpyPlotDecodedCache(int argc, char* argv[])
+{
+  vtkNew<vtkTesting> testing;
+  testing->AddArguments(argc, const_cast<const char**>(argv));
+  std::string fileName = testing->GetTempDirectory();
+  fileName += "/TestSpyPlotDecodedCache.spcth";
+  if (!WriteFile(fileName, 0))
+    {
+    cerr << "Cannot write " << fileName << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkDataArraySelection> selection;
+  vtkNew<vtkSpyPlotUniReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->SetCellArraySelection(selection.GetPointer());
+  reader->ReadInformation();
+  selection->EnableArray(Fields[0]);
+  vtkSpyPlotUniReader::SetCacheSize(256);
+  vtkSpyPlotUniReader::ClearCache();
+
+  // The arrays of a time step left are taken back with their state. The
+  // ghost cells of the first block only are marked as fixed.
+  bool status = true;
+  vtkDataArray* array =
+    Show(reader.GetPointer(), 0, 0, 0, 0, "first read", status);
+  reader->MarkCellFieldDataFixed(0, 0);
+  Show(reader.GetPointer(), 1, 0, 0, 0, "next time step", status);
+  if (Show(reader.GetPointer(), 0, 0, 0, 1, "back to the first time step",
+      status) != array)
+    {
+    cerr << "ERROR: the density is not taken back from the cache" << endl;
+    status = false;
+    }
+  Show(reader.GetPointer(), 0, 1, 0, 0, "second block", status);
+
+  // The arrays of an unselected field are kept as well.
+  selection->DisableArray(Fields[0]);
+  selection->EnableArray(Fields[1]);
+  reader->SetNeedToCheck(1);
+  reader->MakeCurrent();
+  selection->EnableArray(Fields[0]);
+  if (Show(reader.GetPointer(), 0, 0, 0, 1, "field selected again",
+      status) != array)
+    {
+    cerr << "ERROR: the density is not taken back from the cache" << endl;
+    status = false;
+    }
+  selection->DisableArray(Fields[1]);
+
+  // Another reader of the same file gets them too.
+  Show(reader.GetPointer(), 1, 0, 0, 0, "next time step", status);
+  vtkNew<vtkSpyPlotUniReader> other;
+  other->SetFileName(fileName.c_str());
+  other->SetCellArraySelection(selection.GetPointer());
+  other->ReadInformation();
+  if (Show(other.GetPointer(), 0, 0, 0, 1, "other reader", status) != array)
+    {
+    cerr << "ERROR: the density is not shared by the readers" << endl;
+    status = false;
+    }
+  Show(other.GetPointer(), 1, 0, 0, 0, "other reader next time step",
+    status);
+
+  // Nothing is kept without the cache.
+  vtkSpyPlotUniReader::SetCacheSize(0);
+  Show(reader.GetPointer(), 0, 0, 0, 0, "without the cache", status);
+  reader->MarkCellFieldDataFixed(0, 0);
+  Show(reader.GetPointer(), 1, 0, 0, 0, "without the cache", status);
+  Show(reader.GetPointer(), 0, 0, 0, 0, "without the cache", status);
+
+  // Once the file is written again, the arrays of the previous version are
+  // not used. The modification times of files may only have a resolution
+  // of a second or two.
+  vtkSpyPlotUniReader::SetCacheSize(256);
+  reader->MarkCellFieldDataFixed(0, 0);
+  Show(reader.GetPointer(), 1, 0, 0, 0, "before writing again", status);
+  vtksys::SystemTools::Delay(2100);
+  if (!WriteFile(fileName, 1))
+    {
+    cerr << "Cannot write " << fileName << " again" << endl;
+    status = false;
+    }
+  Show(reader.GetPointer(), 0, 0, 1, 0, "file written again", status);
+
+  vtksys::SystemTools::RemoveFile(fileName.c_str());
+  return status? EXIT_SUCCESS : EXIT_FAILURE;
+}
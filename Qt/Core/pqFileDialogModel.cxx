@@ -309,6 +309,8 @@ public:
         helper->GetProperty("WorkingDirectory"), workingDir);
       pqSMAdaptor::setElementProperty(
         helper->GetProperty("DirectoryListing"), dirListing);
+      pqSMAdaptor::setElementProperty(
+        helper->GetProperty("CompactListing"), dirListing);
       pqSMAdaptor::setElementProperty(
         helper->GetProperty("Path"), path.toLatin1().data());
       pqSMAdaptor::setElementProperty(
@@ -324,6 +326,7 @@ public:
       {
       vtkPVFileInformationHelper* helper = this->FileInformationHelper;
       helper->SetDirectoryListing(dirListing);
+      helper->SetCompactListing(dirListing);
       helper->SetPath(path.toLatin1().data());
       helper->SetSpecialDirectories(specialDirs);
       helper->SetWorkingDirectory(workingDir.toLatin1().data());
@@ -341,47 +344,44 @@ public:
     QList<pqFileDialogModelFileInfo> dirs;
     QList<pqFileDialogModelFileInfo> files;
 
-    vtkSmartPointer<vtkCollectionIterator> iter;
-    iter.TakeReference(dir->GetContents()->NewIterator());
+    QString prefix = dir->GetFullPath();
+    if (!prefix.isEmpty() && !prefix.endsWith('/') && !prefix.endsWith('\\'))
+      {
+      prefix += this->Separator;
+      }
 
-    for (iter->InitTraversal();
-         !iter->IsDoneWithTraversal();
-         iter->GoToNextItem())
+    for (int cc = 0; cc < dir->GetNumberOfListingEntries(); ++cc)
       {
-      vtkPVFileInformation* info = vtkPVFileInformation::SafeDownCast(
-        iter->GetCurrentObject());
-      if (!info)
+      QString name = dir->GetListingEntryName(cc);
+      vtkPVFileInformation::FileTypes type =
+        static_cast<vtkPVFileInformation::FileTypes>(
+          dir->GetListingEntryType(cc));
+      bool hidden = dir->GetListingEntryHidden(cc);
+      // links (Windows shortcuts) open their target.
+      const char* target = dir->GetListingEntryTarget(cc);
+      QString filePath = target? QString(target) : prefix + name;
+      if (vtkPVFileInformation::IsDirectory(type))
         {
-        continue;
+        dirs.push_back(pqFileDialogModelFileInfo(name, filePath, type,
+            hidden));
         }
-      if (vtkPVFileInformation::IsDirectory(info->GetType()))
+      else if (type != vtkPVFileInformation::FILE_GROUP)
         {
-        dirs.push_back(pqFileDialogModelFileInfo(info->GetName(), info->GetFullPath(),
-            static_cast<vtkPVFileInformation::FileTypes>(info->GetType()),
-            info->GetHidden()));
+        files.push_back(pqFileDialogModelFileInfo(name, filePath, type,
+            hidden));
         }
-      else if (info->GetType() != vtkPVFileInformation::FILE_GROUP)
-        {
-        files.push_back(pqFileDialogModelFileInfo(info->GetName(), info->GetFullPath(),
-            static_cast<vtkPVFileInformation::FileTypes>(info->GetType()),
-            info->GetHidden()));
-        }
-      else if (info->GetType() == vtkPVFileInformation::FILE_GROUP)
+      else
         {
         QList<pqFileDialogModelFileInfo> groupFiles;
-        vtkSmartPointer<vtkCollectionIterator> childIter;
-        childIter.TakeReference(info->GetContents()->NewIterator());
-        for (childIter->InitTraversal(); !childIter->IsDoneWithTraversal();
-          childIter->GoToNextItem())
+        int numFiles = dir->GetNumberOfListingGroupFiles(cc);
+        for (int file = 0; file < numFiles; ++file)
           {
-          vtkPVFileInformation* child = vtkPVFileInformation::SafeDownCast(
-            childIter->GetCurrentObject());
-          groupFiles.push_back(pqFileDialogModelFileInfo(child->GetName(), child->GetFullPath(),
-            static_cast<vtkPVFileInformation::FileTypes>(child->GetType()),
-            child->GetHidden()));
+          QString fileName = dir->GetListingGroupFileName(cc, file);
+          groupFiles.push_back(pqFileDialogModelFileInfo(fileName,
+              prefix + fileName, vtkPVFileInformation::SINGLE_FILE, hidden));
           }
-        files.push_back(pqFileDialogModelFileInfo(info->GetName(), groupFiles[0].filePath(),
-          vtkPVFileInformation::SINGLE_FILE,info->GetHidden(), groupFiles));
+        files.push_back(pqFileDialogModelFileInfo(name, groupFiles[0].filePath(),
+          vtkPVFileInformation::SINGLE_FILE, hidden, groupFiles));
         }
       }
 
@@ -481,6 +481,128 @@ void outputFunction(FILE *fp, ClassInfo *data)
 #endif
 }
 
+//--------------------------------------------------------------------------nix
+/*
+ * isDispatchedFunction returns true if outputFunction generates a wrapper
+ * for the given function, i.e. if the function is wrappable, its arguments
+ * are manageable and it is neither a constructor nor a destructor.
+ */
+int isDispatchedFunction(ClassInfo *data, FunctionInfo *curFunction)
+{
+  return (!notWrappable(curFunction) &&
+          managableArguments(curFunction) &&
+          strcmp(data->Name,curFunction->Name) &&
+          strcmp(data->Name,curFunction->Name + 1));
+}
+
+static int methodNameCmp(const void *name1, const void *name2)
+{
+  return strcmp(*(const char* const*)name1, *(const char* const*)name2);
+}
+
+//--------------------------------------------------------------------------nix
+/*
+ * outputDispatch writes the method handling code of the command function.
+ * Instead of testing every wrapped method in turn with strcmp, the unique
+ * method names are emitted in a sorted table which is binary-searched at run
+ * time; a switch on the resulting index then only tests the overloads of the
+ * requested method. Overloads keep their declaration order so that overload
+ * resolution is unchanged.
+ *
+ * @param fp the output file
+ * @param data the class being wrapped
+ */
+void outputDispatch(FILE *fp, ClassInfo *data)
+{
+  int i, j;
+  int numberOfNames = 0;
+  const char **names;
+
+  if (data->NumberOfFunctions == 0)
+    {
+    return;
+    }
+
+  names = (const char**)malloc(sizeof(const char*)*data->NumberOfFunctions);
+  for (i = 0; i < data->NumberOfFunctions; i++)
+    {
+    if (isDispatchedFunction(data, data->Functions[i]))
+      {
+      names[numberOfNames++] = data->Functions[i]->Name;
+      }
+    }
+  qsort(names, numberOfNames, sizeof(const char*), methodNameCmp);
+
+  /* remove duplicates (overloads) */
+  for (i = 0, j = 0; i < numberOfNames; i++)
+    {
+    if (j == 0 || strcmp(names[j-1], names[i]) != 0)
+      {
+      names[j++] = names[i];
+      }
+    }
+  numberOfNames = j;
+
+  if (numberOfNames == 0)
+    {
+    free(names);
+    return;
+    }
+
+  fprintf(fp, "  static const char* const methodNames[%i] =\n    {\n",
+          numberOfNames);
+  for (i = 0; i < numberOfNames; i++)
+    {
+    fprintf(fp, "    \"%s\",\n", names[i]);
+    }
+  fprintf(fp, "    };\n");
+  fprintf(fp,
+          "  int methodIndex = -1;\n"
+          "  int methodLow = 0;\n"
+          "  int methodHigh = %i;\n"
+          "  while (methodLow <= methodHigh)\n"
+          "    {\n"
+          "    int methodMid = (methodLow + methodHigh) / 2;\n"
+          "    int methodCmp = strcmp(method, methodNames[methodMid]);\n"
+          "    if (methodCmp == 0)\n"
+          "      {\n"
+          "      methodIndex = methodMid;\n"
+          "      break;\n"
+          "      }\n"
+          "    else if (methodCmp < 0)\n"
+          "      {\n"
+          "      methodHigh = methodMid - 1;\n"
+          "      }\n"
+          "    else\n"
+          "      {\n"
+          "      methodLow = methodMid + 1;\n"
+          "      }\n"
+          "    }\n"
+          "  switch (methodIndex)\n"
+          "    {\n",
+          numberOfNames - 1);
+
+  for (j = 0; j < numberOfNames; j++)
+    {
+    fprintf(fp, "    case %i: /* %s */\n", j, names[j]);
+    for (i = 0; i < data->NumberOfFunctions; i++)
+      {
+      currentFunction = data->Functions[i];
+      if (isDispatchedFunction(data, currentFunction) &&
+          strcmp(currentFunction->Name, names[j]) == 0)
+        {
+        outputFunction(fp, data);
+        }
+      }
+    fprintf(fp, "    break;\n");
+    }
+  fprintf(fp,
+          "    default:\n"
+          "    break;\n"
+          "    }\n");
+  free(names);
+}
+
 //--------------------------------------------------------------------------nix
 /*
  * This structure is used internally to sort+collect individual functions.
@@ -1306,11 +1428,7 @@ int main(int argc, char *argv[])
   /*fprintf(fp,"  vtkClientServerStream resultStream;\n");*/
 
   /* insert function handling code here */
-  for (i = 0; i < data->NumberOfFunctions; i++)
-    {
-    currentFunction = data->Functions[i];
-    outputFunction(fp, data);
-    }
+  outputDispatch(fp, data);
 
   /* try superclasses */
   for (i = 0; i < data->NumberOfSuperClasses; i++)
@@ -52,9 +52,12 @@ public:
     vtkSmartPointer<vtkUnsignedCharArray> Data;
     bool NeedsRender;
     bool HasImagesBeingProcessed;
+    // Image without Base64 encoding, see StillRenderToBuffer().
+    vtkSmartPointer<vtkUnsignedCharArray> RawData;
+    bool RawNeedsRender;
     vtkObject* ViewPointer;
     unsigned long ObserverId;
-    ImageCacheValueType() : NeedsRender(true), HasImagesBeingProcessed(false), ViewPointer(NULL), ObserverId(0) { }
+    ImageCacheValueType() : NeedsRender(true), HasImagesBeingProcessed(false), RawNeedsRender(true), ViewPointer(NULL), ObserverId(0) { }
 
     void SetListener(vtkObject* view)
     {
@@ -88,6 +91,7 @@ public:
     void ViewEventListener(vtkObject*, unsigned long, void*)
     {
       this->NeedsRender = true;
+      this->RawNeedsRender = true;
     }
     };
   typedef std::map<void*, ImageCacheValueType> ImageCacheType;
@@ -104,6 +108,7 @@ public:
     public:
       int ObjIndex;
       std::map<int, std::string> BinaryParts;
+      std::map<int, vtkSmartPointer<vtkUnsignedCharArray> > RawBinaryParts;
     };
   // map for <vtkWebGLExporter, <webgl-objID, WebGLObjCacheValue> >
   typedef std::map<std::string, WebGLObjCacheValue> WebGLObjId2IndexMap;
@@ -147,6 +152,7 @@ vtkUnsignedCharArray* vtkPVWebApplication::InteractiveRender(vtkSMViewProxy* vie
 void vtkPVWebApplication::InvalidateCache(vtkSMViewProxy* view)
 {
   this->Internals->ImageCache[view].NeedsRender = true;
+  this->Internals->ImageCache[view].RawNeedsRender = true;
 }
 
 //----------------------------------------------------------------------------
@@ -216,6 +222,78 @@ const char* vtkPVWebApplication::StillRenderToString(vtkSMViewProxy* view, unsig
   return NULL;
 }
 
+//----------------------------------------------------------------------------
+vtkUnsignedCharArray* vtkPVWebApplication::InteractiveRenderToBuffer(vtkSMViewProxy* view, int quality)
+{
+  vtkUnsignedCharArray* array = this->StillRenderToBuffer(view, 0, quality);
+  return array? array : this->Internals->ImageCache[view].RawData.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+vtkUnsignedCharArray* vtkPVWebApplication::StillRenderToBuffer(vtkSMViewProxy* view, unsigned long time, int quality)
+{
+  if (!view)
+    {
+    vtkErrorMacro("No view specified.");
+    return NULL;
+    }
+
+  vtkInternals::ImageCacheValueType& value = this->Internals->ImageCache[view];
+  value.SetListener(view);
+
+  if (value.RawNeedsRender || value.RawData == NULL || view->GetNeedsUpdate())
+    {
+    vtkImageData* image = view->CaptureWindow(1);
+    image->GetDimensions(this->LastStillRenderImageSize);
+
+    // A new array for every image, so that its MTime identifies the image.
+    vtkSmartPointer<vtkUnsignedCharArray> data;
+    switch (this->ImageCompression)
+      {
+    case COMPRESSION_JPEG:
+        {
+        vtkNew<vtkJPEGWriter> writer;
+        writer->SetInputData(image);
+        writer->SetQuality(quality);
+        writer->WriteToMemoryOn();
+        writer->Write();
+        data = writer->GetResult();
+        }
+      break;
+
+    case COMPRESSION_PNG:
+        {
+        vtkNew<vtkPNGWriter> writer;
+        writer->SetInputData(image);
+        writer->WriteToMemoryOn();
+        writer->Write();
+        data = writer->GetResult();
+        }
+      break;
+
+    default:
+      data = vtkUnsignedCharArray::SafeDownCast(
+        image->GetPointData()->GetScalars());
+      }
+    image->Delete();
+
+    if (data == NULL)
+      {
+      vtkErrorMacro("Failed to compress the image of view : " << view);
+      return NULL;
+      }
+    value.RawData = data;
+    value.RawNeedsRender = false;
+    }
+
+  if (value.RawData->GetMTime() != time)
+    {
+    this->LastStillRenderToStringMTime = value.RawData->GetMTime();
+    return value.RawData;
+    }
+  return NULL;
+}
+
 //----------------------------------------------------------------------------
 bool vtkPVWebApplication::HandleInteractionEvent(
   vtkSMViewProxy* view, vtkWebInteractionEvent* event)
@@ -288,6 +366,7 @@ bool vtkPVWebApplication::HandleInteractionEvent(
 
   bool needs_render = (changed_buttons != 0 || event->GetButtons());
   this->Internals->ImageCache[view].NeedsRender = needs_render;
+  this->Internals->ImageCache[view].RawNeedsRender = needs_render;
   return needs_render;
 }
 
@@ -350,7 +429,7 @@ const char* vtkPVWebApplication::GetWebGLSceneMetaData(vtkSMViewProxy* view)
 }
 
 //----------------------------------------------------------------------------
-const char* vtkPVWebApplication::GetWebGLBinaryData(
+vtkUnsignedCharArray* vtkPVWebApplication::GetWebGLBinaryBuffer(
   vtkSMViewProxy* view, const char* id, int part)
 {
   if (!view)
@@ -383,26 +462,51 @@ const char* vtkPVWebApplication::GetWebGLBinaryData(
       &(this->Internals->WebGLExporterObjIdMap[webglExporter][id]);
     if(cachedVal->BinaryParts.find(part) != cachedVal->BinaryParts.end())
       {
-      if(cachedVal->BinaryParts[part].empty())
+      vtkSmartPointer<vtkUnsignedCharArray>& raw =
+        cachedVal->RawBinaryParts[part];
+      if(raw == NULL)
         {
         vtkWebGLObject* obj = webglExporter->GetWebGLObject(cachedVal->ObjIndex);
         if(obj && obj->isVisible())
           {
-          // Manage Base64
-          vtkNew<vtkBase64Utilities> base64;
-          unsigned char* output = new unsigned char[obj->GetBinarySize(part)*2];
-          int size = base64->Encode(
-            obj->GetBinaryData(part), obj->GetBinarySize(part), output, false);
-          cachedVal->BinaryParts[part] = std::string((const char *)output, size);
-          delete[] output;
+          // Refer to the object's memory, save=1 so that it is not freed.
+          raw = vtkSmartPointer<vtkUnsignedCharArray>::New();
+          raw->SetArray(obj->GetBinaryData(part), obj->GetBinarySize(part), 1);
           }
         }
-      return cachedVal->BinaryParts[part].c_str();
+      return raw;
       }
     }
 
   return NULL;
 }
+
+//----------------------------------------------------------------------------
+const char* vtkPVWebApplication::GetWebGLBinaryData(
+  vtkSMViewProxy* view, const char* id, int part)
+{
+  vtkUnsignedCharArray* raw = this->GetWebGLBinaryBuffer(view, id, part);
+  if(raw == NULL)
+    {
+    return NULL;
+    }
+
+  vtkWebGLExporter* webglExporter = this->Internals->ViewWebGLMap[view];
+  std::string& encoded =
+    this->Internals->WebGLExporterObjIdMap[webglExporter][id].BinaryParts[part];
+  if(encoded.empty())
+    {
+    // Manage Base64
+    vtkNew<vtkBase64Utilities> base64;
+    unsigned char* output = new unsigned char[raw->GetNumberOfTuples()*2];
+    int size = base64->Encode(
+      raw->GetPointer(0), raw->GetNumberOfTuples(), output, false);
+    encoded = std::string((const char *)output, size);
+    delete[] output;
+    }
+  return encoded.c_str();
+}
+
 //----------------------------------------------------------------------------
 void vtkPVWebApplication::PrintSelf(ostream& os, vtkIndent indent)
 {
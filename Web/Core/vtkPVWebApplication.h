@@ -62,6 +62,18 @@ public:
   vtkUnsignedCharArray* InteractiveRender(vtkSMViewProxy* view, int quality = 50);
   const char* StillRenderToString(vtkSMViewProxy* view, unsigned long time = 0, int quality = 100);
 
+  // Description:
+  // Render a view and obtain the rendered image compressed as set by
+  // ImageCompression, but never Base64 encoded, irrespective of ImageEncoding.
+  // This is meant for clients that receive images as binary WebSocket
+  // messages: the payload is a third smaller than the Base64 one and it is
+  // not copied again. StillRenderToBuffer() returns NULL when the image did
+  // not change since the one with the given MTime.
+  // Unlike StillRender(), the image is compressed in the calling thread, so
+  // the image returned always corresponds to the current state of the view.
+  vtkUnsignedCharArray* StillRenderToBuffer(vtkSMViewProxy* view, unsigned long time = 0, int quality = 100);
+  vtkUnsignedCharArray* InteractiveRenderToBuffer(vtkSMViewProxy* view, int quality = 50);
+
   // Description:
   // StillRenderToString() need not necessary returns the most recently rendered
   // image. Use this method to get whether there are any pending images being
@@ -79,7 +91,8 @@ public:
   void InvalidateCache(vtkSMViewProxy* view);
 
   // Description:
-  // Return the MTime of the last array exported by StillRenderToString.
+  // Return the MTime of the last array exported by StillRenderToString or
+  // StillRenderToBuffer.
   vtkGetMacro(LastStillRenderToStringMTime, unsigned long);
 
   // Description:
@@ -94,6 +107,13 @@ public:
   const char* GetWebGLBinaryData(
     vtkSMViewProxy* view, const char* id, int partIndex);
 
+  // Description:
+  // Same as GetWebGLBinaryData() but returns the binary data as is, without
+  // Base64 encoding. The array refers to the memory of the webGL object and
+  // is only valid until the next call to GetWebGLSceneMetaData().
+  vtkUnsignedCharArray* GetWebGLBinaryBuffer(
+    vtkSMViewProxy* view, const char* id, int partIndex);
+
   // Description:
   // Return the size of the last image exported.
   vtkGetVector2Macro(LastStillRenderImageSize, int);
@@ -11,6 +11,42 @@ of spheres and moves the camera around the scene.  To run the benchmark,
 either explicitly import manyspheres from paraview.benchmark and call it's
 run method, or call the manyspheres.py module directly via pvbatch or pvpython.
 
+fileseries is an I/O benchmark that plays back a synthetic file series with and
+without prefetching of upcoming time steps and reports frames per second.
+
+webimages is a ParaViewWeb image delivery benchmark that interacts with a
+render view and reports the bytes per frame and the latency of base64 and
+binary image delivery.
+
+histogram measures the throughput of vtkExtractHistogram on float, double
+and int arrays.
+
+ensight reads time steps across a single file transient EnSight Gold case
+with and without the offset index of the parallel EnSight reader and reports
+the seconds needed to read each one.
+
+spyplot reads a synthetic SpyPlot file across time steps and cell array
+selections with and without the cache of decoded arrays of the SpyPlot
+reader and reports the seconds needed by each update.
+
+lod builds the levels of detail of a large surface in a geometry
+representation and reports the build time and the number of triangles of
+each level.
+
+calculator evaluates typical Calculator functions over a point cloud, with
+the functions interpreted point by point and compiled, and reports millions
+of points per second for both.
+
+fragments extracts the fragments of a material from an AMR fractal with the
+Material Interface filter, with the blocks labeled serially and concurrently,
+and reports the seconds needed by each.
+
+histogram, calculator and fragments measure code running concurrently through
+vtkSMPTools, so their results depend on the SMP backend ParaView is built
+with and on the number of threads it uses, e.g. OMP_NUM_THREADS for the
+OpenMP backend. Running them with one thread, and against older ParaView
+versions, gives the baseline to compare with.
+
 ::
 
     TODO: this doesn't handle split render/data server mode
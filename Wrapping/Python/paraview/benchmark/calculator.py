@@ -0,0 +1,103 @@
+'''
+Calculator benchmark.
+
+Evaluates typical Calculator functions over the points of a point cloud with
+vtkPVArrayCalculator, with the functions interpreted one point at a time by
+vtkFunctionParser and compiled by vtkPVCompiledExpression (see
+vtkPVArrayCalculator::SetUseCompiledExpressions()), and reports millions of
+points per second and the speedup of each function.
+
+Compiled functions are evaluated concurrently, see the paraview.benchmark
+package about threads. To run the benchmark, either import calculator from
+paraview.benchmark and call its run method, or run this module directly via
+pvpython.
+'''
+
+import datetime as dt
+import sys
+
+import paraview
+
+__FUNCTIONS = (
+    'Pressure*2+1',
+    'mag(Velocity)',
+    'sqrt(coordsX^2+coordsY^2+coordsZ^2)',
+    'Velocity.coords',
+    'norm(cross(Velocity,coords))',
+    'sin(Pressure)*iHat+exp(-abs(Pressure))*jHat+max(coordsZ,0)*kHat',
+    'coords+0.01*Velocity',
+)
+
+
+def __make_points(npoints):
+    '''Returns a polydata of npoints random points with a scalar point
+    array, Pressure, and a vector point array, Velocity.'''
+    from vtk.vtkFiltersSources import vtkPointSource
+    from vtk.vtkPVVTKExtensionsDefault import vtkPVArrayCalculator
+
+    source = vtkPointSource()
+    source.SetNumberOfPoints(npoints)
+    source.SetRadius(1)
+    source.Update()
+    points = source.GetOutput()
+
+    for name, function in (('Pressure', 'coordsX*coordsY-coordsZ'),
+                           ('Velocity', '-coordsY*iHat+coordsX*jHat+kHat')):
+        calculator = vtkPVArrayCalculator()
+        calculator.SetInputData(points)
+        calculator.SetResultArrayName(name)
+        calculator.SetFunction(function)
+        calculator.Update()
+        points = calculator.GetOutput()
+    return points
+
+
+def __time_function(points, function, compiled, nloops):
+    '''Returns the seconds per evaluation of function.'''
+    from vtk.vtkPVVTKExtensionsDefault import vtkPVArrayCalculator
+
+    calculator = vtkPVArrayCalculator()
+    calculator.SetInputData(points)
+    calculator.SetResultArrayName('Result')
+    calculator.SetFunction(function)
+    calculator.SetUseCompiledExpressions(compiled)
+
+    c1 = dt.datetime.now()
+    for i in range(nloops):
+        calculator.Modified()
+        calculator.Update()
+    return (dt.datetime.now() - c1).total_seconds() / nloops
+
+
+def run(npoints=1000000, nloops=3, filename=None):
+    '''Runs the benchmark. If a filename is specified, the results are
+    written to that file as csv.
+    '''
+    paraview.servermanager.SetProgressPrintingEnabled(0)
+
+    points = __make_points(npoints)
+    results = []
+    for function in __FUNCTIONS:
+        interpreted = __time_function(points, function, False, nloops)
+        compiled = __time_function(points, function, True, nloops)
+        results.append((function, npoints / interpreted / 1e6,
+            npoints / compiled / 1e6, interpreted / compiled))
+
+    for result in results:
+        print '============================================================'
+        print result[0]
+        print result[1], ' Mpoints/s interpreted'
+        print result[2], ' Mpoints/s compiled'
+        print result[3], ' speedup'
+
+    if filename:
+        f = open(filename, "w")
+    else:
+        f = sys.stdout
+    print >>f, 'function, interpreted (Mpoints/s), compiled (Mpoints/s), speedup'
+    for result in results:
+        print >>f, '"%s", %g, %g, %g' % result
+
+
+if __name__ == "__main__":
+    run()
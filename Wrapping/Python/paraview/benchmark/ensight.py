@@ -0,0 +1,134 @@
+'''
+EnSight random access benchmark.
+
+Writes an EnSight Gold binary case with a point array stored as single file
+transient data, i.e. all the time steps in one file, then reads time steps
+across the file, each with a new reader as when the data is opened again, and
+reports the seconds needed to read each one. Without the offset index, see
+UseOffsetIndexFile in vtkPGenericEnSightReader, the file is scanned from its
+beginning up to the requested time step, so the time grows with the step.
+With the index, built once by reading the last time step, it stays flat.
+
+Uses vtkPEnSightGoldBinaryReader, the reader ParaView uses when running in
+parallel. To run the benchmark, either import ensight from paraview.benchmark
+and call its run method, or run this module directly via pvpython.
+'''
+
+import datetime as dt
+import os
+import shutil
+import struct
+import sys
+import tempfile
+
+import paraview
+
+
+def __line(f, text):
+    f.write(struct.pack('80s', text))
+
+
+def __write_case(directory, npoints, nsteps):
+    '''Writes the case and returns its file name.'''
+    geo = open(os.path.join(directory, 'points.geo'), 'wb')
+    __line(geo, 'C Binary')
+    __line(geo, 'BEGIN TIME STEP')
+    __line(geo, 'EnSight random access benchmark')
+    __line(geo, 'points')
+    __line(geo, 'node id off')
+    __line(geo, 'element id off')
+    __line(geo, 'part')
+    geo.write(struct.pack('i', 1))
+    __line(geo, 'points')
+    __line(geo, 'coordinates')
+    geo.write(struct.pack('i', npoints))
+    geo.write(struct.pack('%df' % npoints, *range(npoints)))
+    geo.write(struct.pack('%df' % npoints, *([0.0] * npoints)))
+    geo.write(struct.pack('%df' % npoints, *([0.0] * npoints)))
+    __line(geo, 'point')
+    geo.write(struct.pack('i', npoints))
+    geo.write(struct.pack('%di' % npoints, *range(1, npoints + 1)))
+    __line(geo, 'END TIME STEP')
+    geo.close()
+
+    scl = open(os.path.join(directory, 'value.scl'), 'wb')
+    for step in range(nsteps):
+        __line(scl, 'BEGIN TIME STEP')
+        __line(scl, 'value')
+        __line(scl, 'part')
+        scl.write(struct.pack('i', 1))
+        __line(scl, 'coordinates')
+        scl.write(struct.pack('%df' % npoints, *([float(step)] * npoints)))
+        __line(scl, 'END TIME STEP')
+    scl.close()
+
+    casename = os.path.join(directory, 'points.case')
+    case = open(casename, 'w')
+    case.write('FORMAT\ntype: ensight gold\n\n')
+    case.write('GEOMETRY\nmodel: points.geo\n\n')
+    case.write('VARIABLE\nscalar per node: 1 1 value value.scl\n\n')
+    case.write('TIME\ntime set: 1\nnumber of steps: %d\ntime values:\n' % nsteps)
+    for step in range(nsteps):
+        case.write('%d\n' % step)
+    case.write('\nFILE\nfile set: 1\nnumber of steps: %d\n' % nsteps)
+    case.close()
+    return casename
+
+
+def __time_step(casename, step, index):
+    '''Returns the seconds needed to open the case and read step.'''
+    from vtk.vtkPVVTKExtensionsDefault import vtkPEnSightGoldBinaryReader
+
+    c1 = dt.datetime.now()
+    reader = vtkPEnSightGoldBinaryReader()
+    reader.SetCaseFileName(casename)
+    reader.SetUseOffsetIndexFile(index)
+    reader.UpdateInformation()
+    reader.SetTimeValue(step)
+    reader.Update()
+    seconds = (dt.datetime.now() - c1).total_seconds()
+
+    block = reader.GetOutput().GetBlock(0)
+    value = block.GetPointData().GetArray('value').GetValue(0)
+    if value != step:
+        raise RuntimeError('read %g instead of time step %d' % (value, step))
+    return seconds
+
+
+def run(npoints=1000, nsteps=20000, nsamples=5, filename=None):
+    '''Runs the benchmark. If a filename is specified, the results are
+    written to that file as csv.
+    '''
+    paraview.servermanager.SetProgressPrintingEnabled(0)
+
+    directory = tempfile.mkdtemp()
+    try:
+        casename = __write_case(directory, npoints, nsteps)
+        steps = [(nsteps - 1) * i / max(nsamples - 1, 1) for i in range(nsamples)]
+
+        results = []
+        for index in (0, 1):
+            if index:
+                # builds the index, as a first read of the data would.
+                __time_step(casename, nsteps - 1, 1)
+            for step in steps:
+                seconds = __time_step(casename, step, index)
+                print '============================================================'
+                print 'offset index: %s' % ('on' if index else 'off')
+                print 'time step: %d' % step
+                print seconds, ' seconds'
+                results.append(('on' if index else 'off', step, seconds))
+    finally:
+        shutil.rmtree(directory)
+
+    if filename:
+        f = open(filename, "w")
+    else:
+        f = sys.stdout
+    print >>f, 'offset index, time step, seconds'
+    for result in results:
+        print >>f, '%s, %d, %g' % result
+
+
+if __name__ == "__main__":
+    run()
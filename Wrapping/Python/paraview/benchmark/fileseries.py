@@ -0,0 +1,103 @@
+'''
+File series playback benchmark.
+
+Writes a synthetic series of legacy VTK files, then plays it back through the
+animation scene with and without prefetching of upcoming time steps (see the
+AnimationPrefetchTimeSteps general setting) and reports frames per second.
+
+Prefetching hides the time spent waiting on the file system, so the difference
+is only visible when the files are not already in the operating system's file
+cache, for instance when the series is written to a network file system, or
+after the file cache has been dropped between the runs. To run the benchmark,
+either import fileseries from paraview.benchmark and call its run method, or
+run this module directly via pvbatch or pvpython.
+'''
+
+import datetime as dt
+import os
+import shutil
+import sys
+import tempfile
+
+import paraview
+from paraview import servermanager
+from paraview.simple import *
+
+
+def __write_series(directory, ntimesteps, extent):
+    '''Writes ntimesteps files of a wavelet, each with a different maximum so
+    that the data actually changes from one time step to the next.'''
+    files = []
+    wavelet = Wavelet(WholeExtent=[-extent, extent] * 3)
+    for i in range(ntimesteps):
+        wavelet.Maximum = 255.0 + i
+        fname = os.path.join(directory, 'wavelet_%04d.vtk' % i)
+        SaveData(fname, proxy=wavelet, FileType='Binary')
+        files.append(fname)
+    Delete(wavelet)
+    return files
+
+
+def __play(files, prefetch, nloops):
+    '''Plays the series nloops times and returns the frames per second.'''
+    settings = servermanager.ProxyManager().GetProxy('settings', 'GeneralSettings')
+    settings.AnimationPrefetchTimeSteps = prefetch
+
+    reader = OpenDataFile(files)
+    contour = Contour(Input=reader, ContourBy=['POINTS', 'RTData'],
+                      Isosurfaces=[157.0])
+    Show(contour)
+    Render()
+
+    scene = GetAnimationScene()
+    scene.UpdateAnimationUsingDataTimeSteps()
+    scene.PlayMode = 'Snap To TimeSteps'
+    scene.Loop = 0
+
+    nframes = 0
+    c1 = dt.datetime.now()
+    for i in range(nloops):
+        scene.Play()
+        nframes += len(files)
+    elapsed = (dt.datetime.now() - c1).total_seconds()
+
+    Delete(contour)
+    Delete(reader)
+    return nframes / elapsed if elapsed > 0 else 0.0
+
+
+def run(directory=None, ntimesteps=50, extent=64, prefetch=4, nloops=1,
+        filename=None):
+    '''Runs the benchmark. The series is written in a temporary directory
+    unless one is specified, and removed afterwards in that case. If a
+    filename is specified, the results are written to that file as csv.
+    '''
+    paraview.servermanager.SetProgressPrintingEnabled(0)
+
+    cleanup = directory is None
+    if cleanup:
+        directory = tempfile.mkdtemp(prefix='pvfileseries')
+    try:
+        files = __write_series(directory, ntimesteps, extent)
+        results = []
+        for steps in (0, prefetch):
+            fps = __play(files, steps, nloops)
+            print '============================================================'
+            print 'prefetch time steps: %d' % steps
+            print fps, ' frames/sec'
+            results.append((steps, fps))
+    finally:
+        if cleanup:
+            shutil.rmtree(directory, ignore_errors=True)
+
+    if filename:
+        f = open(filename, "w")
+    else:
+        f = sys.stdout
+    print >>f, 'prefetch time steps, frames/sec'
+    for steps, fps in results:
+        print >>f, '%d, %g' % (steps, fps)
+
+
+if __name__ == "__main__":
+    run()
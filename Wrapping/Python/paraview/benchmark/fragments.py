@@ -0,0 +1,125 @@
+'''
+Fragments benchmark.
+
+Extracts the fragments of a material from an AMR data set made with
+vtkHierarchicalFractal with vtkMaterialInterfaceFilter, with the blocks
+labeled one after the other and concurrently (see
+vtkMaterialInterfaceFilter::SetThreadedLabeling()), and reports the seconds
+needed by each and the number of fragments found.
+
+Blocks are labeled concurrently, see the paraview.benchmark package about
+threads. To run the benchmark, either import fragments from
+paraview.benchmark and call its run method, or run this module directly via
+pvpython.
+'''
+
+import datetime as dt
+import sys
+
+import paraview
+
+
+def __make_material(dimensions, levels):
+    '''Returns a vtkNonOverlappingAMR with the blocks of a 3D fractal and an
+    unsigned char volume fraction cell array, Material, and a mass cell
+    array, Mass.'''
+    from vtk.vtkCommonCore import vtkDoubleArray, vtkUnsignedCharArray
+    from vtk.vtkCommonDataModel import vtkNonOverlappingAMR, vtkUniformGrid
+    from vtk.vtkPVVTKExtensionsDefault import vtkHierarchicalFractal
+
+    fractal = vtkHierarchicalFractal()
+    fractal.SetDimensions(dimensions)
+    fractal.SetMaximumLevel(levels)
+    fractal.SetGhostLevels(0)
+    fractal.SetTwoDimensional(0)
+    fractal.SetAsymetric(0)
+    fractal.SetOverlap(0)
+    fractal.Update()
+    output = fractal.GetOutputDataObject(0)
+
+    nlevels = output.GetNumberOfLevels()
+    nblocks = [output.GetNumberOfDataSets(level) for level in range(nlevels)]
+    amr = vtkNonOverlappingAMR()
+    amr.Initialize(nlevels, nblocks)
+    for level in range(nlevels):
+        for idx in range(nblocks[level]):
+            grid = output.GetDataSet(level, idx)
+            if not grid:
+                continue
+            fraction = grid.GetCellData().GetArray('Fractal Volume Fraction')
+            spacing = grid.GetSpacing()
+            volume = spacing[0] * spacing[1] * spacing[2]
+            ncells = grid.GetNumberOfCells()
+            material = vtkUnsignedCharArray()
+            material.SetName('Material')
+            material.SetNumberOfTuples(ncells)
+            mass = vtkDoubleArray()
+            mass.SetName('Mass')
+            mass.SetNumberOfTuples(ncells)
+            for i in range(ncells):
+                value = min(max(fraction.GetTuple1(i), 0.0), 1.0)
+                material.SetValue(i, int(value * 255 + 0.5))
+                mass.SetValue(i, 2 * value * volume)
+            block = vtkUniformGrid()
+            block.CopyStructure(grid)
+            block.GetCellData().AddArray(material)
+            block.GetCellData().AddArray(mass)
+            amr.SetDataSet(level, idx, block)
+    return amr
+
+
+def __time_filter(amr, threaded, nloops):
+    '''Returns the seconds per update of the filter and the number of
+    fragments.'''
+    from vtk.vtkPVVTKExtensionsDefault import vtkMaterialInterfaceFilter
+
+    filter = vtkMaterialInterfaceFilter()
+    filter.SetInputData(amr)
+    filter.SelectMaterialArray('Material')
+    filter.SelectMassArray('Mass')
+    filter.SetBlockGhostLevel(0)
+    filter.SetThreadedLabeling(threaded)
+
+    c1 = dt.datetime.now()
+    for i in range(nloops):
+        filter.Modified()
+        filter.Update()
+    seconds = (dt.datetime.now() - c1).total_seconds() / nloops
+    fragments = filter.GetOutputDataObject(1).GetBlock(0).GetNumberOfPoints()
+    return seconds, fragments
+
+
+def run(dimensions=16, levels=(3, 4, 5), nloops=3, filename=None):
+    '''Runs the benchmark for fractals refined up to each of the given
+    levels. If a filename is specified, the results are written to that
+    file as csv.
+    '''
+    paraview.servermanager.SetProgressPrintingEnabled(0)
+
+    results = []
+    for level in levels:
+        amr = __make_material(dimensions, level)
+        serial, fragments = __time_filter(amr, False, nloops)
+        threaded, ignored = __time_filter(amr, True, nloops)
+        results.append((level, amr.GetTotalNumberOfBlocks(), fragments,
+            serial, threaded, serial / threaded))
+
+    for result in results:
+        print '============================================================'
+        print 'Level ', result[0], ', ', result[1], ' blocks'
+        print result[2], ' fragments'
+        print result[3], ' seconds serial'
+        print result[4], ' seconds threaded'
+        print result[5], ' speedup'
+
+    if filename:
+        f = open(filename, "w")
+    else:
+        f = sys.stdout
+    print >>f, 'level, blocks, fragments, serial (s), threaded (s), speedup'
+    for result in results:
+        print >>f, '%d, %d, %d, %g, %g, %g' % result
+
+
+if __name__ == "__main__":
+    run()
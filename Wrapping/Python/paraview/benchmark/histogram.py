@@ -0,0 +1,113 @@
+'''
+Histogram benchmark.
+
+Bins float, double and int point arrays of an image with vtkExtractHistogram,
+with and without the averages of the other arrays, and reports millions of
+values binned per second and the speedup over the serial binning that reads
+one value at a time (see vtkExtractHistogram::SetUseConcurrentBinning()).
+numpy.histogram on the same values is reported as a reference.
+
+vtkExtractHistogram bins concurrently, see the paraview.benchmark package
+about threads. Requires numpy. To run the benchmark, either import histogram
+from paraview.benchmark and call its run method, or run this module directly
+via pvpython.
+'''
+
+import datetime as dt
+import sys
+
+import paraview
+
+
+def __make_image(npoints):
+    '''Returns an image with a float, a double, an int and a 3-component
+    float array of npoints random values.'''
+    import numpy
+    from vtk import vtkImageData
+    from vtk.util import numpy_support
+
+    image = vtkImageData()
+    image.SetDimensions(npoints, 1, 1)
+    values = numpy.random.normal(size=npoints)
+    arrays = { 'float': values.astype(numpy.float32),
+               'double': values,
+               'int': (values * 1000).astype(numpy.int32),
+               'vector': numpy.random.random((npoints, 3)).astype(numpy.float32) }
+    for name, array in arrays.items():
+        vtkarray = numpy_support.numpy_to_vtk(array, deep=1)
+        vtkarray.SetName(name)
+        image.GetPointData().AddArray(vtkarray)
+    return image, arrays
+
+
+def __time_histogram(image, name, bins, averages, concurrent, nloops):
+    '''Returns the seconds per histogram of array name.'''
+    from vtk.vtkPVVTKExtensionsDefault import vtkExtractHistogram
+    from vtk.vtkCommonDataModel import vtkDataObject
+
+    histogram = vtkExtractHistogram()
+    histogram.SetInputData(image)
+    histogram.SetInputArrayToProcess(0, 0, 0,
+        vtkDataObject.FIELD_ASSOCIATION_POINTS, name)
+    histogram.SetBinCount(bins)
+    histogram.SetCalculateAverages(averages)
+    histogram.SetUseConcurrentBinning(concurrent)
+
+    c1 = dt.datetime.now()
+    for i in range(nloops):
+        histogram.Modified()
+        histogram.Update()
+    return (dt.datetime.now() - c1).total_seconds() / nloops
+
+
+def run(npoints=20000000, bins=256, nloops=5, filename=None):
+    '''Runs the benchmark. If a filename is specified, the results are
+    written to that file as csv.
+    '''
+    try:
+        import numpy
+    except ImportError:
+        print 'numpy is not available, cannot run the benchmark.'
+        return
+
+    paraview.servermanager.SetProgressPrintingEnabled(0)
+
+    image, arrays = __make_image(npoints)
+    mvalues = npoints / 1.0e6
+    results = []
+    for name in ('float', 'double', 'int'):
+        c1 = dt.datetime.now()
+        for i in range(nloops):
+            numpy.histogram(arrays[name], bins=bins)
+        reference = (dt.datetime.now() - c1).total_seconds() / nloops
+        results.append((name,
+            mvalues / __time_histogram(image, name, bins, 0, False, nloops),
+            mvalues / __time_histogram(image, name, bins, 0, True, nloops),
+            mvalues / __time_histogram(image, name, bins, 1, False, nloops),
+            mvalues / __time_histogram(image, name, bins, 1, True, nloops),
+            mvalues / reference))
+        result = results[-1]
+        print '============================================================'
+        print 'array type: %s' % name
+        print result[1], ' Mvalues/sec serial'
+        print result[2], ' Mvalues/sec (%gx)' % (result[2] / result[1])
+        print result[3], ' Mvalues/sec serial with averages'
+        print result[4], ' Mvalues/sec with averages (%gx)' % (
+            result[4] / result[3])
+        print result[5], ' Mvalues/sec numpy.histogram'
+
+    if filename:
+        f = open(filename, "w")
+    else:
+        f = sys.stdout
+    print >>f, 'array type, serial Mvalues/sec, Mvalues/sec, speedup, ' \
+        'serial Mvalues/sec with averages, Mvalues/sec with averages, ' \
+        'speedup with averages, numpy.histogram Mvalues/sec'
+    for name, serial, binned, serialavg, averaged, reference in results:
+        print >>f, '%s, %g, %g, %g, %g, %g, %g, %g' % (name, serial, binned,
+            binned / serial, serialavg, averaged, averaged / serialavg,
+            reference)
+
+
+if __name__ == "__main__":
+    run()
@@ -0,0 +1,90 @@
+'''
+Level-of-detail benchmark.
+
+Builds the levels of detail of vtkGeometryRepresentation for a surface made
+of tessellated spheres, one per block, and reports the number of triangles
+of each level, the seconds needed to build it the first time it is requested
+and the seconds needed to get it again, as the render view does when the LOD
+resolution changes.
+
+To run the benchmark, either import lod from paraview.benchmark and call its
+run method, or run this module directly via pvpython.
+'''
+
+import datetime as dt
+import sys
+
+
+def __make_surface(nblocks, resolution):
+    '''Returns a multiblock of nblocks spheres of resolution^2 quads.'''
+    from vtk.vtkCommonDataModel import vtkMultiBlockDataSet
+    from vtk.vtkFiltersSources import vtkSphereSource
+
+    surface = vtkMultiBlockDataSet()
+    for block in range(nblocks):
+        sphere = vtkSphereSource()
+        sphere.SetCenter(2.5 * block, 0, 0)
+        sphere.SetThetaResolution(resolution)
+        sphere.SetPhiResolution(resolution)
+        sphere.Update()
+        surface.SetBlock(block, sphere.GetOutput())
+    return surface
+
+
+def __count_triangles(data):
+    count = 0
+    iterator = data.NewIterator()
+    iterator.InitTraversal()
+    while not iterator.IsDoneWithTraversal():
+        count += iterator.GetCurrentDataObject().GetNumberOfCells()
+        iterator.GoToNextItem()
+    return count
+
+
+def __get_level(representation, level):
+    '''Returns the level and the seconds needed to get it.'''
+    c1 = dt.datetime.now()
+    data = representation.GetLODLevel(level)
+    return data, (dt.datetime.now() - c1).total_seconds()
+
+
+def run(nblocks=8, resolution=1024, nlevels=5, filename=None):
+    '''Runs the benchmark. If a filename is specified, the results are
+    written to that file as csv.
+    '''
+    from vtk.vtkPVClientServerCoreRendering import vtkGeometryRepresentation
+
+    surface = __make_surface(nblocks, resolution)
+    results = [('input', 'full resolution', __count_triangles(surface), 0)]
+
+    representation = vtkGeometryRepresentation()
+    representation.SetNumberOfLODLevels(nlevels)
+    representation.SetInputDataObject(0, surface)
+    representation.Update()
+
+    # each level is built the first time it is requested.
+    for mode in ('build', 'get'):
+        for level in range(nlevels):
+            data, seconds = __get_level(representation, level)
+            results.append((mode, 'level %d' % level, __count_triangles(data),
+                seconds))
+    del representation
+
+    for result in results:
+        print '============================================================'
+        print result[0]
+        print result[1]
+        print result[2], ' triangles'
+        print result[3], ' seconds'
+
+    if filename:
+        f = open(filename, "w")
+    else:
+        f = sys.stdout
+    print >>f, 'mode, operation, triangles, seconds'
+    for result in results:
+        print >>f, '%s, %s, %d, %g' % result
+
+
+if __name__ == "__main__":
+    run()
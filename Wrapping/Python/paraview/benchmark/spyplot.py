@@ -0,0 +1,201 @@
+'''
+SpyPlot decoding benchmark.
+
+Writes a synthetic SPCTH SpyPlot file with several blocks, cell fields and
+time steps, its planes run-length encoded as SPCTH does, then reads it with
+vtkSpyPlotReader and reports the seconds needed to:
+
+  - read each time step for the first time,
+  - go back to the first time step,
+  - select another cell array, then the first one again,
+
+with the cache of decoded arrays of the reader enabled and disabled (see
+vtkSpyPlotReader::SetDecodedCacheSize()). The planes of each field are
+decoded concurrently, using the threads of vtkSMPTools.
+
+To run the benchmark, either import spyplot from paraview.benchmark and
+call its run method, or run this module directly via pvpython.
+'''
+
+import datetime as dt
+import os
+import shutil
+import struct
+import sys
+import tempfile
+
+import paraview
+
+__MAX_DUMPS = 100
+__FIELDS = ('density', 'pressure', 'temperature')
+
+
+def __string(text, length):
+    return struct.pack('%ds' % length, text)
+
+
+def __encode_values(values):
+    '''Returns the run-length encoding of values as literal runs.'''
+    runs = []
+    for start in range(0, len(values), 127):
+        chunk = values[start:start + 127]
+        runs.append(chr(128 + len(chunk)))
+        runs.append(struct.pack('>%df' % len(chunk), *chunk))
+    return ''.join(runs)
+
+
+def __encode_coordinates(origin, spacing, count):
+    '''Returns the encoding of count regularly spaced coordinates.'''
+    runs = [struct.pack('>ff', origin, spacing)]
+    while count > 0:
+        run = min(count, 127)
+        runs.append(chr(run) + struct.pack('>f', 0.0))
+        count -= run
+    return ''.join(runs)
+
+
+def __write_file(filename, nblocks, dimension, nsteps):
+    '''Writes the file: nblocks blocks of dimension^3 cells side by side
+    along x, with the fields of __FIELDS, for nsteps time steps.'''
+    f = open(filename, 'wb')
+    f.write('spydata\0')
+    f.write(__string('SpyPlot decoding benchmark', 128))
+    # version, size of file pointers, compression, processor id, number of
+    # processors, coordinate system (3D cartesian), dimensions, materials,
+    # maximum number of materials
+    f.write(struct.pack('>9i', 104, 64, 1, 0, 1, 30, 3, 1, 1))
+    f.write(struct.pack('>3d', 0, 0, 0))
+    f.write(struct.pack('>3d', nblocks * dimension, dimension, dimension))
+    f.write(struct.pack('>2i', nblocks, 1))
+
+    # cell fields, then no material field
+    f.write(struct.pack('>i', len(__FIELDS)))
+    for index, name in enumerate(__FIELDS):
+        f.write(__string(name[:8].upper(), 30))
+        f.write(__string(name, 80))
+        f.write(struct.pack('>i', index + 1))
+    f.write(struct.pack('>i', 0))
+
+    # the group header follows its offset, the dump offsets are filled in
+    # once the dumps are written.
+    header = f.tell() + 8
+    f.write(struct.pack('>q', header))
+    f.write(struct.pack('>i', nsteps))
+    f.write(struct.pack('>%di' % __MAX_DUMPS, *range(__MAX_DUMPS)))
+    f.write(struct.pack('>%dd' % __MAX_DUMPS, *range(__MAX_DUMPS)))
+    f.write(struct.pack('>%dd' % __MAX_DUMPS, *([1.0] * __MAX_DUMPS)))
+    offsets = f.tell()
+    f.write(struct.pack('>%dq' % __MAX_DUMPS, *([0] * __MAX_DUMPS)))
+
+    dumps = []
+    plane = dimension * dimension
+    for step in range(nsteps):
+        dumps.append(f.tell())
+        nvars = len(__FIELDS)
+        f.write(struct.pack('>i', nvars))
+        f.write(struct.pack('>%di' % nvars, *range(1, nvars + 1)))
+        variables = f.tell()
+        f.write(struct.pack('>%dq' % nvars, *([0] * nvars)))
+        # no tracers, no histograms
+        f.write(struct.pack('>2i', 0, 0))
+        f.write(struct.pack('>i', nblocks))
+        for block in range(nblocks):
+            # dimensions, allocated, active, level, bounds
+            f.write(struct.pack('>3i', dimension, dimension, dimension))
+            f.write(struct.pack('>3i', 1, 1, 0))
+            f.write(struct.pack('>6i', block * dimension,
+                (block + 1) * dimension - 1, 0, dimension - 1, 0,
+                dimension - 1))
+        for block in range(nblocks):
+            for origin in (block * dimension, 0, 0):
+                coordinates = __encode_coordinates(origin, 1.0, dimension + 1)
+                f.write(struct.pack('>i', len(coordinates)))
+                f.write(coordinates)
+
+        starts = []
+        for field in range(nvars):
+            starts.append(f.tell())
+            for block in range(nblocks):
+                for z in range(dimension):
+                    base = step + field * 1000 + block + z * 0.001
+                    values = [base + i * 1e-6 for i in range(plane)]
+                    encoded = __encode_values(values)
+                    f.write(struct.pack('>i', len(encoded)))
+                    f.write(encoded)
+        end = f.tell()
+        f.seek(variables)
+        f.write(struct.pack('>%dq' % nvars, *starts))
+        f.seek(end)
+
+    f.seek(offsets)
+    f.write(struct.pack('>%dq' % len(dumps), *dumps))
+    f.close()
+
+
+def __update(reader, time):
+    '''Returns the seconds needed to update the reader at time.'''
+    c1 = dt.datetime.now()
+    reader.UpdateTimeStep(time)
+    return (dt.datetime.now() - c1).total_seconds()
+
+
+def __select(reader, name):
+    for field in __FIELDS:
+        reader.SetCellArrayStatus(field, 1 if field == name else 0)
+
+
+def run(nblocks=8, dimension=32, nsteps=4, cachesize=256, filename=None):
+    '''Runs the benchmark. cachesize is the size of the cache in MiB used
+    for the runs with the cache. If a filename is specified, the results
+    are written to that file as csv.
+    '''
+    from vtk.vtkPVVTKExtensionsDefault import vtkSpyPlotReader
+
+    paraview.servermanager.SetProgressPrintingEnabled(0)
+
+    directory = tempfile.mkdtemp()
+    results = []
+    try:
+        spcth = os.path.join(directory, 'benchmark.spcth')
+        __write_file(spcth, nblocks, dimension, nsteps)
+
+        for size in (0, cachesize):
+            vtkSpyPlotReader.SetDecodedCacheSize(size)
+            reader = vtkSpyPlotReader()
+            reader.SetFileName(spcth)
+            reader.UpdateInformation()
+            __select(reader, __FIELDS[0])
+
+            operations = []
+            for step in range(nsteps):
+                operations.append(('read time step %d' % step,
+                    __update(reader, step)))
+            operations.append(('back to time step 0', __update(reader, 0)))
+            __select(reader, __FIELDS[1])
+            operations.append(('select %s' % __FIELDS[1], __update(reader, 0)))
+            __select(reader, __FIELDS[0])
+            operations.append(('select %s again' % __FIELDS[0],
+                __update(reader, 0)))
+            del reader
+
+            for operation, seconds in operations:
+                print '============================================================'
+                print 'cache: %d MiB' % size
+                print operation
+                print seconds, ' seconds'
+                results.append((size, operation, seconds))
+    finally:
+        vtkSpyPlotReader.SetDecodedCacheSize(256)
+        shutil.rmtree(directory)
+
+    if filename:
+        f = open(filename, "w")
+    else:
+        f = sys.stdout
+    print >>f, 'cache size (MiB), operation, seconds'
+    for result in results:
+        print >>f, '%d, %s, %g' % result
+
+
+if __name__ == "__main__":
+    run()
@@ -0,0 +1,135 @@
+'''
+Web image delivery benchmark.
+
+Rotates the camera of a render view through the interaction events a
+ParaViewWeb client sends, and delivers the image of every frame the way
+vtkPVWebApplication does for the web clients: either as a base64 string, see
+InteractiveRender(), or as a raw binary buffer, see InteractiveRenderToBuffer().
+A local stand-in client receives every payload and turns it back into the
+compressed image, as a browser does before decoding it. Reports the bytes per
+frame, the average and maximum latency from the interaction event to the
+image available on the client, and the frames per second.
+
+Requires ParaView to be built with ParaViewWeb. To run the benchmark, either
+import webimages from paraview.benchmark and call its run method, or run this
+module directly via pvpython.
+'''
+
+import base64
+import datetime as dt
+import sys
+
+import paraview
+from paraview.simple import *
+
+
+class StandInClient(object):
+    '''Receives the payloads as they would arrive on a WebSocket.'''
+
+    def __init__(self, binary):
+        self.binary = binary
+        self.nbytes = 0
+        self.nframes = 0
+
+    def receive(self, array):
+        '''Receives the array returned by the application, returns the
+        compressed image.'''
+        payload = str(buffer(array))
+        if not self.binary:
+            # StillRender() returns a null terminated string.
+            payload = payload.rstrip('\0')
+        self.nbytes += len(payload)
+        self.nframes += 1
+        return payload if self.binary else base64.b64decode(payload)
+
+
+def __drag_event(x, y, buttons):
+    from vtk.vtkWebCore import vtkWebInteractionEvent
+    event = vtkWebInteractionEvent()
+    event.SetButtons(buttons)
+    event.SetX(x)
+    event.SetY(y)
+    return event
+
+
+def __interact(app, view, binary, nframes, quality):
+    '''Drags the mouse across the view for nframes frames and returns the
+    client, the latencies in seconds and the frames per second.'''
+    from vtk.vtkWebCore import vtkWebInteractionEvent
+    left = vtkWebInteractionEvent.LEFT_BUTTON
+    client = StandInClient(binary)
+    latencies = []
+
+    app.HandleInteractionEvent(view.SMProxy, __drag_event(0.1, 0.5, left))
+    c1 = dt.datetime.now()
+    for i in range(nframes):
+        x = 0.1 + 0.8 * (i + 1) / float(nframes)
+        f1 = dt.datetime.now()
+        app.HandleInteractionEvent(view.SMProxy, __drag_event(x, 0.5, left))
+        if binary:
+            array = app.InteractiveRenderToBuffer(view.SMProxy, quality)
+        else:
+            array = app.InteractiveRender(view.SMProxy, quality)
+        client.receive(array)
+        latencies.append((dt.datetime.now() - f1).total_seconds())
+    elapsed = (dt.datetime.now() - c1).total_seconds()
+    app.HandleInteractionEvent(view.SMProxy, __drag_event(0.9, 0.5, 0))
+
+    fps = nframes / elapsed if elapsed > 0 else 0.0
+    return client, latencies, fps
+
+
+def run(nframes=100, size=[1024, 768], quality=50, filename=None):
+    '''Runs the benchmark. If a filename is specified, the results are
+    written to that file as csv.
+    '''
+    try:
+        from vtk.vtkParaViewWebCore import vtkPVWebApplication
+    except ImportError:
+        print 'ParaViewWeb is not available, cannot run the benchmark.'
+        return
+
+    paraview.servermanager.SetProgressPrintingEnabled(0)
+
+    wavelet = Wavelet(WholeExtent=[-64, 64] * 3)
+    contour = Contour(Input=wavelet, ContourBy=['POINTS', 'RTData'],
+                      Isosurfaces=[100.0, 157.0, 220.0])
+    view = CreateRenderView()
+    view.ViewSize = size
+    display = Show(contour, view)
+    ColorBy(display, ('POINTS', 'Normals', 'Magnitude'))
+    ResetCamera(view)
+    Render(view)
+
+    app = vtkPVWebApplication()
+    results = []
+    for binary in (False, True):
+        # first frame is not timed: the image encoder is started then.
+        __interact(app, view, binary, 1, quality)
+        client, latencies, fps = __interact(app, view, binary, nframes, quality)
+        mode = 'binary' if binary else 'base64'
+        average = sum(latencies) / len(latencies) if latencies else 0.0
+        bytesPerFrame = client.nbytes / float(max(client.nframes, 1))
+        print '============================================================'
+        print 'image delivery: %s' % mode
+        print bytesPerFrame, ' bytes/frame'
+        print average * 1000, ' ms average latency'
+        print max(latencies) * 1000 if latencies else 0.0, ' ms maximum latency'
+        print fps, ' frames/sec'
+        results.append((mode, bytesPerFrame, average, max(latencies), fps))
+
+    Delete(view)
+    Delete(contour)
+    Delete(wavelet)
+
+    if filename:
+        f = open(filename, "w")
+    else:
+        f = sys.stdout
+    print >>f, 'image delivery, bytes/frame, average latency (s), maximum latency (s), frames/sec'
+    for result in results:
+        print >>f, '%s, %g, %g, %g, %g' % result
+
+
+if __name__ == "__main__":
+    run()